@@ -0,0 +1,144 @@
+
+#include <loco.h>
+#include <chrono>
+#include <iostream>
+#include <limits>
+
+#include <loco_common_dart.h>
+
+// Exposes the creation of collision-objects, so the filters can be queried without going through a full step
+class TExposedBulletCollisionDetector : public dart::collision::BulletCollisionDetector
+{
+public :
+    TExposedBulletCollisionDetector() : dart::collision::BulletCollisionDetector() {}
+
+    using dart::collision::CollisionDetector::claimCollisionObject;
+};
+
+// Previous filter implementation (hash-maps lookups on every pair), the baseline of the dense-slots filter
+class TMapBasedBitmaskCollisionFilter : public dart::collision::BodyNodeCollisionFilter
+{
+public :
+
+    bool ignoresCollision( const dart::collision::CollisionObject* object_1,
+                           const dart::collision::CollisionObject* object_2 ) const override
+    {
+        if ( dart::collision::BodyNodeCollisionFilter::ignoresCollision( object_1, object_2 ) )
+            return true;
+
+        auto shape_node_1 = object_1->getShapeFrame()->asShapeNode();
+        auto shape_node_2 = object_2->getShapeFrame()->asShapeNode();
+
+        if ( m_CollisionGroupsMap.find( shape_node_1 ) == m_CollisionGroupsMap.end() ||
+             m_CollisionGroupsMap.find( shape_node_2 ) == m_CollisionGroupsMap.end() ||
+             m_CollisionMasksMap.find( shape_node_1 ) == m_CollisionMasksMap.end() ||
+             m_CollisionMasksMap.find( shape_node_2 ) == m_CollisionMasksMap.end() )
+            return false;
+
+        auto shape_1_colgroup = m_CollisionGroupsMap.at( shape_node_1 );
+        auto shape_2_colgroup = m_CollisionGroupsMap.at( shape_node_2 );
+        auto shape_1_colmask = m_CollisionMasksMap.at( shape_node_1 );
+        auto shape_2_colmask = m_CollisionMasksMap.at( shape_node_2 );
+
+        bool col_affinity_1_2 = ( shape_1_colgroup & shape_2_colmask ) != 0;
+        bool col_affinity_2_1 = ( shape_2_colgroup & shape_1_colmask ) != 0;
+
+        return !(col_affinity_1_2 || col_affinity_2_1);
+    }
+
+    void setCollisionGroup( const dart::dynamics::ShapeNode* shape_node, int collision_group )
+    {
+        m_CollisionGroupsMap[shape_node] = collision_group;
+    }
+
+    void setCollisionMask( const dart::dynamics::ShapeNode* shape_node, int collision_mask )
+    {
+        m_CollisionMasksMap[shape_node] = collision_mask;
+    }
+
+private :
+
+    std::unordered_map<const dart::dynamics::ShapeNode*,int> m_CollisionGroupsMap;
+    std::unordered_map<const dart::dynamics::ShapeNode*,int> m_CollisionMasksMap;
+};
+
+using TObjectPairs = std::vector<std::pair<dart::collision::CollisionObject*, dart::collision::CollisionObject*>>;
+
+// Average cost of a single ->ignoresCollision call over all given pairs (best of a few runs)
+template< class FilterType >
+double time_per_pair_ns( const FilterType& filter, const TObjectPairs& pairs, size_t num_repetitions, size_t& dst_num_ignored )
+{
+    double best_ns_per_pair = std::numeric_limits<double>::infinity();
+    for ( size_t run = 0; run < 5; run++ )
+    {
+        dst_num_ignored = 0;
+        auto t_start = std::chrono::high_resolution_clock::now();
+        for ( size_t r = 0; r < num_repetitions; r++ )
+            for ( const auto& pair : pairs )
+                dst_num_ignored += filter.ignoresCollision( pair.first, pair.second ) ? 1 : 0;
+        auto t_end = std::chrono::high_resolution_clock::now();
+        const double duration_ns = std::chrono::duration<double, std::nano>( t_end - t_start ).count();
+        best_ns_per_pair = std::min( best_ns_per_pair, duration_ns / ( num_repetitions * pairs.size() ) );
+    }
+    return best_ns_per_pair;
+}
+
+// Per-pair cost of the collision-filter, before (hash-maps) and after (dense slots), on a swarm-like setup where
+// agents (group 2) only collide with the environment (group 1), and vice-versa
+// usage: bench_collision_filter_dart [num_bodies] [num_repetitions]
+int main( int argc, char* argv[] )
+{
+    loco::InitUtils();
+
+    const size_t num_bodies = ( argc > 1 ) ? std::stoul( argv[1] ) : 256;
+    const size_t num_repetitions = ( argc > 2 ) ? std::stoul( argv[2] ) : 20;
+
+    std::vector<dart::dynamics::SkeletonPtr> skeletons;
+    std::vector<dart::dynamics::ShapeNode*> shape_nodes;
+    for ( size_t i = 0; i < num_bodies; i++ )
+    {
+        auto skeleton = dart::dynamics::Skeleton::create( "body_" + std::to_string( i ) );
+        auto joint_bodynode_pair = skeleton->createJointAndBodyNodePair<dart::dynamics::FreeJoint>();
+        auto shape_node = joint_bodynode_pair.second->createShapeNodeWith<dart::dynamics::CollisionAspect>(
+                                    std::make_shared<dart::dynamics::BoxShape>( Eigen::Vector3d( 0.1, 0.1, 0.1 ) ) );
+        skeletons.push_back( skeleton );
+        shape_nodes.push_back( shape_node );
+    }
+
+    auto detector = std::make_shared<TExposedBulletCollisionDetector>();
+    std::vector<std::shared_ptr<dart::collision::CollisionObject>> objects;
+    for ( auto shape_node : shape_nodes )
+        objects.push_back( detector->claimCollisionObject( shape_node ) );
+
+    TMapBasedBitmaskCollisionFilter map_filter;
+    loco::dartsim::TDartBitmaskCollisionFilter dense_filter;
+    for ( size_t i = 0; i < num_bodies; i++ )
+    {
+        const int group = ( i % 8 == 0 ) ? 1 : 2;
+        const int mask = ( i % 8 == 0 ) ? 2 : 1;
+        map_filter.setCollisionGroup( shape_nodes[i], group );
+        map_filter.setCollisionMask( shape_nodes[i], mask );
+        dense_filter.setCollisionGroup( shape_nodes[i], group );
+        dense_filter.setCollisionMask( shape_nodes[i], mask );
+    }
+
+    TObjectPairs pairs;
+    for ( size_t i = 0; i < num_bodies; i++ )
+        for ( size_t j = i + 1; j < num_bodies; j++ )
+            pairs.push_back( { objects[i].get(), objects[j].get() } );
+
+    size_t num_ignored_map = 0, num_ignored_dense = 0;
+    const double map_ns_per_pair = time_per_pair_ns( map_filter, pairs, num_repetitions, num_ignored_map );
+    const double dense_ns_per_pair = time_per_pair_ns( dense_filter, pairs, num_repetitions, num_ignored_dense );
+    if ( num_ignored_map != num_ignored_dense )
+    {
+        std::cout << "ERROR: filters disagree (" << num_ignored_map << " vs " << num_ignored_dense << " ignored pairs)" << std::endl;
+        return 1;
+    }
+
+    std::cout << "TDartBitmaskCollisionFilter per-pair cost (" << pairs.size() << " pairs, " << num_repetitions << " repetitions)" << std::endl;
+    std::cout << "\thash-maps (before) : " << map_ns_per_pair << " ns/pair" << std::endl;
+    std::cout << "\tdense-slots (after): " << dense_ns_per_pair << " ns/pair" << std::endl;
+    std::cout << "\tspeedup            : " << map_ns_per_pair / dense_ns_per_pair << "x" << std::endl;
+    return 0;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <loco_common_dart.h>
+
+namespace loco {
+namespace kintree {
+
+    // Control modes of the joint actuators
+    enum class eDartActuatorMode : uint8_t
+    {
+        TORQUE = 0, // target is the motor torque
+        POSITION,   // PD controller towards the target joint position
+        VELOCITY    // P controller (with kv as gain) towards the target joint velocity
+    };
+
+    // User-data of a joint actuator. Gains act on joint-space errors and produce motor torques, which are clamped by
+    // the torque limit of the motor and then amplified by the gear-ratio before being applied to the joint
+    struct TDartActuatorData
+    {
+        eDartActuatorMode mode = eDartActuatorMode::TORQUE;
+        TScalar kp = 0.0f;
+        TScalar kv = 0.0f;
+        TScalar gear = 1.0f;
+        TScalar torque_limit = std::numeric_limits<TScalar>::infinity();
+    };
+
+    // Actuators of single dofs of kintree joints, evaluated for all skeletons at once before every substep. State
+    // is kept as structure-of-arrays, so the control law runs as a single vectorized pass over all actuators
+    class TDartJointActuators
+    {
+    public :
+
+        TDartJointActuators() = default;
+
+        TDartJointActuators( const TDartJointActuators& other ) = delete;
+
+        TDartJointActuators& operator=( const TDartJointActuators& other ) = delete;
+
+        ~TDartJointActuators() = default;
+
+        // Adds an actuator to a dof of the given joint of a skeleton, returning its index (-1 if not supported)
+        ssize_t AddActuator( dart::dynamics::Skeleton* skeleton, const std::string& joint_name,
+                             const TDartActuatorData& data, ssize_t dof_index = 0 );
+
+        // Computes the torques of all actuators from the current joints' state, and applies them to their dofs
+        void Evaluate();
+
+        void ChangeMode( ssize_t actuator_index, const eDartActuatorMode& mode );
+
+        void ChangeGains( ssize_t actuator_index, const TScalar& kp, const TScalar& kv );
+
+        void ChangeTorqueLimit( ssize_t actuator_index, const TScalar& torque_limit );
+
+        // Targets of all actuators (torque, position or velocity, according to each actuator's mode)
+        void SetTargets( const Eigen::VectorXd& targets );
+
+        void SetTarget( ssize_t actuator_index, double target ) { m_Targets[actuator_index] = target; }
+
+        const Eigen::VectorXd& targets() const { return m_Targets; }
+
+        // Joint torques applied by all actuators on the last evaluation
+        const Eigen::VectorXd& torques() const { return m_Torques; }
+
+        ssize_t num_actuators() const { return m_Dofs.size(); }
+
+    private :
+
+        void _UpdateModeMasks( ssize_t actuator_index, const eDartActuatorMode& mode );
+
+    private :
+
+        // Dofs driven by each actuator, and references to their position|velocity (joint's internal state)
+        std::vector<dart::dynamics::DegreeOfFreedom*> m_Dofs;
+        std::vector<const double*> m_QposRefs;
+        std::vector<const double*> m_QvelRefs;
+        // Parameters of all actuators (mode given as 0|1 masks, so modes can be mixed in a single pass)
+        Eigen::ArrayXd m_Kp;
+        Eigen::ArrayXd m_Kv;
+        Eigen::ArrayXd m_Gear;
+        Eigen::ArrayXd m_TorqueLimit;
+        Eigen::ArrayXd m_TorqueMask;
+        Eigen::ArrayXd m_PositionMask;
+        Eigen::ArrayXd m_VelocityMask;
+        // Targets given by the user, and torques applied on the last evaluation
+        Eigen::VectorXd m_Targets;
+        Eigen::VectorXd m_Torques;
+        // Joints' state gathered on each evaluation
+        Eigen::ArrayXd m_Qpos;
+        Eigen::ArrayXd m_Qvel;
+    };
+}}
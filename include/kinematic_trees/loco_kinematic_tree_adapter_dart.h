@@ -2,6 +2,8 @@
 
 #include <loco_common_dart.h>
 #include <kinematic_trees/loco_kinematic_tree_adapter.h>
+#include <kinematic_trees/loco_kinematic_tree_body_adapter_dart.h>
+#include <kinematic_trees/loco_kinematic_tree_joint_adapter_dart.h>
 
 namespace loco {
 namespace kintree {
@@ -15,8 +17,11 @@ namespace kintree {
     {
     public :
 
-        TDartKinematicTreeAdapter( TKinematicTree* kintree_ref )
-            : TIKinematicTreeAdapter( kintree_ref ) {}
+        TDartKinematicTreeAdapter( TKinematicTree* kintree_ref );
+
+        TDartKinematicTreeAdapter( const TDartKinematicTreeAdapter& other ) = delete;
+
+        TDartKinematicTreeAdapter& operator=( const TDartKinematicTreeAdapter& other ) = delete;
 
         ~TDartKinematicTreeAdapter();
 
@@ -34,17 +39,85 @@ namespace kintree {
 
         void GetTransform( TMat4& dst_tf ) override;
 
-        void GetLinearVelocity( TVec3& dst_linearl_vel ) override;
+        void GetLinearVelocity( TVec3& dst_linear_vel ) override;
 
         void GetAngularVelocity( TVec3& dst_angular_vel ) override;
 
+        // Generalized coordinates of the whole kinematic-tree, as a single contiguous vector laid out as in the dart
+        // skeleton (joints in tree order, orientations of ball|free joints as exponential coordinates). These map
+        // directly onto Skeleton::getPositions|setPositions (and velocities), with no per-joint conversions
+        void GetQpos( Eigen::VectorXd& dst_qpos ) const;
+
+        void SetQpos( const Eigen::VectorXd& qpos );
+
+        void GetQvel( Eigen::VectorXd& dst_qvel ) const;
+
+        void SetQvel( const Eigen::VectorXd& qvel );
+
+        // Kintrees with the same signature (same structure, joints, colliders and inertias, regardless of names and
+        // placement) can share a single dart-skeleton template: only the first one is built from scratch, and the
+        // others are cloned from it (sharing collision-shapes, until a collider changes its size)
+        static std::string ComputeTemplateSignature( const TKinematicTree* kintree );
+
+        // Sets the kintree-adapter to clone the skeleton from (must be built before this one, and share its signature)
+        void SetTemplate( TDartKinematicTreeAdapter* template_ref ) { m_TemplateRef = template_ref; }
+
+        const TDartKinematicTreeAdapter* template_ref() const { return m_TemplateRef; }
+
+        // Sets which bodies of this kintree can collide with each other (explicit pairs given by body names). The
+        // policy is compiled into a pairs-table when built, and used by the collision-filter of the simulation
+        void SetSelfCollisionPolicy( const dartsim::eDartSelfCollisionPolicy& policy,
+                                     const std::vector<std::pair<std::string, std::string>>& pairs = {} );
+
+        dartsim::eDartSelfCollisionPolicy self_collision_policy() const { return m_SelfCollisionPolicy; }
+
+        const dartsim::TDartSelfCollisionTable& self_collision_table() const { return m_SelfCollisionTable; }
+
+        ssize_t num_dofs() const { return m_DartSkeleton ? m_DartSkeleton->getNumDofs() : 0; }
+
+        void SetDartWorld( dart::simulation::World* world_ref );
+
+        // Scene-cache used on ->Build for the collision-shapes and inertias of the bodies (nullptr to build from scratch)
+        void SetSceneCache( dartsim::TDartSceneCache* scene_cache_ref ) { m_SceneCacheRef = scene_cache_ref; }
+
+        // Parallel builder holding the collision-shapes and inertias of the bodies already built (nullptr to build on ->Build)
+        void SetParallelBuilder( dartsim::TDartParallelBuilder* parallel_builder_ref ) { m_ParallelBuilderRef = parallel_builder_ref; }
+
         dart::dynamics::SkeletonPtr& skeleton() { return m_DartSkeleton; }
 
         const dart::dynamics::SkeletonPtr& skeleton() const { return m_DartSkeleton; }
 
+        std::vector<std::unique_ptr<TDartKinematicTreeBodyAdapter>>& body_adapters() { return m_BodyAdapters; }
+
+        const std::vector<std::unique_ptr<TDartKinematicTreeBodyAdapter>>& body_adapters() const { return m_BodyAdapters; }
+
+    private :
+
+        void _BuildFromTemplate();
+
+        void _CacheJointsStateViews();
+
+        void _CompileSelfCollisionPolicy();
+
     private :
 
         // Internal dart resource that holds articulated system
         dart::dynamics::SkeletonPtr m_DartSkeleton;
+        // Adapters of all bodies in the kinematic tree (parents always come before their children)
+        std::vector<std::unique_ptr<TDartKinematicTreeBodyAdapter>> m_BodyAdapters;
+        // Reference to the dart-world related to the current simulation
+        dart::simulation::World* m_DartWorldRef = nullptr;
+        // Reference to the adapter whose skeleton is cloned by this one (nullptr if built from scratch)
+        TDartKinematicTreeAdapter* m_TemplateRef = nullptr;
+        // Reference to the scene-cache of the simulation (if any)
+        dartsim::TDartSceneCache* m_SceneCacheRef = nullptr;
+        // Reference to the parallel builder of the simulation (if any)
+        dartsim::TDartParallelBuilder* m_ParallelBuilderRef = nullptr;
+        // Self-collision policy of this kintree (none by default, as dart skeletons), and its compiled pairs-table
+        dartsim::eDartSelfCollisionPolicy m_SelfCollisionPolicy = dartsim::eDartSelfCollisionPolicy::NONE;
+        std::vector<std::pair<std::string, std::string>> m_SelfCollisionPairs;
+        dartsim::TDartSelfCollisionTable m_SelfCollisionTable;
+        // Collision-filter of the simulation (nullptr if the world uses a different one)
+        dartsim::TDartBitmaskCollisionFilter* m_CollisionFilterRef = nullptr;
     };
-}}
\ No newline at end of file
+}}
@@ -1,11 +1,14 @@
 #pragma once
 
 #include <loco_common_dart.h>
+#include <loco_parallel_build_dart.h>
 #include <kinematic_trees/loco_kinematic_tree_body_adapter.h>
+#include <kinematic_trees/loco_kinematic_tree_collider_adapter_dart.h>
 
 namespace loco {
 namespace kintree {
     class TKinematicTreeBody;
+    class TDartKinematicTreeJointAdapter;
 }}
 
 namespace loco {
@@ -15,13 +18,20 @@ namespace kintree {
     {
     public :
 
-        TDartKinematicTreeBodyAdapter( TKinematicTreeBody* body_ref )
-            : TIKinematicTreeBodyAdapter( body_ref ) {}
+        TDartKinematicTreeBodyAdapter( TKinematicTreeBody* body_ref );
 
-        ~TIKinematicTreeBodyAdapter();
+        TDartKinematicTreeBodyAdapter( const TDartKinematicTreeBodyAdapter& other ) = delete;
+
+        TDartKinematicTreeBodyAdapter& operator=( const TDartKinematicTreeBodyAdapter& other ) = delete;
+
+        ~TDartKinematicTreeBodyAdapter();
 
         void Build() override;
 
+        // Grabs the body-node (and joint, shape-nodes) created by cloning the skeleton of a template kintree, which
+        // must have been built from an equivalent kintree (same structure and data, see TDartKinematicTreeAdapter)
+        void BuildFromTemplate( TDartKinematicTreeBodyAdapter* template_adapter );
+
         void Initialize() override;
 
         void Reset() override;
@@ -32,13 +42,49 @@ namespace kintree {
 
         void GetTransform( TMat4& dst_transform ) override;
 
+        // Places the body w.r.t. its parent body-node (w.r.t. the world for root bodies), through its joint
+        void SetTransformFromParentBody( const Eigen::Isometry3d& tf_parent_body_to_body );
+
+        void SetDartSkeleton( dart::dynamics::Skeleton* skeleton_ref ) { m_DartSkeletonRef = skeleton_ref; }
+
+        void SetDartWorld( dart::simulation::World* world_ref );
+
+        // Scene-cache used on ->Build for the collision-shapes and inertia of this body (nullptr to build from scratch)
+        void SetSceneCache( dartsim::TDartSceneCache* scene_cache_ref ) { m_SceneCacheRef = scene_cache_ref; }
+
+        // Parallel builder holding the collision-shapes and inertia of this body already built (nullptr to build on ->Build)
+        void SetParallelBuilder( dartsim::TDartParallelBuilder* parallel_builder_ref ) { m_ParallelBuilderRef = parallel_builder_ref; }
+
         dart::dynamics::BodyNode* body_node() { return m_DartBodyNodeRef; }
 
         const dart::dynamics::BodyNode* body_node() const { return m_DartBodyNodeRef; }
 
+        dart::dynamics::Joint* joint() { return m_DartJointRef; }
+
+        const dart::dynamics::Joint* joint() const { return m_DartJointRef; }
+
+        std::vector<std::unique_ptr<TDartKinematicTreeColliderAdapter>>& collider_adapters() { return m_ColliderAdapters; }
+
+        const std::vector<std::unique_ptr<TDartKinematicTreeColliderAdapter>>& collider_adapters() const { return m_ColliderAdapters; }
+
+        std::vector<std::unique_ptr<TDartKinematicTreeJointAdapter>>& joint_adapters() { return m_JointAdapters; }
+
+        const std::vector<std::unique_ptr<TDartKinematicTreeJointAdapter>>& joint_adapters() const { return m_JointAdapters; }
+
     private :
 
+        // Reference to the skeleton of the kinematic-tree this body belongs to
+        dart::dynamics::Skeleton* m_DartSkeletonRef = nullptr;
         // Reference to the dart resource that holds the information of the body in simulation (mass, inertia, com, ...)
         dart::dynamics::BodyNode* m_DartBodyNodeRef = nullptr;
+        // Reference to the dart-joint that connects this body to its parent (weld-joint if the body has no joints)
+        dart::dynamics::Joint* m_DartJointRef = nullptr;
+        // Adapters of the joints and colliders of this body
+        std::vector<std::unique_ptr<TDartKinematicTreeJointAdapter>> m_JointAdapters;
+        std::vector<std::unique_ptr<TDartKinematicTreeColliderAdapter>> m_ColliderAdapters;
+        // Reference to the scene-cache of the simulation (if any)
+        dartsim::TDartSceneCache* m_SceneCacheRef = nullptr;
+        // Reference to the parallel builder of the simulation (if any)
+        dartsim::TDartParallelBuilder* m_ParallelBuilderRef = nullptr;
     };
-}}
\ No newline at end of file
+}}
@@ -25,6 +25,10 @@ namespace kintree {
 
         void Build() override;
 
+        // Reuses the collision-shape of the equivalent collider of a template kintree (the shape-node is the one
+        // created by the cloned skeleton). The shape is shared until one of the colliders changes its size
+        void BuildFromTemplate( TDartKinematicTreeColliderAdapter* template_adapter, dart::dynamics::ShapeNode* shape_node_ref );
+
         void Initialize() override;
 
         void SetLocalTransform( const TMat4& local_tf ) override;
@@ -41,10 +45,25 @@ namespace kintree {
 
         void SetDartWorld( dart::simulation::World* world_ref ) { m_DartWorldRef = world_ref; }
 
+        // Scene-cache used to create the collision-shape on ->Build (nullptr to build it from scratch)
+        void SetSceneCache( dartsim::TDartSceneCache* scene_cache_ref ) { m_SceneCacheRef = scene_cache_ref; }
+
+        // Parallel builder holding the collision-shape already built (nullptr to build on ->Build)
+        void SetParallelBuilder( dartsim::TDartParallelBuilder* parallel_builder_ref ) { m_ParallelBuilderRef = parallel_builder_ref; }
+
         dart::dynamics::ShapePtr& collision_shape() { return m_DartShape; }
 
         const dart::dynamics::ShapePtr& collision_shape() const { return m_DartShape; }
 
+        dart::dynamics::ShapeNode* shape_node() { return m_DartShapeNodeRef; }
+
+        const dart::dynamics::ShapeNode* shape_node() const { return m_DartShapeNodeRef; }
+
+    private :
+
+        // Replaces a shared collision-shape by a copy owned only by this collider (copy-on-write)
+        void _DetachSharedShape();
+
     private :
 
         // Owned internal dart resource for collider data (dims, type, ...)
@@ -53,5 +72,14 @@ namespace kintree {
         dart::dynamics::ShapeNode* m_DartShapeNodeRef = nullptr;
         // Reference to the internal dart world
         dart::simulation::World* m_DartWorldRef = nullptr;
+        // Reference to the scene-cache of the simulation (if any)
+        dartsim::TDartSceneCache* m_SceneCacheRef = nullptr;
+        // Reference to the parallel builder of the simulation (if any)
+        dartsim::TDartParallelBuilder* m_ParallelBuilderRef = nullptr;
+        // Whether or not the collision-shape is shared with other instances of the same kintree-template
+        bool m_ShapeShared = false;
+        // Reference to the collision-filter of the world, and the slot of this collider in it (for O(1) updates)
+        dartsim::TDartBitmaskCollisionFilter* m_CollisionFilterRef = nullptr;
+        ssize_t m_CollisionFilterSlot = -1;
     };
 }}
\ No newline at end of file
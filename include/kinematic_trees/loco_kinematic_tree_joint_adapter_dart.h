@@ -2,7 +2,7 @@
 
 #include <loco_common_dart.h>
 #include <kinematic_trees/loco_kinematic_tree_joint_adapter.h>
-#include <kinematic_trees/loco_kineamtic_tree_body_adapter_dart.h>
+#include <kinematic_trees/loco_kinematic_tree_body_adapter_dart.h>
 
 namespace loco {
 namespace kintree {
@@ -26,6 +26,9 @@ namespace kintree {
 
         void Build() override;
 
+        // Grabs the joint and body-node from a skeleton cloned from a template kintree (see TDartKinematicTreeAdapter)
+        void BuildFromTemplate( const TDartKinematicTreeJointAdapter* template_adapter, dart::dynamics::BodyNode* body_node_ref );
+
         void Initialize() override;
 
         void Reset() override;
@@ -50,9 +53,29 @@ namespace kintree {
 
         void GetQvel( std::vector<TScalar>& dst_qvel ) override;
 
-        void SetDartSkeleton( dart::dynamics::Skeleton* skeleton_ref ) { m_DartSkeletonRef = skeleton_ref; }
+        // Places the joint w.r.t. its parent body-node, given the transform of the body w.r.t. its parent (the
+        // joint's local transform is applied on top of it)
+        void SetTransformFromParentBody( const Eigen::Isometry3d& tf_parent_body_to_body );
+
+        // Caches the range of this joint's dofs in the skeleton's generalized coordinates, and the location of its
+        // internal state (called by the kintree-adapter once the whole skeleton has been built)
+        void CacheStateViews();
+
+        // Zero-copy views of the joint's generalized coordinates (dart's layout, see GetJointPositionsData)
+        Eigen::Map<const Eigen::VectorXd> qpos_view() const { return Eigen::Map<const Eigen::VectorXd>( m_QposDataRef, m_NumDofs ); }
+
+        Eigen::Map<const Eigen::VectorXd> qvel_view() const { return Eigen::Map<const Eigen::VectorXd>( m_QvelDataRef, m_NumDofs ); }
 
-        void SetDartParentsParentBody( dart::dynamics::BodyNode* body_node_ref ) {  }
+        // Views of this joint's range within a whole-skeleton vector (e.g. from TDartKinematicTreeAdapter::GetQpos)
+        Eigen::VectorBlock<Eigen::VectorXd> segment( Eigen::VectorXd& skeleton_vec ) const { return skeleton_vec.segment( m_DofsIndex, m_NumDofs ); }
+
+        Eigen::VectorBlock<const Eigen::VectorXd> segment( const Eigen::VectorXd& skeleton_vec ) const { return skeleton_vec.segment( m_DofsIndex, m_NumDofs ); }
+
+        ssize_t dofs_index() const { return m_DofsIndex; }
+
+        ssize_t num_dofs() const { return m_NumDofs; }
+
+        void SetDartSkeleton( dart::dynamics::Skeleton* skeleton_ref ) { m_DartSkeletonRef = skeleton_ref; }
 
         dart::dynamics::Skeleton* skeleton() { return m_DartSkeletonRef; }
 
@@ -74,7 +97,13 @@ namespace kintree {
         dart::dynamics::Joint* m_DartJointRef = nullptr;
         /// Reference to bodynode-ptr created during joint creation (related to its parent body)
         dart::dynamics::BodyNode* m_DartBodyNodeRef = nullptr;
-        /// Reference to bodynode-ptr created during joint creation (related to its parent's parent body)
-        dart::dynamics::BodyNode* m_DartParentsParentBodyNodeRef = nullptr;
+        /// Transform from the parent body-node to the joint frame, excluding the joint's local transform
+        Eigen::Isometry3d m_TfParentBodyToBody = Eigen::Isometry3d::Identity();
+        /// Index of the first dof of this joint in the skeleton's generalized coordinates, and number of dofs
+        ssize_t m_DofsIndex = 0;
+        ssize_t m_NumDofs = 0;
+        /// Internal state of the joint (owned by dart, nullptr for zero-dof joints)
+        const double* m_QposDataRef = nullptr;
+        const double* m_QvelDataRef = nullptr;
     };
 }}
\ No newline at end of file
@@ -5,6 +5,21 @@
 // Main Dart-API
 #include <dart/dart.hpp>
 #include <dart/collision/bullet/BulletCollisionDetector.hpp>
+#include <dart/collision/bullet/BulletCollisionObject.hpp>
+#include <dart/collision/bullet/BulletCollisionGroup.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace loco {
+namespace dartsim {
+    class TDartSceneCache;
+    class TDartParallelBuilder;
+}}
 
 namespace loco {
 namespace dartsim {
@@ -22,13 +37,135 @@ namespace dartsim {
     TMat4 mat4_from_eigen_tf( const Eigen::Isometry3d& tf );
 
 
-    // Creates a dart collision-shape from given user-data
-    dart::dynamics::ShapePtr CreateCollisionShape( const TShapeData& data );
+    // Assimp scenes of meshes decoded ahead of time, by the address of the shape-data they were loaded for
+    using TDartLoadedMeshes = std::unordered_map<const TShapeData*, const aiScene*>;
+
+    // Decodes the mesh of a mesh shape-data, either from its file (through the scene-cache, if given) or from its
+    // vertex-data (nullptr for other shapes, or on failure). No dart resources are created, so it's safe to call from
+    // several threads at once (unlike creating dart shapes, which take their ids from a shared non-atomic counter)
+    const aiScene* LoadCollisionMesh( const TShapeData& data, TDartSceneCache* scene_cache = nullptr );
+
+    // Creates a dart collision-shape from given user-data (meshes loaded from files go through the scene-cache, if
+    // given). Meshes already decoded for the data (or its children) are taken from the given loaded-meshes instead
+    dart::dynamics::ShapePtr CreateCollisionShape( const TShapeData& data, TDartSceneCache* scene_cache = nullptr,
+                                                   const TDartLoadedMeshes* loaded_meshes = nullptr );
+
+    // Heights of a heightfield in the layout given by the user (row-major, depth rows of width samples), possibly
+    // viewed within a larger buffer (e.g. a tile of a height-file). Dart lays these out with the first row at the
+    // +y border of the shape (rows go along -y), and its bullet collision-detector flips the rows of the heights-
+    // buffer of a heightmap-shape in place every time it builds its terrain-shape (keeping a reference to that
+    // buffer). So the live buffer of a shape might be in either layout, and edits|samples go through an unflipped copy
+    using THeightsMatrix = Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+    using THeightsRef = Eigen::Ref<THeightsMatrix, 0, Eigen::OuterStride<>>;
+    using THeightsConstRef = Eigen::Ref<const THeightsMatrix, 0, Eigen::OuterStride<>>;
+    using THeightsConstMap = Eigen::Map<const THeightsMatrix, Eigen::Unaligned, Eigen::OuterStride<>>;
+
+    enum class eHeightfieldLayout { UNFLIPPED, FLIPPED, UNKNOWN };
+
+    // Current layout of the heights-buffer of a heightmap-shape, found by comparing it against the unflipped heights
+    // (UNKNOWN if these are symmetric along y, as both layouts hold the same data then, or if out of sync)
+    eHeightfieldLayout GetHeightfieldLayout( const dart::dynamics::HeightmapShapef* hfield_shape,
+                                             const THeightsConstRef& heights_unflipped );
+
+    // Copies the (width x depth) region starting at sample (x0, y0) of the (already updated) unflipped heights into
+    // the heights-buffer of a heightmap-shape, given the layout of that buffer before the update. The shape is rebuilt
+    // from the unflipped heights instead if its layout is unknown, or if the region goes past its bounds
+    void WriteHeightfieldRegion( dart::dynamics::HeightmapShapef* hfield_shape, eHeightfieldLayout layout,
+                                 const THeightsConstRef& heights_unflipped,
+                                 ssize_t x0, ssize_t y0, ssize_t width, ssize_t depth );
+
+    // Writes a (width x depth) patch of heights starting at sample (x0, y0) both into the unflipped heights and
+    // into the heightmap-shape built from them. Rows of the patch are read from the given buffer every (stride) elements
+    void UpdateHeightfieldRegion( dart::dynamics::HeightmapShapef* hfield_shape, THeightsRef heights_unflipped,
+                                  ssize_t x0, ssize_t y0, ssize_t width, ssize_t depth,
+                                  const float* heights, ssize_t stride );
+
+    // Heights (in world-space) of a heightfield at the given (x, y) world points, one point per row. Heights are
+    // interpolated bilinearly from the unflipped heights (the collision-detector uses two triangles per cell instead),
+    // with the samples laid out as dart does (centered at the shape's frame, first row at +y). Expects the shape's
+    // frame to be upright (rotated only around z), and clamps points outside the shape to its border
+    using TPointsXY = Eigen::Matrix<double, Eigen::Dynamic, 2, Eigen::RowMajor>;
+    void SampleHeightfield( const THeightsConstRef& heights_unflipped, const Eigen::Vector3f& scale,
+                            const Eigen::Isometry3d& tf_world_to_shape, const TPointsXY& points_xy,
+                            Eigen::VectorXd& dst_heights );
+
+    // Pointers to the internal (contiguous, in dart's layout) positions|velocities of a joint. These stay valid for
+    // the lifetime of the joint, so can be mapped once and read with no copies (nullptr for zero-dof joints)
+    const double* GetJointPositionsData( const dart::dynamics::Joint* joint );
+    const double* GetJointVelocitiesData( const dart::dynamics::Joint* joint );
+
+    // Conversions between the generalized coordinates of a dart joint and the ones used by loco. These only differ for
+    // ball|free joints: loco uses quaternions (w,x,y,z) for orientations (dart uses exponential coordinates), and the
+    // position of free joints goes first (qpos: [x,y,z,qw,qx,qy,qz], qvel: [vx,vy,vz,wx,wy,wz], in dart's body frame)
+    ssize_t GetJointNumQpos( const dart::dynamics::Joint* joint );
+    ssize_t GetJointNumQvel( const dart::dynamics::Joint* joint );
+    void GetJointQpos( const dart::dynamics::Joint* joint, std::vector<TScalar>& dst_qpos );
+    void GetJointQvel( const dart::dynamics::Joint* joint, std::vector<TScalar>& dst_qvel );
+    void SetJointQpos( dart::dynamics::Joint* joint, const std::vector<TScalar>& qpos );
+    void SetJointQvel( dart::dynamics::Joint* joint, const std::vector<TScalar>& qvel );
 
     // Creates an assimp-scene object from given user data
     const aiScene* CreateAssimpSceneFromVertexData( const std::vector<float>& vertices, const std::vector<int>& faces );
 
+    const aiScene* CreateAssimpSceneFromVertexData( const float* vertices, ssize_t num_vertices, const int* faces, ssize_t num_faces );
+
+    // Policies for collisions between bodies of the same kinematic tree
+    enum class eDartSelfCollisionPolicy
+    {
+        NONE = 0,       // bodies of the same kintree never collide with each other
+        NON_ADJACENT,   // all pairs collide, except parent-child pairs (and bodies with themselves)
+        EXPLICIT_PAIRS  // only the given pairs collide
+    };
+
+    // Symmetric bitset (num_bodies x num_bodies) with the pairs of bodies of a skeleton that can collide with each
+    // other, indexed by the bodies' indices in the skeleton
+    struct TDartSelfCollisionTable
+    {
+        ssize_t num_bodies = 0;
+        std::vector<uint64_t> bits;
+
+        void Resize( ssize_t new_num_bodies );
+
+        void SetPair( ssize_t body_index_1, ssize_t body_index_2, bool collides );
+
+        bool collides( ssize_t body_index_1, ssize_t body_index_2 ) const
+        {
+            const ssize_t bit_index = body_index_1 * num_bodies + body_index_2;
+            return ( bits[bit_index >> 6] >> ( bit_index & 63 ) ) & 1u;
+        }
+    };
+
+    // Compiles the self-collision policy of a skeleton into its pairs-table. Explicit pairs are given by body-node names
+    TDartSelfCollisionTable CompileSelfCollisionTable( const dart::dynamics::Skeleton* skeleton,
+                                                       const eDartSelfCollisionPolicy& policy,
+                                                       const std::vector<std::pair<std::string, std::string>>& pairs );
+
+    // Collision-filtering information of a single shape-node (stored densely, indexed by the slot of the shape-node)
+    struct TDartCollisionFilterEntry
+    {
+        // Shape-node that owns this slot (used to validate the slot cached in the collision-objects)
+        const dart::dynamics::ShapeFrame* shape_frame = nullptr;
+        // Collision group and mask (all bits by default, so unregistered shapes collide as usual)
+        int group = -1;
+        int mask = -1;
+        // Bullet object that cached this slot (nullptr if not seen by the collision-detector yet)
+        btCollisionObject* bullet_object = nullptr;
+        // Whether or not the broadphase proxy of the bullet object must be refreshed before the next step
+        bool pending_refresh = false;
+        // Whether or not the group|mask was given by the user (unregistered shapes keep the defaults)
+        bool registered = false;
+        // Self-collision table of the skeleton of the shape-node (-1 if none), and index of its body in the skeleton
+        ssize_t self_collision_table = -1;
+        ssize_t body_index = -1;
+    };
+
     // Custom ODE-like collision-filtering functionality
+    //
+    // Each shape-node gets a slot into a dense array of group|mask entries when registered. The bullet object of
+    // each slot is found on the next broadphase refresh, and the slot cached in its bullet user-index, so testing a
+    // pair is just a couple of loads and ANDs. Testing pairs never modifies the filter (shapes without a slot use
+    // the default entry, i.e. collide as usual).
+    // @note: expects the collision-objects given to ->ignoresCollision to be created by the bullet collision-detector
     class TDartBitmaskCollisionFilter : public dart::collision::BodyNodeCollisionFilter
     {
         public :
@@ -40,9 +177,180 @@ namespace dartsim {
 
             void setCollisionMask( const dart::dynamics::ShapeNode* shape, int collision_mask );
 
+            // Registers the group|mask of a shape-node, returning its slot for later O(1) updates
+            ssize_t registerShapeNode( const dart::dynamics::ShapeNode* shape, int collision_group, int collision_mask );
+
+            // Releases the slot of a shape-node removed from the world, to be reused by the next shape registered
+            void unregisterShapeNode( ssize_t slot );
+
+            void setCollisionGroup( ssize_t slot, int collision_group );
+
+            void setCollisionMask( ssize_t slot, int collision_mask );
+
+            // Recreates the broadphase proxies of the objects whose group|mask changed, so the pairs they form are
+            // tested again (pairs rejected before never reach the pair-cache, and might not be reported again). If
+            // possible, the group|mask are also stamped into the proxies (see broadphase_filtering)
+            void refreshBroadphase( btCollisionWorld* bullet_world );
+
+            // Sets the pairs of bodies of a skeleton that can collide. Pairs within a skeleton with a table are
+            // decided by a single bit-test, instead of dart's self-collision and adjacency checks
+            void setSelfCollisionTable( const dart::dynamics::Skeleton* skeleton, const TDartSelfCollisionTable& table );
+
+            // Blacklists a pair of bodies (forwarded to dart's blacklist). Pairs are also kept here, as pairs decided
+            // by a self-collision table never reach dart's checks. @note: blacklist pairs through this class, as the
+            // base-class methods aren't virtual
+            void addBodyNodePairToBlackList( const dart::dynamics::BodyNode* bodynode_1, const dart::dynamics::BodyNode* bodynode_2 );
+
+            void removeBodyNodePairFromBlackList( const dart::dynamics::BodyNode* bodynode_1, const dart::dynamics::BodyNode* bodynode_2 );
+
+            void removeAllBodyNodePairsFromBlackList();
+
+            ssize_t num_slots() const { return m_Entries.size(); }
+
+            // Whether or not the group|mask of the registered shapes are stamped into their broadphase proxies, so
+            // bullet rejects pairs with a couple of integer ANDs before even calling this filter. Bullet requires both
+            // (g1 & m2) and (g2 & m1), whereas we require either of them, so this is only enabled if for all classes
+            // (unique group|mask combinations) both tests agree, and if the groups fit in the proxy's filter bits
+            bool broadphase_filtering() const { return m_BroadphaseFiltering; }
+
+            ssize_t num_classes() const { return m_ClassesCount.size(); }
+
+        private :
+
+            ssize_t _GetSlot( const dart::collision::CollisionObject* object ) const;
+
+            ssize_t _GetOrCreateSlot( const dart::dynamics::ShapeFrame* shape_frame );
+
+            void _ResolveObject( ssize_t slot, btCollisionObject* bullet_object );
+
+            void _MarkForRefresh( ssize_t slot );
+
+            void _UpdateClass( TDartCollisionFilterEntry& entry, int collision_group, int collision_mask );
+
+            void _RemoveFromClass( const TDartCollisionFilterEntry& entry );
+
+            bool _CheckBroadphaseFiltering() const;
+
+            void _StampProxy( const TDartCollisionFilterEntry& entry ) const;
+
+            void _ResolveRegisteredObjects( btCollisionWorld* bullet_world );
+
+            void _RefreshAllProxies( btCollisionWorld* bullet_world );
+
+            void _ResolveSelfCollisionTable( TDartCollisionFilterEntry& entry ) const;
+
+            bool _IsBlackListed( const TDartCollisionFilterEntry& entry_1, const TDartCollisionFilterEntry& entry_2 ) const;
+
+        private :
+
+            // Dense storage of group|mask information, indexed by the slot of each shape-node
+            std::vector<TDartCollisionFilterEntry> m_Entries;
+            // Entry used for shapes without a slot
+            TDartCollisionFilterEntry m_DefaultEntry;
+            // Slot of each shape-node (used for collision-objects whose bullet object wasn't resolved yet)
+            std::unordered_map<const dart::dynamics::ShapeFrame*, ssize_t> m_SlotsMap;
+            // Slots released by unregistered shape-nodes, reused before growing the entries
+            std::vector<ssize_t> m_FreeSlots;
+            // Slots whose bullet objects must have their broadphase proxies refreshed before the next step
+            std::vector<ssize_t> m_PendingRefreshSlots;
+            // Number of registered shapes per class (unique group|mask combination)
+            std::map<std::pair<int, int>, ssize_t> m_ClassesCount;
+            // Whether or not the classes changed since the last refresh (requires checking broadphase-filtering again)
+            bool m_ClassesChanged = false;
+            // Slots whose bullet objects must still be found (and their proxies stamped), whether slots were created
+            // since the last refresh, and the number of objects of the bullet world when last looked for these
+            std::vector<ssize_t> m_PendingRegistrationSlots;
+            bool m_NewRegistrations = false;
+            int m_LastNumBulletObjects = 0;
+            // Whether or not group|mask are currently stamped into the broadphase proxies
+            bool m_BroadphaseFiltering = false;
+            // Self-collision tables of the skeletons that have one, and the index of the table of each skeleton
+            std::vector<TDartSelfCollisionTable> m_SelfCollisionTables;
+            std::unordered_map<const dart::dynamics::Skeleton*, ssize_t> m_SelfCollisionTablesMap;
+            // Blacklisted pairs of bodies (sorted by address), checked for pairs decided by a self-collision table
+            std::set<std::pair<const dart::dynamics::BodyNode*, const dart::dynamics::BodyNode*>> m_BlackList;
+    };
+
+    // Settings of the adaptive substepping of the simulation. The number of substeps of each step is raised when the
+    // errors measured in the previous step go past their thresholds, and lowered when all are well below them
+    struct TDartAdaptiveSubstepData
+    {
+        // Range of substeps taken per step
+        ssize_t min_substeps = 1;
+        ssize_t max_substeps = 32;
+        // Thresholds of the errors must be positive (infinity disables the related error)
+        // Maximum penetration depth of contacts (m)
+        double max_penetration = 0.005;
+        // Maximum change of any generalized coordinate within a substep (m for linear dofs, rad for angular ones)
+        double max_displacement = 0.02;
+        // Maximum violation of the position limits of the joints (m|rad)
+        double max_constraint_error = 0.01;
+        // Substeps are lowered only if all errors are below this fraction of their thresholds
+        double lower_ratio = 0.25;
+    };
+
+    // Statistics of the last step of the simulation
+    struct TDartSubstepStats
+    {
+        ssize_t num_substeps = 0;
+        double substep_dt = 0.0;
+        // Maximum errors measured over the substeps (only measured in adaptive mode)
+        double max_penetration = 0.0;
+        double max_displacement = 0.0;
+        double max_constraint_error = 0.0;
+        // Largest ratio of error to its threshold (above 1 raises the substeps of the next step)
+        double error_ratio = 0.0;
+        // Substeps taken since the simulation started
+        ssize_t total_substeps = 0;
+    };
+
+    // Fixed-size pool of worker threads, used to split batched work (e.g. queries) over chunks of items
+    class TDartThreadPool
+    {
+        public :
+
+            // Work over items [begin, end), given the index of the thread running it (in [0, num_threads])
+            using TChunkFcn = std::function<void( ssize_t begin, ssize_t end, ssize_t thread_index )>;
+
+            // Creates the given number of workers (hardware concurrency minus the calling thread if less than 0)
+            TDartThreadPool( ssize_t num_workers = -1 );
+
+            TDartThreadPool( const TDartThreadPool& other ) = delete;
+
+            TDartThreadPool& operator=( const TDartThreadPool& other ) = delete;
+
+            ~TDartThreadPool();
+
+            // Runs the given function over chunks of [0, num_items) on the workers and the calling thread, blocking
+            // until all chunks are done. Chunks have at least min_chunk_size items
+            void ParallelFor( ssize_t num_items, ssize_t min_chunk_size, const TChunkFcn& fcn );
+
+            // Number of threads that might run chunks (workers plus the calling thread)
+            ssize_t num_threads() const { return m_Workers.size() + 1; }
+
+        private :
+
+            void _WorkerLoop( ssize_t worker_index );
+
+            void _RunChunks( ssize_t thread_index );
+
         private :
 
-            std::unordered_map<const dart::dynamics::ShapeNode*,int> m_CollisionGroupsMap;
-            std::unordered_map<const dart::dynamics::ShapeNode*,int> m_CollisionMasksMap;
+            std::vector<std::thread> m_Workers;
+            // Serializes calls to ->ParallelFor from different threads
+            std::mutex m_JobMutex;
+            // Protects the state of the current job, and the conditions used to signal workers and the caller
+            std::mutex m_StateMutex;
+            std::condition_variable m_WorkCondition;
+            std::condition_variable m_DoneCondition;
+            // Current job: function, items, chunk-size, next item to be taken and workers yet to finish
+            const TChunkFcn* m_JobFcn = nullptr;
+            ssize_t m_JobNumItems = 0;
+            ssize_t m_JobChunkSize = 1;
+            std::atomic<ssize_t> m_JobNextItem;
+            ssize_t m_JobPendingWorkers = 0;
+            // Incremented on every job, so workers know when a new one is available
+            uint64_t m_JobGeneration = 0;
+            bool m_Stop = false;
     };
 }}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <loco_common_dart.h>
+
+#include <cstdio>
+
+namespace loco {
+namespace dartsim {
+
+    // Output file written through memory-mapped chunks (plain buffered writes where mmap isn't available)
+    class TDartMappedFileWriter
+    {
+    public :
+
+        TDartMappedFileWriter( const std::string& filepath, size_t chunk_size );
+
+        TDartMappedFileWriter( const TDartMappedFileWriter& other ) = delete;
+
+        TDartMappedFileWriter& operator=( const TDartMappedFileWriter& other ) = delete;
+
+        ~TDartMappedFileWriter();
+
+        bool Write( const void* data, size_t num_bytes );
+
+        // Unmaps the last chunk, and trims the file to the bytes actually written
+        void Close();
+
+        bool valid() const { return m_Valid; }
+
+        size_t size() const { return m_Size; }
+
+    private :
+
+        bool _MapChunk( size_t chunk_index );
+
+    private :
+
+        bool m_Valid = false;
+        size_t m_ChunkSize;
+        size_t m_Size = 0;
+    #if defined( _WIN32 )
+        std::FILE* m_File = nullptr;
+    #else
+        int m_Fd = -1;
+        uint8_t* m_Chunk = nullptr;
+        size_t m_ChunkIndex = 0;
+    #endif
+    };
+
+    // Input file mapped as a whole (read into memory where mmap isn't available). Pages are only loaded when first
+    // accessed, so opening large files is cheap. Writable files are mapped shared, so writes into ->mutable_data()
+    // end up in the file (written back on destruction where mmap isn't available)
+    class TDartMappedFileReader
+    {
+    public :
+
+        TDartMappedFileReader( const std::string& filepath, bool writable = false );
+
+        TDartMappedFileReader( const TDartMappedFileReader& other ) = delete;
+
+        TDartMappedFileReader& operator=( const TDartMappedFileReader& other ) = delete;
+
+        ~TDartMappedFileReader();
+
+        bool valid() const { return m_Data != nullptr; }
+
+        // Contents of the file (aligned for any scalar type, nullptr if the file couldn't be mapped)
+        const uint8_t* data() const { return m_Data; }
+
+        // Writable contents of the file (nullptr if not opened as writable)
+        uint8_t* mutable_data() { return m_Writable ? const_cast<uint8_t*>( m_Data ) : nullptr; }
+
+        size_t size() const { return m_Size; }
+
+        bool writable() const { return m_Writable; }
+
+    private :
+
+        const uint8_t* m_Data = nullptr;
+        size_t m_Size = 0;
+        bool m_Writable = false;
+    #if defined( _WIN32 )
+        std::string m_Filepath;
+        std::vector<uint8_t> m_Buffer;
+    #endif
+    };
+}}
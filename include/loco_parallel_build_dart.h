@@ -0,0 +1,76 @@
+#pragma once
+
+#include <loco_common_dart.h>
+#include <loco_scene_cache_dart.h>
+
+namespace loco {
+namespace dartsim {
+
+    // Resources of the bodies in a scenario that are expensive to build but independent of each other (collision-
+    // shapes, and inertias computed from them), built all at once. Meshes are decoded and inertias computed on a
+    // thread-pool, whereas the dart shapes themselves are created serially in between (these aren't thread-safe to
+    // construct). The adapters then only assemble their skeletons out of these, and skeletons are still added to the
+    // world serially (in the adapters' order). Building is triggered by the first adapter built, so it happens right
+    // before the serial build of the adapters
+    class TDartParallelBuilder
+    {
+    public :
+
+        TDartParallelBuilder( TDartThreadPool* thread_pool_ref );
+
+        TDartParallelBuilder( const TDartParallelBuilder& other ) = delete;
+
+        TDartParallelBuilder& operator=( const TDartParallelBuilder& other ) = delete;
+
+        ~TDartParallelBuilder() = default;
+
+        // Registers the data the resources of a body are built from (inertia only computed if requested). The data
+        // is read on ->Build, so it can still change in between
+        void AddBody( const std::string& name,
+                      const TInertialData* inertia_data,
+                      const std::vector<const TCollisionData*>& colliders_data,
+                      bool compute_inertia );
+
+        // Scene-cache used for the meshes and inertias of the bodies (nullptr to build them from scratch)
+        void SetSceneCache( TDartSceneCache* scene_cache_ref ) { m_SceneCacheRef = scene_cache_ref; }
+
+        // Builds the resources of all registered bodies on the thread-pool (only the first call does any work)
+        void Build();
+
+        // Collision-shape built for the given collider-data (nullptr if it wasn't registered)
+        dart::dynamics::ShapePtr GetShape( const TShapeData* data ) const;
+
+        // Inertia computed for the body with the given inertial-data (false if not registered or not requested)
+        bool GetInertia( const TInertialData* inertia_data, dart::dynamics::Inertia& dst_inertia ) const;
+
+        // Drops the references to the built resources, once the adapters grabbed theirs
+        void Release();
+
+        bool built() const { return m_Built; }
+
+        ssize_t num_bodies() const { return m_Bodies.size(); }
+
+    private :
+
+        struct TBodyEntry
+        {
+            std::string name;
+            const TInertialData* inertia_data = nullptr;
+            std::vector<const TCollisionData*> colliders_data;
+            bool compute_inertia = false;
+            // Resources built on ->Build (one shape per collider)
+            std::vector<dart::dynamics::ShapePtr> shapes;
+            dart::dynamics::Inertia inertia;
+        };
+
+    private :
+
+        std::vector<TBodyEntry> m_Bodies;
+        // Lookups into the built resources, by the address of the data they were built from
+        std::unordered_map<const TShapeData*, dart::dynamics::ShapePtr> m_Shapes;
+        std::unordered_map<const TInertialData*, ssize_t> m_InertiaIndices;
+        TDartThreadPool* m_ThreadPoolRef = nullptr;
+        TDartSceneCache* m_SceneCacheRef = nullptr;
+        bool m_Built = false;
+    };
+}}
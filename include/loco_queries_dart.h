@@ -0,0 +1,137 @@
+#pragma once
+
+#include <loco_common_dart.h>
+#include <dart/collision/fcl/FCLCollisionDetector.hpp>
+
+namespace loco {
+namespace dartsim {
+
+    // Collider-id reported by rays that didn't hit anything, and by rays that hit shapes that aren't colliders of
+    // the scenario (e.g. tiles of tiled terrains)
+    const ssize_t LOCO_DART_RAY_MISS = -1;
+    const ssize_t LOCO_DART_RAY_HIT_UNKNOWN = -2;
+
+    // Batch of rays, with preallocated buffers for both the inputs and the results (one row per ray)
+    struct TDartRayBatch
+    {
+        using TVectors = Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>;
+        using TIds = Eigen::Matrix<ssize_t, Eigen::Dynamic, 1>;
+
+        // Inputs: origins and directions (needn't be normalized) of each ray, and the maximum distance of all rays
+        TVectors origins;
+        TVectors directions;
+        double max_distance = 10.0;
+        // Outputs: distance to the closest hit (max_distance on misses), normal at the hit, and collider hit
+        Eigen::VectorXd distances;
+        TVectors normals;
+        TIds collider_ids;
+
+        void Resize( ssize_t num_rays );
+
+        ssize_t num_rays() const { return origins.rows(); }
+    };
+
+    // Results of the registered distance-queries (one row per query, in registration order)
+    struct TDartDistanceResults
+    {
+        using TVectors = Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>;
+        using TIds = Eigen::Matrix<ssize_t, Eigen::Dynamic, 1>;
+
+        // Minimum distance between the colliders of each query (zero if they're in contact)
+        Eigen::VectorXd distances;
+        // Witness points (in world-space) on the query's collider, and on the closest collider of the other side
+        TVectors points_a;
+        TVectors points_b;
+        // Id of the closest collider of the other side (useful for collider-vs-group queries)
+        TIds collider_ids_b;
+
+        void Resize( ssize_t num_queries );
+
+        ssize_t num_queries() const { return distances.size(); }
+    };
+
+    // Queries against the collision-world of a simulation. Colliders are given ids on registration, which are the
+    // ones reported by the queries (see ->collider_name to go back to the collider)
+    class TDartQueries
+    {
+    public :
+
+        TDartQueries( dart::simulation::World* world_ref, ssize_t num_workers = -1 );
+
+        TDartQueries( const TDartQueries& other ) = delete;
+
+        TDartQueries& operator=( const TDartQueries& other ) = delete;
+
+        ~TDartQueries() = default;
+
+        ssize_t RegisterCollider( const dart::dynamics::ShapeFrame* shape_frame, const std::string& name );
+
+        // Unregisters a collider removed from the world. Its id is reused by the next collider registered, and the
+        // distance-queries it was part of no longer take it into account (ids of other colliders don't change)
+        void UnregisterCollider( const dart::dynamics::ShapeFrame* shape_frame );
+
+        // Casts all rays of the batch against the world's bullet collision-world, in parallel over the rays
+        void CastRays( TDartRayBatch& batch );
+
+        // Registers a distance-query between two registered colliders, returning its index in the results
+        ssize_t RegisterDistancePair( ssize_t collider_a, ssize_t collider_b );
+
+        // Registers a distance-query between a registered collider and the closest one of a group of registered
+        // colliders (the collider itself is excluded from the group), returning its index in the results
+        ssize_t RegisterDistanceGroup( ssize_t collider_a, const std::vector<ssize_t>& colliders_b );
+
+        // Evaluates all registered distance-queries, in parallel over the queries
+        void ComputeDistances( TDartDistanceResults& results );
+
+        // Id of the collider registered with the given shape-frame (-1 if not registered)
+        ssize_t collider_id( const dart::dynamics::ShapeFrame* shape_frame ) const;
+
+        // Id of the collider registered with the given name (-1 if not registered)
+        ssize_t collider_id( const std::string& name ) const;
+
+        // Name of the collider with the given id (empty if unregistered)
+        const std::string& collider_name( ssize_t collider_id ) const { return m_CollidersNames[collider_id]; }
+
+        // Number of ids given to colliders (ids released by unregistered colliders included)
+        ssize_t num_colliders() const { return m_CollidersNames.size(); }
+
+        ssize_t num_distance_queries() const { return m_DistanceQueries.size(); }
+
+        TDartThreadPool& thread_pool() { return m_ThreadPool; }
+
+    private :
+
+        // Distance-query evaluated with dart's fcl distance-support. Groups of all queries come from the same
+        // detector (sharing the fcl geometries of the shapes), but own their collision-objects, so all queries
+        // can be evaluated concurrently
+        struct TDistanceQuery
+        {
+            std::unique_ptr<dart::collision::CollisionGroup> group_a;
+            std::unique_ptr<dart::collision::CollisionGroup> group_b;
+            const dart::dynamics::ShapeFrame* shape_frame_a;
+        };
+
+        btCollisionWorld* _GetBulletWorld();
+
+    private :
+
+        // Reference to the dart-world related to the simulation
+        dart::simulation::World* m_DartWorldRef;
+        // Ids of the registered colliders, and their names and shape-frames (indexed by id)
+        std::unordered_map<const dart::dynamics::ShapeFrame*, ssize_t> m_CollidersIds;
+        std::unordered_map<std::string, ssize_t> m_CollidersIdsByName;
+        std::vector<std::string> m_CollidersNames;
+        std::vector<const dart::dynamics::ShapeFrame*> m_CollidersFrames;
+        // Ids released by unregistered colliders
+        std::vector<ssize_t> m_FreeIds;
+        // Detector shared by all distance-queries, registered distance-queries, and whether each collider is
+        // used by any of them
+        std::shared_ptr<dart::collision::FCLCollisionDetector> m_DistanceDetector;
+        std::vector<TDistanceQuery> m_DistanceQueries;
+        std::vector<bool> m_CollidersInDistanceQueries;
+        // Workers used to split the batched queries
+        TDartThreadPool m_ThreadPool;
+        // Traversal stacks of the broadphase trees, one per thread (bullet's own ray-tests share a single stack)
+        std::vector<btAlignedObjectArray<const btDbvtNode*>> m_TraversalStacks;
+    };
+}}
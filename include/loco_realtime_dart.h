@@ -0,0 +1,91 @@
+#pragma once
+
+#include <loco_common_dart.h>
+
+#include <array>
+#include <chrono>
+#include <functional>
+
+namespace loco {
+namespace dartsim {
+
+    // Number of buckets of the histogram of overruns (bucket k holds overruns in [2^k, 2^(k+1)) microseconds)
+    const ssize_t LOCO_DART_OVERRUN_HISTOGRAM_SIZE = 20;
+
+    // Settings of the real-time pacing of the simulation
+    struct TDartRealtimeData
+    {
+        // Simulated seconds per wall-clock second (1 for real-time)
+        double real_time_factor = 1.0;
+        // Time before the deadline (s) spent spinning instead of sleeping (sleeps are too coarse for kHz rates)
+        double spin_threshold = 0.0005;
+        // Lag behind the wall-clock (s) after which the clocks are resynced, instead of stepping as fast as possible
+        // to catch up
+        double max_lag = 0.1;
+    };
+
+    // Statistics of the real-time pacing
+    struct TDartRealtimeStats
+    {
+        ssize_t num_steps = 0;
+        // Steps that took longer (wall-clock) than their simulated duration
+        ssize_t num_overruns = 0;
+        // Times the clocks were resynced after lagging more than the maximum lag
+        ssize_t num_resyncs = 0;
+        // Wall-clock time past the deadline at which the last step was released, and the maximum so far (s)
+        double last_lateness = 0.0;
+        double max_lateness = 0.0;
+        // Histogram of the excess duration of the overruns (see LOCO_DART_OVERRUN_HISTOGRAM_SIZE)
+        std::array<ssize_t, LOCO_DART_OVERRUN_HISTOGRAM_SIZE> overruns_histogram {};
+    };
+
+    // Paces steps of the simulation to a monotonic wall-clock, by sleeping and then spinning until the wall-clock
+    // catches up with the simulation time
+    class TDartRealtimePacer
+    {
+    public :
+
+        using TClock = std::chrono::steady_clock;
+        // Reads the wall-clock, and blocks until the wall-clock reaches a given time (TClock::now and
+        // std::this_thread::sleep_until if not given, e.g. replaced by a fake clock in tests)
+        using TNowFn = std::function<TClock::time_point()>;
+        using TSleepUntilFn = std::function<void( const TClock::time_point& )>;
+
+        TDartRealtimePacer( const TDartRealtimeData& data = TDartRealtimeData(),
+                            const TNowFn& now_fn = nullptr,
+                            const TSleepUntilFn& sleep_until_fn = nullptr );
+
+        TDartRealtimePacer( const TDartRealtimePacer& other ) = delete;
+
+        TDartRealtimePacer& operator=( const TDartRealtimePacer& other ) = delete;
+
+        ~TDartRealtimePacer() = default;
+
+        // Anchors the given simulation time to the current wall-clock time (and clears the statistics)
+        void Start( double sim_time );
+
+        // Blocks until the wall-clock reaches the given simulation time, recording overruns of the last step
+        void Pace( double sim_time );
+
+        const TDartRealtimeData& data() const { return m_Data; }
+
+        const TDartRealtimeStats& stats() const { return m_Stats; }
+
+    private :
+
+        void _Resync( double sim_time, const TClock::time_point& wall_time );
+
+    private :
+
+        TDartRealtimeData m_Data;
+        TDartRealtimeStats m_Stats;
+        TNowFn m_NowFn;
+        TSleepUntilFn m_SleepUntilFn;
+        // Simulation time and wall-clock time both clocks are anchored at
+        double m_SimTimeAnchor = 0.0;
+        TClock::time_point m_WallTimeAnchor;
+        // Simulation time and wall-clock time at which the last step was released
+        double m_LastSimTime = 0.0;
+        TClock::time_point m_LastWallTime;
+    };
+}}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <loco_common_dart.h>
+
+#include <fstream>
+
+namespace loco {
+namespace dartsim {
+
+    const uint32_t LOCO_DART_REPLAY_MAGIC = 0x4c44524c; // "LDRL"
+    const uint32_t LOCO_DART_REPLAY_VERSION = 3;
+
+    // Types of the records of a replay-log. Every record starts with its type (uint8) and payload size (uint32)
+    enum eDartReplayRecord : uint8_t
+    {
+        REPLAY_RECORD_KEYFRAME = 1,   // full state of the mobile skeletons, time, gravity and time-step, and the
+                                      // contact-manifolds cached by the collision-detector
+        REPLAY_RECORD_SUBSTEP = 2,    // inputs applied right before a substep of the world
+        REPLAY_RECORD_PARAMS = 3      // gravity and time-step, written whenever these change
+    };
+
+    // Flags of the inputs recorded for each skeleton on a substep (only the ones present are written)
+    enum eDartReplayInputs : uint8_t
+    {
+        REPLAY_INPUT_FORCES = 1 << 0,           // generalized forces of the joints (commands, actuators)
+        REPLAY_INPUT_EXTERNAL_FORCES = 1 << 1,  // external wrenches of the body-nodes
+        REPLAY_INPUT_TELEPORT = 1 << 2          // positions|velocities set from outside since the last substep
+    };
+
+    // Records the inputs of every substep of a dart-world into an append-only binary log, with periodic keyframes
+    // of the full state. Inputs are captured right before the world steps, so these include anything that ends up
+    // driving the skeletons (external forces, joint commands|actuators, teleports and parameter changes). Only
+    // skeletons with dofs at the start of the recording are tracked
+    class TDartReplayRecorder
+    {
+    public :
+
+        TDartReplayRecorder( dart::simulation::World* world_ref, const std::string& filepath, ssize_t keyframe_interval = 1000 );
+
+        TDartReplayRecorder( const TDartReplayRecorder& other ) = delete;
+
+        TDartReplayRecorder& operator=( const TDartReplayRecorder& other ) = delete;
+
+        ~TDartReplayRecorder();
+
+        // Records the inputs of the substep about to be taken (and a keyframe, every keyframe_interval substeps)
+        void RecordSubstep( bool reset_commands );
+
+        // Keeps the state after the substep, to detect teleports before the next one
+        void RecordPostSubstep();
+
+        void Close();
+
+        bool valid() const { return m_File.is_open(); }
+
+        ssize_t num_substeps() const { return m_NumSubsteps; }
+
+    private :
+
+        void _WriteKeyframe();
+
+        void _WriteParams();
+
+    private :
+
+        dart::simulation::World* m_DartWorldRef;
+        std::ofstream m_File;
+        // Mobile skeletons being tracked, and their state after the last substep
+        std::vector<dart::dynamics::Skeleton*> m_Skeletons;
+        std::vector<Eigen::VectorXd> m_LastPositions;
+        std::vector<Eigen::VectorXd> m_LastVelocities;
+        // Generalized forces of the tracked skeletons (preallocated, filled on every substep)
+        std::vector<Eigen::VectorXd> m_Forces;
+        // Scratch buffer where records are assembled before being written
+        std::vector<char> m_Record;
+        Eigen::Vector3d m_LastGravity;
+        double m_LastTimeStep;
+        ssize_t m_KeyframeInterval;
+        ssize_t m_NumSubsteps = 0;
+    };
+
+    // Plays back a replay-log on a dart-world with the same skeletons as the recorded one. Any substep can be
+    // reached by restoring the closest keyframe before it, and replaying the inputs from there. Keyframes include
+    // the contact caches of the world (e.g. of bodies resting on the ground), so the replay stays bit-exact
+    class TDartReplayPlayer
+    {
+    public :
+
+        TDartReplayPlayer( dart::simulation::World* world_ref, const std::string& filepath );
+
+        TDartReplayPlayer( const TDartReplayPlayer& other ) = delete;
+
+        TDartReplayPlayer& operator=( const TDartReplayPlayer& other ) = delete;
+
+        ~TDartReplayPlayer() = default;
+
+        // Brings the world to the state right before the given substep (the one after all previous substeps)
+        bool Seek( ssize_t substep_index );
+
+        // Applies the inputs of the next substep, and steps the world. Returns false at the end of the log
+        bool StepForward();
+
+        bool valid() const { return m_Valid; }
+
+        ssize_t num_substeps() const { return m_NumSubsteps; }
+
+        // Index of the next substep to be replayed
+        ssize_t current_substep() const { return m_CurrentSubstep; }
+
+    private :
+
+        bool _ReadRecord( uint8_t& type, std::vector<char>& payload );
+
+        // Returns whether the contact caches of the keyframe could be restored as recorded
+        bool _RestoreKeyframe( const std::vector<char>& payload );
+
+        void _ApplyParams( const std::vector<char>& payload );
+
+    private :
+
+        struct TKeyframe
+        {
+            ssize_t substep;
+            size_t offset;
+        };
+
+        dart::simulation::World* m_DartWorldRef;
+        std::vector<char> m_Data;
+        size_t m_ReadOffset = 0;
+        bool m_Valid = false;
+        std::vector<dart::dynamics::Skeleton*> m_Skeletons;
+        // Preallocated buffers where the states|forces of each skeleton are read into
+        std::vector<Eigen::VectorXd> m_Buffers;
+        // Every keyframe of the log (in order)
+        std::vector<TKeyframe> m_Keyframes;
+        ssize_t m_NumSubsteps = 0;
+        ssize_t m_CurrentSubstep = -1;
+        std::vector<char> m_Payload;
+    };
+}}
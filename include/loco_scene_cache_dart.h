@@ -0,0 +1,120 @@
+#pragma once
+
+#include <loco_common_dart.h>
+#include <loco_mapped_file_dart.h>
+
+namespace loco {
+namespace dartsim {
+
+    const uint32_t LOCO_DART_SCENE_CACHE_MAGIC = 0x4c445343; // "LDSC"
+    const uint32_t LOCO_DART_SCENE_CACHE_VERSION = 1;
+
+    // Hash (FNV-1a) of the data a cached resource was built from, used to detect stale entries
+    struct TDartSignature
+    {
+        uint64_t value = 0xcbf29ce484222325ull;
+
+        void AddBytes( const void* data, size_t num_bytes );
+
+        template< typename T >
+        void Add( const T& scalar ) { AddBytes( &scalar, sizeof( T ) ); }
+
+        void AddString( const std::string& str );
+
+        // Adds everything the collision-shape built from the given data depends on
+        void AddShape( const TShapeData& data );
+
+        void AddInertia( const TInertialData& inertia_data );
+    };
+
+    // Resources built for the bodies of a scenario, kept in a binary file so later runs can skip the expensive parts
+    // of building the world: meshes loaded from files (vertex-data as loaded, keyed by filename) and inertias computed
+    // from collision-shapes (keyed by body name). Entries are checked against the signature of the data they were
+    // built from (file size and modification time for meshes), so stale entries are just rebuilt. The file is mapped,
+    // so restoring a mesh reads its vertex-data straight from the page-cache. Lookups and additions can be made from
+    // several threads at once (e.g. while building in parallel)
+    class TDartSceneCache
+    {
+    public :
+
+        TDartSceneCache() = default;
+
+        TDartSceneCache( const TDartSceneCache& other ) = delete;
+
+        TDartSceneCache& operator=( const TDartSceneCache& other ) = delete;
+
+        ~TDartSceneCache() = default;
+
+        // Maps a cache file written by ->Save (returns false if missing or invalid, leaving the cache empty)
+        bool Load( const std::string& filepath );
+
+        // Writes all entries into the given file (through a temporary file, so readers never see it half-written)
+        bool Save( const std::string& filepath );
+
+        // Collision-shape for the given data (as dartsim::CreateCollisionShape), with meshes taken from the cache
+        dart::dynamics::ShapePtr CreateCollisionShape( const TShapeData& data );
+
+        // Mesh loaded from the given file, created from cached vertex-data if up to date (loaded and cached otherwise)
+        const aiScene* LoadMesh( const std::string& filename );
+
+        // Grabs the cached inertia of the given body, if any and built from data with the same signature
+        bool GetInertia( const std::string& body_name, uint64_t signature, dart::dynamics::Inertia& dst_inertia );
+
+        void AddInertia( const std::string& body_name, uint64_t signature, const dart::dynamics::Inertia& inertia );
+
+        // Whether entries were added or replaced since the last ->Load|->Save
+        bool dirty() const { return m_Dirty; }
+
+        ssize_t num_meshes() const { return m_Meshes.size(); }
+
+        ssize_t num_inertias() const { return m_Inertias.size(); }
+
+        ssize_t num_hits() const { return m_NumHits; }
+
+        ssize_t num_misses() const { return m_NumMisses; }
+
+    private :
+
+        // Vertex-data of a mesh, either pointing into the mapped file or into its own buffers
+        struct TMeshEntry
+        {
+            uint64_t signature = 0;
+            const float* vertices = nullptr;
+            const int32_t* faces = nullptr;
+            uint32_t num_vertices = 0;
+            uint32_t num_faces = 0;
+            std::vector<float> owned_vertices;
+            std::vector<int32_t> owned_faces;
+        };
+
+        struct TInertiaEntry
+        {
+            uint64_t signature = 0;
+            // Mass, center of mass (3) and moments (ixx, iyy, izz, ixy, ixz, iyz)
+            double values[10];
+        };
+
+    private :
+
+        std::unique_ptr<TDartMappedFileReader> m_File;
+        std::unordered_map<std::string, TMeshEntry> m_Meshes;
+        std::unordered_map<std::string, TInertiaEntry> m_Inertias;
+        bool m_Dirty = false;
+        ssize_t m_NumHits = 0;
+        ssize_t m_NumMisses = 0;
+        // Protects the entries, flags and counters above from concurrent lookups and additions
+        mutable std::mutex m_Mutex;
+    };
+
+    // Signature of a mesh file (size and modification time), 0 if it doesn't exist
+    uint64_t ComputeFileSignature( const std::string& filename );
+
+    // Inertia of a body from its inertial-data, using the collision-shape (and density) of its first collider for
+    // the mass and moments that weren't given (no collider if nullptr). Taken from the scene-cache if provided and up
+    // to date (added to it otherwise)
+    dart::dynamics::Inertia ComputeBodyInertia( const std::string& body_name,
+                                                const TInertialData& inertia_data,
+                                                const TCollisionData* collision_data,
+                                                const dart::dynamics::ShapePtr& collision_shape,
+                                                TDartSceneCache* scene_cache = nullptr );
+}}
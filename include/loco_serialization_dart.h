@@ -0,0 +1,89 @@
+#pragma once
+
+#include <loco_common_dart.h>
+
+#include <cstring>
+
+namespace loco {
+namespace dartsim {
+
+    // Helpers shared by the binary files of the backend (replay-logs, trajectories and scene-caches). Values are
+    // stored as-is (native byte order), so files are meant to be read back on the same kind of machine
+
+    template< typename TBuffer, typename T >
+    void AppendValue( TBuffer& buffer, const T& value )
+    {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>( &value );
+        buffer.insert( buffer.end(), bytes, bytes + sizeof( T ) );
+    }
+
+    template< typename TBuffer >
+    void AppendBytes( TBuffer& buffer, const void* data, size_t num_bytes )
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>( data );
+        buffer.insert( buffer.end(), bytes, bytes + num_bytes );
+    }
+
+    // Zig-zag encoded varint (small values, either positive or negative, take a single byte)
+    template< typename TBuffer >
+    void AppendVarint( TBuffer& buffer, int64_t value )
+    {
+        uint64_t zigzag = ( uint64_t( value ) << 1 ) ^ uint64_t( value >> 63 );
+        while ( zigzag >= 0x80 )
+        {
+            buffer.push_back( uint8_t( zigzag | 0x80 ) );
+            zigzag >>= 7;
+        }
+        buffer.push_back( uint8_t( zigzag ) );
+    }
+
+    // Reads values from a buffer, in the same order they were appended. Reads past the end of the buffer return
+    // zeros and leave the cursor invalid, so callers can check once after a batch of reads
+    struct TDartByteCursor
+    {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        size_t offset = 0;
+        bool valid = true;
+
+        TDartByteCursor( const void* data, size_t size, size_t offset = 0 )
+            : data( static_cast<const uint8_t*>( data ) ), size( size ), offset( offset ) {}
+
+        bool ReadBytes( void* dst, size_t num_bytes )
+        {
+            if ( !valid || offset + num_bytes > size )
+            {
+                valid = false;
+                std::memset( dst, 0, num_bytes );
+                return false;
+            }
+            std::memcpy( dst, data + offset, num_bytes );
+            offset += num_bytes;
+            return true;
+        }
+
+        template< typename T >
+        T Read()
+        {
+            T value;
+            ReadBytes( &value, sizeof( T ) );
+            return value;
+        }
+
+        int64_t ReadVarint()
+        {
+            uint64_t zigzag = 0;
+            for ( ssize_t shift = 0; shift < 64; shift += 7 )
+            {
+                const uint8_t byte = Read<uint8_t>();
+                zigzag |= uint64_t( byte & 0x7f ) << shift;
+                if ( !( byte & 0x80 ) )
+                    return int64_t( zigzag >> 1 ) ^ -int64_t( zigzag & 1 );
+            }
+            valid = false;
+            return 0;
+        }
+
+        size_t remaining() const { return valid ? size - offset : 0; }
+    };
+}}
@@ -1,10 +1,22 @@
 #pragma once
 
 #include <loco_common_dart.h>
+#include <loco_parallel_build_dart.h>
+#include <loco_queries_dart.h>
+#include <loco_realtime_dart.h>
+#include <loco_replay_dart.h>
+#include <loco_scene_cache_dart.h>
+#include <loco_state_buffer_dart.h>
+#include <loco_trajectory_dart.h>
 #include <loco_simulation.h>
 
 #include <primitives/loco_single_body_collider_adapter_dart.h>
 #include <primitives/loco_single_body_adapter_dart.h>
+#include <kinematic_trees/loco_kinematic_tree_adapter_dart.h>
+#include <kinematic_trees/loco_kinematic_tree_actuators_dart.h>
+#include <sensors/loco_sensor_joints_dart.h>
+#include <sensors/loco_sensor_bodies_dart.h>
+#include <terrain/loco_terrain_tiled_dart.h>
 
 namespace loco {
 
@@ -24,6 +36,124 @@ namespace loco {
 
         const dart::simulation::WorldPtr& dart_world() const { return m_DartWorld; }
 
+        // Casts a batch of rays against all colliders in the world (collider-ids as given by ->queries())
+        void CastRays( dartsim::TDartRayBatch& batch ) { m_Queries->CastRays( batch ); }
+
+        // Registers a distance-query between two colliders (by name), returning its index in the results, or -1 if
+        // any of the colliders wasn't found (colliders are registered on initialization)
+        ssize_t RegisterDistancePair( const std::string& collider_a, const std::string& collider_b );
+
+        // Registers a distance-query between a collider and the closest one of a group of colliders (by name)
+        ssize_t RegisterDistanceGroup( const std::string& collider_a, const std::vector<std::string>& colliders_b );
+
+        // Evaluates all registered distance-queries (distances and witness-points), in parallel over the queries
+        void ComputeDistances( dartsim::TDartDistanceResults& results ) { m_Queries->ComputeDistances( results ); }
+
+        dartsim::TDartQueries* queries() { return m_Queries.get(); }
+
+        const dartsim::TDartQueries* queries() const { return m_Queries.get(); }
+
+        // Joint actuators of all kintrees, evaluated before every substep of the simulation
+        kintree::TDartJointActuators* joint_actuators() { return m_JointActuators.get(); }
+
+        const kintree::TDartJointActuators* joint_actuators() const { return m_JointActuators.get(); }
+
+        // Joint sensors of all kintrees, sampled after every substep of the simulation
+        sensors::TDartJointSensors* joint_sensors() { return m_JointSensors.get(); }
+
+        const sensors::TDartJointSensors* joint_sensors() const { return m_JointSensors.get(); }
+
+        // Imu and force-torque sensors attached to body-nodes, updated after every step of the simulation
+        sensors::TDartBodySensors* body_sensors() { return m_BodySensors.get(); }
+
+        const sensors::TDartBodySensors* body_sensors() const { return m_BodySensors.get(); }
+
+        // Picks the number of substeps of each step from the errors measured in the previous step (within the given
+        // range), instead of taking substeps of fixed duration
+        void EnableAdaptiveSubstepping( const dartsim::TDartAdaptiveSubstepData& data );
+
+        // Goes back to substeps of fixed duration (the fixed time-step of the simulation)
+        void DisableAdaptiveSubstepping();
+
+        bool adaptive_substepping() const { return m_AdaptiveSubstepping; }
+
+        // Number of substeps, substep duration and errors measured in the last step
+        const dartsim::TDartSubstepStats& substep_stats() const { return m_SubstepStats; }
+
+        // Paces every step to the wall-clock (blocking at the end of the step until the wall-clock catches up)
+        void EnableRealtimePacing( const dartsim::TDartRealtimeData& data = dartsim::TDartRealtimeData() );
+
+        void DisableRealtimePacing() { m_RealtimePacer = nullptr; }
+
+        // Real-time pacer of the simulation (nullptr if pacing is disabled)
+        const dartsim::TDartRealtimePacer* realtime_pacer() const { return m_RealtimePacer.get(); }
+
+        // Starts recording the inputs of every substep into a replay-log (keyframes every keyframe_interval substeps)
+        bool StartReplayRecording( const std::string& filepath, ssize_t keyframe_interval = 1000 );
+
+        void StopReplayRecording() { m_ReplayRecorder = nullptr; }
+
+        const dartsim::TDartReplayRecorder* replay_recorder() const { return m_ReplayRecorder.get(); }
+
+        // Starts recording the published state of all bodies into a compressed trajectory file, written by a
+        // background thread (must be called after ->Initialize)
+        bool StartTrajectoryRecording( const std::string& filepath,
+                                       const dartsim::TDartTrajectoryData& data = dartsim::TDartTrajectoryData() );
+
+        // Flushes the frames still queued, and closes the trajectory file
+        void StopTrajectoryRecording() { m_TrajectoryRecorder = nullptr; }
+
+        const dartsim::TDartTrajectoryRecorder* trajectory_recorder() const { return m_TrajectoryRecorder.get(); }
+
+        // Builds the world using the given scene-cache file (meshes and inertias), which gets created or updated on
+        // ->Initialize if anything had to be built from scratch (must be called before ->Initialize)
+        bool UseSceneCache( const std::string& filepath );
+
+        // Scene-cache used to build the world (nullptr if not using any)
+        const dartsim::TDartSceneCache* scene_cache() const { return m_SceneCache.get(); }
+
+        // Starts taking a step on a dedicated physics thread, and returns right away. Until ->Wait() returns, the
+        // scenario and the adapters must not be touched, but the last published ->state() can be read (it's only
+        // overwritten by the step after this one). Use ->CopyState() to read it from threads not synced with steps
+        void StepAsync( const TScalar& dt = -1.0 );
+
+        // Blocks until the step started by ->StepAsync() is done (returns right away if there's none)
+        void Wait();
+
+        // Whether a step started by ->StepAsync() is still running
+        bool stepping() const;
+
+        // Snapshot of the bodies and contacts published after the last finished step
+        const dartsim::TDartStateSnapshot& state() const { return m_StateBuffer->front(); }
+
+        // Consistent copy of the last published snapshot (safe from any thread, see TDartStateBuffer::CopyFront)
+        void CopyState( dartsim::TDartStateSnapshot& dst_snapshot ) const { m_StateBuffer->CopyFront( dst_snapshot ); }
+
+        const dartsim::TDartStateBuffer* state_buffer() const { return m_StateBuffer.get(); }
+
+        // Transforms of all bodies published after every step (and reset), to be acquired by a single rendering
+        // thread. Unlike ->CopyState(), acquiring never waits nor retries, even while ->StepAsync() is publishing
+        dartsim::TDartVisualBuffer* visual_buffer() { return m_VisualBuffer.get(); }
+
+        // Adds a single-body to the scenario of an initialized simulation, and puts it into the world right away. The
+        // adapter (and skeleton) of a removed body with the same pool-signature is reused if available, so spawning
+        // bodies in steady-state doesn't allocate. Its row in the published state goes after all other bodies
+        TSingleBody* AddSingleBody( std::unique_ptr<TSingleBody> body );
+
+        // Takes a single-body (by name) out of the world and removes it from the scenario, keeping its adapter for
+        // reuse. Rows of the bodies after it in the published state move up by one, and body-sensors attached to it
+        // are removed as well (see sensors::TDartBodySensors::RemoveSensorsOf)
+        bool RemoveSingleBody( const std::string& name );
+
+        // Number of adapters of removed single-bodies kept for reuse
+        ssize_t num_pooled_bodies() const;
+
+        // Registers a tiled terrain to be created on initialization (must be called before ->Initialize)
+        void AddTiledTerrain( const terrain::TDartTiledTerrainData& terrain_data );
+
+        // Returns the tiled terrain with the given name (nullptr if not found, or if not initialized yet)
+        terrain::TDartTiledTerrain* GetTiledTerrainByName( const std::string& name );
+
     protected :
 
         bool _InitializeInternal() override;
@@ -46,15 +176,78 @@ namespace loco {
 
         //// void _CreateCompoundAdapters();
 
-        //// void _CreateKintreeAdapters();
+        void _CreateKintreeAdapters();
 
-        //// void _CreateTerrainGeneratorAdapters();
+        void _CreateTerrainGeneratorAdapters();
+
+        void _UpdateTerrainTiles();
 
         void _CollectContacts();
 
+        void _RegisterQueryColliders();
+
+        void _RegisterStateBodies();
+
+        void _StopRecordingsOnBodiesChanged( const std::string& caller );
+
+        void _StepThreadLoop();
+
+        void _StopStepThread();
+
+        void _SubStep( bool reset_commands );
+
+        void _AdaptiveStep( double step_time );
+
+        void _MeasureSubstepErrors( double substep_dt );
+
     private :
 
         dart::simulation::WorldPtr m_DartWorld;
+        // User-data of the tiled terrains to be created on initialization
+        std::vector<terrain::TDartTiledTerrainData> m_TiledTerrainsData;
+        // Tiled terrains streamed around the active bodies of the simulation
+        std::vector<std::unique_ptr<terrain::TDartTiledTerrain>> m_TiledTerrains;
+        // Actuators of the joints of all kintrees
+        std::unique_ptr<kintree::TDartJointActuators> m_JointActuators;
+        // Sensors of the joints of all kintrees (ring-buffers at the physics rate)
+        std::unique_ptr<sensors::TDartJointSensors> m_JointSensors;
+        // Sensors attached to body-nodes of single bodies and kintrees
+        std::unique_ptr<sensors::TDartBodySensors> m_BodySensors;
+        // Batched queries against the collision-world (raycasts and distances)
+        std::unique_ptr<dartsim::TDartQueries> m_Queries;
+        // Snapshots of the state of the bodies and contacts, published after every step
+        std::unique_ptr<dartsim::TDartStateBuffer> m_StateBuffer;
+        // Transforms of the bodies handed to the rendering thread, published after every step
+        std::unique_ptr<dartsim::TDartVisualBuffer> m_VisualBuffer;
+        // Adaptive substepping settings, and number of substeps to be taken in the next step
+        bool m_AdaptiveSubstepping = false;
+        dartsim::TDartAdaptiveSubstepData m_AdaptiveSubstepData;
+        ssize_t m_AdaptiveNumSubsteps = 1;
+        // Time left over by steps that aren't a multiple of the fixed time-step (fixed mode)
+        double m_SubstepRemainder = 0.0;
+        dartsim::TDartSubstepStats m_SubstepStats;
+        // Pacer of the steps to the wall-clock (only in real-time mode)
+        std::unique_ptr<dartsim::TDartRealtimePacer> m_RealtimePacer;
+        // Recorder of the inputs of every substep (only while recording a replay-log)
+        std::unique_ptr<dartsim::TDartReplayRecorder> m_ReplayRecorder;
+        // Recorder of the state of the bodies after every step (only while recording a trajectory)
+        std::unique_ptr<dartsim::TDartTrajectoryRecorder> m_TrajectoryRecorder;
+        // Builder of the collision-shapes and inertias of all bodies, in parallel before the adapters are built
+        std::unique_ptr<dartsim::TDartParallelBuilder> m_ParallelBuilder;
+        // Cache of the resources used to build the world (only if requested through ->UseSceneCache)
+        std::unique_ptr<dartsim::TDartSceneCache> m_SceneCache;
+        std::string m_SceneCacheFilepath;
+        // Adapters of removed single-bodies (out of the world), by the pool-signature of the bodies they were built for
+        std::unordered_map<uint64_t, std::vector<std::unique_ptr<primitives::TDartSingleBodyAdapter>>> m_SingleBodyPool;
+        // Whether the world has been built (bodies can only be added|removed at runtime afterwards)
+        bool m_WorldBuilt = false;
+        // Physics thread used by ->StepAsync (created on first use), and the state of the step it's running
+        std::thread m_StepThread;
+        mutable std::mutex m_StepMutex;
+        std::condition_variable m_StepCondition;
+        bool m_StepPending = false;
+        bool m_StepThreadStop = false;
+        TScalar m_StepAsyncDt = -1.0;
 
     };
 
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <loco_common_dart.h>
+#include <loco_queries_dart.h>
+
+namespace loco {
+namespace dartsim {
+
+    // Contact between two colliders, with ids as given by the simulation's queries (-1 for shapes that aren't
+    // colliders of the scenario, e.g. tiles of tiled terrains)
+    struct TDartContactState
+    {
+        ssize_t collider_id_1;
+        ssize_t collider_id_2;
+        Eigen::Vector3d position;
+        // Normal pointing from collider 2 to collider 1
+        Eigen::Vector3d normal;
+    };
+
+    // State of the simulation after a step (one row per tracked body, in the order they were added)
+    struct TDartStateSnapshot
+    {
+        using TPoses = Eigen::Matrix<double, Eigen::Dynamic, 7, Eigen::RowMajor>;
+        using TTwists = Eigen::Matrix<double, Eigen::Dynamic, 6, Eigen::RowMajor>;
+
+        // Simulation time, and number of snapshots published before this one
+        double time = 0.0;
+        ssize_t sequence = 0;
+        // World poses of the bodies, as (x, y, z, qx, qy, qz, qw)
+        TPoses poses;
+        // World velocities of the bodies, as (vx, vy, vz, wx, wy, wz)
+        TTwists velocities;
+        // Contacts detected in the last step
+        std::vector<TDartContactState> contacts;
+    };
+
+    // Double-buffered snapshots of the state of the simulation. The stepping thread writes into the back snapshot
+    // and publishes it by swapping it with the front one. A front snapshot stays untouched until the publish after
+    // the next one, i.e. readers of ->front() have a full step to read it. Readers that might take longer (or don't
+    // know when steps happen) should use ->CopyFront, which detects writes overlapping with the copy (seqlock)
+    class TDartStateBuffer
+    {
+    public :
+
+        TDartStateBuffer() = default;
+
+        TDartStateBuffer( const TDartStateBuffer& other ) = delete;
+
+        TDartStateBuffer& operator=( const TDartStateBuffer& other ) = delete;
+
+        ~TDartStateBuffer() = default;
+
+        // Adds a body to be tracked, returning its row in the snapshots (must not be called while readers hold
+        // snapshots, as both snapshots are resized)
+        ssize_t AddBody( const dart::dynamics::BodyNode* bodynode, const std::string& name );
+
+        // Stops tracking a body. Rows of the bodies after it move up by one (must not be called while readers hold
+        // snapshots, as both snapshots are resized)
+        bool RemoveBody( const std::string& name );
+
+        // Writes the state of the tracked bodies and the given contacts into the back snapshot, then swaps it to front
+        void Publish( double time, const dart::collision::CollisionResult& collision_result, const TDartQueries& queries );
+
+        // Latest published snapshot. Only consistent until the publish after the next one, as that one writes
+        // into it (e.g. can be read while a single step is being taken)
+        const TDartStateSnapshot& front() const { return m_Snapshots[m_FrontIndex.load( std::memory_order_acquire )]; }
+
+        // Copies the latest published snapshot, retrying if the stepping thread started writing into it meanwhile
+        // (safe to call from any thread at any time, except while bodies are added or removed)
+        void CopyFront( TDartStateSnapshot& dst_snapshot ) const;
+
+        // Row of the body with the given name in the snapshots (-1 if not tracked)
+        ssize_t body_index( const std::string& name ) const;
+
+        const std::string& body_name( ssize_t body_index ) const { return m_BodyNames[body_index]; }
+
+        ssize_t num_bodies() const { return m_BodyNodes.size(); }
+
+        const std::vector<const dart::dynamics::BodyNode*>& body_nodes() const { return m_BodyNodes; }
+
+    private :
+
+        // Body-nodes being tracked, and their names
+        std::vector<const dart::dynamics::BodyNode*> m_BodyNodes;
+        std::vector<std::string> m_BodyNames;
+        std::unordered_map<std::string, ssize_t> m_BodyIndices;
+        // Front and back snapshots, and the index of the front one
+        TDartStateSnapshot m_Snapshots[2];
+        std::atomic<int> m_FrontIndex { 0 };
+        // Version of each snapshot, odd while it's being written (checked by ->CopyFront)
+        std::atomic<uint64_t> m_Versions[2] = { { 0 }, { 0 } };
+        // Storage of the contacts of each snapshot, and the number of contacts written into it (read by ->CopyFront
+        // instead of the snapshot's vector, whose fields might be torn by a concurrent publish)
+        std::atomic<const TDartContactState*> m_ContactsData[2] = { { nullptr }, { nullptr } };
+        std::atomic<size_t> m_NumContacts[2] = { { 0 }, { 0 } };
+        // Contacts-buffers outgrown by each snapshot. These are never freed nor moved, as copies in flight might still
+        // be reading from them (buffers grow geometrically, so these add up to less than the current ones)
+        std::vector<std::vector<TDartContactState>> m_RetiredContacts[2];
+        ssize_t m_NumPublished = 0;
+    };
+
+    // World transforms of the bodies after a step, in the layout used by the visualizers
+    struct TDartVisualFrame
+    {
+        // Simulation time, and number of frames published before this one
+        double time = 0.0;
+        ssize_t sequence = -1;
+        // World transforms of the bodies (same order as the bodies of the state-buffer)
+        std::vector<TMat4> transforms;
+    };
+
+    // Triple-buffered visual frames, handed from the stepping thread (single producer) to a rendering thread (single
+    // consumer) with no locks. The producer never waits for the consumer and vice versa: frames published faster
+    // than they're consumed are just skipped, so rendering at 60Hz doesn't stall physics running at 1kHz
+    class TDartVisualBuffer
+    {
+    public :
+
+        TDartVisualBuffer();
+
+        TDartVisualBuffer( const TDartVisualBuffer& other ) = delete;
+
+        TDartVisualBuffer& operator=( const TDartVisualBuffer& other ) = delete;
+
+        ~TDartVisualBuffer() = default;
+
+        // Writes the transforms of the given body-nodes into the back frame, and hands it over (producer only)
+        void Publish( double time, const std::vector<const dart::dynamics::BodyNode*>& body_nodes );
+
+        // Grabs the latest published frame if there's a new one, and returns the frame owned by the consumer. This
+        // frame stays untouched until the next call to ->Acquire (consumer only)
+        const TDartVisualFrame& Acquire();
+
+    private :
+
+        // Frames owned by the producer (back), by the consumer (front), and the one in between (middle)
+        TDartVisualFrame m_Frames[3];
+        int m_BackIndex;
+        int m_FrontIndex;
+        // Index of the middle frame, flagged with LOCO_DART_VISUAL_FRAME_FRESH if it hasn't been acquired yet
+        std::atomic<int> m_MiddleIndex;
+        ssize_t m_NumPublished = 0;
+    };
+}}
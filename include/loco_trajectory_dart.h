@@ -0,0 +1,173 @@
+#pragma once
+
+#include <loco_common_dart.h>
+#include <loco_mapped_file_dart.h>
+#include <loco_state_buffer_dart.h>
+
+#include <fstream>
+
+namespace loco {
+namespace dartsim {
+
+    const uint32_t LOCO_DART_TRAJECTORY_MAGIC = 0x4c445452; // "LDTR"
+    const uint32_t LOCO_DART_TRAJECTORY_VERSION = 1;
+
+    // Types of the frames of a trajectory file. Every frame starts with its type (uint8), payload size (uint32)
+    // and time (double)
+    enum eDartTrajectoryFrame : uint8_t
+    {
+        TRAJECTORY_FRAME_KEY = 1,    // absolute quantized states of all bodies
+        TRAJECTORY_FRAME_DELTA = 2   // quantized states of all bodies relative to the previous frame
+    };
+
+    // Settings of the trajectory recorder
+    struct TDartTrajectoryData
+    {
+        // Resolution of the quantized positions (m) and velocities (m/s, rad/s)
+        double position_resolution = 1e-5;
+        double velocity_resolution = 1e-4;
+        // Steps between recorded frames (1 records every step)
+        ssize_t record_interval = 1;
+        // Frames between key-frames, which can be decoded without the previous ones
+        ssize_t keyframe_interval = 1000;
+        // Frames the stepping thread can get ahead of the writer thread (frames are dropped when it's full)
+        ssize_t queue_capacity = 256;
+        // Size of the chunks the output file is grown and mapped by (bytes)
+        size_t chunk_size = 64 * 1024 * 1024;
+        // Size of the output file after which recording stops (bytes, 0 for no limit)
+        size_t max_file_size = 0;
+    };
+
+    // Records the poses and velocities of all bodies of the state-snapshots into a compressed trajectory file.
+    // Positions and velocities are quantized and delta-encoded (zig-zag varints), quaternions are packed into 32
+    // bits (smallest-three), and bodies that didn't move take a single byte. The stepping thread only copies the
+    // snapshot into a preallocated queue; encoding and writing happen on a background writer thread, and frames
+    // are dropped (never waited for) if the writer falls behind
+    class TDartTrajectoryRecorder
+    {
+    public :
+
+        TDartTrajectoryRecorder( const std::string& filepath, const std::vector<std::string>& body_names,
+                                 const TDartTrajectoryData& data = TDartTrajectoryData() );
+
+        TDartTrajectoryRecorder( const TDartTrajectoryRecorder& other ) = delete;
+
+        TDartTrajectoryRecorder& operator=( const TDartTrajectoryRecorder& other ) = delete;
+
+        ~TDartTrajectoryRecorder();
+
+        // Queues the snapshot for recording (every record_interval calls). Called by the stepping thread only
+        void Record( const TDartStateSnapshot& snapshot );
+
+        // Writes all queued frames, and closes the file
+        void Close();
+
+        bool valid() const { return m_File && m_File->valid(); }
+
+        const TDartTrajectoryData& data() const { return m_Data; }
+
+        ssize_t num_frames_recorded() const { return m_NumFramesRecorded.load( std::memory_order_relaxed ); }
+
+        ssize_t num_frames_dropped() const { return m_NumFramesDropped.load( std::memory_order_relaxed ); }
+
+        size_t num_bytes_written() const { return m_NumBytesWritten.load( std::memory_order_relaxed ); }
+
+    private :
+
+        // Copy of the part of a snapshot that gets recorded
+        struct TQueuedFrame
+        {
+            double time;
+            TDartStateSnapshot::TPoses poses;
+            TDartStateSnapshot::TTwists velocities;
+        };
+
+        void _WriterLoop();
+
+        void _EncodeFrame( const TQueuedFrame& frame );
+
+    private :
+
+        TDartTrajectoryData m_Data;
+        ssize_t m_NumBodies;
+        std::unique_ptr<TDartMappedFileWriter> m_File;
+        // Single-producer single-consumer queue of frames (head written by the writer, tail by the stepping thread)
+        std::vector<TQueuedFrame> m_Queue;
+        std::atomic<ssize_t> m_QueueHead { 0 };
+        std::atomic<ssize_t> m_QueueTail { 0 };
+        ssize_t m_NumSnapshots = 0;
+        // Quantized positions (3), quaternions (1, packed) and velocities (6) of the last frame written, and of the
+        // frame being encoded (becomes the last one only once written, so deltas never refer to a dropped frame)
+        std::vector<int64_t> m_LastQuantized;
+        std::vector<int64_t> m_Quantized;
+        std::vector<uint8_t> m_Encoded;
+        ssize_t m_NumFramesEncoded = 0;
+        bool m_FileFull = false;
+        std::atomic<ssize_t> m_NumFramesRecorded { 0 };
+        std::atomic<ssize_t> m_NumFramesDropped { 0 };
+        std::atomic<size_t> m_NumBytesWritten { 0 };
+        // Writer thread, woken up whenever a frame is queued
+        std::thread m_WriterThread;
+        std::mutex m_WriterMutex;
+        std::condition_variable m_WriterCondition;
+        bool m_WriterStop = false;
+    };
+
+    // Reads back the frames of a trajectory file, one after the other. Frames are streamed from the file into a
+    // reusable buffer, so long recordings aren't loaded into memory
+    class TDartTrajectoryReader
+    {
+    public :
+
+        TDartTrajectoryReader( const std::string& filepath );
+
+        TDartTrajectoryReader( const TDartTrajectoryReader& other ) = delete;
+
+        TDartTrajectoryReader& operator=( const TDartTrajectoryReader& other ) = delete;
+
+        ~TDartTrajectoryReader() = default;
+
+        // Decodes the next frame into the poses, velocities and time of the given snapshot (no contacts), with
+        // the index of the frame as sequence
+        bool Next( TDartStateSnapshot& snapshot );
+
+        // Goes back to the first frame
+        void Rewind();
+
+        bool valid() const { return m_Valid; }
+
+        ssize_t num_bodies() const { return m_BodyNames.size(); }
+
+        const std::string& body_name( ssize_t body_index ) const { return m_BodyNames[body_index]; }
+
+        double position_resolution() const { return m_PositionResolution; }
+
+        double velocity_resolution() const { return m_VelocityResolution; }
+
+    private :
+
+        void _SeekReadOffset();
+
+    private :
+
+        std::ifstream m_File;
+        // Payload of the frame being decoded (sized for the largest possible frame up-front)
+        std::vector<uint8_t> m_Payload;
+        size_t m_MaxPayloadSize = 0;
+        bool m_Valid = false;
+        // Offsets of the first frame, and of the next frame to be read
+        std::streamoff m_FramesOffset = 0;
+        std::streamoff m_ReadOffset = 0;
+        ssize_t m_NumFramesRead = 0;
+        std::vector<std::string> m_BodyNames;
+        double m_PositionResolution = 1e-5;
+        double m_VelocityResolution = 1e-4;
+        std::vector<int64_t> m_LastQuantized;
+    };
+
+    // Packs a unit quaternion (qx, qy, qz, qw) into 32 bits: index of the largest component (2 bits) and the other
+    // three components (10 bits each). Angular error is below ~0.2 deg
+    uint32_t QuantizeQuaternion( const Eigen::Vector4d& quat );
+
+    Eigen::Vector4d DequantizeQuaternion( uint32_t packed_quat );
+}}
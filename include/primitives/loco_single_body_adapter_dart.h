@@ -1,6 +1,7 @@
 #pragma once
 
 #include <loco_common_dart.h>
+#include <loco_parallel_build_dart.h>
 #include <primitives/loco_single_body_collider_adapter_dart.h>
 #include <primitives/loco_single_body_constraint_adapter_dart.h>
 #include <primitives/loco_single_body_adapter.h>
@@ -33,6 +34,16 @@ namespace primitives {
 
         void OnDetach() override;
 
+        // Binds this (pooled) adapter to another body with the same pool-signature, reusing its skeleton as is (only
+        // renamed). The body is placed at its initial configuration on ->Initialize, as if freshly built
+        void Rebind( TSingleBody* body_ref );
+
+        // Takes the skeleton out of the world (and the collider out of the collision-filter), keeping it for reuse
+        void RemoveFromWorld();
+
+        // Hash of everything the skeleton of the given body is built from (0 if its skeleton can't be reused)
+        static uint64_t ComputePoolSignature( const TSingleBody* body );
+
         void SetTransform( const TMat4& transform ) override;
 
         void SetLinearVelocity( const TVec3& linear_vel ) override;
@@ -51,6 +62,12 @@ namespace primitives {
 
         void SetDartWorld( dart::simulation::World* world_ref );
 
+        // Scene-cache used on ->Build for the collision-shape and inertia of this body (nullptr to build from scratch)
+        void SetSceneCache( dartsim::TDartSceneCache* scene_cache_ref ) { m_SceneCacheRef = scene_cache_ref; }
+
+        // Parallel builder holding the collision-shape and inertia of this body already built (nullptr to build on ->Build)
+        void SetParallelBuilder( dartsim::TDartParallelBuilder* parallel_builder_ref ) { m_ParallelBuilderRef = parallel_builder_ref; }
+
         dart::dynamics::SkeletonPtr& skeleton() { return m_DartSkeleton; }
 
         const dart::dynamics::SkeletonPtr& skeleton() const { return m_DartSkeleton; }
@@ -73,6 +90,10 @@ namespace primitives {
         dart::dynamics::Joint* m_DartJointRef;
         // Reference to the dart-world related to the current simulation
         dart::simulation::World* m_DartWorldRef;
+        // Reference to the scene-cache of the simulation (if any)
+        dartsim::TDartSceneCache* m_SceneCacheRef = nullptr;
+        // Reference to the parallel builder of the simulation (if any)
+        dartsim::TDartParallelBuilder* m_ParallelBuilderRef = nullptr;
     };
 
 }}
\ No newline at end of file
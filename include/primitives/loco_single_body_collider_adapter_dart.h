@@ -26,12 +26,26 @@ namespace primitives {
 
         void OnDetach() override;
 
+        // Binds this (pooled) adapter, along with its collision-shape, to another collider with equivalent data
+        void Rebind( TSingleBodyCollider* collider_ref );
+
+        // Releases the slot of this collider in the collision-filter (its shape-node leaves the world with its skeleton)
+        void RemoveFromWorld();
+
         void ChangeSize( const TVec3& new_size ) override;
 
         void ChangeVertexData( const std::vector<float>& vertices, const std::vector<int>& faces );
 
         void ChangeElevationData( const std::vector<float>& heights ) override;
 
+        // Updates only the (width x depth) patch of a heightfield starting at sample (x0, y0). The given
+        // heights are laid out row-major (depth rows of width samples), as in the full elevation-data buffer
+        void ChangeElevationRegion( ssize_t x0, ssize_t y0, ssize_t width, ssize_t depth, const std::vector<float>& heights );
+
+        // Heights of a heightfield collider (in world-space) at the given (x, y) world points, sampled straight from
+        // its heights (much cheaper than casting vertical rays, see dartsim::SampleHeightfield)
+        void SampleHeights( const dartsim::TPointsXY& points_xy, Eigen::VectorXd& dst_heights ) const;
+
         void ChangeCollisionGroup( int collisionGroup ) override;
 
         void ChangeCollisionMask( int collisionMask ) override;
@@ -42,10 +56,23 @@ namespace primitives {
 
         void SetDartWorld( dart::simulation::World* world_ref ) { m_DartWorldRef = world_ref; }
 
+        // Scene-cache used to create the collision-shape on ->Build (nullptr to build it from scratch)
+        void SetSceneCache( dartsim::TDartSceneCache* scene_cache_ref ) { m_SceneCacheRef = scene_cache_ref; }
+
+        // Parallel builder holding the collision-shape already built (nullptr to build on ->Build)
+        void SetParallelBuilder( dartsim::TDartParallelBuilder* parallel_builder_ref ) { m_ParallelBuilderRef = parallel_builder_ref; }
+
         dart::dynamics::ShapePtr& collision_shape() { return m_DartShape; }
 
         const dart::dynamics::ShapePtr& collision_shape() const { return m_DartShape; }
 
+        dart::dynamics::ShapeNode* shape_node() { return m_DartShapeNodeRef; }
+
+        const dart::dynamics::ShapeNode* shape_node() const { return m_DartShapeNodeRef; }
+
+        // Heights of a heightfield collider, in the user's layout (the buffer of the dart-shape might be flipped)
+        const dartsim::THeightsMatrix& heights() const { return m_Heights; }
+
     private :
 
         // Owned internal dart resource for collider data (dims, type, ...)
@@ -54,5 +81,14 @@ namespace primitives {
         dart::dynamics::ShapeNode* m_DartShapeNodeRef;
         // Reference to the internal dart world
         dart::simulation::World* m_DartWorldRef;
+        // Unflipped copy of the heights of a heightfield collider (empty for other shapes)
+        dartsim::THeightsMatrix m_Heights;
+        // Reference to the collision-filter of the world, and the slot of this collider in it (for O(1) updates)
+        dartsim::TDartBitmaskCollisionFilter* m_CollisionFilterRef;
+        ssize_t m_CollisionFilterSlot;
+        // Reference to the scene-cache of the simulation (if any)
+        dartsim::TDartSceneCache* m_SceneCacheRef = nullptr;
+        // Reference to the parallel builder of the simulation (if any)
+        dartsim::TDartParallelBuilder* m_ParallelBuilderRef = nullptr;
     };
 }}
\ No newline at end of file
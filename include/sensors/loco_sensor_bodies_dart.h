@@ -0,0 +1,100 @@
+#pragma once
+
+#include <loco_common_dart.h>
+
+#include <random>
+
+namespace loco {
+namespace sensors {
+
+    // Types of sensors attached to bodies
+    enum class eDartBodySensorType : uint8_t
+    {
+        IMU = 0,        // readings: [accelerometer (proper acceleration), gyroscope], in the sensor frame
+        FORCE_TORQUE    // readings: [force, torque] transmitted by the body's parent joint, in the sensor frame
+    };
+
+    // Noise model of a 3d measurement: constant bias (re-drawn on reset), bias random-walk and white noise
+    struct TDartSensorNoiseData
+    {
+        // Standard deviation of the white noise added to each reading
+        TScalar noise_stddev = 0.0f;
+        // Standard deviation of the initial bias of each axis
+        TScalar bias_stddev = 0.0f;
+        // Standard deviation of the bias drift, per square-root of second
+        TScalar bias_random_walk = 0.0f;
+    };
+
+    // Sensors attached to body-nodes (of single bodies or kintrees), all evaluated in a single pass after each step.
+    // Readings of all sensors are stored contiguously, as a (num_sensors x 6) row-major matrix
+    class TDartBodySensors
+    {
+    public :
+
+        using TReadings = Eigen::Matrix<double, Eigen::Dynamic, 6, Eigen::RowMajor>;
+
+        TDartBodySensors( uint32_t seed = 0 );
+
+        TDartBodySensors( const TDartBodySensors& other ) = delete;
+
+        TDartBodySensors& operator=( const TDartBodySensors& other ) = delete;
+
+        ~TDartBodySensors() = default;
+
+        // Adds an imu located at the given pose w.r.t. the body-node, returning its index
+        ssize_t AddImuSensor( const dart::dynamics::BodyNode* bodynode, const Eigen::Isometry3d& tf_body_to_sensor,
+                              const TDartSensorNoiseData& accel_noise = TDartSensorNoiseData(),
+                              const TDartSensorNoiseData& gyro_noise = TDartSensorNoiseData() );
+
+        // Adds a force-torque sensor measuring the wrench between the body-node and its parent, returning its index
+        ssize_t AddForceTorqueSensor( const dart::dynamics::BodyNode* bodynode, const Eigen::Isometry3d& tf_body_to_sensor,
+                                      const TDartSensorNoiseData& force_noise = TDartSensorNoiseData(),
+                                      const TDartSensorNoiseData& torque_noise = TDartSensorNoiseData() );
+
+        // Removes all sensors attached to the given body-node, returning how many were removed. Sensors after them
+        // move up (keeping their order), so indices returned by ->Add...Sensor might change
+        ssize_t RemoveSensorsOf( const dart::dynamics::BodyNode* bodynode );
+
+        // Computes the readings of all sensors from the current state of their body-nodes (time is the world time,
+        // used to drift the biases according to the time elapsed since the last update)
+        void Update( const Eigen::Vector3d& gravity, double time );
+
+        // Re-draws the initial biases of all sensors
+        void Reset();
+
+        const TReadings& readings() const { return m_Readings; }
+
+        Eigen::Matrix<double, 6, 1> reading( ssize_t sensor_index ) const { return m_Readings.row( sensor_index ).transpose(); }
+
+        eDartBodySensorType type( ssize_t sensor_index ) const { return m_Types[sensor_index]; }
+
+        ssize_t num_sensors() const { return m_BodyNodes.size(); }
+
+    private :
+
+        ssize_t _AddSensor( const eDartBodySensorType& type, const dart::dynamics::BodyNode* bodynode,
+                            const Eigen::Isometry3d& tf_body_to_sensor,
+                            const TDartSensorNoiseData& noise_head, const TDartSensorNoiseData& noise_tail );
+
+        void _DrawBias( ssize_t sensor_index );
+
+    private :
+
+        // Type, body-node, and pose w.r.t. its body-node, of each sensor
+        std::vector<eDartBodySensorType> m_Types;
+        std::vector<const dart::dynamics::BodyNode*> m_BodyNodes;
+        std::vector<Eigen::Isometry3d, Eigen::aligned_allocator<Eigen::Isometry3d>> m_TfsBodyToSensor;
+        // Noise parameters and current biases, per reading (same layout as the readings)
+        TReadings m_NoiseStddev;
+        TReadings m_BiasStddev;
+        TReadings m_BiasRandomWalk;
+        TReadings m_Bias;
+        // Readings of all sensors computed on the last update
+        TReadings m_Readings;
+        // Random generator used by the noise models (seeded, so runs are reproducible)
+        std::mt19937 m_RandomGenerator;
+        std::normal_distribution<double> m_NormalDistribution;
+        // World time of the last update (negative if not updated yet)
+        double m_LastUpdateTime;
+    };
+}}
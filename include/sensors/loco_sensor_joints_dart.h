@@ -0,0 +1,103 @@
+#pragma once
+
+#include <loco_common_dart.h>
+
+namespace loco {
+namespace sensors {
+
+    // Channels that can be recorded by a joint sensor (can be combined as flags). Torques are the forces commanded
+    // to the dof for the substep (sampled before stepping), not the ones applied by the constraint solver
+    enum eDartJointSensorChannel : int
+    {
+        JOINT_QPOS = 1 << 0,
+        JOINT_QVEL = 1 << 1,
+        JOINT_TORQUE = 1 << 2
+    };
+
+    // Default number of samples kept by the ring-buffers of the joint sensors
+    const ssize_t LOCO_DART_JOINT_SENSORS_DEFAULT_CAPACITY = 1024;
+
+    // Read-only view of the samples of a channel (num_samples x num_columns), oldest sample first
+    using TDartJointSamplesView = Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>;
+
+    // Joint sensors sampled at the physics rate (once per substep) into preallocated ring-buffers. Each channel has
+    // its own buffer, with one row per sample (all sensors of the channel, contiguous) and one column per sensor.
+    // Every row is written twice (at head and head + capacity), so the recorded history is always contiguous
+    class TDartJointSensors
+    {
+    public :
+
+        TDartJointSensors( ssize_t capacity = LOCO_DART_JOINT_SENSORS_DEFAULT_CAPACITY );
+
+        TDartJointSensors( const TDartJointSensors& other ) = delete;
+
+        TDartJointSensors& operator=( const TDartJointSensors& other ) = delete;
+
+        ~TDartJointSensors() = default;
+
+        // Adds a sensor on a dof of the given joint, recording the given channels. Returns its index (-1 on failure)
+        // @note: adding sensors (or changing the capacity) clears the samples recorded so far
+        ssize_t AddSensor( dart::dynamics::Skeleton* skeleton, const std::string& joint_name, int channels,
+                           ssize_t dof_index = 0 );
+
+        // Records the commanded torques of the upcoming substep (called right before stepping the world)
+        void RecordCommands();
+
+        // Records the joints' state after the substep, along with the world time, completing the current sample
+        void RecordState( double time );
+
+        void SetCapacity( ssize_t capacity );
+
+        void Clear();
+
+        // Samples of a channel, oldest sample first (valid until the next recorded sample or layout change)
+        TDartJointSamplesView GetHistory( const eDartJointSensorChannel& channel ) const;
+
+        // Times of the recorded samples, oldest sample first (valid until the next recorded sample or layout change)
+        Eigen::Map<const Eigen::VectorXd> GetTimes() const;
+
+        // Column of the given sensor in the buffer of the given channel (-1 if the sensor doesn't record it)
+        ssize_t column( ssize_t sensor_index, const eDartJointSensorChannel& channel ) const;
+
+        ssize_t num_columns( const eDartJointSensorChannel& channel ) const { return _Channel( channel ).refs.size(); }
+
+        ssize_t num_sensors() const { return m_SensorsColumns.size(); }
+
+        ssize_t num_samples() const { return m_NumSamples; }
+
+        ssize_t capacity() const { return m_Capacity; }
+
+    private :
+
+        struct TChannelBuffer
+        {
+            // References to the values sampled by each column of this channel
+            std::vector<const double*> refs;
+            std::vector<dart::dynamics::DegreeOfFreedom*> dofs;
+            // Mirrored ring-buffer of (2 * capacity x num_columns) samples, row-major
+            std::vector<double> samples;
+        };
+
+        TChannelBuffer& _Channel( const eDartJointSensorChannel& channel );
+
+        const TChannelBuffer& _Channel( const eDartJointSensorChannel& channel ) const;
+
+        void _Allocate();
+
+        // Row where the oldest sample kept starts (the window of samples spans num_samples rows from there)
+        ssize_t _OldestRow() const { return ( m_NumSamples < m_Capacity ) ? 0 : m_Head; }
+
+    private :
+
+        // Buffers of each channel (qpos, qvel, torque)
+        TChannelBuffer m_Channels[3];
+        // Times of each sample (mirrored ring-buffer of size 2 * capacity)
+        std::vector<double> m_Times;
+        // Columns of each sensor in the buffer of each channel (-1 if not recorded)
+        std::vector<std::array<ssize_t, 3>> m_SensorsColumns;
+        // Maximum number of samples kept, number of samples kept so far, and row where the next sample is written
+        ssize_t m_Capacity;
+        ssize_t m_NumSamples;
+        ssize_t m_Head;
+    };
+}}
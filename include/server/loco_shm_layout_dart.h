@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Layout of the shared-memory region exposed by the simulation server. Only fixed-size types are used, so clients
+// written in other languages can mirror it. Any change of the layout must bump LOCO_DART_SHM_VERSION
+
+namespace loco {
+namespace server {
+
+    const uint32_t LOCO_DART_SHM_MAGIC = 0x4c4f434f; // "LOCO"
+    const uint32_t LOCO_DART_SHM_VERSION = 1;
+
+    // Number of doubles per body in the states-section: pose (x, y, z, qx, qy, qz, qw) and velocity (v, w)
+    const uint32_t LOCO_DART_SHM_BODY_STATE_SIZE = 13;
+
+    enum eDartShmCommand : uint32_t
+    {
+        SHM_COMMAND_NONE = 0,
+        SHM_COMMAND_STEP = 1,   // applies the actuation-section, then steps by the requested dt
+        SHM_COMMAND_RESET = 2,  // resets the simulation
+        SHM_COMMAND_READ = 3    // only refreshes the states and contacts sections
+    };
+
+    enum eDartShmStatus : uint32_t
+    {
+        SHM_STATUS_OK = 0,
+        SHM_STATUS_INVALID_COMMAND = 1
+    };
+
+    struct TDartShmContact
+    {
+        int64_t collider_id_1;
+        int64_t collider_id_2;
+        double position[3];
+        double normal[3];
+    };
+
+    // Header at the start of the region. Sections are placed at the given offsets (from the start of the region).
+    // Requests and responses are sequenced by 32-bit counters, which are also the futex-words used for signaling
+    struct TDartShmHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t region_size;
+        uint32_t num_bodies;
+        uint32_t num_actuators;
+        uint32_t max_contacts;
+        uint32_t reserved;
+        uint64_t offset_states;      // num_bodies x LOCO_DART_SHM_BODY_STATE_SIZE doubles (written by the server)
+        uint64_t offset_actuation;   // num_actuators doubles, targets of the joint actuators (written by the client)
+        uint64_t offset_contacts;    // max_contacts x TDartShmContact (written by the server)
+
+        // Request (written by the client), published by bumping the request sequence
+        alignas( 64 ) std::atomic<uint32_t> request_seq;
+        uint32_t command;
+        double dt;
+
+        // Response (written by the server), published by setting the response sequence to the request's one
+        alignas( 64 ) std::atomic<uint32_t> response_seq;
+        uint32_t status;
+        uint32_t num_contacts;
+        double sim_time;
+    };
+
+    // Sent by the server over the control-socket to every client that connects
+    struct TDartShmHandshake
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t region_size;
+        char shm_name[64];
+    };
+
+    static_assert( ATOMIC_INT_LOCK_FREE == 2, "shared-memory sequences must be lock-free" );
+}}
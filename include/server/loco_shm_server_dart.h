@@ -0,0 +1,136 @@
+#pragma once
+
+#include <loco_simulation_dart.h>
+#include <server/loco_shm_layout_dart.h>
+
+namespace loco {
+namespace server {
+
+    // Directory where the control-sockets of the servers are created
+    const std::string LOCO_DART_SHM_SOCKET_DIR = "/tmp";
+
+    // Exposes a simulation to out-of-process controllers through a shared-memory region (see loco_shm_layout_dart.h).
+    // Clients find the region through a unix-domain control-socket, and then exchange requests and responses through
+    // the region only, signaled with futexes. A single client is expected to issue requests at a time
+    class TDartShmServer
+    {
+    public :
+
+        TDartShmServer( TDartSimulation* simulation_ref, const std::string& name, ssize_t max_contacts = 256 );
+
+        TDartShmServer( const TDartShmServer& other ) = delete;
+
+        TDartShmServer& operator=( const TDartShmServer& other ) = delete;
+
+        ~TDartShmServer();
+
+        // Creates the shared-memory region and the control-socket (the simulation must be initialized by now). Fails
+        // if the name doesn't fit in a control-socket path
+        bool Open();
+
+        // Releases the region and the control-socket (called on destruction)
+        void Close();
+
+        // Serves requests from the calling thread until ->Stop() is called
+        void Serve();
+
+        // Serves a single request, waiting at most the given time (s) for it. Returns whether a request was served
+        bool ServeOnce( double timeout );
+
+        // Makes ->Serve() return (can be called from any thread)
+        void Stop();
+
+        const std::string& shm_name() const { return m_ShmName; }
+
+        const std::string& socket_path() const { return m_SocketPath; }
+
+    private :
+
+        void _ControlLoop();
+
+        void _WriteState();
+
+    private :
+
+        // Simulation being served
+        TDartSimulation* m_SimulationRef;
+        // Names of the shared-memory region and path of the control-socket
+        std::string m_ShmName;
+        std::string m_SocketPath;
+        ssize_t m_MaxContacts;
+        // Layout of the region, as created (the copy in its header is writable by the clients, so never read back)
+        ssize_t m_NumBodies = 0;
+        ssize_t m_NumActuators = 0;
+        uint64_t m_OffsetStates = 0;
+        uint64_t m_OffsetActuation = 0;
+        uint64_t m_OffsetContacts = 0;
+        // Mapped region
+        int m_ShmFd = -1;
+        uint8_t* m_Region = nullptr;
+        size_t m_RegionSize = 0;
+        TDartShmHeader* m_Header = nullptr;
+        // Sequence number of the last request served
+        uint32_t m_LastRequestSeq = 0;
+        // Listening control-socket, and thread answering the clients that connect to it
+        int m_SocketFd = -1;
+        std::thread m_ControlThread;
+        std::atomic<bool> m_Running { false };
+    };
+
+    // Client side of the shared-memory server (for controllers written in c++)
+    class TDartShmClient
+    {
+    public :
+
+        using TStates = Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, LOCO_DART_SHM_BODY_STATE_SIZE, Eigen::RowMajor>>;
+        using TActuation = Eigen::Map<Eigen::VectorXd>;
+
+        TDartShmClient() = default;
+
+        TDartShmClient( const TDartShmClient& other ) = delete;
+
+        TDartShmClient& operator=( const TDartShmClient& other ) = delete;
+
+        ~TDartShmClient();
+
+        // Connects to the server listening at the given control-socket, and maps its shared-memory region
+        bool Connect( const std::string& socket_path );
+
+        void Disconnect();
+
+        // Applies the actuation-section, and steps the simulation (blocks until the step is done)
+        bool Step( double dt = -1.0 );
+
+        bool Reset();
+
+        bool Read();
+
+        // Views of the sections of the region (states and contacts are valid after each request)
+        TStates states() const;
+
+        TActuation actuation();
+
+        const TDartShmContact* contacts() const;
+
+        ssize_t num_contacts() const { return m_Header->num_contacts; }
+
+        double sim_time() const { return m_Header->sim_time; }
+
+        bool connected() const { return m_Header != nullptr; }
+
+        // Number of busy-wait iterations before sleeping on the futex, when waiting for a response
+        void SetSpinIterations( ssize_t spin_iterations ) { m_SpinIterations = spin_iterations; }
+
+    private :
+
+        bool _Request( uint32_t command, double dt );
+
+    private :
+
+        int m_ShmFd = -1;
+        uint8_t* m_Region = nullptr;
+        size_t m_RegionSize = 0;
+        TDartShmHeader* m_Header = nullptr;
+        ssize_t m_SpinIterations = 10000;
+    };
+}}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <loco_common_dart.h>
+#include <loco_mapped_file_dart.h>
+
+namespace loco {
+namespace terrain {
+
+    // Header of the height-files used by the tiled terrain (followed by nWidthSamples * nDepthSamples float32
+    // heights, stored row-major, with rows along the depth direction, as in the heightfield colliders). As in dart's
+    // heightfields, the first row lies at the +y border of the terrain
+    struct TDartHeightFileHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t nWidthSamples;
+        uint32_t nDepthSamples;
+        float size_x;
+        float size_y;
+        float scale_z;
+    };
+
+    const char LOCO_DART_HEIGHT_FILE_MAGIC[4] = { 'L', 'H', 'F', 'D' };
+    const uint32_t LOCO_DART_HEIGHT_FILE_VERSION = 1;
+
+    // User-data required to create a tiled terrain
+    struct TDartTiledTerrainData
+    {
+        // Unique name of the terrain (used as contact-name for the bodies touching it)
+        std::string name = "tiled_terrain";
+        // Path to the height-file (see TDartHeightFileHeader) that holds the whole elevation-data
+        std::string heights_filepath = "";
+        // Position of the center of the terrain in world-space
+        TVec3 position = { 0.0f, 0.0f, 0.0f };
+        // Number of samples per side of each tile (neighbouring tiles share their border samples)
+        ssize_t tile_num_samples = 65;
+        // Tiles whose center lies within this distance (in xy) from an active body are instantiated
+        TScalar activation_radius = 20.0f;
+        // Friction coefficient for all tiles
+        TScalar friction = 1.0f;
+    };
+
+    // Writes a height-file with the given elevation-data, to be consumed by a TDartTiledTerrain
+    bool CreateHeightFile( const std::string& filepath, ssize_t num_width_samples, ssize_t num_depth_samples,
+                           const TVec3& size, const std::vector<float>& heights );
+
+    // Heightfield terrain split into tiles, where only the tiles near active bodies are part of the world. The
+    // elevation-data is memory-mapped from a height-file, so only the pages of the tiles in use stay resident
+    class TDartTiledTerrain
+    {
+    public :
+
+        TDartTiledTerrain( const TDartTiledTerrainData& data );
+
+        TDartTiledTerrain( const TDartTiledTerrain& other ) = delete;
+
+        TDartTiledTerrain& operator=( const TDartTiledTerrain& other ) = delete;
+
+        ~TDartTiledTerrain();
+
+        // Instantiates the tiles close to the given points (in world-space), and evicts the ones far from all of them
+        void Update( const std::vector<Eigen::Vector3d>& focus_points );
+
+        // Updates a patch of the whole elevation-data (global sample coordinates), both in the height-file and in
+        // the tiles currently instantiated. Heights are given row-major (depth rows of width samples)
+        void ChangeElevationRegion( ssize_t x0, ssize_t y0, ssize_t width, ssize_t depth, const std::vector<float>& heights );
+
+        void SetDartWorld( dart::simulation::World* world_ref ) { m_DartWorldRef = world_ref; }
+
+        // Collects the collision-shapes of the tiles currently instantiated
+        void GetActiveShapes( std::vector<const dart::dynamics::Shape*>& dst_shapes ) const;
+
+        bool valid() const { return m_HeightsMapped != nullptr; }
+
+        std::string name() const { return m_Data.name; }
+
+        ssize_t num_tiles_x() const { return m_NumTilesX; }
+
+        ssize_t num_tiles_y() const { return m_NumTilesY; }
+
+        ssize_t num_active_tiles() const { return m_ActiveTiles.size(); }
+
+        const TDartTiledTerrainData& data() const { return m_Data; }
+
+    private :
+
+        struct TTile
+        {
+            // Index of the first sample (global coordinates) of this tile
+            ssize_t x0;
+            ssize_t y0;
+            // Number of samples of this tile (border tiles might be smaller)
+            ssize_t width;
+            ssize_t depth;
+            // Dart resources of the tile (taken from the pool when instantiated, returned to it when evicted)
+            dart::dynamics::SkeletonPtr skeleton;
+            dart::dynamics::HeightmapShapef* shape;
+        };
+
+        bool _MapHeightFile();
+
+        void _UnmapHeightFile();
+
+        void _LoadTile( ssize_t tile_index );
+
+        void _EvictTile( ssize_t tile_index );
+
+        dart::dynamics::SkeletonPtr _GrabSkeleton( ssize_t tile_index );
+
+        Eigen::Vector2d _TileCenter( ssize_t tile_index ) const;
+
+        // Heights of a tile, as stored in the height-file (the buffer of its shape might be flipped)
+        dartsim::THeightsConstMap _TileHeights( ssize_t tile_index ) const;
+
+    private :
+
+        // User-data of this terrain
+        TDartTiledTerrainData m_Data;
+        // Header of the mapped height-file
+        TDartHeightFileHeader m_Header;
+        // Height-file mapped as a whole (writable, so elevation changes persist), and the elevation-data within it
+        std::unique_ptr<dartsim::TDartMappedFileReader> m_HeightFile;
+        float* m_HeightsMapped;
+        // Distance between consecutive samples, and vertical scale
+        Eigen::Vector3f m_Scale;
+        // Layout of the tiles grid
+        ssize_t m_NumTilesX;
+        ssize_t m_NumTilesY;
+        // All tiles of the terrain (only the ones listed in m_ActiveTiles have dart resources)
+        std::vector<TTile> m_Tiles;
+        // Indices of the tiles currently part of the world
+        std::vector<ssize_t> m_ActiveTiles;
+        // Per-tile flags computed during ->Update (0: evict, 1: keep if loaded, 2: load)
+        std::vector<uint8_t> m_TilesFlags;
+        // Per-tile layouts of the buffers of the shapes, checked during ->ChangeElevationRegion
+        std::vector<dartsim::eHeightfieldLayout> m_TilesLayouts;
+        // Skeletons of evicted tiles, reused by the next tiles to be instantiated
+        std::vector<dart::dynamics::SkeletonPtr> m_SkeletonsPool;
+        // Reference to the dart-world related to the current simulation
+        dart::simulation::World* m_DartWorldRef;
+    };
+}}
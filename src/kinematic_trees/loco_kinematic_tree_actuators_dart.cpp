@@ -0,0 +1,124 @@
+
+#include <kinematic_trees/loco_kinematic_tree_actuators_dart.h>
+
+namespace loco {
+namespace kintree {
+
+    ssize_t TDartJointActuators::AddActuator( dart::dynamics::Skeleton* skeleton, const std::string& joint_name,
+                                              const TDartActuatorData& data, ssize_t dof_index )
+    {
+        auto joint = skeleton ? skeleton->getJoint( joint_name ) : nullptr;
+        if ( !joint )
+        {
+            LOCO_CORE_WARN( "TDartJointActuators::AddActuator >>> couldn't find joint {0}", joint_name );
+            return -1;
+        }
+        if ( ( dof_index < 0 ) || ( dof_index >= joint->getNumDofs() ) )
+        {
+            LOCO_CORE_WARN( "TDartJointActuators::AddActuator >>> joint {0} has {1} dofs, but requested dof {2}",
+                            joint_name, joint->getNumDofs(), dof_index );
+            return -1;
+        }
+        // Orientations of ball|free joints are exponential coordinates, so joint-space errors are meaningless there
+        if ( dynamic_cast<dart::dynamics::BallJoint*>( joint ) || dynamic_cast<dart::dynamics::FreeJoint*>( joint ) )
+        {
+            LOCO_CORE_WARN( "TDartJointActuators::AddActuator >>> ball|free joints aren't supported (joint {0})", joint_name );
+            return -1;
+        }
+        if ( joint->getActuatorType() != dart::dynamics::Joint::FORCE )
+        {
+            LOCO_CORE_WARN( "TDartJointActuators::AddActuator >>> joint {0} isn't force-actuated. Changing its \
+                             actuator-type to FORCE", joint_name );
+            joint->setActuatorType( dart::dynamics::Joint::FORCE );
+        }
+
+        const ssize_t actuator_index = m_Dofs.size();
+        const ssize_t num_actuators = actuator_index + 1;
+        m_Dofs.push_back( joint->getDof( dof_index ) );
+        m_QposRefs.push_back( dartsim::GetJointPositionsData( joint ) + dof_index );
+        m_QvelRefs.push_back( dartsim::GetJointVelocitiesData( joint ) + dof_index );
+
+        m_Kp.conservativeResize( num_actuators );
+        m_Kv.conservativeResize( num_actuators );
+        m_Gear.conservativeResize( num_actuators );
+        m_TorqueLimit.conservativeResize( num_actuators );
+        m_TorqueMask.conservativeResize( num_actuators );
+        m_PositionMask.conservativeResize( num_actuators );
+        m_VelocityMask.conservativeResize( num_actuators );
+        m_Targets.conservativeResize( num_actuators );
+        m_Torques.conservativeResize( num_actuators );
+        m_Qpos.resize( num_actuators );
+        m_Qvel.resize( num_actuators );
+
+        m_Kp[actuator_index] = data.kp;
+        m_Kv[actuator_index] = data.kv;
+        m_Gear[actuator_index] = data.gear;
+        m_TorqueLimit[actuator_index] = data.torque_limit;
+        m_Targets[actuator_index] = 0.0;
+        m_Torques[actuator_index] = 0.0;
+        _UpdateModeMasks( actuator_index, data.mode );
+        return actuator_index;
+    }
+
+    void TDartJointActuators::Evaluate()
+    {
+        const ssize_t num_actuators = m_Dofs.size();
+        if ( num_actuators < 1 )
+            return;
+
+        for ( ssize_t i = 0; i < num_actuators; i++ )
+        {
+            m_Qpos[i] = *m_QposRefs[i];
+            m_Qvel[i] = *m_QvelRefs[i];
+        }
+
+        const auto targets = m_Targets.array();
+        auto motor_torques = m_TorqueMask * targets +
+                             m_PositionMask * ( m_Kp * ( targets - m_Qpos ) - m_Kv * m_Qvel ) +
+                             m_VelocityMask * ( m_Kv * ( targets - m_Qvel ) );
+        m_Torques.array() = m_Gear * motor_torques.max( -m_TorqueLimit ).min( m_TorqueLimit );
+
+        for ( ssize_t i = 0; i < num_actuators; i++ )
+            m_Dofs[i]->setForce( m_Torques[i] );
+    }
+
+    void TDartJointActuators::ChangeMode( ssize_t actuator_index, const eDartActuatorMode& mode )
+    {
+        LOCO_CORE_ASSERT( ( actuator_index >= 0 ) && ( actuator_index < m_Dofs.size() ), "TDartJointActuators::ChangeMode >>> \
+                          actuator index {0} out of range [0,{1})", actuator_index, m_Dofs.size() );
+        _UpdateModeMasks( actuator_index, mode );
+    }
+
+    void TDartJointActuators::ChangeGains( ssize_t actuator_index, const TScalar& kp, const TScalar& kv )
+    {
+        LOCO_CORE_ASSERT( ( actuator_index >= 0 ) && ( actuator_index < m_Dofs.size() ), "TDartJointActuators::ChangeGains >>> \
+                          actuator index {0} out of range [0,{1})", actuator_index, m_Dofs.size() );
+        m_Kp[actuator_index] = kp;
+        m_Kv[actuator_index] = kv;
+    }
+
+    void TDartJointActuators::ChangeTorqueLimit( ssize_t actuator_index, const TScalar& torque_limit )
+    {
+        LOCO_CORE_ASSERT( ( actuator_index >= 0 ) && ( actuator_index < m_Dofs.size() ), "TDartJointActuators::ChangeTorqueLimit >>> \
+                          actuator index {0} out of range [0,{1})", actuator_index, m_Dofs.size() );
+        m_TorqueLimit[actuator_index] = torque_limit;
+    }
+
+    void TDartJointActuators::SetTargets( const Eigen::VectorXd& targets )
+    {
+        if ( targets.size() != m_Targets.size() )
+        {
+            LOCO_CORE_WARN( "TDartJointActuators::SetTargets >>> expected {0} targets, but got {1}",
+                            m_Targets.size(), targets.size() );
+            return;
+        }
+        m_Targets = targets;
+    }
+
+    void TDartJointActuators::_UpdateModeMasks( ssize_t actuator_index, const eDartActuatorMode& mode )
+    {
+        m_TorqueMask[actuator_index] = ( mode == eDartActuatorMode::TORQUE ) ? 1.0 : 0.0;
+        m_PositionMask[actuator_index] = ( mode == eDartActuatorMode::POSITION ) ? 1.0 : 0.0;
+        m_VelocityMask[actuator_index] = ( mode == eDartActuatorMode::VELOCITY ) ? 1.0 : 0.0;
+    }
+}}
@@ -0,0 +1,358 @@
+
+#include <kinematic_trees/loco_kinematic_tree_adapter_dart.h>
+
+namespace loco {
+namespace kintree {
+
+    // Helpers to serialize the data of a kintree that ends up in its dart-skeleton
+    template< typename T >
+    static void _AppendBytes( std::string& dst_signature, const T& value )
+    {
+        dst_signature.append( reinterpret_cast<const char*>( &value ), sizeof( T ) );
+    }
+
+    template< typename T >
+    static void _AppendBuffer( std::string& dst_signature, const std::vector<T>& buffer )
+    {
+        _AppendBytes( dst_signature, buffer.size() );
+        dst_signature.append( reinterpret_cast<const char*>( buffer.data() ), sizeof( T ) * buffer.size() );
+    }
+
+    static void _AppendVec3( std::string& dst_signature, const TVec3& vec )
+    {
+        _AppendBytes( dst_signature, vec.x() );
+        _AppendBytes( dst_signature, vec.y() );
+        _AppendBytes( dst_signature, vec.z() );
+    }
+
+    static void _AppendTransform( std::string& dst_signature, const TMat4& tf )
+    {
+        const Eigen::Matrix4d eigen_tf = dartsim::mat4_to_eigen( tf );
+        dst_signature.append( reinterpret_cast<const char*>( eigen_tf.data() ), sizeof( double ) * 16 );
+    }
+
+    static void _AppendShapeData( std::string& dst_signature, const TShapeData& data )
+    {
+        _AppendBytes( dst_signature, data.type );
+        _AppendVec3( dst_signature, data.size );
+        dst_signature += data.mesh_data.filename;
+        dst_signature += '\0';
+        _AppendBuffer( dst_signature, data.mesh_data.vertices );
+        _AppendBuffer( dst_signature, data.mesh_data.faces );
+        _AppendBytes( dst_signature, data.hfield_data.nWidthSamples );
+        _AppendBytes( dst_signature, data.hfield_data.nDepthSamples );
+        _AppendBuffer( dst_signature, data.hfield_data.heights );
+        _AppendBytes( dst_signature, data.children.size() );
+        for ( ssize_t i = 0; i < data.children.size(); i++ )
+        {
+            _AppendShapeData( dst_signature, data.children[i] );
+            _AppendTransform( dst_signature, data.children_tfs[i] );
+        }
+    }
+
+    TDartKinematicTreeAdapter::TDartKinematicTreeAdapter( TKinematicTree* kintree_ref )
+        : TIKinematicTreeAdapter( kintree_ref )
+    {
+        LOCO_CORE_ASSERT( kintree_ref, "TDartKinematicTreeAdapter >>> expected non-null kintree-obj reference" );
+
+        m_DartSkeleton = nullptr;
+        m_DartWorldRef = nullptr;
+    }
+
+    TDartKinematicTreeAdapter::~TDartKinematicTreeAdapter()
+    {
+        m_BodyAdapters.clear();
+        m_DartSkeleton = nullptr;
+        m_DartWorldRef = nullptr;
+        m_CollisionFilterRef = nullptr;
+    }
+
+    std::string TDartKinematicTreeAdapter::ComputeTemplateSignature( const TKinematicTree* kintree )
+    {
+        std::string signature;
+        std::vector<const TKinematicTreeBody*> bodies_to_visit = { kintree->root() };
+        if ( !bodies_to_visit[0] )
+            return signature;
+
+        // Same traversal as in ->Build, so equivalent kintrees list their bodies in the same order
+        for ( size_t i = 0; i < bodies_to_visit.size(); i++ )
+        {
+            auto body = bodies_to_visit[i];
+            const auto& inertia_data = body->data().inertia;
+            _AppendTransform( signature, body->local_tf() );
+            _AppendBytes( signature, inertia_data.mass );
+            _AppendBytes( signature, inertia_data.ixx ); _AppendBytes( signature, inertia_data.iyy );
+            _AppendBytes( signature, inertia_data.izz ); _AppendBytes( signature, inertia_data.ixy );
+            _AppendBytes( signature, inertia_data.ixz ); _AppendBytes( signature, inertia_data.iyz );
+
+            auto joints = body->joints();
+            _AppendBytes( signature, joints.size() );
+            for ( auto joint : joints )
+            {
+                const auto& joint_data = joint->data();
+                _AppendBytes( signature, joint->type() );
+                _AppendTransform( signature, joint_data.local_tf );
+                _AppendVec3( signature, joint_data.local_axis );
+                _AppendVec3( signature, joint_data.plane_axis_1 );
+                _AppendVec3( signature, joint_data.plane_axis_2 );
+                _AppendBytes( signature, joint_data.stiffness );
+                _AppendBytes( signature, joint_data.damping );
+            }
+
+            auto colliders = body->colliders();
+            _AppendBytes( signature, colliders.size() );
+            for ( auto collider : colliders )
+            {
+                _AppendShapeData( signature, collider->data() );
+                _AppendTransform( signature, collider->local_tf() );
+                _AppendBytes( signature, collider->data().density );
+            }
+
+            auto children = body->children();
+            _AppendBytes( signature, children.size() );
+            for ( auto child : children )
+                bodies_to_visit.push_back( child );
+        }
+        return signature;
+    }
+
+    void TDartKinematicTreeAdapter::Build()
+    {
+        auto root_body = m_KintreeRef->root();
+        LOCO_CORE_ASSERT( root_body, "TDartKinematicTreeAdapter::Build >>> kintree {0} doesn't have \
+                          a root body", m_KintreeRef->name() );
+
+        if ( m_TemplateRef && m_TemplateRef->skeleton() )
+        {
+            _BuildFromTemplate();
+            return;
+        }
+
+        // Collision-shapes and inertias of all bodies are built in parallel, right before the first adapter is built
+        if ( m_ParallelBuilderRef )
+            m_ParallelBuilderRef->Build();
+
+        m_DartSkeleton = dart::dynamics::Skeleton::create( m_KintreeRef->name() );
+
+        // Build bodies in breadth-first order, as the body-nodes of the parents are required by their children
+        std::vector<TKinematicTreeBody*> bodies_to_build = { root_body };
+        for ( size_t i = 0; i < bodies_to_build.size(); i++ )
+        {
+            auto body = bodies_to_build[i];
+            auto body_adapter = std::make_unique<TDartKinematicTreeBodyAdapter>( body );
+            body->SetBodyAdapter( body_adapter.get() );
+            body_adapter->SetDartSkeleton( m_DartSkeleton.get() );
+            body_adapter->SetSceneCache( m_SceneCacheRef );
+            body_adapter->SetParallelBuilder( m_ParallelBuilderRef );
+            body_adapter->Build();
+            m_BodyAdapters.push_back( std::move( body_adapter ) );
+
+            for ( auto child : body->children() )
+                bodies_to_build.push_back( child );
+        }
+
+        _CacheJointsStateViews();
+        _CompileSelfCollisionPolicy();
+    }
+
+    void TDartKinematicTreeAdapter::_BuildFromTemplate()
+    {
+        // Cloning shares the collision-shapes, and copies the joint and inertial properties, so no shapes, joints
+        // or body-nodes have to be created from the kintree's data (only the adapters are wired to the clone)
+        m_DartSkeleton = m_TemplateRef->skeleton()->cloneSkeleton( m_KintreeRef->name() );
+
+        auto& template_body_adapters = m_TemplateRef->body_adapters();
+        std::vector<TKinematicTreeBody*> bodies_to_build = { m_KintreeRef->root() };
+        for ( size_t i = 0; i < bodies_to_build.size(); i++ )
+        {
+            LOCO_CORE_ASSERT( i < template_body_adapters.size(), "TDartKinematicTreeAdapter::_BuildFromTemplate >>> \
+                              kintree {0} doesn't match the structure of its template", m_KintreeRef->name() );
+
+            auto body = bodies_to_build[i];
+            auto body_adapter = std::make_unique<TDartKinematicTreeBodyAdapter>( body );
+            body->SetBodyAdapter( body_adapter.get() );
+            body_adapter->SetDartSkeleton( m_DartSkeleton.get() );
+            body_adapter->BuildFromTemplate( template_body_adapters[i].get() );
+            m_BodyAdapters.push_back( std::move( body_adapter ) );
+
+            for ( auto child : body->children() )
+                bodies_to_build.push_back( child );
+        }
+
+        _CacheJointsStateViews();
+        _CompileSelfCollisionPolicy();
+    }
+
+    void TDartKinematicTreeAdapter::_CacheJointsStateViews()
+    {
+        // Dof indices are only final once all joints are part of the skeleton
+        for ( auto& body_adapter : m_BodyAdapters )
+            for ( auto& joint_adapter : body_adapter->joint_adapters() )
+                joint_adapter->CacheStateViews();
+    }
+
+    void TDartKinematicTreeAdapter::SetSelfCollisionPolicy( const dartsim::eDartSelfCollisionPolicy& policy,
+                                                            const std::vector<std::pair<std::string, std::string>>& pairs )
+    {
+        m_SelfCollisionPolicy = policy;
+        m_SelfCollisionPairs = pairs;
+        // Already built kintrees are compiled again (and the filter updated) right away
+        if ( m_DartSkeleton )
+            _CompileSelfCollisionPolicy();
+    }
+
+    void TDartKinematicTreeAdapter::_CompileSelfCollisionPolicy()
+    {
+        m_SelfCollisionTable = dartsim::CompileSelfCollisionTable( m_DartSkeleton.get(), m_SelfCollisionPolicy, m_SelfCollisionPairs );
+
+        // Keep dart's own flags as close as possible to the policy, for worlds without our collision-filter (explicit
+        // pairs can't be expressed with these flags, so all non-adjacent pairs are checked in that case)
+        if ( m_SelfCollisionPolicy == dartsim::eDartSelfCollisionPolicy::NONE )
+        {
+            m_DartSkeleton->disableSelfCollisionCheck();
+        }
+        else
+        {
+            m_DartSkeleton->enableSelfCollisionCheck();
+            m_DartSkeleton->disableAdjacentBodyCheck();
+        }
+
+        if ( m_CollisionFilterRef )
+            m_CollisionFilterRef->setSelfCollisionTable( m_DartSkeleton.get(), m_SelfCollisionTable );
+    }
+
+    void TDartKinematicTreeAdapter::Initialize()
+    {
+        LOCO_CORE_ASSERT( m_DartWorldRef, "TDartKinematicTreeAdapter::Initialize >>> kintree {0} must have \
+                          a valid dart-world reference", m_KintreeRef->name() );
+        LOCO_CORE_ASSERT( m_DartSkeleton, "TDartKinematicTreeAdapter::Initialize >>> kintree {0} must have \
+                          a valid dart-skeleton. Perhaps missing call to ->Build()?", m_KintreeRef->name() );
+
+        m_DartWorldRef->addSkeleton( m_DartSkeleton );
+
+        auto& collision_filter = m_DartWorldRef->getConstraintSolver()->getCollisionOption().collisionFilter;
+        m_CollisionFilterRef = dynamic_cast<dartsim::TDartBitmaskCollisionFilter*>( collision_filter.get() );
+        if ( m_CollisionFilterRef )
+            m_CollisionFilterRef->setSelfCollisionTable( m_DartSkeleton.get(), m_SelfCollisionTable );
+
+        for ( auto& body_adapter : m_BodyAdapters )
+            body_adapter->Initialize();
+
+        SetTransform( m_KintreeRef->tf0() );
+    }
+
+    void TDartKinematicTreeAdapter::Reset()
+    {
+        for ( auto& body_adapter : m_BodyAdapters )
+            body_adapter->Reset();
+
+        SetTransform( m_KintreeRef->tf0() );
+    }
+
+    void TDartKinematicTreeAdapter::SetTransform( const TMat4& tf )
+    {
+        LOCO_CORE_ASSERT( m_BodyAdapters.size() > 0, "TDartKinematicTreeAdapter::SetTransform >>> kintree {0} \
+                          doesn't have any bodies. Perhaps missing call to ->Build()?", m_KintreeRef->name() );
+
+        auto& root_body_adapter = m_BodyAdapters[0];
+        const Eigen::Isometry3d tf_world_to_root = dartsim::mat4_to_eigen_tf( tf ) *
+                                                   dartsim::mat4_to_eigen_tf( m_KintreeRef->root()->local_tf() );
+        // Floating-base robots are placed through their free-joint's coordinates, fixed-base ones through the
+        // transform of the root joint w.r.t. the world
+        if ( auto free_joint = dynamic_cast<dart::dynamics::FreeJoint*>( root_body_adapter->joint() ) )
+            free_joint->setTransform( tf_world_to_root );
+        else
+            root_body_adapter->SetTransformFromParentBody( tf_world_to_root );
+    }
+
+    void TDartKinematicTreeAdapter::SetLinearVelocity( const TVec3& linear_vel )
+    {
+        auto free_joint = ( m_BodyAdapters.size() > 0 ) ? dynamic_cast<dart::dynamics::FreeJoint*>( m_BodyAdapters[0]->joint() ) : nullptr;
+        if ( !free_joint )
+        {
+            LOCO_CORE_WARN( "TDartKinematicTreeAdapter::SetLinearVelocity >>> kintree {0} must have a free-joint \
+                             at its root to set its linear velocity", m_KintreeRef->name() );
+            return;
+        }
+
+        free_joint->setLinearVelocity( dartsim::vec3_to_eigen( linear_vel ) );
+    }
+
+    void TDartKinematicTreeAdapter::SetAngularVelocity( const TVec3& angular_vel )
+    {
+        auto free_joint = ( m_BodyAdapters.size() > 0 ) ? dynamic_cast<dart::dynamics::FreeJoint*>( m_BodyAdapters[0]->joint() ) : nullptr;
+        if ( !free_joint )
+        {
+            LOCO_CORE_WARN( "TDartKinematicTreeAdapter::SetAngularVelocity >>> kintree {0} must have a free-joint \
+                             at its root to set its angular velocity", m_KintreeRef->name() );
+            return;
+        }
+
+        free_joint->setAngularVelocity( dartsim::vec3_to_eigen( angular_vel ) );
+    }
+
+    void TDartKinematicTreeAdapter::GetTransform( TMat4& dst_tf )
+    {
+        LOCO_CORE_ASSERT( m_BodyAdapters.size() > 0, "TDartKinematicTreeAdapter::GetTransform >>> kintree {0} \
+                          doesn't have any bodies. Perhaps missing call to ->Build()?", m_KintreeRef->name() );
+
+        const Eigen::Isometry3d tf_world_to_root = m_BodyAdapters[0]->body_node()->getTransform();
+        dst_tf = dartsim::mat4_from_eigen_tf( tf_world_to_root *
+                                              dartsim::mat4_to_eigen_tf( m_KintreeRef->root()->local_tf() ).inverse() );
+    }
+
+    void TDartKinematicTreeAdapter::GetLinearVelocity( TVec3& dst_linear_vel )
+    {
+        LOCO_CORE_ASSERT( m_BodyAdapters.size() > 0, "TDartKinematicTreeAdapter::GetLinearVelocity >>> kintree {0} \
+                          doesn't have any bodies. Perhaps missing call to ->Build()?", m_KintreeRef->name() );
+
+        dst_linear_vel = dartsim::vec3_from_eigen( m_BodyAdapters[0]->body_node()->getLinearVelocity() );
+    }
+
+    void TDartKinematicTreeAdapter::GetAngularVelocity( TVec3& dst_angular_vel )
+    {
+        LOCO_CORE_ASSERT( m_BodyAdapters.size() > 0, "TDartKinematicTreeAdapter::GetAngularVelocity >>> kintree {0} \
+                          doesn't have any bodies. Perhaps missing call to ->Build()?", m_KintreeRef->name() );
+
+        dst_angular_vel = dartsim::vec3_from_eigen( m_BodyAdapters[0]->body_node()->getAngularVelocity() );
+    }
+
+    void TDartKinematicTreeAdapter::GetQpos( Eigen::VectorXd& dst_qpos ) const
+    {
+        dst_qpos = m_DartSkeleton->getPositions();
+    }
+
+    void TDartKinematicTreeAdapter::SetQpos( const Eigen::VectorXd& qpos )
+    {
+        if ( qpos.size() != m_DartSkeleton->getNumDofs() )
+        {
+            LOCO_CORE_WARN( "TDartKinematicTreeAdapter::SetQpos >>> kintree {0} expects {1} qpos values, but got {2}",
+                            m_KintreeRef->name(), m_DartSkeleton->getNumDofs(), qpos.size() );
+            return;
+        }
+        m_DartSkeleton->setPositions( qpos );
+    }
+
+    void TDartKinematicTreeAdapter::GetQvel( Eigen::VectorXd& dst_qvel ) const
+    {
+        dst_qvel = m_DartSkeleton->getVelocities();
+    }
+
+    void TDartKinematicTreeAdapter::SetQvel( const Eigen::VectorXd& qvel )
+    {
+        if ( qvel.size() != m_DartSkeleton->getNumDofs() )
+        {
+            LOCO_CORE_WARN( "TDartKinematicTreeAdapter::SetQvel >>> kintree {0} expects {1} qvel values, but got {2}",
+                            m_KintreeRef->name(), m_DartSkeleton->getNumDofs(), qvel.size() );
+            return;
+        }
+        m_DartSkeleton->setVelocities( qvel );
+    }
+
+    void TDartKinematicTreeAdapter::SetDartWorld( dart::simulation::World* world_ref )
+    {
+        m_DartWorldRef = world_ref;
+        for ( auto& body_adapter : m_BodyAdapters )
+            body_adapter->SetDartWorld( world_ref );
+    }
+}}
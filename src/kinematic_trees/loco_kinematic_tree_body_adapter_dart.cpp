@@ -0,0 +1,186 @@
+
+#include <kinematic_trees/loco_kinematic_tree_body_adapter_dart.h>
+#include <kinematic_trees/loco_kinematic_tree_joint_adapter_dart.h>
+
+namespace loco {
+namespace kintree {
+
+    TDartKinematicTreeBodyAdapter::TDartKinematicTreeBodyAdapter( TKinematicTreeBody* body_ref )
+        : TIKinematicTreeBodyAdapter( body_ref )
+    {
+        LOCO_CORE_ASSERT( body_ref, "TDartKinematicTreeBodyAdapter >>> expected non-null body-obj reference" );
+    }
+
+    TDartKinematicTreeBodyAdapter::~TDartKinematicTreeBodyAdapter()
+    {
+        m_JointAdapters.clear();
+        m_ColliderAdapters.clear();
+        m_DartSkeletonRef = nullptr;
+        m_DartBodyNodeRef = nullptr;
+        m_DartJointRef = nullptr;
+    }
+
+    void TDartKinematicTreeBodyAdapter::Build()
+    {
+        LOCO_CORE_ASSERT( m_DartSkeletonRef, "TDartKinematicTreeBodyAdapter::Build >>> dart-skeleton reference \
+                          must be provided before calling ->Build(), for body {0}", m_BodyRef->name() );
+
+        // Dart uses a single joint per body-node. Bodies without joints are welded to their parents
+        auto joints = m_BodyRef->joints();
+        if ( joints.size() > 1 )
+            LOCO_CORE_WARN( "TDartKinematicTreeBodyAdapter::Build >>> body {0} has {1} joints, but the dart backend \
+                             only supports a single joint per body. Using only the first one", m_BodyRef->name(), joints.size() );
+
+        if ( joints.size() > 0 )
+        {
+            auto joint_adapter = std::make_unique<TDartKinematicTreeJointAdapter>( joints[0] );
+            joints[0]->SetJointAdapter( joint_adapter.get() );
+            joint_adapter->SetDartSkeleton( m_DartSkeletonRef );
+            joint_adapter->Build();
+
+            m_DartJointRef = joint_adapter->joint();
+            m_DartBodyNodeRef = joint_adapter->body_node();
+            m_JointAdapters.push_back( std::move( joint_adapter ) );
+        }
+
+        if ( !m_DartBodyNodeRef )
+        {
+            auto body_parent = m_BodyRef->parent(); // nullptr <=> root body
+            auto dart_body_parent_bodynode = ( body_parent == nullptr ) ? nullptr :
+                        static_cast<TDartKinematicTreeBodyAdapter*>( body_parent->adapter() )->body_node();
+
+            dart::dynamics::WeldJoint::Properties joint_properties;
+            joint_properties.mName = m_BodyRef->name() + "_weldjoint";
+            if ( body_parent )
+                joint_properties.mT_ParentBodyToJoint = dartsim::mat4_to_eigen_tf( m_BodyRef->local_tf() );
+
+            auto joint_bodynode_pair = m_DartSkeletonRef->createJointAndBodyNodePair<dart::dynamics::WeldJoint>(
+                                            dart_body_parent_bodynode, joint_properties,
+                                            dart::dynamics::BodyNode::AspectProperties( m_BodyRef->name() ) );
+            m_DartJointRef = joint_bodynode_pair.first;
+            m_DartBodyNodeRef = joint_bodynode_pair.second;
+        }
+
+        auto colliders = m_BodyRef->colliders();
+        for ( auto collider : colliders )
+        {
+            auto collider_adapter = std::make_unique<TDartKinematicTreeColliderAdapter>( collider );
+            collider->SetColliderAdapter( collider_adapter.get() );
+            collider_adapter->SetSceneCache( m_SceneCacheRef );
+            collider_adapter->SetParallelBuilder( m_ParallelBuilderRef );
+            collider_adapter->Build();
+
+            auto shape_node = m_DartBodyNodeRef->createShapeNodeWith<
+                                                    dart::dynamics::CollisionAspect,
+                                                    dart::dynamics::DynamicsAspect>( collider_adapter->collision_shape() );
+            collider_adapter->SetDartShapeNode( shape_node );
+            collider_adapter->SetLocalTransform( collider->local_tf() );
+            m_ColliderAdapters.push_back( std::move( collider_adapter ) );
+        }
+
+        dart::dynamics::Inertia body_inertia;
+        if ( !m_ParallelBuilderRef || !m_ParallelBuilderRef->GetInertia( &m_BodyRef->data().inertia, body_inertia ) )
+            body_inertia = dartsim::ComputeBodyInertia( m_BodyRef->name(), m_BodyRef->data().inertia,
+                                                        ( colliders.size() > 0 ) ? &colliders[0]->data() : nullptr,
+                                                        ( colliders.size() > 0 ) ? m_ColliderAdapters[0]->collision_shape() : nullptr,
+                                                        m_SceneCacheRef );
+        m_DartBodyNodeRef->setInertia( body_inertia );
+    }
+
+    void TDartKinematicTreeBodyAdapter::BuildFromTemplate( TDartKinematicTreeBodyAdapter* template_adapter )
+    {
+        LOCO_CORE_ASSERT( m_DartSkeletonRef, "TDartKinematicTreeBodyAdapter::BuildFromTemplate >>> dart-skeleton \
+                          reference must be provided before calling ->BuildFromTemplate(), for body {0}", m_BodyRef->name() );
+
+        // Cloned skeletons keep the indices of body-nodes, and of shape-nodes within them, but also the names of
+        // the template. These are renamed as in ->Build(), so name-based lookups find this kintree's elements
+        m_DartBodyNodeRef = m_DartSkeletonRef->getBodyNode( template_adapter->body_node()->getIndexInSkeleton() );
+        m_DartJointRef = m_DartBodyNodeRef->getParentJoint();
+        m_DartBodyNodeRef->setName( m_BodyRef->name() );
+
+        auto joints = m_BodyRef->joints();
+        if ( ( joints.size() > 0 ) && ( template_adapter->joint_adapters().size() > 0 ) )
+        {
+            auto joint_adapter = std::make_unique<TDartKinematicTreeJointAdapter>( joints[0] );
+            joints[0]->SetJointAdapter( joint_adapter.get() );
+            joint_adapter->SetDartSkeleton( m_DartSkeletonRef );
+            joint_adapter->BuildFromTemplate( template_adapter->joint_adapters()[0].get(), m_DartBodyNodeRef );
+            m_JointAdapters.push_back( std::move( joint_adapter ) );
+        }
+        else
+        {
+            m_DartJointRef->setName( m_BodyRef->name() + "_weldjoint" );
+        }
+
+        auto colliders = m_BodyRef->colliders();
+        auto& template_collider_adapters = template_adapter->collider_adapters();
+        for ( size_t i = 0; i < colliders.size(); i++ )
+        {
+            auto template_collider_adapter = template_collider_adapters[i].get();
+            auto shape_node = m_DartBodyNodeRef->getShapeNode( template_collider_adapter->shape_node()->getIndexInBodyNode() );
+
+            auto collider_adapter = std::make_unique<TDartKinematicTreeColliderAdapter>( colliders[i] );
+            colliders[i]->SetColliderAdapter( collider_adapter.get() );
+            collider_adapter->BuildFromTemplate( template_collider_adapter, shape_node );
+            m_ColliderAdapters.push_back( std::move( collider_adapter ) );
+        }
+    }
+
+    void TDartKinematicTreeBodyAdapter::Initialize()
+    {
+        LOCO_CORE_ASSERT( m_DartBodyNodeRef, "TDartKinematicTreeBodyAdapter::Initialize >>> body {0} must have \
+                          a valid dart-bodynode. Perhaps missing call to ->Build()?", m_BodyRef->name() );
+
+        for ( auto& collider_adapter : m_ColliderAdapters )
+            collider_adapter->Initialize();
+        for ( auto& joint_adapter : m_JointAdapters )
+            joint_adapter->Initialize();
+    }
+
+    void TDartKinematicTreeBodyAdapter::Reset()
+    {
+        for ( auto& joint_adapter : m_JointAdapters )
+            joint_adapter->Reset();
+    }
+
+    void TDartKinematicTreeBodyAdapter::SetForceCOM( const TVec3& force )
+    {
+        LOCO_CORE_ASSERT( m_DartBodyNodeRef, "TDartKinematicTreeBodyAdapter::SetForceCOM >>> body {0} must have \
+                          a valid dart-bodynode to set a force @ com. Perhaps missing call to ->Build()", m_BodyRef->name() );
+
+        m_DartBodyNodeRef->setExtForce( dartsim::vec3_to_eigen( force ) );
+    }
+
+    void TDartKinematicTreeBodyAdapter::SetTorqueCOM( const TVec3& torque )
+    {
+        LOCO_CORE_ASSERT( m_DartBodyNodeRef, "TDartKinematicTreeBodyAdapter::SetTorqueCOM >>> body {0} must have \
+                          a valid dart-bodynode to set a torque @ com. Perhaps missing call to ->Build()", m_BodyRef->name() );
+
+        m_DartBodyNodeRef->setExtTorque( dartsim::vec3_to_eigen( torque ) );
+    }
+
+    void TDartKinematicTreeBodyAdapter::GetTransform( TMat4& dst_transform )
+    {
+        LOCO_CORE_ASSERT( m_DartBodyNodeRef, "TDartKinematicTreeBodyAdapter::GetTransform >>> body {0} must have \
+                          a valid dart-bodynode to get its transform. Perhaps missing call to ->Build()", m_BodyRef->name() );
+
+        dst_transform = dartsim::mat4_from_eigen_tf( m_DartBodyNodeRef->getTransform() );
+    }
+
+    void TDartKinematicTreeBodyAdapter::SetTransformFromParentBody( const Eigen::Isometry3d& tf_parent_body_to_body )
+    {
+        LOCO_CORE_ASSERT( m_DartJointRef, "TDartKinematicTreeBodyAdapter::SetTransformFromParentBody >>> body {0} must \
+                          have a valid dart-joint. Perhaps missing call to ->Build()", m_BodyRef->name() );
+
+        if ( m_JointAdapters.size() > 0 )
+            m_JointAdapters[0]->SetTransformFromParentBody( tf_parent_body_to_body );
+        else
+            m_DartJointRef->setTransformFromParentBodyNode( tf_parent_body_to_body );
+    }
+
+    void TDartKinematicTreeBodyAdapter::SetDartWorld( dart::simulation::World* world_ref )
+    {
+        for ( auto& collider_adapter : m_ColliderAdapters )
+            collider_adapter->SetDartWorld( world_ref );
+    }
+}}
@@ -1,5 +1,6 @@
 
 #include <kinematic_trees/loco_kinematic_tree_collider_adapter_dart.h>
+#include <loco_parallel_build_dart.h>
 
 namespace loco {
 namespace kintree {
@@ -16,28 +17,54 @@ namespace kintree {
         m_DartShape = nullptr;
         m_DartShapeNodeRef = nullptr;
         m_DartWorldRef = nullptr;
+        m_CollisionFilterRef = nullptr;
+        m_CollisionFilterSlot = -1;
     }
 
     void TDartKinematicTreeColliderAdapter::Build()
     {
-        m_DartShape = dartsim::CreateCollisionShape( m_ColliderRef->data() );
+        // The shape might have been created already, by the parallel build-phase of the simulation
+        m_DartShape = m_ParallelBuilderRef ? m_ParallelBuilderRef->GetShape( &m_ColliderRef->data() ) : nullptr;
+        if ( !m_DartShape )
+            m_DartShape = dartsim::CreateCollisionShape( m_ColliderRef->data(), m_SceneCacheRef );
         m_DartShapeNodeRef = nullptr;
         m_DartWorldRef = nullptr;
     }
 
+    void TDartKinematicTreeColliderAdapter::BuildFromTemplate( TDartKinematicTreeColliderAdapter* template_adapter,
+                                                               dart::dynamics::ShapeNode* shape_node_ref )
+    {
+        m_DartShape = template_adapter->collision_shape();
+        m_DartShapeNodeRef = shape_node_ref;
+        m_DartWorldRef = nullptr;
+        m_ShapeShared = true;
+        template_adapter->m_ShapeShared = true;
+    }
+
     void TDartKinematicTreeColliderAdapter::Initialize()
     {
         LOCO_CORE_ASSERT( m_DartWorldRef, "TDartKinematicTreeColliderAdapter::Initialize >>> must have a \
                           valid reference to the dart-world object to initialize collider {0}", m_ColliderRef->name() );
 
         auto& collision_filter = m_DartWorldRef->getConstraintSolver()->getCollisionOption().collisionFilter;
-        auto bitmask_collision_filter = dynamic_cast<dartsim::TDartBitmaskCollisionFilter*>( collision_filter.get() );
-        if ( bitmask_collision_filter )
+        m_CollisionFilterRef = dynamic_cast<dartsim::TDartBitmaskCollisionFilter*>( collision_filter.get() );
+        if ( m_CollisionFilterRef )
+            m_CollisionFilterSlot = m_CollisionFilterRef->registerShapeNode( m_DartShapeNodeRef,
+                                                                              m_ColliderRef->collisionGroup(),
+                                                                              m_ColliderRef->collisionMask() );
+        ChangeFriction( m_ColliderRef->data().friction.x() );
+    }
+
+    void TDartKinematicTreeColliderAdapter::SetLocalTransform( const TMat4& local_tf )
+    {
+        if ( !m_DartShapeNodeRef )
         {
-            bitmask_collision_filter->setCollisionGroup( m_DartShapeNodeRef, m_ColliderRef->collisionGroup() );
-            bitmask_collision_filter->setCollisionMask( m_DartShapeNodeRef, m_ColliderRef->collisionMask() );
+            LOCO_CORE_ERROR( "TDartKinematicTreeColliderAdapter::SetLocalTransform >>> collider {0} doesn't have \
+                             a handle to its corresponding dart-shape-node", m_ColliderRef->name() );
+            return;
         }
-        ChangeFriction( m_ColliderRef->data().friction.x() );
+
+        m_DartShapeNodeRef->setRelativeTransform( dartsim::mat4_to_eigen_tf( local_tf ) );
     }
 
     void TDartKinematicTreeColliderAdapter::ChangeSize( const TVec3& new_size )
@@ -45,6 +72,9 @@ namespace kintree {
         if ( !m_DartShape )
             return;
 
+        if ( m_ShapeShared )
+            _DetachSharedShape();
+
         switch ( m_ColliderRef->shape() )
         {
             case eShapeType::BOX :
@@ -97,7 +127,7 @@ namespace kintree {
         }
     }
 
-    void TDartKinematicTreeColliderAdapter::ChangeCollisionGroup( int collisionGroup )
+    void TDartKinematicTreeColliderAdapter::ChangeCollisionGroup( int collision_group )
     {
         if ( !m_DartWorldRef )
         {
@@ -106,12 +136,12 @@ namespace kintree {
             return;
         }
 
-        auto& collision_filter = m_DartWorldRef->getConstraintSolver()->getCollisionOption().collisionFilter;
-        if ( auto bitmask_collision_filter = dynamic_cast<dartsim::TDartBitmaskCollisionFilter*>( collision_filter.get() ) )
-            bitmask_collision_filter->setCollisionGroup( m_DartShapeNodeRef, m_ColliderRef->collisionGroup() );
+        // Changes take effect on the next step (the broadphase-proxy is refreshed by the simulation before stepping)
+        if ( m_CollisionFilterRef && m_CollisionFilterSlot >= 0 )
+            m_CollisionFilterRef->setCollisionGroup( m_CollisionFilterSlot, collision_group );
     }
 
-    void TDartKinematicTreeColliderAdapter::ChangeCollisionMask( int collisionMask )
+    void TDartKinematicTreeColliderAdapter::ChangeCollisionMask( int collision_mask )
     {
         if ( !m_DartWorldRef )
         {
@@ -120,9 +150,9 @@ namespace kintree {
             return;
         }
 
-        auto& collision_filter = m_DartWorldRef->getConstraintSolver()->getCollisionOption().collisionFilter;
-        if ( auto bitmask_collision_filter = dynamic_cast<dartsim::TDartBitmaskCollisionFilter*>( collision_filter.get() ) )
-            bitmask_collision_filter->setCollisionMask( m_DartShapeNodeRef, m_ColliderRef->collisionMask() );
+        // Changes take effect on the next step (the broadphase-proxy is refreshed by the simulation before stepping)
+        if ( m_CollisionFilterRef && m_CollisionFilterSlot >= 0 )
+            m_CollisionFilterRef->setCollisionMask( m_CollisionFilterSlot, collision_mask );
     }
 
     void TDartKinematicTreeColliderAdapter::ChangeFriction( const TScalar& friction )
@@ -136,4 +166,14 @@ namespace kintree {
 
         m_DartShapeNodeRef->getDynamicsAspect()->setFrictionCoeff( friction );
     }
+
+    void TDartKinematicTreeColliderAdapter::_DetachSharedShape()
+    {
+        m_ShapeShared = false;
+        if ( !m_DartShapeNodeRef )
+            return;
+
+        m_DartShape = m_DartShape->clone();
+        m_DartShapeNodeRef->setShape( m_DartShape );
+    }
 }}
\ No newline at end of file
@@ -12,11 +12,14 @@ namespace kintree {
         m_DartSkeletonRef = nullptr;
         m_DartJointRef = nullptr;
         m_DartBodyNodeRef = nullptr;
+        m_QposDataRef = nullptr;
+        m_QvelDataRef = nullptr;
     }
 
     void TDartKinematicTreeJointAdapter::Build()
     {
-        LOCO_CORE_ASSERT( m_DartSkeletonRef, "" );
+        LOCO_CORE_ASSERT( m_DartSkeletonRef, "TDartKinematicTreeJointAdapter::Build >>> dart-skeleton reference \
+                          must be provided before calling ->Build(), for joint {0}", m_JointRef->name() );
 
         const auto joint_type = m_JointRef->type();
         const auto joint_name = m_JointRef->name();
@@ -27,27 +30,24 @@ namespace kintree {
         auto body_parent = m_JointRef->parent();
         auto body_parent_parent = body_parent->parent(); // nullptr <=> root body
         const bool is_root = ( body_parent_parent == nullptr );
-        const auto tf_body_parent_parent_to_joint = ( !is_root ) ? body_parent->tf() :
-                        body_parent->local_tf().inverse() * joint_local_tf;
 
-        const Eigen::Vector3d jnt_pos_local = dartsim::vec3_to_eigen( TVec3( joint_local_tf.col( 3 ) ) );
-        const Eigen::Matrix3d jnt_rot_local = dartsim::mat3_to_eigen( TMat3( joint_local_tf ) );
-        const Eigen::Vector3d jnt_axis_body_frame = dartsim::vec3_to_eigen( TMat3( joint_local_tf ) * joint_local_axis );
-        const Eigen::Vector3d body_pos_parent_to_joint = dartsim::vec3_to_eigen( TVec3( tf_body_parent_parent_to_joint.col( 3 ) ) );
-        const Eigen::Matrix3d body_rot_parent_to_joint = dartsim::mat3_to_eigen( TMat3( tf_body_parent_parent_to_joint ) );
+        // Root bodies are placed w.r.t. the world by the kintree-adapter (see TDartKinematicTreeAdapter::SetTransform)
+        m_TfParentBodyToBody = ( is_root ) ? Eigen::Isometry3d::Identity() : dartsim::mat4_to_eigen_tf( body_parent->local_tf() );
+        const Eigen::Isometry3d tf_child_body_to_joint = dartsim::mat4_to_eigen_tf( joint_local_tf );
+        const Eigen::Isometry3d tf_parent_body_to_joint = m_TfParentBodyToBody * tf_child_body_to_joint;
+        // Axis is given in the joint frame, which already includes the rotation of the joint's local transform
+        const Eigen::Vector3d jnt_axis_joint_frame = dartsim::vec3_to_eigen( joint_local_axis );
 
         auto dart_body_parent_parent_bodynode = ( is_root ) ? nullptr :
-                    static_cast<TKinematicTreeBodyAdapter*>( body_parent_parent->adapter() )->body_node();
+                    static_cast<TDartKinematicTreeBodyAdapter*>( body_parent_parent->adapter() )->body_node();
 
         /**/ if ( joint_type == eJointType::REVOLUTE )
         {
             dart::dynamics::RevoluteJoint::Properties jnt_properties;
             jnt_properties.mName = joint_name;
-            jnt_properties.mAxis = jnt_axis_body_frame;
-            jnt_properties.mT_ParentBodyToJoint.linear() = body_rot_parent_to_joint;
-            jnt_properties.mT_ParentBodyToJoint.translation() = body_pos_parent_to_joint;
-            jnt_properties.mT_ChildBodyToJoint.linear() = jnt_rot_local;
-            jnt_properties.mT_ChildBodyToJoint.translation() = jnt_pos_local;
+            jnt_properties.mAxis = jnt_axis_joint_frame;
+            jnt_properties.mT_ParentBodyToJoint = tf_parent_body_to_joint;
+            jnt_properties.mT_ChildBodyToJoint = tf_child_body_to_joint;
             jnt_properties.mRestPositions[0] = 0.0;
             jnt_properties.mSpringStiffnesses[0] = joint_data.stiffness;
             jnt_properties.mDampingCoefficients[0] = joint_data.damping;
@@ -64,11 +64,9 @@ namespace kintree {
         {
             dart::dynamics::PrismaticJoint::Properties jnt_properties;
             jnt_properties.mName = joint_name;
-            jnt_properties.mAxis = jnt_axis_world;
-            jnt_properties.mT_ParentBodyToJoint.linear() = body_rot_parent_to_joint;
-            jnt_properties.mT_ParentBodyToJoint.translation() = body_pos_parent_to_joint;
-            jnt_properties.mT_ChildBodyToJoint.linear() = jnt_rot_local;
-            jnt_properties.mT_ChildBodyToJoint.translation() = jnt_pos_local;
+            jnt_properties.mAxis = jnt_axis_joint_frame;
+            jnt_properties.mT_ParentBodyToJoint = tf_parent_body_to_joint;
+            jnt_properties.mT_ChildBodyToJoint = tf_child_body_to_joint;
             jnt_properties.mRestPositions[0] = 0.0;
             jnt_properties.mSpringStiffnesses[0] = joint_data.stiffness;
             jnt_properties.mDampingCoefficients[0] = joint_data.damping;
@@ -85,10 +83,8 @@ namespace kintree {
         {
             dart::dynamics::SphericalJoint::Properties jnt_properties;
             jnt_properties.mName = joint_name;
-            jnt_properties.mT_ParentBodyToJoint.linear() = body_rot_parent_to_joint;
-            jnt_properties.mT_ParentBodyToJoint.translation() = body_pos_parent_to_joint;
-            jnt_properties.mT_ChildBodyToJoint.linear() = jnt_rot_local;
-            jnt_properties.mT_ChildBodyToJoint.translation() = jnt_pos_local;
+            jnt_properties.mT_ParentBodyToJoint = tf_parent_body_to_joint;
+            jnt_properties.mT_ChildBodyToJoint = tf_child_body_to_joint;
 
             dart::dynamics::BodyNode::Properties body_properties;
             body_properties.mName = body_parent->name();
@@ -105,8 +101,8 @@ namespace kintree {
             jnt_properties.mPlaneType = dart::dynamics::detail::PlaneType::ARBITRARY;
             jnt_properties.mTransAxis1 = dartsim::vec3_to_eigen( joint_data.plane_axis_1 );
             jnt_properties.mTransAxis2 = dartsim::vec3_to_eigen( joint_data.plane_axis_2 );
-            jnt_properties.mT_ParentBodyToJoint.translation() = body_pos_parent_to_joint;
-            jnt_properties.mT_ChildBodyToJoint.translation() = jnt_pos_local;
+            jnt_properties.mT_ParentBodyToJoint = tf_parent_body_to_joint;
+            jnt_properties.mT_ChildBodyToJoint = tf_child_body_to_joint;
 
             dart::dynamics::BodyNode::Properties body_properties;
             body_properties.mName = body_parent->name();
@@ -120,10 +116,8 @@ namespace kintree {
         {
             dart::dynamics::WeldJoint::Properties jnt_properties;
             jnt_properties.mName = joint_name;
-            jnt_properties.mT_ParentBodyToJoint.linear() = body_rot_parent_to_joint;
-            jnt_properties.mT_ParentBodyToJoint.translation() = body_pos_parent_to_joint;
-            jnt_properties.mT_ChildBodyToJoint.linear() = jnt_rot_local;
-            jnt_properties.mT_ChildBodyToJoint.translation() = jnt_pos_local;
+            jnt_properties.mT_ParentBodyToJoint = tf_parent_body_to_joint;
+            jnt_properties.mT_ChildBodyToJoint = tf_child_body_to_joint;
 
             dart::dynamics::BodyNode::Properties body_properties;
             body_properties.mName = body_parent->name();
@@ -137,6 +131,8 @@ namespace kintree {
         {
             dart::dynamics::FreeJoint::Properties jnt_properties;
             jnt_properties.mName = joint_name;
+            jnt_properties.mT_ParentBodyToJoint = tf_parent_body_to_joint;
+            jnt_properties.mT_ChildBodyToJoint = tf_child_body_to_joint;
 
             dart::dynamics::BodyNode::Properties body_properties;
             body_properties.mName = body_parent->name();
@@ -152,63 +148,158 @@ namespace kintree {
         }
     }
 
+    void TDartKinematicTreeJointAdapter::BuildFromTemplate( const TDartKinematicTreeJointAdapter* template_adapter,
+                                                            dart::dynamics::BodyNode* body_node_ref )
+    {
+        m_DartBodyNodeRef = body_node_ref;
+        m_DartJointRef = body_node_ref->getParentJoint();
+        m_DartJointRef->setName( m_JointRef->name() );
+        m_TfParentBodyToBody = template_adapter->m_TfParentBodyToBody;
+    }
+
+    void TDartKinematicTreeJointAdapter::CacheStateViews()
+    {
+        LOCO_CORE_ASSERT( m_DartJointRef, "TDartKinematicTreeJointAdapter::CacheStateViews >>> dart-joint reference \
+                          must be valid (got nullptr), for joint {0}. Perhaps missing call to ->Build()?", m_JointRef->name() );
+
+        m_NumDofs = m_DartJointRef->getNumDofs();
+        m_DofsIndex = ( m_NumDofs > 0 ) ? m_DartJointRef->getIndexInSkeleton( 0 ) : 0;
+        m_QposDataRef = dartsim::GetJointPositionsData( m_DartJointRef );
+        m_QvelDataRef = dartsim::GetJointVelocitiesData( m_DartJointRef );
+        if ( ( m_NumDofs > 0 ) && ( !m_QposDataRef || !m_QvelDataRef ) )
+        {
+            LOCO_CORE_WARN( "TDartKinematicTreeJointAdapter::CacheStateViews >>> couldn't find the internal state of \
+                             joint {0}, so views of its state won't be available", m_JointRef->name() );
+            m_NumDofs = 0;
+        }
+    }
+
     void TDartKinematicTreeJointAdapter::Initialize()
     {
+        LOCO_CORE_ASSERT( m_DartJointRef, "TDartKinematicTreeJointAdapter::Initialize >>> dart-joint reference \
+                          must be valid (got nullptr), for joint {0}. Perhaps missing call to ->Build()?", m_JointRef->name() );
 
+        ChangeLimits( m_JointRef->data().limits );
+        Reset();
     }
 
     void TDartKinematicTreeJointAdapter::Reset()
     {
+        LOCO_CORE_ASSERT( m_DartJointRef, "TDartKinematicTreeJointAdapter::Reset >>> dart-joint reference \
+                          must be valid (got nullptr), for joint {0}", m_JointRef->name() );
 
+        m_DartJointRef->resetPositions();
+        m_DartJointRef->resetVelocities();
     }
 
     void TDartKinematicTreeJointAdapter::SetQpos( const std::vector<TScalar>& qpos )
     {
+        LOCO_CORE_ASSERT( m_DartJointRef, "TDartKinematicTreeJointAdapter::SetQpos >>> dart-joint reference \
+                          must be valid (got nullptr), for joint {0}", m_JointRef->name() );
 
+        dartsim::SetJointQpos( m_DartJointRef, qpos );
     }
 
     void TDartKinematicTreeJointAdapter::SetQvel( const std::vector<TScalar>& qvel )
     {
+        LOCO_CORE_ASSERT( m_DartJointRef, "TDartKinematicTreeJointAdapter::SetQvel >>> dart-joint reference \
+                          must be valid (got nullptr), for joint {0}", m_JointRef->name() );
 
+        dartsim::SetJointQvel( m_DartJointRef, qvel );
     }
 
     void TDartKinematicTreeJointAdapter::SetLocalTransform( const TMat4& local_tf )
     {
+        LOCO_CORE_ASSERT( m_DartJointRef, "TDartKinematicTreeJointAdapter::SetLocalTransform >>> dart-joint reference \
+                          must be valid (got nullptr), for joint {0}", m_JointRef->name() );
 
+        const Eigen::Isometry3d tf_child_body_to_joint = dartsim::mat4_to_eigen_tf( local_tf );
+        m_DartJointRef->setTransformFromChildBodyNode( tf_child_body_to_joint );
+        m_DartJointRef->setTransformFromParentBodyNode( m_TfParentBodyToBody * tf_child_body_to_joint );
+    }
+
+    void TDartKinematicTreeJointAdapter::SetTransformFromParentBody( const Eigen::Isometry3d& tf_parent_body_to_body )
+    {
+        LOCO_CORE_ASSERT( m_DartJointRef, "TDartKinematicTreeJointAdapter::SetTransformFromParentBody >>> dart-joint \
+                          reference must be valid (got nullptr), for joint {0}", m_JointRef->name() );
+
+        m_TfParentBodyToBody = tf_parent_body_to_body;
+        m_DartJointRef->setTransformFromParentBodyNode( m_TfParentBodyToBody * m_DartJointRef->getTransformFromChildBodyNode() );
     }
 
     void TDartKinematicTreeJointAdapter::ChangeStiffness( const TScalar& stiffness )
     {
+        LOCO_CORE_ASSERT( m_DartJointRef, "TDartKinematicTreeJointAdapter::ChangeStiffness >>> dart-joint reference \
+                          must be valid (got nullptr), for joint {0}", m_JointRef->name() );
 
+        for ( size_t i = 0; i < m_DartJointRef->getNumDofs(); i++ )
+            m_DartJointRef->setSpringStiffness( i, stiffness );
     }
 
     void TDartKinematicTreeJointAdapter::ChangeArmature( const TScalar& armature )
     {
+        LOCO_CORE_ASSERT( m_DartJointRef, "TDartKinematicTreeJointAdapter::ChangeArmature >>> dart-joint reference \
+                          must be valid (got nullptr), for joint {0}", m_JointRef->name() );
 
+        // Armature maps to the rotor-inertia of each dof of the joint
+        for ( size_t i = 0; i < m_DartJointRef->getNumDofs(); i++ )
+            m_DartJointRef->getDof( i )->setRotorInertia( armature );
     }
 
     void TDartKinematicTreeJointAdapter::ChangeDamping( const TScalar& damping )
     {
+        LOCO_CORE_ASSERT( m_DartJointRef, "TDartKinematicTreeJointAdapter::ChangeDamping >>> dart-joint reference \
+                          must be valid (got nullptr), for joint {0}", m_JointRef->name() );
 
+        for ( size_t i = 0; i < m_DartJointRef->getNumDofs(); i++ )
+            m_DartJointRef->setDampingCoefficient( i, damping );
     }
 
     void TDartKinematicTreeJointAdapter::ChangeAxis( const TVec3& axis )
     {
+        LOCO_CORE_ASSERT( m_DartJointRef, "TDartKinematicTreeJointAdapter::ChangeAxis >>> dart-joint reference \
+                          must be valid (got nullptr), for joint {0}", m_JointRef->name() );
 
+        if ( auto revolute_joint = dynamic_cast<dart::dynamics::RevoluteJoint*>( m_DartJointRef ) )
+            revolute_joint->setAxis( dartsim::vec3_to_eigen( axis ) );
+        else if ( auto prismatic_joint = dynamic_cast<dart::dynamics::PrismaticJoint*>( m_DartJointRef ) )
+            prismatic_joint->setAxis( dartsim::vec3_to_eigen( axis ) );
+        else
+            LOCO_CORE_WARN( "TDartKinematicTreeJointAdapter::ChangeAxis >>> joint {0} of type {1} doesn't have an axis",
+                            m_JointRef->name(), ToString( m_JointRef->type() ) );
     }
 
     void TDartKinematicTreeJointAdapter::ChangeLimits( const TVec2& limits )
     {
+        LOCO_CORE_ASSERT( m_DartJointRef, "TDartKinematicTreeJointAdapter::ChangeLimits >>> dart-joint reference \
+                          must be valid (got nullptr), for joint {0}", m_JointRef->name() );
+
+        // Only single-dof joints (revolute|prismatic) have limits
+        if ( m_DartJointRef->getNumDofs() != 1 )
+            return;
 
+        const bool is_limited = ( limits.x() < limits.y() );
+        m_DartJointRef->setPositionLimitEnforced( is_limited );
+        if ( is_limited )
+        {
+            m_DartJointRef->setPositionLowerLimit( 0, limits.x() );
+            m_DartJointRef->setPositionUpperLimit( 0, limits.y() );
+        }
     }
 
     void TDartKinematicTreeJointAdapter::GetQpos( std::vector<TScalar>& dst_qpos )
     {
+        LOCO_CORE_ASSERT( m_DartJointRef, "TDartKinematicTreeJointAdapter::GetQpos >>> dart-joint reference \
+                          must be valid (got nullptr), for joint {0}", m_JointRef->name() );
 
+        dartsim::GetJointQpos( m_DartJointRef, dst_qpos );
     }
 
     void TDartKinematicTreeJointAdapter::GetQvel( std::vector<TScalar>& dst_qvel )
     {
+        LOCO_CORE_ASSERT( m_DartJointRef, "TDartKinematicTreeJointAdapter::GetQvel >>> dart-joint reference \
+                          must be valid (got nullptr), for joint {0}", m_JointRef->name() );
 
+        dartsim::GetJointQvel( m_DartJointRef, dst_qvel );
     }
-}}
\ No newline at end of file
+}}
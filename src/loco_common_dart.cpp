@@ -1,5 +1,6 @@
 
 #include <loco_common_dart.h>
+#include <loco_scene_cache_dart.h>
 
 namespace loco {
 namespace dartsim {
@@ -89,7 +90,21 @@ namespace dartsim {
         return tm_mat;
     }
 
-    dart::dynamics::ShapePtr CreateCollisionShape( const TShapeData& data )
+    const aiScene* LoadCollisionMesh( const TShapeData& data, TDartSceneCache* scene_cache )
+    {
+        if ( ( data.type != eShapeType::CONVEX_MESH ) && ( data.type != eShapeType::TRIANGULAR_MESH ) )
+            return nullptr;
+
+        const auto& mesh_data = data.mesh_data;
+        if ( mesh_data.filename != "" )
+            return scene_cache ? scene_cache->LoadMesh( mesh_data.filename ) : dart::dynamics::MeshShape::loadMesh( mesh_data.filename );
+        if ( ( mesh_data.vertices.size() > 0 ) && ( ( data.type == eShapeType::CONVEX_MESH ) || ( mesh_data.faces.size() > 0 ) ) )
+            return CreateAssimpSceneFromVertexData( mesh_data.vertices, mesh_data.faces );
+        return nullptr;
+    }
+
+    dart::dynamics::ShapePtr CreateCollisionShape( const TShapeData& data, TDartSceneCache* scene_cache,
+                                                   const TDartLoadedMeshes* loaded_meshes )
     {
         switch ( data.type )
         {
@@ -106,37 +121,20 @@ namespace dartsim {
             case eShapeType::ELLIPSOID :
                 return std::make_shared<dart::dynamics::EllipsoidShape>( 2.0 * vec3_to_eigen( data.size ) );
             case eShapeType::CONVEX_MESH :
-            {
-                const auto& mesh_data = data.mesh_data;
-                if ( mesh_data.filename != "" )
-                {
-                    if ( const auto assimp_scene = dart::dynamics::ConvexHullShape::loadMesh( mesh_data.filename ) )
-                        return std::make_shared<dart::dynamics::ConvexHullShape>( vec3_to_eigen( data.size ), assimp_scene );
-                }
-                else if ( mesh_data.vertices.size() > 0 )
-                {
-                    if ( const auto assimp_scene = CreateAssimpSceneFromVertexData( mesh_data.vertices, mesh_data.faces ) )
-                        return std::make_shared<dart::dynamics::ConvexHullShape>( vec3_to_eigen( data.size ), assimp_scene );
-                }
-
-                LOCO_CORE_ERROR( "CreateCollisionShape >>> Couldn't create dart convex-hull-mesh-shape" );
-                return nullptr;
-            }
             case eShapeType::TRIANGULAR_MESH :
             {
-                const auto& mesh_data = data.mesh_data;
-                if ( mesh_data.filename != "" )
-                {
-                    if ( const auto assimp_scene = dart::dynamics::TriangleMeshShape::loadMesh( mesh_data.filename ) )
-                        return std::make_shared<dart::dynamics::TriangleMeshShape>( vec3_to_eigen( data.size ), assimp_scene );
-                }
-                else if ( mesh_data.vertices.size() > 0 && mesh_data.faces.size() > 0 )
-                {
-                    if ( const auto assimp_scene = CreateAssimpSceneFromVertexData( mesh_data.vertices, mesh_data.faces ) )
-                        return std::make_shared<dart::dynamics::TriangleMeshShape>( vec3_to_eigen( data.size ), assimp_scene );
-                }
-
-                LOCO_CORE_ERROR( "CreateCollisionShape >>> Couldn't create dart triangle-mesh-shape" );
+                auto it_mesh = loaded_meshes ? loaded_meshes->find( &data ) : TDartLoadedMeshes::const_iterator();
+                const auto assimp_scene = ( loaded_meshes && it_mesh != loaded_meshes->end() ) ? it_mesh->second :
+                                                                                                LoadCollisionMesh( data, scene_cache );
+                if ( assimp_scene && data.type == eShapeType::CONVEX_MESH )
+                    return std::make_shared<dart::dynamics::ConvexHullShape>( vec3_to_eigen( data.size ), assimp_scene );
+                if ( assimp_scene )
+                    return std::make_shared<dart::dynamics::TriangleMeshShape>( vec3_to_eigen( data.size ), assimp_scene );
+
+                if ( data.type == eShapeType::CONVEX_MESH )
+                    LOCO_CORE_ERROR( "CreateCollisionShape >>> Couldn't create dart convex-hull-mesh-shape" );
+                else
+                    LOCO_CORE_ERROR( "CreateCollisionShape >>> Couldn't create dart triangle-mesh-shape" );
                 return nullptr;
             }
             case eShapeType::HEIGHTFIELD :
@@ -158,7 +156,8 @@ namespace dartsim {
             {
                 auto compound_shape = std::make_shared<dart::dynamics::CompoundShape>();
                 for ( ssize_t i = 0; i < data.children.size(); i++ )
-                    compound_shape->addChild( CreateCollisionShape( data.children[i] ), mat4_to_eigen_tf( data.children_tfs[i] ) );
+                    compound_shape->addChild( CreateCollisionShape( data.children[i], scene_cache, loaded_meshes ),
+                                              mat4_to_eigen_tf( data.children_tfs[i] ) );
                 return compound_shape;
             }
         }
@@ -167,6 +166,267 @@ namespace dartsim {
         return nullptr;
     }
 
+    eHeightfieldLayout GetHeightfieldLayout( const dart::dynamics::HeightmapShapef* hfield_shape,
+                                             const THeightsConstRef& heights_unflipped )
+    {
+        const auto& hfield = hfield_shape->getHeightField();
+        const ssize_t num_rows = heights_unflipped.rows();
+        if ( ( hfield.rows() != num_rows ) || ( hfield.cols() != heights_unflipped.cols() ) )
+            return eHeightfieldLayout::UNKNOWN;
+
+        // Only rows that differ from their mirrored row tell both layouts apart (usually the very first one)
+        for ( ssize_t i = 0; i < num_rows / 2; i++ )
+        {
+            const ssize_t i_mirror = num_rows - 1 - i;
+            if ( heights_unflipped.row( i ) == heights_unflipped.row( i_mirror ) )
+                continue;
+            if ( hfield.row( i ) == heights_unflipped.row( i ) )
+                return eHeightfieldLayout::UNFLIPPED;
+            if ( hfield.row( i ) == heights_unflipped.row( i_mirror ) )
+                return eHeightfieldLayout::FLIPPED;
+            break;
+        }
+        return eHeightfieldLayout::UNKNOWN;
+    }
+
+    void WriteHeightfieldRegion( dart::dynamics::HeightmapShapef* hfield_shape, eHeightfieldLayout layout,
+                                 const THeightsConstRef& heights_unflipped,
+                                 ssize_t x0, ssize_t y0, ssize_t width, ssize_t depth )
+    {
+        const auto region = heights_unflipped.block( y0, x0, depth, width );
+
+        // The only data cached by the collision-detector is the vertical extent of the terrain (used for its aabb),
+        // so rebuild it (the detector flips the new buffer once again) only if the region goes past those bounds
+        if ( ( layout == eHeightfieldLayout::UNKNOWN ) ||
+             ( region.minCoeff() < hfield_shape->getMinHeight() ) || ( region.maxCoeff() > hfield_shape->getMaxHeight() ) )
+        {
+            hfield_shape->setHeightField( dart::dynamics::HeightmapShapef::HeightField( heights_unflipped ) );
+            return;
+        }
+
+        // The bullet terrain-shape references the heights-buffer of the dart-shape (no copy), so writing the region
+        // in place is enough for the narrowphase to use the new elevations on the next step
+        auto& hfield = hfield_shape->getHeightFieldModifiable();
+        if ( layout == eHeightfieldLayout::UNFLIPPED )
+            hfield.block( y0, x0, depth, width ) = region;
+        else
+            hfield.block( hfield.rows() - y0 - depth, x0, depth, width ) = region.colwise().reverse();
+    }
+
+    void UpdateHeightfieldRegion( dart::dynamics::HeightmapShapef* hfield_shape, THeightsRef heights_unflipped,
+                                  ssize_t x0, ssize_t y0, ssize_t width, ssize_t depth,
+                                  const float* heights, ssize_t stride )
+    {
+        const THeightsConstMap region( heights, depth, width, Eigen::OuterStride<>( stride ) );
+
+        // The layout of the shape's buffer can only be told apart before the unflipped heights change
+        const auto layout = GetHeightfieldLayout( hfield_shape, heights_unflipped );
+        heights_unflipped.block( y0, x0, depth, width ) = region;
+        WriteHeightfieldRegion( hfield_shape, layout, heights_unflipped, x0, y0, width, depth );
+    }
+
+    void SampleHeightfield( const THeightsConstRef& heights_unflipped, const Eigen::Vector3f& scale_f,
+                            const Eigen::Isometry3d& tf_world_to_shape, const TPointsXY& points_xy,
+                            Eigen::VectorXd& dst_heights )
+    {
+        const ssize_t num_points = points_xy.rows();
+        dst_heights.resize( num_points );
+        const ssize_t num_width_samples = heights_unflipped.cols();
+        const ssize_t num_depth_samples = heights_unflipped.rows();
+        if ( num_points < 1 || num_width_samples < 2 || num_depth_samples < 2 )
+            return;
+
+        const Eigen::Vector3d scale = scale_f.cast<double>();
+        const Eigen::Matrix2d rot_xy_inv = tf_world_to_shape.linear().topLeftCorner<2, 2>().transpose();
+        const Eigen::Vector2d pos_xy = tf_world_to_shape.translation().head<2>();
+
+        // Continuous sample coordinates of all points (vectorized), clamped to the last cell. Rows go along -y
+        const Eigen::Matrix<double, 2, Eigen::Dynamic> points_local = rot_xy_inv * ( points_xy.transpose().colwise() - pos_xy );
+        const Eigen::ArrayXd u = ( points_local.row( 0 ).transpose().array() / scale.x() + 0.5 * ( num_width_samples - 1 ) )
+                                        .max( 0.0 ).min( num_width_samples - 1.0 );
+        const Eigen::ArrayXd v = ( 0.5 * ( num_depth_samples - 1 ) - points_local.row( 1 ).transpose().array() / scale.y() )
+                                        .max( 0.0 ).min( num_depth_samples - 1.0 );
+        const Eigen::ArrayXd u0 = u.floor().min( num_width_samples - 2.0 );
+        const Eigen::ArrayXd v0 = v.floor().min( num_depth_samples - 2.0 );
+
+        // Gather the corners of the cell of each point (the only non-vectorized part), then interpolate all at once
+        Eigen::ArrayXd h00( num_points ), h10( num_points ), h01( num_points ), h11( num_points );
+        for ( ssize_t i = 0; i < num_points; i++ )
+        {
+            const ssize_t x0 = u0[i];
+            const ssize_t y0 = v0[i];
+            h00[i] = heights_unflipped( y0, x0 );
+            h10[i] = heights_unflipped( y0, x0 + 1 );
+            h01[i] = heights_unflipped( y0 + 1, x0 );
+            h11[i] = heights_unflipped( y0 + 1, x0 + 1 );
+        }
+        const Eigen::ArrayXd fu = u - u0;
+        const Eigen::ArrayXd fv = v - v0;
+        dst_heights.array() = tf_world_to_shape.translation().z() +
+                              scale.z() * ( ( 1.0 - fv ) * ( ( 1.0 - fu ) * h00 + fu * h10 ) +
+                                            fv * ( ( 1.0 - fu ) * h01 + fu * h11 ) );
+    }
+
+    template< class ConfigSpace >
+    const double* _GetGenericJointPositionsData( const dart::dynamics::Joint* joint )
+    {
+        auto generic_joint = dynamic_cast<const dart::dynamics::GenericJoint<ConfigSpace>*>( joint );
+        return ( generic_joint ) ? generic_joint->getPositionsStatic().data() : nullptr;
+    }
+
+    template< class ConfigSpace >
+    const double* _GetGenericJointVelocitiesData( const dart::dynamics::Joint* joint )
+    {
+        auto generic_joint = dynamic_cast<const dart::dynamics::GenericJoint<ConfigSpace>*>( joint );
+        return ( generic_joint ) ? generic_joint->getVelocitiesStatic().data() : nullptr;
+    }
+
+    const double* GetJointPositionsData( const dart::dynamics::Joint* joint )
+    {
+        if ( joint->getNumDofs() < 1 )
+            return nullptr;
+        if ( auto data = _GetGenericJointPositionsData<dart::math::RealVectorSpace<1>>( joint ) )
+            return data;
+        if ( auto data = _GetGenericJointPositionsData<dart::math::RealVectorSpace<2>>( joint ) )
+            return data;
+        if ( auto data = _GetGenericJointPositionsData<dart::math::RealVectorSpace<3>>( joint ) )
+            return data;
+        if ( auto data = _GetGenericJointPositionsData<dart::math::SO3Space>( joint ) )
+            return data;
+        return _GetGenericJointPositionsData<dart::math::SE3Space>( joint );
+    }
+
+    const double* GetJointVelocitiesData( const dart::dynamics::Joint* joint )
+    {
+        if ( joint->getNumDofs() < 1 )
+            return nullptr;
+        if ( auto data = _GetGenericJointVelocitiesData<dart::math::RealVectorSpace<1>>( joint ) )
+            return data;
+        if ( auto data = _GetGenericJointVelocitiesData<dart::math::RealVectorSpace<2>>( joint ) )
+            return data;
+        if ( auto data = _GetGenericJointVelocitiesData<dart::math::RealVectorSpace<3>>( joint ) )
+            return data;
+        if ( auto data = _GetGenericJointVelocitiesData<dart::math::SO3Space>( joint ) )
+            return data;
+        return _GetGenericJointVelocitiesData<dart::math::SE3Space>( joint );
+    }
+
+    ssize_t GetJointNumQpos( const dart::dynamics::Joint* joint )
+    {
+        const auto& joint_type = joint->getType();
+        if ( joint_type == dart::dynamics::FreeJoint::getStaticType() )
+            return 7;
+        if ( joint_type == dart::dynamics::BallJoint::getStaticType() )
+            return 4;
+        return joint->getNumDofs();
+    }
+
+    ssize_t GetJointNumQvel( const dart::dynamics::Joint* joint )
+    {
+        return joint->getNumDofs();
+    }
+
+    // @note: conversions below only use fixed-size temporaries, so these don't allocate if the destination
+    //        buffers already have enough capacity (e.g. when reused every control step)
+
+    void GetJointQpos( const dart::dynamics::Joint* joint, std::vector<TScalar>& dst_qpos )
+    {
+        const auto& joint_type = joint->getType();
+        dst_qpos.resize( GetJointNumQpos( joint ) );
+        if ( joint_type == dart::dynamics::FreeJoint::getStaticType() )
+        {
+            // dart's free-joint: [rot(exp-coords), trans]
+            const Eigen::Vector3d exp_coords( joint->getPosition( 0 ), joint->getPosition( 1 ), joint->getPosition( 2 ) );
+            const Eigen::Quaterniond quat( dart::dynamics::BallJoint::convertToRotation( exp_coords ) );
+            dst_qpos[0] = joint->getPosition( 3 ); dst_qpos[1] = joint->getPosition( 4 ); dst_qpos[2] = joint->getPosition( 5 );
+            dst_qpos[3] = quat.w(); dst_qpos[4] = quat.x(); dst_qpos[5] = quat.y(); dst_qpos[6] = quat.z();
+        }
+        else if ( joint_type == dart::dynamics::BallJoint::getStaticType() )
+        {
+            const Eigen::Vector3d exp_coords( joint->getPosition( 0 ), joint->getPosition( 1 ), joint->getPosition( 2 ) );
+            const Eigen::Quaterniond quat( dart::dynamics::BallJoint::convertToRotation( exp_coords ) );
+            dst_qpos[0] = quat.w(); dst_qpos[1] = quat.x(); dst_qpos[2] = quat.y(); dst_qpos[3] = quat.z();
+        }
+        else
+        {
+            for ( size_t i = 0; i < joint->getNumDofs(); i++ )
+                dst_qpos[i] = joint->getPosition( i );
+        }
+    }
+
+    void GetJointQvel( const dart::dynamics::Joint* joint, std::vector<TScalar>& dst_qvel )
+    {
+        const ssize_t num_dofs = joint->getNumDofs();
+        dst_qvel.resize( num_dofs );
+        if ( joint->getType() == dart::dynamics::FreeJoint::getStaticType() )
+        {
+            // dart's free-joint: [angular, linear]
+            for ( size_t i = 0; i < 3; i++ )
+            {
+                dst_qvel[i] = joint->getVelocity( 3 + i );
+                dst_qvel[3 + i] = joint->getVelocity( i );
+            }
+        }
+        else
+        {
+            for ( ssize_t i = 0; i < num_dofs; i++ )
+                dst_qvel[i] = joint->getVelocity( i );
+        }
+    }
+
+    void SetJointQpos( dart::dynamics::Joint* joint, const std::vector<TScalar>& qpos )
+    {
+        if ( qpos.size() != GetJointNumQpos( joint ) )
+        {
+            LOCO_CORE_WARN( "SetJointQpos >>> joint {0} expects {1} qpos values, but got {2}",
+                            joint->getName(), GetJointNumQpos( joint ), qpos.size() );
+            return;
+        }
+
+        const auto& joint_type = joint->getType();
+        if ( joint_type == dart::dynamics::FreeJoint::getStaticType() )
+        {
+            const Eigen::Quaterniond quat( qpos[3], qpos[4], qpos[5], qpos[6] );
+            Eigen::Vector6d positions;
+            positions.head<3>() = dart::dynamics::BallJoint::convertToPositions( quat.normalized().toRotationMatrix() );
+            positions.tail<3>() = Eigen::Vector3d( qpos[0], qpos[1], qpos[2] );
+            static_cast<dart::dynamics::FreeJoint*>( joint )->setPositionsStatic( positions );
+        }
+        else if ( joint_type == dart::dynamics::BallJoint::getStaticType() )
+        {
+            const Eigen::Quaterniond quat( qpos[0], qpos[1], qpos[2], qpos[3] );
+            static_cast<dart::dynamics::BallJoint*>( joint )->setPositionsStatic(
+                    dart::dynamics::BallJoint::convertToPositions( quat.normalized().toRotationMatrix() ) );
+        }
+        else
+        {
+            for ( size_t i = 0; i < qpos.size(); i++ )
+                joint->setPosition( i, qpos[i] );
+        }
+    }
+
+    void SetJointQvel( dart::dynamics::Joint* joint, const std::vector<TScalar>& qvel )
+    {
+        if ( qvel.size() != GetJointNumQvel( joint ) )
+        {
+            LOCO_CORE_WARN( "SetJointQvel >>> joint {0} expects {1} qvel values, but got {2}",
+                            joint->getName(), GetJointNumQvel( joint ), qvel.size() );
+            return;
+        }
+
+        if ( joint->getType() == dart::dynamics::FreeJoint::getStaticType() )
+        {
+            Eigen::Vector6d velocities;
+            velocities << qvel[3], qvel[4], qvel[5], qvel[0], qvel[1], qvel[2];
+            static_cast<dart::dynamics::FreeJoint*>( joint )->setVelocitiesStatic( velocities );
+        }
+        else
+        {
+            for ( size_t i = 0; i < qvel.size(); i++ )
+                joint->setVelocity( i, qvel[i] );
+        }
+    }
+
     const aiScene* CreateAssimpSceneFromVertexData( const std::vector<float>& vertices, const std::vector<int>& faces )
     {
         if ( vertices.size() % 3 != 0 )
@@ -174,9 +434,11 @@ namespace dartsim {
         if ( faces.size() % 3 != 0 )
             LOCO_CORE_ERROR( "CreateAssimpSceneFromVertexData >>> there must be 3 elements per face" );
 
-        const ssize_t num_vertices = vertices.size() / 3;
-        const ssize_t num_faces = faces.size() / 3;
+        return CreateAssimpSceneFromVertexData( vertices.data(), vertices.size() / 3, faces.data(), faces.size() / 3 );
+    }
 
+    const aiScene* CreateAssimpSceneFromVertexData( const float* vertices, ssize_t num_vertices, const int* faces, ssize_t num_faces )
+    {
         auto assimp_scene = new aiScene();
         assimp_scene->mMaterials = new aiMaterial*[1];
         assimp_scene->mMaterials[0] = new aiMaterial();
@@ -214,6 +476,61 @@ namespace dartsim {
         return assimp_scene;
     }
 
+    void TDartSelfCollisionTable::Resize( ssize_t new_num_bodies )
+    {
+        num_bodies = new_num_bodies;
+        bits.assign( ( num_bodies * num_bodies + 63 ) / 64, 0 );
+    }
+
+    void TDartSelfCollisionTable::SetPair( ssize_t body_index_1, ssize_t body_index_2, bool collides )
+    {
+        const ssize_t bit_index_12 = body_index_1 * num_bodies + body_index_2;
+        const ssize_t bit_index_21 = body_index_2 * num_bodies + body_index_1;
+        for ( auto bit_index : { bit_index_12, bit_index_21 } )
+        {
+            if ( collides )
+                bits[bit_index >> 6] |= ( uint64_t( 1 ) << ( bit_index & 63 ) );
+            else
+                bits[bit_index >> 6] &= ~( uint64_t( 1 ) << ( bit_index & 63 ) );
+        }
+    }
+
+    TDartSelfCollisionTable CompileSelfCollisionTable( const dart::dynamics::Skeleton* skeleton,
+                                                       const eDartSelfCollisionPolicy& policy,
+                                                       const std::vector<std::pair<std::string, std::string>>& pairs )
+    {
+        TDartSelfCollisionTable table;
+        const ssize_t num_bodies = skeleton->getNumBodyNodes();
+        table.Resize( num_bodies );
+        if ( policy == eDartSelfCollisionPolicy::NON_ADJACENT )
+        {
+            for ( ssize_t i = 0; i < num_bodies; i++ )
+                for ( ssize_t j = i + 1; j < num_bodies; j++ )
+                    table.SetPair( i, j, true );
+
+            for ( ssize_t i = 0; i < num_bodies; i++ )
+                if ( auto parent_bodynode = skeleton->getBodyNode( i )->getParentBodyNode() )
+                    table.SetPair( i, parent_bodynode->getIndexInSkeleton(), false );
+        }
+        else if ( policy == eDartSelfCollisionPolicy::EXPLICIT_PAIRS )
+        {
+            for ( const auto& pair : pairs )
+            {
+                auto bodynode_1 = skeleton->getBodyNode( pair.first );
+                auto bodynode_2 = skeleton->getBodyNode( pair.second );
+                if ( !bodynode_1 || !bodynode_2 )
+                {
+                    LOCO_CORE_WARN( "CompileSelfCollisionTable >>> skeleton {0} doesn't have bodies for pair ({1},{2})",
+                                    skeleton->getName(), pair.first, pair.second );
+                    continue;
+                }
+                if ( bodynode_1 != bodynode_2 )
+                    table.SetPair( bodynode_1->getIndexInSkeleton(), bodynode_2->getIndexInSkeleton(), true );
+            }
+        }
+        return table;
+    }
+
     /***********************************************************************************************
     *                              Dart Bitmask Collision Filter Impl.                             *
     ***********************************************************************************************/
@@ -221,37 +538,469 @@ namespace dartsim {
     bool TDartBitmaskCollisionFilter::ignoresCollision( const dart::collision::CollisionObject* object_1,
                                                         const dart::collision::CollisionObject* object_2 ) const
     {
-        if ( dart::collision::BodyNodeCollisionFilter::ignoresCollision( object_1, object_2 ) )
+        // Shapes the filter doesn't know about collide as usual (dart's checks decide)
+        const ssize_t slot_1 = _GetSlot( object_1 );
+        const ssize_t slot_2 = _GetSlot( object_2 );
+        const auto& entry_1 = ( slot_1 >= 0 ) ? m_Entries[slot_1] : m_DefaultEntry;
+        const auto& entry_2 = ( slot_2 >= 0 ) ? m_Entries[slot_2] : m_DefaultEntry;
+
+        // Cheap bitmask rejection first, and only then the more expensive checks made by dart (same-body,
+        // self-collision, adjacency, blacklists) for the pairs that survive
+        if ( ( ( entry_1.group & entry_2.mask ) | ( entry_2.group & entry_1.mask ) ) == 0 )
             return true;
 
-        auto shape_node_1 = object_1->getShapeFrame()->asShapeNode();
-        auto shape_node_2 = object_2->getShapeFrame()->asShapeNode();
+        // Pairs within a skeleton with a self-collision table are decided by a single bit-test (and by the bodies'
+        // collidable flags and the blacklist, which the table can't override)
+        if ( ( entry_1.self_collision_table >= 0 ) && ( entry_1.self_collision_table == entry_2.self_collision_table ) )
+        {
+            auto bodynode_1 = object_1->getShapeFrame()->asShapeNode()->getBodyNodePtr();
+            auto bodynode_2 = object_2->getShapeFrame()->asShapeNode()->getBodyNodePtr();
+            if ( !bodynode_1->isCollidable() || !bodynode_2->isCollidable() )
+                return true;
+            if ( !m_SelfCollisionTables[entry_1.self_collision_table].collides( entry_1.body_index, entry_2.body_index ) )
+                return true;
+            return !m_BlackList.empty() && _IsBlackListed( entry_1, entry_2 );
+        }
+
+        return dart::collision::BodyNodeCollisionFilter::ignoresCollision( object_1, object_2 );
+    }
+
+    void TDartBitmaskCollisionFilter::setCollisionGroup( const dart::dynamics::ShapeNode* shape_node, int collision_group )
+    {
+        setCollisionGroup( _GetOrCreateSlot( shape_node ), collision_group );
+    }
+
+    void TDartBitmaskCollisionFilter::setCollisionMask( const dart::dynamics::ShapeNode* shape_node, int collision_mask )
+    {
+        setCollisionMask( _GetOrCreateSlot( shape_node ), collision_mask );
+    }
 
-        if ( m_CollisionGroupsMap.find( shape_node_1 ) == m_CollisionGroupsMap.end() ||
-             m_CollisionGroupsMap.find( shape_node_2 ) == m_CollisionGroupsMap.end() ||
-             m_CollisionMasksMap.find( shape_node_1 ) == m_CollisionMasksMap.end() ||
-             m_CollisionMasksMap.find( shape_node_2 ) == m_CollisionMasksMap.end() )
+    ssize_t TDartBitmaskCollisionFilter::registerShapeNode( const dart::dynamics::ShapeNode* shape_node, int collision_group, int collision_mask )
+    {
+        const ssize_t slot = _GetOrCreateSlot( shape_node );
+        _UpdateClass( m_Entries[slot], collision_group, collision_mask );
+        _MarkForRefresh( slot );
+        return slot;
+    }
+
+    void TDartBitmaskCollisionFilter::unregisterShapeNode( ssize_t slot )
+    {
+        if ( slot < 0 || slot >= m_Entries.size() || !m_Entries[slot].shape_frame )
+            return;
+
+        auto& entry = m_Entries[slot];
+        if ( entry.registered )
+            _RemoveFromClass( entry );
+        m_SlotsMap.erase( entry.shape_frame );
+        // Bullet objects that cached this slot fail validation against the empty entry (and are gone with the shape
+        // anyways), and a refresh still pending for the slot is skipped as there's no bullet object to refresh
+        entry = TDartCollisionFilterEntry();
+        m_FreeSlots.push_back( slot );
+    }
+
+    void TDartBitmaskCollisionFilter::setCollisionGroup( ssize_t slot, int collision_group )
+    {
+        _UpdateClass( m_Entries[slot], collision_group, m_Entries[slot].mask );
+        _MarkForRefresh( slot );
+    }
+
+    void TDartBitmaskCollisionFilter::setCollisionMask( ssize_t slot, int collision_mask )
+    {
+        _UpdateClass( m_Entries[slot], m_Entries[slot].group, collision_mask );
+        _MarkForRefresh( slot );
+    }
+
+    void TDartBitmaskCollisionFilter::setSelfCollisionTable( const dart::dynamics::Skeleton* skeleton,
+                                                            const TDartSelfCollisionTable& table )
+    {
+        LOCO_CORE_ASSERT( table.num_bodies == skeleton->getNumBodyNodes(), "TDartBitmaskCollisionFilter::setSelfCollisionTable >>> \
+                          table of skeleton {0} expected to have {1} bodies, but got {2}", skeleton->getName(),
+                          skeleton->getNumBodyNodes(), table.num_bodies );
+
+        auto it_table = m_SelfCollisionTablesMap.find( skeleton );
+        if ( it_table != m_SelfCollisionTablesMap.end() )
+        {
+            m_SelfCollisionTables[it_table->second] = table;
+        }
+        else
+        {
+            m_SelfCollisionTablesMap[skeleton] = m_SelfCollisionTables.size();
+            m_SelfCollisionTables.push_back( table );
+        }
+
+        // Every shape of the skeleton gets a slot, linked to the table (entries created later are linked on creation).
+        // Proxies of existing ones are refreshed, as pairs rejected with the previous table never reached the pair-cache
+        for ( size_t i = 0; i < skeleton->getNumShapeNodes(); i++ )
+        {
+            const ssize_t slot = _GetOrCreateSlot( skeleton->getShapeNode( i ) );
+            _ResolveSelfCollisionTable( m_Entries[slot] );
+            _MarkForRefresh( slot );
+        }
+    }
+
+    void TDartBitmaskCollisionFilter::addBodyNodePairToBlackList( const dart::dynamics::BodyNode* bodynode_1,
+                                                                  const dart::dynamics::BodyNode* bodynode_2 )
+    {
+        dart::collision::BodyNodeCollisionFilter::addBodyNodePairToBlackList( bodynode_1, bodynode_2 );
+        m_BlackList.insert( std::minmax( bodynode_1, bodynode_2 ) );
+    }
+
+    void TDartBitmaskCollisionFilter::removeBodyNodePairFromBlackList( const dart::dynamics::BodyNode* bodynode_1,
+                                                                       const dart::dynamics::BodyNode* bodynode_2 )
+    {
+        dart::collision::BodyNodeCollisionFilter::removeBodyNodePairFromBlackList( bodynode_1, bodynode_2 );
+        m_BlackList.erase( std::minmax( bodynode_1, bodynode_2 ) );
+    }
+
+    void TDartBitmaskCollisionFilter::removeAllBodyNodePairsFromBlackList()
+    {
+        dart::collision::BodyNodeCollisionFilter::removeAllBodyNodePairsFromBlackList();
+        m_BlackList.clear();
+    }
+
+    bool TDartBitmaskCollisionFilter::_IsBlackListed( const TDartCollisionFilterEntry& entry_1,
+                                                      const TDartCollisionFilterEntry& entry_2 ) const
+    {
+        auto shape_node_1 = entry_1.shape_frame->asShapeNode();
+        auto shape_node_2 = entry_2.shape_frame->asShapeNode();
+        if ( !shape_node_1 || !shape_node_2 )
             return false;
+        const dart::dynamics::BodyNode* bodynode_1 = shape_node_1->getBodyNodePtr().get();
+        const dart::dynamics::BodyNode* bodynode_2 = shape_node_2->getBodyNodePtr().get();
+        return m_BlackList.find( std::minmax( bodynode_1, bodynode_2 ) ) != m_BlackList.end();
+    }
 
-        auto shape_1_colgroup = m_CollisionGroupsMap.at( shape_node_1 );
-        auto shape_2_colgroup = m_CollisionGroupsMap.at( shape_node_2 );
-        auto shape_1_colmask = m_CollisionMasksMap.at( shape_node_1 );
-        auto shape_2_colmask = m_CollisionMasksMap.at( shape_node_2 );
+    void TDartBitmaskCollisionFilter::_ResolveSelfCollisionTable( TDartCollisionFilterEntry& entry ) const
+    {
+        auto shape_node = entry.shape_frame->asShapeNode();
+        if ( !shape_node )
+            return;
 
-        bool col_affinity_1_2 = ( shape_1_colgroup & shape_2_colmask ) != 0;
-        bool col_affinity_2_1 = ( shape_2_colgroup & shape_1_colmask ) != 0;
+        auto bodynode = shape_node->getBodyNodePtr();
+        auto it_table = m_SelfCollisionTablesMap.find( bodynode->getSkeleton().get() );
+        if ( it_table == m_SelfCollisionTablesMap.end() )
+            return;
 
-        return !(col_affinity_1_2 || col_affinity_2_1);
+        entry.self_collision_table = it_table->second;
+        entry.body_index = bodynode->getIndexInSkeleton();
     }
 
-    void TDartBitmaskCollisionFilter::setCollisionGroup( const dart::dynamics::ShapeNode* shape_node, int collision_group )
+    void TDartBitmaskCollisionFilter::refreshBroadphase( btCollisionWorld* bullet_world )
     {
-        m_CollisionGroupsMap[shape_node] = collision_group;
+        if ( m_ClassesChanged )
+        {
+            m_ClassesChanged = false;
+            const bool broadphase_filtering = _CheckBroadphaseFiltering();
+            if ( broadphase_filtering != m_BroadphaseFiltering )
+            {
+                // Switching modes requires every proxy to be stamped again (or restored to bullet's defaults)
+                m_BroadphaseFiltering = broadphase_filtering;
+                _RefreshAllProxies( bullet_world );
+                return;
+            }
+        }
+
+        if ( !m_PendingRegistrationSlots.empty() )
+            _ResolveRegisteredObjects( bullet_world );
+
+        for ( auto slot : m_PendingRefreshSlots )
+        {
+            auto& entry = m_Entries[slot];
+            if ( entry.bullet_object && entry.bullet_object->getBroadphaseHandle() )
+            {
+                _StampProxy( entry );
+                bullet_world->refreshBroadphaseProxy( entry.bullet_object );
+            }
+            entry.pending_refresh = false;
+        }
+        m_PendingRefreshSlots.clear();
     }
 
-    void TDartBitmaskCollisionFilter::setCollisionMask( const dart::dynamics::ShapeNode* shape_node, int collision_mask )
+    void TDartBitmaskCollisionFilter::_ResolveRegisteredObjects( btCollisionWorld* bullet_world )
     {
-        m_CollisionMasksMap[shape_node] = collision_mask;
+        // Slots with no bullet object yet are the ones just created (or whose skeleton isn't in the world). Objects
+        // are appended to the bullet world when added, so the new ones are usually found right at the back of its
+        // objects-array. Slots of shapes not in the world stay pending, and are looked for again once new slots are
+        // created or the number of objects in the world changes
+        auto& bullet_objects = bullet_world->getCollisionObjectArray();
+        if ( !m_NewRegistrations && ( bullet_objects.size() == m_LastNumBulletObjects ) )
+            return;
+        m_NewRegistrations = false;
+        m_LastNumBulletObjects = bullet_objects.size();
+
+        ssize_t num_unresolved = 0;
+        for ( auto slot : m_PendingRegistrationSlots )
+            if ( m_Entries[slot].shape_frame && !m_Entries[slot].bullet_object )
+                num_unresolved++;
+
+        for ( int i = bullet_objects.size() - 1; ( i >= 0 ) && ( num_unresolved > 0 ); i-- )
+        {
+            auto bullet_object = bullet_objects[i];
+            auto dart_object = static_cast<dart::collision::CollisionObject*>( bullet_object->getUserPointer() );
+            if ( !dart_object || !bullet_object->getBroadphaseHandle() )
+                continue;
+
+            auto it_slot = m_SlotsMap.find( dart_object->getShapeFrame() );
+            if ( it_slot == m_SlotsMap.end() || m_Entries[it_slot->second].bullet_object )
+                continue;
+
+            // Proxies of new objects are stamped as any other updated object, right below (see ->refreshBroadphase)
+            _ResolveObject( it_slot->second, bullet_object );
+            _MarkForRefresh( it_slot->second );
+            num_unresolved--;
+        }
+
+        m_PendingRegistrationSlots.erase( std::remove_if( m_PendingRegistrationSlots.begin(), m_PendingRegistrationSlots.end(),
+                                                          [this]( ssize_t slot )
+                                                            { return !m_Entries[slot].shape_frame || m_Entries[slot].bullet_object; } ),
+                                          m_PendingRegistrationSlots.end() );
     }
 
-}}
\ No newline at end of file
+    void TDartBitmaskCollisionFilter::_RefreshAllProxies( btCollisionWorld* bullet_world )
+    {
+        // Go through the objects in the world (instead of the entries), as these are the only ones known to be alive
+        auto& bullet_objects = bullet_world->getCollisionObjectArray();
+        for ( int i = 0; i < bullet_objects.size(); i++ )
+        {
+            auto bullet_object = bullet_objects[i];
+            auto dart_object = static_cast<dart::collision::CollisionObject*>( bullet_object->getUserPointer() );
+            if ( !dart_object || !bullet_object->getBroadphaseHandle() )
+                continue;
+
+            auto it_slot = m_SlotsMap.find( dart_object->getShapeFrame() );
+            if ( it_slot == m_SlotsMap.end() )
+                continue;
+            _ResolveObject( it_slot->second, bullet_object );
+            _StampProxy( m_Entries[it_slot->second] );
+            bullet_world->refreshBroadphaseProxy( bullet_object );
+        }
+
+        for ( auto slot : m_PendingRefreshSlots )
+            m_Entries[slot].pending_refresh = false;
+        m_PendingRefreshSlots.clear();
+        m_PendingRegistrationSlots.clear();
+        m_NewRegistrations = false;
+        m_LastNumBulletObjects = bullet_objects.size();
+    }
+
+    void TDartBitmaskCollisionFilter::_ResolveObject( ssize_t slot, btCollisionObject* bullet_object )
+    {
+        // Dart doesn't use the user-index of the bullet objects (only their user-pointer), so keep the slot there
+        bullet_object->setUserIndex( slot );
+        m_Entries[slot].bullet_object = bullet_object;
+    }
+
+    void TDartBitmaskCollisionFilter::_StampProxy( const TDartCollisionFilterEntry& entry ) const
+    {
+        // Shift group|mask by one bit, and keep bit-0 of the mask set, so proxies with bullet's defaults (group 1,
+        // mask all) still pass the test against stamped ones, and leave the decision to this filter
+        using TProxyFilter = decltype( btBroadphaseProxy::m_collisionFilterGroup );
+        auto proxy = entry.bullet_object->getBroadphaseHandle();
+        if ( m_BroadphaseFiltering && entry.registered )
+        {
+            proxy->m_collisionFilterGroup = static_cast<TProxyFilter>( static_cast<uint32_t>( entry.group ) << 1 );
+            proxy->m_collisionFilterMask = static_cast<TProxyFilter>( ( static_cast<uint32_t>( entry.mask ) << 1 ) | 1u );
+        }
+        else
+        {
+            proxy->m_collisionFilterGroup = btBroadphaseProxy::DefaultFilter;
+            proxy->m_collisionFilterMask = btBroadphaseProxy::AllFilter;
+        }
+    }
+
+    bool TDartBitmaskCollisionFilter::_CheckBroadphaseFiltering() const
+    {
+        // Older bullet versions use shorts for the proxy's filter bits. Keep one bit for the shift and one for the sign
+        const ssize_t num_proxy_bits = 8 * sizeof( btBroadphaseProxy::m_collisionFilterGroup );
+        for ( const auto& class_1 : m_ClassesCount )
+        {
+            const int group_1 = class_1.first.first;
+            const int mask_1 = class_1.first.second;
+            if ( ( group_1 <= 0 ) || ( ( static_cast<uint32_t>( group_1 ) >> ( num_proxy_bits - 2 ) ) != 0 ) )
+                return false;
+
+            for ( const auto& class_2 : m_ClassesCount )
+            {
+                const int group_2 = class_2.first.first;
+                const int mask_2 = class_2.first.second;
+                if ( ( ( group_1 & mask_2 ) != 0 ) != ( ( group_2 & mask_1 ) != 0 ) )
+                    return false;
+            }
+        }
+        return m_ClassesCount.size() > 0;
+    }
+
+    void TDartBitmaskCollisionFilter::_UpdateClass( TDartCollisionFilterEntry& entry, int collision_group, int collision_mask )
+    {
+        const auto new_class = std::make_pair( collision_group, collision_mask );
+        if ( entry.registered )
+        {
+            if ( std::make_pair( entry.group, entry.mask ) == new_class )
+                return;
+            _RemoveFromClass( entry );
+        }
+
+        if ( ++m_ClassesCount[new_class] == 1 )
+            m_ClassesChanged = true;
+
+        entry.group = collision_group;
+        entry.mask = collision_mask;
+        entry.registered = true;
+    }
+
+    void TDartBitmaskCollisionFilter::_RemoveFromClass( const TDartCollisionFilterEntry& entry )
+    {
+        auto it_class = m_ClassesCount.find( std::make_pair( entry.group, entry.mask ) );
+        if ( it_class == m_ClassesCount.end() )
+            return;
+        if ( --it_class->second == 0 )
+        {
+            m_ClassesCount.erase( it_class );
+            m_ClassesChanged = true;
+        }
+    }
+
+    void TDartBitmaskCollisionFilter::_MarkForRefresh( ssize_t slot )
+    {
+        // Objects not seen yet by the collision-detector will be tested against the new group|mask anyways
+        auto& entry = m_Entries[slot];
+        if ( !entry.bullet_object || entry.pending_refresh )
+            return;
+        entry.pending_refresh = true;
+        m_PendingRefreshSlots.push_back( slot );
+    }
+
+    ssize_t TDartBitmaskCollisionFilter::_GetSlot( const dart::collision::CollisionObject* object ) const
+    {
+        // Read-only, as dart might query the filter from several threads. Slots of objects already resolved are
+        // cached in their bullet user-index (validated against the entry, as slots get reused)
+        const btCollisionObject* bullet_object = const_cast<dart::collision::BulletCollisionObject*>(
+                                    static_cast<const dart::collision::BulletCollisionObject*>( object ) )->getBulletCollisionObject();
+        const ssize_t cached_slot = bullet_object->getUserIndex();
+        const auto shape_frame = object->getShapeFrame();
+        if ( ( cached_slot >= 0 ) && ( cached_slot < m_Entries.size() ) && ( m_Entries[cached_slot].shape_frame == shape_frame ) )
+            return cached_slot;
+
+        auto it_slot = m_SlotsMap.find( shape_frame );
+        return ( it_slot != m_SlotsMap.end() ) ? it_slot->second : -1;
+    }
+
+    ssize_t TDartBitmaskCollisionFilter::_GetOrCreateSlot( const dart::dynamics::ShapeFrame* shape_frame )
+    {
+        auto it_slot = m_SlotsMap.find( shape_frame );
+        if ( it_slot != m_SlotsMap.end() )
+            return it_slot->second;
+
+        TDartCollisionFilterEntry entry;
+        entry.shape_frame = shape_frame;
+        _ResolveSelfCollisionTable( entry );
+        ssize_t slot = -1;
+        if ( m_FreeSlots.size() > 0 )
+        {
+            slot = m_FreeSlots.back();
+            m_FreeSlots.pop_back();
+            m_Entries[slot] = entry;
+        }
+        else
+        {
+            slot = m_Entries.size();
+            m_Entries.push_back( entry );
+        }
+        m_SlotsMap[shape_frame] = slot;
+        // The bullet object of this shape is looked for on the next refresh
+        m_PendingRegistrationSlots.push_back( slot );
+        m_NewRegistrations = true;
+        return slot;
+    }
+
+    /***********************************************************************************************
+    *                                   Dart Thread Pool Impl.                                     *
+    ***********************************************************************************************/
+
+    TDartThreadPool::TDartThreadPool( ssize_t num_workers )
+    {
+        if ( num_workers < 0 )
+            num_workers = std::max( ssize_t( std::thread::hardware_concurrency() ) - 1, ssize_t( 0 ) );
+
+        m_JobNextItem = 0;
+        for ( ssize_t i = 0; i < num_workers; i++ )
+            m_Workers.emplace_back( &TDartThreadPool::_WorkerLoop, this, i );
+    }
+
+    TDartThreadPool::~TDartThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock( m_StateMutex );
+            m_Stop = true;
+        }
+        m_WorkCondition.notify_all();
+        for ( auto& worker : m_Workers )
+            worker.join();
+        m_Workers.clear();
+    }
+
+    void TDartThreadPool::ParallelFor( ssize_t num_items, ssize_t min_chunk_size, const TChunkFcn& fcn )
+    {
+        if ( num_items < 1 )
+            return;
+
+        const ssize_t num_workers = m_Workers.size();
+        min_chunk_size = std::max( min_chunk_size, ssize_t( 1 ) );
+        if ( ( num_workers < 1 ) || ( num_items <= min_chunk_size ) )
+        {
+            fcn( 0, num_items, num_workers );
+            return;
+        }
+
+        std::lock_guard<std::mutex> job_lock( m_JobMutex );
+        {
+            // A few chunks per thread, so threads that finish early can take over part of the remaining work
+            std::lock_guard<std::mutex> lock( m_StateMutex );
+            m_JobFcn = &fcn;
+            m_JobNumItems = num_items;
+            m_JobChunkSize = std::max( min_chunk_size, num_items / ( 4 * ( num_workers + 1 ) ) );
+            m_JobNextItem = 0;
+            m_JobPendingWorkers = num_workers;
+            m_JobGeneration++;
+        }
+        m_WorkCondition.notify_all();
+
+        _RunChunks( num_workers );
+
+        std::unique_lock<std::mutex> lock( m_StateMutex );
+        m_DoneCondition.wait( lock, [this] { return m_JobPendingWorkers == 0; } );
+        m_JobFcn = nullptr;
+    }
+
+    void TDartThreadPool::_WorkerLoop( ssize_t worker_index )
+    {
+        uint64_t last_generation = 0;
+        while ( true )
+        {
+            {
+                std::unique_lock<std::mutex> lock( m_StateMutex );
+                m_WorkCondition.wait( lock, [&] { return m_Stop || ( m_JobGeneration != last_generation ); } );
+                if ( m_Stop )
+                    return;
+                last_generation = m_JobGeneration;
+            }
+
+            _RunChunks( worker_index );
+
+            std::lock_guard<std::mutex> lock( m_StateMutex );
+            if ( --m_JobPendingWorkers == 0 )
+                m_DoneCondition.notify_one();
+        }
+    }
+
+    void TDartThreadPool::_RunChunks( ssize_t thread_index )
+    {
+        while ( true )
+        {
+            const ssize_t begin = m_JobNextItem.fetch_add( m_JobChunkSize );
+            if ( begin >= m_JobNumItems )
+                return;
+            ( *m_JobFcn )( begin, std::min( begin + m_JobChunkSize, m_JobNumItems ), thread_index );
+        }
+    }
+}}
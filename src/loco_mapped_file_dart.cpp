@@ -0,0 +1,219 @@
+
+#include <loco_mapped_file_dart.h>
+
+#include <cstring>
+#include <fstream>
+
+#if !defined( _WIN32 )
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace loco {
+namespace dartsim {
+
+    /***********************************************************************************************
+    *                                     Mapped File Writer                                       *
+    ***********************************************************************************************/
+
+#if defined( _WIN32 )
+
+    TDartMappedFileWriter::TDartMappedFileWriter( const std::string& filepath, size_t chunk_size )
+        : m_ChunkSize( chunk_size )
+    {
+        m_File = std::fopen( filepath.c_str(), "wb" );
+        if ( !m_File )
+            LOCO_CORE_ERROR( "TDartMappedFileWriter >>> couldn't open file {0} for writing", filepath );
+        m_Valid = ( m_File != nullptr );
+    }
+
+    TDartMappedFileWriter::~TDartMappedFileWriter()
+    {
+        Close();
+    }
+
+    bool TDartMappedFileWriter::Write( const void* data, size_t num_bytes )
+    {
+        if ( !m_Valid )
+            return false;
+        m_Valid = ( std::fwrite( data, 1, num_bytes, m_File ) == num_bytes );
+        m_Size += num_bytes;
+        return m_Valid;
+    }
+
+    void TDartMappedFileWriter::Close()
+    {
+        if ( m_File )
+            std::fclose( m_File );
+        m_File = nullptr;
+        m_Valid = false;
+    }
+
+    bool TDartMappedFileWriter::_MapChunk( size_t chunk_index )
+    {
+        return m_Valid;
+    }
+
+#else
+
+    TDartMappedFileWriter::TDartMappedFileWriter( const std::string& filepath, size_t chunk_size )
+    {
+        // Chunks are mapped at multiples of their size, so these must be page-aligned
+        const size_t page_size = sysconf( _SC_PAGESIZE );
+        m_ChunkSize = std::max<size_t>( ( ( chunk_size + page_size - 1 ) / page_size ) * page_size, page_size );
+
+        m_Fd = open( filepath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+        if ( m_Fd < 0 )
+        {
+            LOCO_CORE_ERROR( "TDartMappedFileWriter >>> couldn't open file {0} for writing: {1}", filepath, std::strerror( errno ) );
+            return;
+        }
+        m_Valid = _MapChunk( 0 );
+    }
+
+    TDartMappedFileWriter::~TDartMappedFileWriter()
+    {
+        Close();
+    }
+
+    bool TDartMappedFileWriter::Write( const void* data, size_t num_bytes )
+    {
+        if ( !m_Valid )
+            return false;
+
+        const uint8_t* src_bytes = static_cast<const uint8_t*>( data );
+        while ( num_bytes > 0 )
+        {
+            size_t chunk_offset = m_Size - m_ChunkIndex * m_ChunkSize;
+            if ( chunk_offset == m_ChunkSize )
+            {
+                if ( !_MapChunk( m_ChunkIndex + 1 ) )
+                {
+                    m_Valid = false;
+                    return false;
+                }
+                chunk_offset = 0;
+            }
+            const size_t num_bytes_chunk = std::min( num_bytes, m_ChunkSize - chunk_offset );
+            std::memcpy( m_Chunk + chunk_offset, src_bytes, num_bytes_chunk );
+            src_bytes += num_bytes_chunk;
+            num_bytes -= num_bytes_chunk;
+            m_Size += num_bytes_chunk;
+        }
+        return true;
+    }
+
+    void TDartMappedFileWriter::Close()
+    {
+        if ( m_Fd < 0 )
+            return;
+
+        if ( m_Chunk )
+            munmap( m_Chunk, m_ChunkSize );
+        m_Chunk = nullptr;
+        if ( ftruncate( m_Fd, m_Size ) != 0 )
+            LOCO_CORE_WARN( "TDartMappedFileWriter::Close >>> couldn't trim file to {0} bytes: {1}", m_Size, std::strerror( errno ) );
+        close( m_Fd );
+        m_Fd = -1;
+        m_Valid = false;
+    }
+
+    bool TDartMappedFileWriter::_MapChunk( size_t chunk_index )
+    {
+        // Full chunks are unmapped right away, so their pages can be written back and evicted by the kernel
+        if ( m_Chunk )
+            munmap( m_Chunk, m_ChunkSize );
+        m_Chunk = nullptr;
+
+        if ( ftruncate( m_Fd, ( chunk_index + 1 ) * m_ChunkSize ) != 0 )
+        {
+            LOCO_CORE_ERROR( "TDartMappedFileWriter::_MapChunk >>> couldn't grow file: {0}", std::strerror( errno ) );
+            return false;
+        }
+        void* address = mmap( nullptr, m_ChunkSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_Fd, chunk_index * m_ChunkSize );
+        if ( address == MAP_FAILED )
+        {
+            LOCO_CORE_ERROR( "TDartMappedFileWriter::_MapChunk >>> couldn't map chunk {0}: {1}", chunk_index, std::strerror( errno ) );
+            return false;
+        }
+        m_Chunk = static_cast<uint8_t*>( address );
+        m_ChunkIndex = chunk_index;
+        return true;
+    }
+
+#endif
+
+    /***********************************************************************************************
+    *                                     Mapped File Reader                                       *
+    ***********************************************************************************************/
+
+#if defined( _WIN32 )
+
+    TDartMappedFileReader::TDartMappedFileReader( const std::string& filepath, bool writable )
+        : m_Filepath( filepath )
+    {
+        std::ifstream file( filepath, std::ios::binary );
+        if ( !file.is_open() )
+            return;
+        m_Buffer.assign( std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() );
+        m_Data = m_Buffer.data();
+        m_Size = m_Buffer.size();
+        m_Writable = writable;
+    }
+
+    TDartMappedFileReader::~TDartMappedFileReader()
+    {
+        if ( m_Data && m_Writable )
+        {
+            std::ofstream file( m_Filepath, std::ios::binary | std::ios::trunc );
+            file.write( reinterpret_cast<const char*>( m_Buffer.data() ), m_Buffer.size() );
+            if ( !file.good() )
+                LOCO_CORE_ERROR( "TDartMappedFileReader >>> couldn't write back file {0}", m_Filepath );
+        }
+        m_Data = nullptr;
+        m_Size = 0;
+    }
+
+#else
+
+    TDartMappedFileReader::TDartMappedFileReader( const std::string& filepath, bool writable )
+    {
+        const int fd = open( filepath.c_str(), writable ? O_RDWR : O_RDONLY );
+        if ( fd < 0 )
+            return;
+
+        struct stat file_stat;
+        if ( fstat( fd, &file_stat ) == 0 && file_stat.st_size > 0 )
+        {
+            // The mapping stays valid after closing the file (and even if the file gets replaced)
+            void* address = writable ? mmap( nullptr, file_stat.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 )
+                                     : mmap( nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+            if ( address != MAP_FAILED )
+            {
+                m_Data = static_cast<const uint8_t*>( address );
+                m_Size = file_stat.st_size;
+                m_Writable = writable;
+            }
+            else
+            {
+                LOCO_CORE_ERROR( "TDartMappedFileReader >>> couldn't map file {0}: {1}", filepath, std::strerror( errno ) );
+            }
+        }
+        close( fd );
+    }
+
+    TDartMappedFileReader::~TDartMappedFileReader()
+    {
+        if ( m_Data && m_Writable )
+            msync( const_cast<uint8_t*>( m_Data ), m_Size, MS_SYNC );
+        if ( m_Data )
+            munmap( const_cast<uint8_t*>( m_Data ), m_Size );
+        m_Data = nullptr;
+        m_Size = 0;
+    }
+
+#endif
+}}
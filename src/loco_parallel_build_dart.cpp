@@ -0,0 +1,116 @@
+
+#include <loco_parallel_build_dart.h>
+
+namespace loco {
+namespace dartsim {
+
+    TDartParallelBuilder::TDartParallelBuilder( TDartThreadPool* thread_pool_ref )
+        : m_ThreadPoolRef( thread_pool_ref )
+    {
+        LOCO_CORE_ASSERT( thread_pool_ref, "TDartParallelBuilder >>> expected non-null thread-pool reference" );
+    }
+
+    void TDartParallelBuilder::AddBody( const std::string& name,
+                                        const TInertialData* inertia_data,
+                                        const std::vector<const TCollisionData*>& colliders_data,
+                                        bool compute_inertia )
+    {
+        LOCO_CORE_ASSERT( !m_Built, "TDartParallelBuilder::AddBody >>> body {0} registered after ->Build", name );
+
+        TBodyEntry body_entry;
+        body_entry.name = name;
+        body_entry.inertia_data = inertia_data;
+        body_entry.colliders_data = colliders_data;
+        body_entry.compute_inertia = compute_inertia;
+        m_Bodies.push_back( std::move( body_entry ) );
+    }
+
+    void TDartParallelBuilder::Build()
+    {
+        if ( m_Built )
+            return;
+        m_Built = true;
+
+        // Decoding meshes is the expensive part of creating shapes, and doesn't touch any dart resource, so these are
+        // decoded on the thread-pool first (each mesh writes into its own slot, the scene-cache serializes its own
+        // accesses). Children of compound shapes are gathered as well, as these might be meshes too
+        std::vector<const TShapeData*> meshes_data;
+        std::function<void( const TShapeData* )> fnGatherMeshes = [&]( const TShapeData* data )
+            {
+                if ( ( data->type == eShapeType::CONVEX_MESH ) || ( data->type == eShapeType::TRIANGULAR_MESH ) )
+                    meshes_data.push_back( data );
+                for ( const auto& child_data : data->children )
+                    fnGatherMeshes( &child_data );
+            };
+        for ( const auto& body_entry : m_Bodies )
+            for ( auto collider_data : body_entry.colliders_data )
+                fnGatherMeshes( collider_data );
+
+        std::vector<const aiScene*> meshes( meshes_data.size(), nullptr );
+        m_ThreadPoolRef->ParallelFor( meshes_data.size(), 1,
+            [&]( ssize_t begin, ssize_t end, ssize_t thread_index )
+            {
+                for ( ssize_t i = begin; i < end; i++ )
+                    meshes[i] = LoadCollisionMesh( *meshes_data[i], m_SceneCacheRef );
+            } );
+        TDartLoadedMeshes loaded_meshes;
+        for ( size_t i = 0; i < meshes_data.size(); i++ )
+            loaded_meshes[meshes_data[i]] = meshes[i];
+
+        // Dart shapes take their ids from a shared (non-atomic) counter on construction, so are created serially
+        for ( auto& body_entry : m_Bodies )
+        {
+            body_entry.shapes.clear();
+            for ( auto collider_data : body_entry.colliders_data )
+                body_entry.shapes.push_back( CreateCollisionShape( *collider_data, m_SceneCacheRef, &loaded_meshes ) );
+        }
+
+        // Inertias only read the shapes of their own body, so these are computed on the thread-pool again
+        m_ThreadPoolRef->ParallelFor( m_Bodies.size(), 1,
+            [this]( ssize_t begin, ssize_t end, ssize_t thread_index )
+            {
+                for ( ssize_t i = begin; i < end; i++ )
+                {
+                    auto& body_entry = m_Bodies[i];
+                    if ( !body_entry.compute_inertia )
+                        continue;
+                    const bool has_colliders = ( body_entry.colliders_data.size() > 0 ) && body_entry.shapes[0];
+                    body_entry.inertia = ComputeBodyInertia( body_entry.name, *body_entry.inertia_data,
+                                                             has_colliders ? body_entry.colliders_data[0] : nullptr,
+                                                             has_colliders ? body_entry.shapes[0] : nullptr,
+                                                             m_SceneCacheRef );
+                }
+            } );
+
+        for ( ssize_t i = 0; i < (ssize_t)m_Bodies.size(); i++ )
+        {
+            const auto& body_entry = m_Bodies[i];
+            for ( size_t j = 0; j < body_entry.colliders_data.size(); j++ )
+                m_Shapes[body_entry.colliders_data[j]] = body_entry.shapes[j];
+            if ( body_entry.compute_inertia )
+                m_InertiaIndices[body_entry.inertia_data] = i;
+        }
+    }
+
+    void TDartParallelBuilder::Release()
+    {
+        m_Bodies.clear();
+        m_Shapes.clear();
+        m_InertiaIndices.clear();
+    }
+
+    dart::dynamics::ShapePtr TDartParallelBuilder::GetShape( const TShapeData* data ) const
+    {
+        auto it_shape = m_Shapes.find( data );
+        return ( it_shape != m_Shapes.end() ) ? it_shape->second : nullptr;
+    }
+
+    bool TDartParallelBuilder::GetInertia( const TInertialData* inertia_data, dart::dynamics::Inertia& dst_inertia ) const
+    {
+        auto it_index = m_InertiaIndices.find( inertia_data );
+        if ( it_index == m_InertiaIndices.end() )
+            return false;
+        dst_inertia = m_Bodies[it_index->second].inertia;
+        return true;
+    }
+}}
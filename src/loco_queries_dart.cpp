@@ -0,0 +1,325 @@
+
+#include <loco_queries_dart.h>
+
+namespace loco {
+namespace dartsim {
+
+    // Minimum number of rays|distance-queries handled by each chunk of work
+    const ssize_t LOCO_DART_RAYS_MIN_CHUNK_SIZE = 64;
+    const ssize_t LOCO_DART_DISTANCES_MIN_CHUNK_SIZE = 4;
+
+    void TDartRayBatch::Resize( ssize_t num_rays )
+    {
+        origins.resize( num_rays, Eigen::NoChange );
+        directions.resize( num_rays, Eigen::NoChange );
+        distances.resize( num_rays );
+        normals.resize( num_rays, Eigen::NoChange );
+        collider_ids.resize( num_rays );
+    }
+
+    void TDartDistanceResults::Resize( ssize_t num_queries )
+    {
+        distances.resize( num_queries );
+        points_a.resize( num_queries, Eigen::NoChange );
+        points_b.resize( num_queries, Eigen::NoChange );
+        collider_ids_b.resize( num_queries );
+    }
+
+    // Tests a ray against the objects of the leaves of a broadphase tree (same as bullet's single-ray callback)
+    struct TRayLeavesCollider : public btDbvt::ICollide
+    {
+        TRayLeavesCollider( const btTransform& ray_from, const btTransform& ray_to,
+                            btCollisionWorld::RayResultCallback& result_callback )
+            : m_RayFrom( ray_from ), m_RayTo( ray_to ), m_ResultCallback( result_callback ) {}
+
+        void Process( const btDbvtNode* leaf ) override
+        {
+            auto proxy = static_cast<btBroadphaseProxy*>( leaf->data );
+            auto bullet_object = static_cast<btCollisionObject*>( proxy->m_clientObject );
+            if ( m_ResultCallback.needsCollision( proxy ) )
+                btCollisionWorld::rayTestSingle( m_RayFrom, m_RayTo, bullet_object, bullet_object->getCollisionShape(),
+                                                 bullet_object->getWorldTransform(), m_ResultCallback );
+        }
+
+        const btTransform& m_RayFrom;
+        const btTransform& m_RayTo;
+        btCollisionWorld::RayResultCallback& m_ResultCallback;
+    };
+
+    // Fcl detector whose groups get their own collision-objects (dart's default shares them among all groups of the
+    // detector), while still sharing the fcl geometries of the shapes. Queries then don't write to each other's
+    // objects when updating their transforms, so they can be evaluated concurrently
+    class TDistanceCollisionDetector : public dart::collision::FCLCollisionDetector
+    {
+    public :
+
+        TDistanceCollisionDetector()
+        {
+            mCollisionObjectManager.reset( new ManagerForUnsharableCollisionObjects( this ) );
+            setPrimitiveShapeType( dart::collision::FCLCollisionDetector::PRIMITIVE );
+        }
+    };
+
+    TDartQueries::TDartQueries( dart::simulation::World* world_ref, ssize_t num_workers )
+        : m_DartWorldRef( world_ref ), m_ThreadPool( num_workers )
+    {
+        m_TraversalStacks.resize( m_ThreadPool.num_threads() );
+        m_DistanceDetector = std::make_shared<TDistanceCollisionDetector>();
+    }
+
+    ssize_t TDartQueries::RegisterCollider( const dart::dynamics::ShapeFrame* shape_frame, const std::string& name )
+    {
+        auto it_collider = m_CollidersIds.find( shape_frame );
+        if ( it_collider != m_CollidersIds.end() )
+            return it_collider->second;
+
+        ssize_t collider_id = -1;
+        if ( m_FreeIds.size() > 0 )
+        {
+            collider_id = m_FreeIds.back();
+            m_FreeIds.pop_back();
+            m_CollidersNames[collider_id] = name;
+            m_CollidersFrames[collider_id] = shape_frame;
+            m_CollidersInDistanceQueries[collider_id] = false;
+        }
+        else
+        {
+            collider_id = m_CollidersNames.size();
+            m_CollidersNames.push_back( name );
+            m_CollidersFrames.push_back( shape_frame );
+            m_CollidersInDistanceQueries.push_back( false );
+        }
+        m_CollidersIds[shape_frame] = collider_id;
+        m_CollidersIdsByName[name] = collider_id;
+        return collider_id;
+    }
+
+    void TDartQueries::UnregisterCollider( const dart::dynamics::ShapeFrame* shape_frame )
+    {
+        auto it_collider = m_CollidersIds.find( shape_frame );
+        if ( it_collider == m_CollidersIds.end() )
+            return;
+
+        const ssize_t collider_id = it_collider->second;
+        if ( m_CollidersInDistanceQueries[collider_id] )
+        {
+            // Queries keep their indices in the results (queries left without colliders just report no distance)
+            for ( auto& query : m_DistanceQueries )
+            {
+                query.group_a->removeShapeFrame( shape_frame );
+                query.group_b->removeShapeFrame( shape_frame );
+            }
+        }
+
+        auto it_name = m_CollidersIdsByName.find( m_CollidersNames[collider_id] );
+        if ( it_name != m_CollidersIdsByName.end() && it_name->second == collider_id )
+            m_CollidersIdsByName.erase( it_name );
+        m_CollidersIds.erase( it_collider );
+        m_CollidersNames[collider_id].clear();
+        m_CollidersFrames[collider_id] = nullptr;
+        m_CollidersInDistanceQueries[collider_id] = false;
+        m_FreeIds.push_back( collider_id );
+    }
+
+    ssize_t TDartQueries::collider_id( const dart::dynamics::ShapeFrame* shape_frame ) const
+    {
+        auto it_collider = m_CollidersIds.find( shape_frame );
+        return ( it_collider != m_CollidersIds.end() ) ? it_collider->second : -1;
+    }
+
+    ssize_t TDartQueries::collider_id( const std::string& name ) const
+    {
+        auto it_collider = m_CollidersIdsByName.find( name );
+        return ( it_collider != m_CollidersIdsByName.end() ) ? it_collider->second : -1;
+    }
+
+    ssize_t TDartQueries::RegisterDistancePair( ssize_t collider_a, ssize_t collider_b )
+    {
+        return RegisterDistanceGroup( collider_a, { collider_b } );
+    }
+
+    ssize_t TDartQueries::RegisterDistanceGroup( ssize_t collider_a, const std::vector<ssize_t>& colliders_b )
+    {
+        const ssize_t num_colliders = m_CollidersFrames.size();
+        auto is_valid_collider = [&]( ssize_t collider_id )
+            {
+                if ( collider_id < 0 || collider_id >= num_colliders || !m_CollidersFrames[collider_id] )
+                {
+                    LOCO_CORE_WARN( "TDartQueries::RegisterDistanceGroup >>> collider-id {0} is not registered", collider_id );
+                    return false;
+                }
+                // Heightfields aren't supported by dart's fcl backend (would be replaced by a dummy geometry)
+                if ( m_CollidersFrames[collider_id]->getShape()->getType() == dart::dynamics::HeightmapShapef::getStaticType() )
+                {
+                    LOCO_CORE_WARN( "TDartQueries::RegisterDistanceGroup >>> collider {0} is a heightfield, which \
+                                     isn't supported by distance-queries", m_CollidersNames[collider_id] );
+                    return false;
+                }
+                return true;
+            };
+
+        if ( !is_valid_collider( collider_a ) )
+            return -1;
+
+        // Groups are refreshed by ->ComputeDistances before evaluating the queries (single-threaded), as refreshing
+        // them can claim new collision-objects|geometries from the shared detector
+        TDistanceQuery query;
+        query.group_a = m_DistanceDetector->createCollisionGroup();
+        query.group_b = m_DistanceDetector->createCollisionGroup();
+        query.group_a->setAutomaticUpdate( false );
+        query.group_b->setAutomaticUpdate( false );
+        query.shape_frame_a = m_CollidersFrames[collider_a];
+        query.group_a->addShapeFrame( query.shape_frame_a );
+        for ( auto collider_b : colliders_b )
+        {
+            if ( collider_b == collider_a || !is_valid_collider( collider_b ) )
+                continue;
+            query.group_b->addShapeFrame( m_CollidersFrames[collider_b] );
+            m_CollidersInDistanceQueries[collider_b] = true;
+        }
+
+        if ( query.group_b->getNumShapeFrames() < 1 )
+        {
+            LOCO_CORE_WARN( "TDartQueries::RegisterDistanceGroup >>> no valid colliders to compute distances to \
+                             from collider {0}", m_CollidersNames[collider_a] );
+            return -1;
+        }
+
+        m_CollidersInDistanceQueries[collider_a] = true;
+        m_DistanceQueries.push_back( std::move( query ) );
+        return m_DistanceQueries.size() - 1;
+    }
+
+    void TDartQueries::ComputeDistances( TDartDistanceResults& results )
+    {
+        const ssize_t num_queries = m_DistanceQueries.size();
+        results.Resize( num_queries );
+
+        // World-transforms of frames are computed lazily by dart (cached on first access), so make sure these are
+        // up to date before reading them from several threads
+        for ( ssize_t i = 0; i < m_CollidersFrames.size(); i++ )
+            if ( m_CollidersInDistanceQueries[i] )
+                m_CollidersFrames[i]->getWorldTransform();
+        // Changed shapes (e.g. resized colliders) get their collision-objects replaced here, not by the workers
+        for ( auto& query : m_DistanceQueries )
+        {
+            query.group_a->update();
+            query.group_b->update();
+        }
+
+        m_ThreadPool.ParallelFor( num_queries, LOCO_DART_DISTANCES_MIN_CHUNK_SIZE,
+            [&]( ssize_t begin, ssize_t end, ssize_t thread_index )
+            {
+                const dart::collision::DistanceOption distance_option( true, 0.0, nullptr );
+                for ( ssize_t i = begin; i < end; i++ )
+                {
+                    auto& query = m_DistanceQueries[i];
+                    dart::collision::DistanceResult distance_result;
+                    m_DistanceDetector->distance( query.group_a.get(), query.group_b.get(), distance_option, &distance_result );
+                    if ( !distance_result.found() )
+                    {
+                        results.distances[i] = std::numeric_limits<double>::infinity();
+                        results.points_a.row( i ).setZero();
+                        results.points_b.row( i ).setZero();
+                        results.collider_ids_b[i] = -1;
+                        continue;
+                    }
+
+                    // Results are given in the order of the objects checked, which needn't be the order of the groups
+                    const bool swapped = ( distance_result.shapeFrame1 != query.shape_frame_a );
+                    const auto& point_a = swapped ? distance_result.nearestPoint2 : distance_result.nearestPoint1;
+                    const auto& point_b = swapped ? distance_result.nearestPoint1 : distance_result.nearestPoint2;
+                    results.distances[i] = distance_result.minDistance;
+                    results.points_a.row( i ) = point_a.transpose();
+                    results.points_b.row( i ) = point_b.transpose();
+                    results.collider_ids_b[i] = collider_id( swapped ? distance_result.shapeFrame1 : distance_result.shapeFrame2 );
+                }
+            } );
+    }
+
+    btCollisionWorld* TDartQueries::_GetBulletWorld()
+    {
+        auto bullet_collision_group = dynamic_cast<dart::collision::BulletCollisionGroup*>(
+                                            m_DartWorldRef->getConstraintSolver()->getCollisionGroup().get() );
+        if ( !bullet_collision_group )
+            return nullptr;
+
+        // Bodies moved since the last collision-check (positions are integrated after it), so refresh the
+        // transforms and aabbs of the collision-objects before querying (single-threaded)
+        bullet_collision_group->updateEngineData();
+        return bullet_collision_group->getBulletCollisionWorld();
+    }
+
+    void TDartQueries::CastRays( TDartRayBatch& batch )
+    {
+        const ssize_t num_rays = batch.num_rays();
+        if ( ( batch.directions.rows() != num_rays ) || ( batch.distances.size() != num_rays ) ||
+             ( batch.normals.rows() != num_rays ) || ( batch.collider_ids.size() != num_rays ) )
+        {
+            LOCO_CORE_ERROR( "TDartQueries::CastRays >>> buffers of the ray-batch must have {0} rows. Perhaps \
+                              missing call to ->Resize()?", num_rays );
+            return;
+        }
+
+        auto bullet_world = _GetBulletWorld();
+        auto dbvt_broadphase = bullet_world ? dynamic_cast<btDbvtBroadphase*>( bullet_world->getBroadphase() ) : nullptr;
+        if ( !dbvt_broadphase )
+        {
+            LOCO_CORE_ERROR( "TDartQueries::CastRays >>> expected a bullet collision-world with a dbvt broadphase" );
+            return;
+        }
+
+        const double max_distance = batch.max_distance;
+        m_ThreadPool.ParallelFor( num_rays, LOCO_DART_RAYS_MIN_CHUNK_SIZE,
+            [&]( ssize_t begin, ssize_t end, ssize_t thread_index )
+            {
+                auto& traversal_stack = m_TraversalStacks[thread_index];
+                for ( ssize_t i = begin; i < end; i++ )
+                {
+                    const Eigen::Vector3d direction = batch.directions.row( i ).transpose().normalized();
+                    const Eigen::Vector3d origin = batch.origins.row( i ).transpose();
+                    const Eigen::Vector3d target = origin + max_distance * direction;
+                    const btVector3 ray_from( origin.x(), origin.y(), origin.z() );
+                    const btVector3 ray_to( target.x(), target.y(), target.z() );
+
+                    btCollisionWorld::ClosestRayResultCallback result_callback( ray_from, ray_to );
+                    btTransform tf_ray_from, tf_ray_to;
+                    tf_ray_from.setIdentity(); tf_ray_from.setOrigin( ray_from );
+                    tf_ray_to.setIdentity(); tf_ray_to.setOrigin( ray_to );
+
+                    // Same setup as bullet's broadphase ray-test, but with a traversal stack per thread
+                    btVector3 direction_inverse;
+                    unsigned int signs[3];
+                    for ( int j = 0; j < 3; j++ )
+                    {
+                        direction_inverse[j] = ( direction[j] == 0.0 ) ? btScalar( BT_LARGE_FLOAT ) : btScalar( 1.0 / direction[j] );
+                        signs[j] = direction_inverse[j] < 0.0;
+                    }
+                    const btScalar lambda_max = max_distance;
+                    const btVector3 aabb_zero( 0.0, 0.0, 0.0 );
+
+                    TRayLeavesCollider leaves_collider( tf_ray_from, tf_ray_to, result_callback );
+                    for ( auto& dbvt_set : dbvt_broadphase->m_sets )
+                        dbvt_set.rayTestInternal( dbvt_set.m_root, ray_from, ray_to, direction_inverse, signs, lambda_max,
+                                                  aabb_zero, aabb_zero, traversal_stack, leaves_collider );
+
+                    if ( !result_callback.hasHit() )
+                    {
+                        batch.distances[i] = max_distance;
+                        batch.normals.row( i ).setZero();
+                        batch.collider_ids[i] = LOCO_DART_RAY_MISS;
+                        continue;
+                    }
+
+                    const auto& hit_normal = result_callback.m_hitNormalWorld;
+                    batch.distances[i] = result_callback.m_closestHitFraction * max_distance;
+                    batch.normals.row( i ) << hit_normal.x(), hit_normal.y(), hit_normal.z();
+
+                    auto dart_object = static_cast<const dart::collision::CollisionObject*>(
+                                                result_callback.m_collisionObject->getUserPointer() );
+                    const ssize_t collider_id = dart_object ? this->collider_id( dart_object->getShapeFrame() ) : -1;
+                    batch.collider_ids[i] = ( collider_id >= 0 ) ? collider_id : LOCO_DART_RAY_HIT_UNKNOWN;
+                }
+            } );
+    }
+}}
@@ -0,0 +1,82 @@
+
+#include <loco_realtime_dart.h>
+
+namespace loco {
+namespace dartsim {
+
+    TDartRealtimePacer::TDartRealtimePacer( const TDartRealtimeData& data,
+                                            const TNowFn& now_fn,
+                                            const TSleepUntilFn& sleep_until_fn )
+        : m_Data( data ), m_NowFn( now_fn ), m_SleepUntilFn( sleep_until_fn )
+    {
+        if ( !m_NowFn )
+            m_NowFn = []() { return TClock::now(); };
+        if ( !m_SleepUntilFn )
+            m_SleepUntilFn = []( const TClock::time_point& wall_time ) { std::this_thread::sleep_until( wall_time ); };
+        if ( m_Data.real_time_factor <= 0.0 )
+        {
+            LOCO_CORE_WARN( "TDartRealtimePacer >>> real-time factor must be positive, got {0}. Using 1.0 instead",
+                            m_Data.real_time_factor );
+            m_Data.real_time_factor = 1.0;
+        }
+        Start( 0.0 );
+    }
+
+    void TDartRealtimePacer::Start( double sim_time )
+    {
+        m_Stats = TDartRealtimeStats();
+        _Resync( sim_time, m_NowFn() );
+    }
+
+    void TDartRealtimePacer::Pace( double sim_time )
+    {
+        using TSeconds = std::chrono::duration<double>;
+        const auto wall_time_start = m_NowFn();
+
+        // Overrun: the step took longer (wall-clock) than its duration in simulation time
+        const double step_sim_duration = ( sim_time - m_LastSimTime ) / m_Data.real_time_factor;
+        const double step_wall_duration = TSeconds( wall_time_start - m_LastWallTime ).count();
+        m_Stats.num_steps++;
+        if ( step_wall_duration > step_sim_duration )
+        {
+            m_Stats.num_overruns++;
+            const double excess_us = 1e6 * ( step_wall_duration - step_sim_duration );
+            const ssize_t bucket = ( excess_us < 1.0 ) ? 0 : ssize_t( std::log2( excess_us ) );
+            m_Stats.overruns_histogram[std::min( bucket, LOCO_DART_OVERRUN_HISTOGRAM_SIZE - 1 )]++;
+        }
+
+        const auto deadline = m_WallTimeAnchor + std::chrono::duration_cast<TClock::duration>(
+                                    TSeconds( ( sim_time - m_SimTimeAnchor ) / m_Data.real_time_factor ) );
+        if ( TSeconds( wall_time_start - deadline ).count() > m_Data.max_lag )
+        {
+            // Too far behind to catch up smoothly, so start over from here
+            m_Stats.num_resyncs++;
+            _Resync( sim_time, wall_time_start );
+            return;
+        }
+
+        // Coarse sleep up to the spin-threshold, then spin up to the deadline
+        const auto spin_start = deadline - std::chrono::duration_cast<TClock::duration>( TSeconds( m_Data.spin_threshold ) );
+        if ( wall_time_start < spin_start )
+            m_SleepUntilFn( spin_start );
+        auto wall_time = m_NowFn();
+        while ( wall_time < deadline )
+        {
+            std::this_thread::yield();
+            wall_time = m_NowFn();
+        }
+
+        m_Stats.last_lateness = TSeconds( wall_time - deadline ).count();
+        m_Stats.max_lateness = std::max( m_Stats.max_lateness, m_Stats.last_lateness );
+        m_LastSimTime = sim_time;
+        m_LastWallTime = wall_time;
+    }
+
+    void TDartRealtimePacer::_Resync( double sim_time, const TClock::time_point& wall_time )
+    {
+        m_SimTimeAnchor = sim_time;
+        m_WallTimeAnchor = wall_time;
+        m_LastSimTime = sim_time;
+        m_LastWallTime = wall_time;
+    }
+}}
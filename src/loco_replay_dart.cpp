@@ -0,0 +1,525 @@
+
+#include <loco_replay_dart.h>
+#include <loco_serialization_dart.h>
+
+#include <cstring>
+#include <unordered_map>
+
+namespace loco {
+namespace dartsim {
+
+    // Size of the header of every record: type (uint8) and payload size (uint32)
+    const size_t LOCO_DART_REPLAY_RECORD_HEADER_SIZE = sizeof( uint8_t ) + sizeof( uint32_t );
+
+    static void _AppendDoubles( std::vector<char>& buffer, const double* values, ssize_t num_values )
+    {
+        AppendBytes( buffer, values, sizeof( double ) * num_values );
+    }
+
+    static void _ReadDoubles( TDartByteCursor& cursor, double* dst_values, ssize_t num_values )
+    {
+        cursor.ReadBytes( dst_values, sizeof( double ) * num_values );
+    }
+
+    // Copies the positions|velocities|forces of a skeleton into a preallocated buffer (skeleton->getPositions()
+    // and the like allocate a new vector on every call)
+    static void _GetPositions( const dart::dynamics::Skeleton* skeleton, Eigen::VectorXd& dst_values )
+    {
+        for ( size_t j = 0; j < skeleton->getNumDofs(); j++ )
+            dst_values[j] = skeleton->getPosition( j );
+    }
+
+    static void _GetVelocities( const dart::dynamics::Skeleton* skeleton, Eigen::VectorXd& dst_values )
+    {
+        for ( size_t j = 0; j < skeleton->getNumDofs(); j++ )
+            dst_values[j] = skeleton->getVelocity( j );
+    }
+
+    static void _GetForces( const dart::dynamics::Skeleton* skeleton, Eigen::VectorXd& dst_values )
+    {
+        for ( size_t j = 0; j < skeleton->getNumDofs(); j++ )
+            dst_values[j] = skeleton->getForce( j );
+    }
+
+    // Skeletons driven by the simulation (static ones, e.g. terrain tiles, have no state to record)
+    static std::vector<dart::dynamics::Skeleton*> _CollectMobileSkeletons( dart::simulation::World* world )
+    {
+        std::vector<dart::dynamics::Skeleton*> skeletons;
+        for ( size_t i = 0; i < world->getNumSkeletons(); i++ )
+            if ( world->getSkeleton( i )->getNumDofs() > 0 )
+                skeletons.push_back( world->getSkeleton( i ).get() );
+        return skeletons;
+    }
+
+    // Dispatcher holding the contact-manifolds of the world (nullptr if it doesn't use the bullet detector)
+    static btDispatcher* _GetBulletDispatcher( dart::simulation::World* world )
+    {
+        auto bullet_collision_group = dynamic_cast<dart::collision::BulletCollisionGroup*>(
+                                            world->getConstraintSolver()->getCollisionGroup().get() );
+        if ( !bullet_collision_group )
+            return nullptr;
+        return bullet_collision_group->getBulletCollisionWorld()->getDispatcher();
+    }
+
+    // Id written for collision-objects that don't belong to any shape-node of the world
+    const uint32_t LOCO_DART_REPLAY_UNKNOWN_SHAPE = 0xffffffff;
+
+    // Ids of the collision shape-nodes of a world (order in a traversal of all its skeletons and body-nodes), which
+    // match between worlds built the same way
+    static std::unordered_map<const dart::dynamics::ShapeFrame*, uint32_t> _CollectShapeFrameIds( dart::simulation::World* world )
+    {
+        std::unordered_map<const dart::dynamics::ShapeFrame*, uint32_t> shape_frame_ids;
+        uint32_t num_shape_frames = 0;
+        for ( size_t i = 0; i < world->getNumSkeletons(); i++ )
+        {
+            auto skeleton = world->getSkeleton( i );
+            for ( size_t j = 0; j < skeleton->getNumBodyNodes(); j++ )
+                for ( auto shape_node : skeleton->getBodyNode( j )->getShapeNodesWith<dart::dynamics::CollisionAspect>() )
+                    shape_frame_ids[shape_node] = num_shape_frames++;
+        }
+        return shape_frame_ids;
+    }
+
+    static uint32_t _ShapeFrameId( const std::unordered_map<const dart::dynamics::ShapeFrame*, uint32_t>& shape_frame_ids,
+                                   const btCollisionObject* bullet_object )
+    {
+        auto dart_object = static_cast<const dart::collision::CollisionObject*>( bullet_object->getUserPointer() );
+        if ( !dart_object )
+            return LOCO_DART_REPLAY_UNKNOWN_SHAPE;
+        auto it_id = shape_frame_ids.find( dart_object->getShapeFrame() );
+        return ( it_id != shape_frame_ids.end() ) ? it_id->second : LOCO_DART_REPLAY_UNKNOWN_SHAPE;
+    }
+
+    // Writes the contact-manifolds of the world, in the order these are kept by the dispatcher (the order in which
+    // their contacts reach the constraint solver), with the ids of both shapes and their cached points as-is
+    static void _AppendContactCaches( std::vector<char>& buffer, dart::simulation::World* world )
+    {
+        auto dispatcher = _GetBulletDispatcher( world );
+        if ( !dispatcher )
+        {
+            AppendValue( buffer, uint32_t( 0 ) );
+            return;
+        }
+
+        const auto shape_frame_ids = _CollectShapeFrameIds( world );
+        AppendValue( buffer, uint32_t( dispatcher->getNumManifolds() ) );
+        for ( int i = 0; i < dispatcher->getNumManifolds(); i++ )
+        {
+            auto manifold = dispatcher->getManifoldByIndexInternal( i );
+            AppendValue( buffer, _ShapeFrameId( shape_frame_ids, manifold->getBody0() ) );
+            AppendValue( buffer, _ShapeFrameId( shape_frame_ids, manifold->getBody1() ) );
+            AppendValue( buffer, uint32_t( manifold->getNumContacts() ) );
+            for ( int j = 0; j < manifold->getNumContacts(); j++ )
+                AppendBytes( buffer, &manifold->getContactPoint( j ), sizeof( btManifoldPoint ) );
+        }
+    }
+
+    // Restores the contact-manifolds written by _AppendContactCaches. Manifolds only exist for the pairs found by
+    // the broadphase, so a collision check is run first (at the restored positions), and the manifolds it leaves
+    // are then moved into the recorded order and overwritten with the recorded points. Returns whether all of the
+    // recorded manifolds were found, and no others
+    static bool _RestoreContactCaches( TDartByteCursor& cursor, dart::simulation::World* world )
+    {
+        const uint32_t num_manifolds = cursor.Read<uint32_t>();
+        auto dispatcher = _GetBulletDispatcher( world );
+        if ( !dispatcher )
+            return ( num_manifolds == 0 );
+
+        auto constraint_solver = world->getConstraintSolver();
+        dart::collision::CollisionResult collision_result;
+        constraint_solver->getCollisionGroup()->collide( constraint_solver->getCollisionOption(), &collision_result );
+
+        const auto shape_frame_ids = _CollectShapeFrameIds( world );
+        auto manifolds = dispatcher->getInternalManifoldPointer();
+        const int num_world_manifolds = dispatcher->getNumManifolds();
+        int num_restored = 0;
+        bool restored = true;
+        btManifoldPoint point;
+        for ( uint32_t i = 0; i < num_manifolds; i++ )
+        {
+            const uint32_t shape_id_0 = cursor.Read<uint32_t>();
+            const uint32_t shape_id_1 = cursor.Read<uint32_t>();
+            const uint32_t num_points = cursor.Read<uint32_t>();
+            int match_index = -1;
+            for ( int j = num_restored; ( j < num_world_manifolds ) && ( match_index < 0 ); j++ )
+                if ( _ShapeFrameId( shape_frame_ids, manifolds[j]->getBody0() ) == shape_id_0 &&
+                     _ShapeFrameId( shape_frame_ids, manifolds[j]->getBody1() ) == shape_id_1 )
+                    match_index = j;
+
+            if ( match_index < 0 )
+            {
+                for ( uint32_t j = 0; j < num_points; j++ )
+                    cursor.ReadBytes( &point, sizeof( btManifoldPoint ) );
+                restored = false;
+                continue;
+            }
+
+            // The dispatcher keeps the index of each manifold within its array (used when releasing these)
+            std::swap( manifolds[num_restored], manifolds[match_index] );
+            manifolds[num_restored]->m_index1a = num_restored;
+            manifolds[match_index]->m_index1a = match_index;
+            auto manifold = manifolds[num_restored++];
+            manifold->clearManifold();
+            for ( uint32_t j = 0; j < num_points; j++ )
+            {
+                cursor.ReadBytes( &point, sizeof( btManifoldPoint ) );
+                point.m_userPersistentData = nullptr;
+                manifold->addManifoldPoint( point );
+            }
+        }
+        // Manifolds the recorded world didn't have start empty
+        for ( int j = num_restored; j < num_world_manifolds; j++ )
+            manifolds[j]->clearManifold();
+        return restored && ( num_restored == num_world_manifolds ) && cursor.valid;
+    }
+
+    /***********************************************************************************************
+    *                                       Replay Recorder                                        *
+    ***********************************************************************************************/
+
+    TDartReplayRecorder::TDartReplayRecorder( dart::simulation::World* world_ref, const std::string& filepath, ssize_t keyframe_interval )
+        : m_DartWorldRef( world_ref ), m_KeyframeInterval( std::max<ssize_t>( keyframe_interval, 1 ) )
+    {
+        m_File.open( filepath, std::ios::binary | std::ios::out | std::ios::trunc );
+        if ( !m_File.is_open() )
+        {
+            LOCO_CORE_ERROR( "TDartReplayRecorder >>> couldn't open replay-log {0} for writing", filepath );
+            return;
+        }
+
+        m_Skeletons = _CollectMobileSkeletons( m_DartWorldRef );
+        m_Record.clear();
+        AppendValue( m_Record, LOCO_DART_REPLAY_MAGIC );
+        AppendValue( m_Record, LOCO_DART_REPLAY_VERSION );
+        // Contact points are stored as-is, so these can only be read back by a build with the same layout
+        AppendValue( m_Record, uint32_t( sizeof( btManifoldPoint ) ) );
+        AppendValue( m_Record, uint32_t( m_Skeletons.size() ) );
+        for ( auto skeleton : m_Skeletons )
+        {
+            AppendValue( m_Record, uint32_t( skeleton->getNumDofs() ) );
+            AppendValue( m_Record, uint32_t( skeleton->getNumBodyNodes() ) );
+            m_LastPositions.push_back( skeleton->getPositions() );
+            m_LastVelocities.push_back( skeleton->getVelocities() );
+            m_Forces.push_back( Eigen::VectorXd::Zero( skeleton->getNumDofs() ) );
+        }
+        m_File.write( m_Record.data(), m_Record.size() );
+        m_LastGravity = m_DartWorldRef->getGravity();
+        m_LastTimeStep = m_DartWorldRef->getTimeStep();
+    }
+
+    TDartReplayRecorder::~TDartReplayRecorder()
+    {
+        Close();
+    }
+
+    void TDartReplayRecorder::Close()
+    {
+        if ( m_File.is_open() )
+            m_File.close();
+    }
+
+    void TDartReplayRecorder::RecordSubstep( bool reset_commands )
+    {
+        if ( !m_File.is_open() )
+            return;
+
+        if ( m_NumSubsteps % m_KeyframeInterval == 0 )
+            _WriteKeyframe();
+        else if ( m_DartWorldRef->getGravity() != m_LastGravity || m_DartWorldRef->getTimeStep() != m_LastTimeStep )
+            _WriteParams();
+
+        m_Record.clear();
+        AppendValue( m_Record, uint8_t( REPLAY_RECORD_SUBSTEP ) );
+        AppendValue( m_Record, uint32_t( 0 ) ); // payload size, filled below
+        AppendValue( m_Record, int64_t( m_NumSubsteps ) );
+        AppendValue( m_Record, uint8_t( reset_commands ) );
+        for ( size_t i = 0; i < m_Skeletons.size(); i++ )
+        {
+            auto skeleton = m_Skeletons[i];
+            // Inputs are compared bit-wise, as any difference would break the replay
+            bool teleported = false;
+            for ( size_t j = 0; j < skeleton->getNumDofs() && !teleported; j++ )
+                teleported = ( skeleton->getPosition( j ) != m_LastPositions[i][j] ) ||
+                             ( skeleton->getVelocity( j ) != m_LastVelocities[i][j] );
+            _GetForces( skeleton, m_Forces[i] );
+            const bool has_forces = ( m_Forces[i].array() != 0.0 ).any();
+            bool has_external_forces = false;
+            for ( size_t j = 0; j < skeleton->getNumBodyNodes() && !has_external_forces; j++ )
+                has_external_forces = !skeleton->getBodyNode( j )->getExternalForceLocal().isZero( 0.0 );
+
+            const uint8_t inputs = ( teleported ? REPLAY_INPUT_TELEPORT : 0 ) |
+                                   ( has_forces ? REPLAY_INPUT_FORCES : 0 ) |
+                                   ( has_external_forces ? REPLAY_INPUT_EXTERNAL_FORCES : 0 );
+            AppendValue( m_Record, inputs );
+            if ( teleported )
+            {
+                // Last state isn't needed anymore (it's replaced after the substep), so it holds the new one
+                _GetPositions( skeleton, m_LastPositions[i] );
+                _GetVelocities( skeleton, m_LastVelocities[i] );
+                _AppendDoubles( m_Record, m_LastPositions[i].data(), m_LastPositions[i].size() );
+                _AppendDoubles( m_Record, m_LastVelocities[i].data(), m_LastVelocities[i].size() );
+            }
+            if ( has_forces )
+                _AppendDoubles( m_Record, m_Forces[i].data(), m_Forces[i].size() );
+            if ( has_external_forces )
+            {
+                for ( size_t j = 0; j < skeleton->getNumBodyNodes(); j++ )
+                    _AppendDoubles( m_Record, skeleton->getBodyNode( j )->getExternalForceLocal().data(), 6 );
+            }
+        }
+        const uint32_t payload_size = m_Record.size() - LOCO_DART_REPLAY_RECORD_HEADER_SIZE;
+        std::memcpy( m_Record.data() + sizeof( uint8_t ), &payload_size, sizeof( uint32_t ) );
+        m_File.write( m_Record.data(), m_Record.size() );
+        m_NumSubsteps++;
+    }
+
+    void TDartReplayRecorder::RecordPostSubstep()
+    {
+        for ( size_t i = 0; i < m_Skeletons.size(); i++ )
+        {
+            _GetPositions( m_Skeletons[i], m_LastPositions[i] );
+            _GetVelocities( m_Skeletons[i], m_LastVelocities[i] );
+        }
+    }
+
+    void TDartReplayRecorder::_WriteKeyframe()
+    {
+        // The world being recorded is left untouched (contact caches are only read)
+        m_Record.clear();
+        AppendValue( m_Record, uint8_t( REPLAY_RECORD_KEYFRAME ) );
+        AppendValue( m_Record, uint32_t( 0 ) );
+        AppendValue( m_Record, int64_t( m_NumSubsteps ) );
+        AppendValue( m_Record, m_DartWorldRef->getTime() );
+        AppendValue( m_Record, m_DartWorldRef->getTimeStep() );
+        _AppendDoubles( m_Record, m_DartWorldRef->getGravity().data(), 3 );
+        for ( size_t i = 0; i < m_Skeletons.size(); i++ )
+        {
+            _GetPositions( m_Skeletons[i], m_LastPositions[i] );
+            _GetVelocities( m_Skeletons[i], m_LastVelocities[i] );
+            _AppendDoubles( m_Record, m_LastPositions[i].data(), m_LastPositions[i].size() );
+            _AppendDoubles( m_Record, m_LastVelocities[i].data(), m_LastVelocities[i].size() );
+        }
+        _AppendContactCaches( m_Record, m_DartWorldRef );
+        const uint32_t payload_size = m_Record.size() - LOCO_DART_REPLAY_RECORD_HEADER_SIZE;
+        std::memcpy( m_Record.data() + sizeof( uint8_t ), &payload_size, sizeof( uint32_t ) );
+        m_File.write( m_Record.data(), m_Record.size() );
+
+        m_LastGravity = m_DartWorldRef->getGravity();
+        m_LastTimeStep = m_DartWorldRef->getTimeStep();
+    }
+
+    void TDartReplayRecorder::_WriteParams()
+    {
+        m_Record.clear();
+        AppendValue( m_Record, uint8_t( REPLAY_RECORD_PARAMS ) );
+        AppendValue( m_Record, uint32_t( sizeof( double ) * 4 ) );
+        AppendValue( m_Record, m_DartWorldRef->getTimeStep() );
+        _AppendDoubles( m_Record, m_DartWorldRef->getGravity().data(), 3 );
+        m_File.write( m_Record.data(), m_Record.size() );
+
+        m_LastGravity = m_DartWorldRef->getGravity();
+        m_LastTimeStep = m_DartWorldRef->getTimeStep();
+    }
+
+    /***********************************************************************************************
+    *                                        Replay Player                                         *
+    ***********************************************************************************************/
+
+    TDartReplayPlayer::TDartReplayPlayer( dart::simulation::World* world_ref, const std::string& filepath )
+        : m_DartWorldRef( world_ref )
+    {
+        std::ifstream file( filepath, std::ios::binary );
+        if ( !file.is_open() )
+        {
+            LOCO_CORE_ERROR( "TDartReplayPlayer >>> couldn't open replay-log {0}", filepath );
+            return;
+        }
+        m_Data.assign( std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() );
+
+        // Header: the world must have the same mobile skeletons (dofs and bodies) as the recorded one
+        m_Skeletons = _CollectMobileSkeletons( m_DartWorldRef );
+        const size_t header_size = 4 * sizeof( uint32_t ) + 2 * sizeof( uint32_t ) * m_Skeletons.size();
+        TDartByteCursor cursor( m_Data.data(), m_Data.size() );
+        if ( m_Data.size() < 4 * sizeof( uint32_t ) || cursor.Read<uint32_t>() != LOCO_DART_REPLAY_MAGIC ||
+             cursor.Read<uint32_t>() != LOCO_DART_REPLAY_VERSION || cursor.Read<uint32_t>() != sizeof( btManifoldPoint ) ||
+             cursor.Read<uint32_t>() != m_Skeletons.size() || m_Data.size() < header_size )
+        {
+            LOCO_CORE_ERROR( "TDartReplayPlayer >>> replay-log {0} is invalid, or doesn't match the world", filepath );
+            return;
+        }
+        for ( auto skeleton : m_Skeletons )
+        {
+            const uint32_t num_dofs = cursor.Read<uint32_t>();
+            const uint32_t num_bodies = cursor.Read<uint32_t>();
+            if ( num_dofs != skeleton->getNumDofs() || num_bodies != skeleton->getNumBodyNodes() )
+            {
+                LOCO_CORE_ERROR( "TDartReplayPlayer >>> skeleton {0} doesn't match the one in replay-log {1}",
+                                 skeleton->getName(), filepath );
+                return;
+            }
+            m_Buffers.push_back( Eigen::VectorXd( num_dofs ) );
+        }
+
+        // Index the keyframes, so seeking doesn't have to go through the whole log
+        m_ReadOffset = cursor.offset;
+        const size_t records_offset = m_ReadOffset;
+        uint8_t type;
+        while ( m_ReadOffset < m_Data.size() )
+        {
+            const size_t record_offset = m_ReadOffset;
+            if ( !_ReadRecord( type, m_Payload ) )
+                break;
+            if ( type == REPLAY_RECORD_KEYFRAME )
+            {
+                TDartByteCursor cursor( m_Payload.data(), m_Payload.size() );
+                m_Keyframes.push_back( { cursor.Read<int64_t>(), record_offset } );
+            }
+            else if ( type == REPLAY_RECORD_SUBSTEP )
+                m_NumSubsteps++;
+        }
+        m_ReadOffset = records_offset;
+        m_Valid = ( m_Keyframes.size() > 0 );
+        if ( !m_Valid )
+            LOCO_CORE_ERROR( "TDartReplayPlayer >>> replay-log {0} has no keyframes", filepath );
+    }
+
+    bool TDartReplayPlayer::_ReadRecord( uint8_t& type, std::vector<char>& payload )
+    {
+        if ( m_ReadOffset + LOCO_DART_REPLAY_RECORD_HEADER_SIZE > m_Data.size() )
+            return false;
+        TDartByteCursor cursor( m_Data.data(), m_Data.size(), m_ReadOffset );
+        type = cursor.Read<uint8_t>();
+        const uint32_t payload_size = cursor.Read<uint32_t>();
+        // Records cut short (e.g. the recording process crashed) are treated as the end of the log
+        if ( cursor.offset + payload_size > m_Data.size() )
+            return false;
+        payload.assign( m_Data.data() + cursor.offset, m_Data.data() + cursor.offset + payload_size );
+        m_ReadOffset = cursor.offset + payload_size;
+        return true;
+    }
+
+    bool TDartReplayPlayer::Seek( ssize_t substep_index )
+    {
+        if ( !m_Valid || substep_index < 0 || substep_index > m_NumSubsteps )
+        {
+            LOCO_CORE_WARN( "TDartReplayPlayer::Seek >>> substep {0} is out of range [0, {1}]", substep_index, m_NumSubsteps );
+            return false;
+        }
+
+        // Closest keyframe before the requested substep (keyframes are sorted by substep)
+        auto it_keyframe = std::upper_bound( m_Keyframes.begin(), m_Keyframes.end(), substep_index,
+                                             []( ssize_t index, const TKeyframe& keyframe )
+                                                { return index < keyframe.substep; } );
+        --it_keyframe;
+
+        uint8_t type;
+        m_ReadOffset = it_keyframe->offset;
+        _ReadRecord( type, m_Payload );
+        if ( !_RestoreKeyframe( m_Payload ) )
+            LOCO_CORE_WARN( "TDartReplayPlayer::Seek >>> contact caches of the keyframe at substep {0} don't match the "
+                            "world, replaying from it might not match the recording exactly", it_keyframe->substep );
+        while ( m_CurrentSubstep < substep_index )
+            if ( !StepForward() )
+                return false;
+        return true;
+    }
+
+    bool TDartReplayPlayer::StepForward()
+    {
+        uint8_t type;
+        while ( _ReadRecord( type, m_Payload ) )
+        {
+            // Keyframes hold the same state as the current one when playing through
+            if ( type == REPLAY_RECORD_KEYFRAME )
+                continue;
+            if ( type == REPLAY_RECORD_PARAMS )
+            {
+                _ApplyParams( m_Payload );
+                continue;
+            }
+            if ( type != REPLAY_RECORD_SUBSTEP )
+                continue;
+
+            TDartByteCursor cursor( m_Payload.data(), m_Payload.size() );
+            m_CurrentSubstep = cursor.Read<int64_t>();
+            const bool reset_commands = cursor.Read<uint8_t>();
+            for ( size_t i = 0; i < m_Skeletons.size(); i++ )
+            {
+                auto skeleton = m_Skeletons[i];
+                const uint8_t inputs = cursor.Read<uint8_t>();
+                const ssize_t num_dofs = skeleton->getNumDofs();
+                auto& buffer = m_Buffers[i];
+                if ( inputs & REPLAY_INPUT_TELEPORT )
+                {
+                    _ReadDoubles( cursor, buffer.data(), num_dofs );
+                    skeleton->setPositions( buffer );
+                    _ReadDoubles( cursor, buffer.data(), num_dofs );
+                    skeleton->setVelocities( buffer );
+                }
+                // Inputs not recorded were zero (these might have been left over by a previous substep)
+                if ( inputs & REPLAY_INPUT_FORCES )
+                {
+                    _ReadDoubles( cursor, buffer.data(), num_dofs );
+                    skeleton->setForces( buffer );
+                }
+                else
+                {
+                    skeleton->resetGeneralizedForces();
+                }
+                if ( !( inputs & REPLAY_INPUT_EXTERNAL_FORCES ) )
+                {
+                    skeleton->clearExternalForces();
+                }
+                else
+                {
+                    for ( size_t j = 0; j < skeleton->getNumBodyNodes(); j++ )
+                    {
+                        // Wrenches are set as-is (instead of through ->setExtForce), so these are bit-exact
+                        auto bodynode = skeleton->getBodyNode( j );
+                        auto aspect_state = bodynode->getAspectState();
+                        _ReadDoubles( cursor, aspect_state.mFext.data(), 6 );
+                        bodynode->setAspectState( aspect_state );
+                    }
+                }
+            }
+            m_DartWorldRef->step( reset_commands );
+            m_CurrentSubstep++;
+            return true;
+        }
+        return false;
+    }
+
+    bool TDartReplayPlayer::_RestoreKeyframe( const std::vector<char>& payload )
+    {
+        TDartByteCursor cursor( payload.data(), payload.size() );
+        m_CurrentSubstep = cursor.Read<int64_t>();
+        m_DartWorldRef->setTime( cursor.Read<double>() );
+        m_DartWorldRef->setTimeStep( cursor.Read<double>() );
+        Eigen::Vector3d gravity;
+        _ReadDoubles( cursor, gravity.data(), 3 );
+        m_DartWorldRef->setGravity( gravity );
+        for ( size_t i = 0; i < m_Skeletons.size(); i++ )
+        {
+            auto skeleton = m_Skeletons[i];
+            const ssize_t num_dofs = skeleton->getNumDofs();
+            auto& buffer = m_Buffers[i];
+            _ReadDoubles( cursor, buffer.data(), num_dofs );
+            skeleton->setPositions( buffer );
+            _ReadDoubles( cursor, buffer.data(), num_dofs );
+            skeleton->setVelocities( buffer );
+            skeleton->clearExternalForces();
+            skeleton->resetGeneralizedForces();
+        }
+        // Contact caches go last, as the collision check that brings back their manifolds needs the restored state
+        return _RestoreContactCaches( cursor, m_DartWorldRef );
+    }
+
+    void TDartReplayPlayer::_ApplyParams( const std::vector<char>& payload )
+    {
+        TDartByteCursor cursor( payload.data(), payload.size() );
+        m_DartWorldRef->setTimeStep( cursor.Read<double>() );
+        Eigen::Vector3d gravity;
+        _ReadDoubles( cursor, gravity.data(), 3 );
+        m_DartWorldRef->setGravity( gravity );
+    }
+}}
@@ -0,0 +1,354 @@
+
+#include <loco_scene_cache_dart.h>
+#include <loco_serialization_dart.h>
+
+#include <fstream>
+#include <sys/stat.h>
+
+namespace loco {
+namespace dartsim {
+
+    void TDartSignature::AddBytes( const void* data, size_t num_bytes )
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>( data );
+        for ( size_t i = 0; i < num_bytes; i++ )
+        {
+            value ^= bytes[i];
+            value *= 0x100000001b3ull;
+        }
+    }
+
+    void TDartSignature::AddString( const std::string& str )
+    {
+        Add( uint64_t( str.size() ) );
+        AddBytes( str.data(), str.size() );
+    }
+
+    void TDartSignature::AddShape( const TShapeData& data )
+    {
+        Add( int32_t( data.type ) );
+        Add( double( data.size.x() ) );
+        Add( double( data.size.y() ) );
+        Add( double( data.size.z() ) );
+        AddString( data.mesh_data.filename );
+        AddBytes( data.mesh_data.vertices.data(), sizeof( float ) * data.mesh_data.vertices.size() );
+        AddBytes( data.mesh_data.faces.data(), sizeof( int ) * data.mesh_data.faces.size() );
+        Add( int64_t( data.hfield_data.nWidthSamples ) );
+        Add( int64_t( data.hfield_data.nDepthSamples ) );
+        for ( size_t i = 0; i < data.children.size(); i++ )
+        {
+            AddShape( data.children[i] );
+            for ( ssize_t row = 0; row < 4; row++ )
+                for ( ssize_t col = 0; col < 4; col++ )
+                    Add( double( data.children_tfs[i]( row, col ) ) );
+        }
+    }
+
+    void TDartSignature::AddInertia( const TInertialData& inertia_data )
+    {
+        Add( double( inertia_data.mass ) );
+        Add( double( inertia_data.ixx ) );
+        Add( double( inertia_data.iyy ) );
+        Add( double( inertia_data.izz ) );
+        Add( double( inertia_data.ixy ) );
+        Add( double( inertia_data.ixz ) );
+        Add( double( inertia_data.iyz ) );
+    }
+
+    uint64_t ComputeFileSignature( const std::string& filename )
+    {
+        struct stat file_stat;
+        if ( stat( filename.c_str(), &file_stat ) != 0 )
+            return 0;
+
+        TDartSignature signature;
+        signature.Add( int64_t( file_stat.st_size ) );
+        signature.Add( int64_t( file_stat.st_mtime ) );
+        return signature.value;
+    }
+
+    // Size of the keys of the entries in a cache file, padded so the arrays after them stay 4-byte aligned
+    static size_t _PaddedKeySize( size_t key_size )
+    {
+        return ( key_size + 3 ) & ~size_t( 3 );
+    }
+
+    static void _AppendKey( std::vector<uint8_t>& buffer, const std::string& key )
+    {
+        AppendValue( buffer, uint32_t( key.size() ) );
+        buffer.insert( buffer.end(), key.begin(), key.end() );
+        buffer.resize( buffer.size() + _PaddedKeySize( key.size() ) - key.size(), 0 );
+    }
+
+    static std::string _ReadKey( TDartByteCursor& cursor )
+    {
+        const uint32_t key_size = cursor.Read<uint32_t>();
+        if ( cursor.remaining() < _PaddedKeySize( key_size ) )
+        {
+            cursor.valid = false;
+            return "";
+        }
+        std::string key( reinterpret_cast<const char*>( cursor.data + cursor.offset ), key_size );
+        cursor.offset += _PaddedKeySize( key_size );
+        return key;
+    }
+
+    // Signatures (size and modification time) of the mesh files used by a shape and its children, so cached
+    // inertias computed from a mesh are dropped once its file changes
+    static void _AddMeshFileSignatures( TDartSignature& signature, const TShapeData& data )
+    {
+        if ( data.mesh_data.filename != "" )
+            signature.Add( ComputeFileSignature( data.mesh_data.filename ) );
+        for ( const auto& child_data : data.children )
+            _AddMeshFileSignatures( signature, child_data );
+    }
+
+    bool TDartSceneCache::Load( const std::string& filepath )
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        m_Meshes.clear();
+        m_Inertias.clear();
+        m_Dirty = false;
+        m_File = std::make_unique<TDartMappedFileReader>( filepath );
+        if ( !m_File->valid() )
+        {
+            m_File = nullptr;
+            return false;
+        }
+
+        TDartByteCursor cursor( m_File->data(), m_File->size() );
+        const uint32_t magic = cursor.Read<uint32_t>();
+        const uint32_t version = cursor.Read<uint32_t>();
+        const uint32_t num_meshes = cursor.Read<uint32_t>();
+        const uint32_t num_inertias = cursor.Read<uint32_t>();
+        if ( !cursor.valid || magic != LOCO_DART_SCENE_CACHE_MAGIC || version != LOCO_DART_SCENE_CACHE_VERSION )
+        {
+            LOCO_CORE_WARN( "TDartSceneCache::Load >>> {0} is not a valid scene-cache, ignoring it", filepath );
+            m_File = nullptr;
+            return false;
+        }
+
+        for ( uint32_t i = 0; i < num_meshes && cursor.valid; i++ )
+        {
+            const std::string filename = _ReadKey( cursor );
+            TMeshEntry mesh_entry;
+            mesh_entry.signature = cursor.Read<uint64_t>();
+            mesh_entry.num_vertices = cursor.Read<uint32_t>();
+            mesh_entry.num_faces = cursor.Read<uint32_t>();
+            const size_t vertices_bytes = sizeof( float ) * 3 * size_t( mesh_entry.num_vertices );
+            const size_t faces_bytes = sizeof( int32_t ) * 3 * size_t( mesh_entry.num_faces );
+            if ( cursor.remaining() < vertices_bytes + faces_bytes )
+            {
+                cursor.valid = false;
+                break;
+            }
+            // Vertex-data is used in place (the mapping is page-aligned, and keys are padded to keep it 4-byte aligned)
+            mesh_entry.vertices = reinterpret_cast<const float*>( cursor.data + cursor.offset );
+            mesh_entry.faces = reinterpret_cast<const int32_t*>( cursor.data + cursor.offset + vertices_bytes );
+            cursor.offset += vertices_bytes + faces_bytes;
+            m_Meshes[filename] = std::move( mesh_entry );
+        }
+
+        for ( uint32_t i = 0; i < num_inertias && cursor.valid; i++ )
+        {
+            const std::string body_name = _ReadKey( cursor );
+            TInertiaEntry inertia_entry;
+            inertia_entry.signature = cursor.Read<uint64_t>();
+            cursor.ReadBytes( inertia_entry.values, sizeof( inertia_entry.values ) );
+            if ( cursor.valid )
+                m_Inertias[body_name] = inertia_entry;
+        }
+
+        if ( !cursor.valid )
+        {
+            LOCO_CORE_WARN( "TDartSceneCache::Load >>> scene-cache {0} is truncated, ignoring it", filepath );
+            m_Meshes.clear();
+            m_Inertias.clear();
+            m_File = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    bool TDartSceneCache::Save( const std::string& filepath )
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        std::vector<uint8_t> buffer;
+        AppendValue( buffer, LOCO_DART_SCENE_CACHE_MAGIC );
+        AppendValue( buffer, LOCO_DART_SCENE_CACHE_VERSION );
+        AppendValue( buffer, uint32_t( m_Meshes.size() ) );
+        AppendValue( buffer, uint32_t( m_Inertias.size() ) );
+        for ( const auto& it_mesh : m_Meshes )
+        {
+            const auto& mesh_entry = it_mesh.second;
+            _AppendKey( buffer, it_mesh.first );
+            AppendValue( buffer, mesh_entry.signature );
+            AppendValue( buffer, mesh_entry.num_vertices );
+            AppendValue( buffer, mesh_entry.num_faces );
+            AppendBytes( buffer, mesh_entry.vertices, sizeof( float ) * 3 * mesh_entry.num_vertices );
+            AppendBytes( buffer, mesh_entry.faces, sizeof( int32_t ) * 3 * mesh_entry.num_faces );
+        }
+        for ( const auto& it_inertia : m_Inertias )
+        {
+            _AppendKey( buffer, it_inertia.first );
+            AppendValue( buffer, it_inertia.second.signature );
+            AppendValue( buffer, it_inertia.second.values );
+        }
+
+        // The current file might still be mapped (by this cache, or by other processes), so it's replaced instead
+        // of being written in place
+        const std::string tmp_filepath = filepath + ".tmp";
+        {
+            std::ofstream file( tmp_filepath, std::ios::binary | std::ios::out | std::ios::trunc );
+            if ( !file.is_open() || !file.write( reinterpret_cast<const char*>( buffer.data() ), buffer.size() ) )
+            {
+                LOCO_CORE_ERROR( "TDartSceneCache::Save >>> couldn't write scene-cache {0}", tmp_filepath );
+                return false;
+            }
+        }
+    #if defined( _WIN32 )
+        std::remove( filepath.c_str() );
+    #endif
+        if ( std::rename( tmp_filepath.c_str(), filepath.c_str() ) != 0 )
+        {
+            LOCO_CORE_ERROR( "TDartSceneCache::Save >>> couldn't replace scene-cache {0}", filepath );
+            std::remove( tmp_filepath.c_str() );
+            return false;
+        }
+        m_Dirty = false;
+        return true;
+    }
+
+    dart::dynamics::ShapePtr TDartSceneCache::CreateCollisionShape( const TShapeData& data )
+    {
+        return dartsim::CreateCollisionShape( data, this );
+    }
+
+    const aiScene* TDartSceneCache::LoadMesh( const std::string& filename )
+    {
+        const uint64_t signature = ComputeFileSignature( filename );
+        {
+            // Held while copying the vertex-data, as other threads might replace the entry meanwhile
+            std::lock_guard<std::mutex> lock( m_Mutex );
+            auto it_mesh = m_Meshes.find( filename );
+            if ( it_mesh != m_Meshes.end() && it_mesh->second.signature == signature )
+            {
+                m_NumHits++;
+                const auto& mesh_entry = it_mesh->second;
+                return CreateAssimpSceneFromVertexData( mesh_entry.vertices, mesh_entry.num_vertices,
+                                                        mesh_entry.faces, mesh_entry.num_faces );
+            }
+            m_NumMisses++;
+        }
+
+        // Loaded without holding the lock, so other meshes can be loaded meanwhile (threads loading the same file at
+        // once just load it more than once)
+        const aiScene* assimp_scene = dart::dynamics::MeshShape::loadMesh( filename );
+        if ( !assimp_scene )
+            return nullptr;
+
+        // All meshes of the scene are merged into one (collision-detectors use the meshes and ignore the node-tree)
+        TMeshEntry mesh_entry;
+        mesh_entry.signature = signature;
+        for ( unsigned int m = 0; m < assimp_scene->mNumMeshes; m++ )
+        {
+            const aiMesh* assimp_mesh = assimp_scene->mMeshes[m];
+            const int32_t base_index = mesh_entry.owned_vertices.size() / 3;
+            for ( unsigned int v = 0; v < assimp_mesh->mNumVertices; v++ )
+            {
+                mesh_entry.owned_vertices.push_back( assimp_mesh->mVertices[v].x );
+                mesh_entry.owned_vertices.push_back( assimp_mesh->mVertices[v].y );
+                mesh_entry.owned_vertices.push_back( assimp_mesh->mVertices[v].z );
+            }
+            for ( unsigned int f = 0; f < assimp_mesh->mNumFaces; f++ )
+            {
+                const aiFace& assimp_face = assimp_mesh->mFaces[f];
+                if ( assimp_face.mNumIndices != 3 )
+                    continue;
+                for ( unsigned int k = 0; k < 3; k++ )
+                    mesh_entry.owned_faces.push_back( base_index + int32_t( assimp_face.mIndices[k] ) );
+            }
+        }
+        mesh_entry.vertices = mesh_entry.owned_vertices.data();
+        mesh_entry.faces = mesh_entry.owned_faces.data();
+        mesh_entry.num_vertices = mesh_entry.owned_vertices.size() / 3;
+        mesh_entry.num_faces = mesh_entry.owned_faces.size() / 3;
+        // Buffers are moved along with the entry, so the pointers into them stay valid
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        m_Meshes[filename] = std::move( mesh_entry );
+        m_Dirty = true;
+        return assimp_scene;
+    }
+
+    bool TDartSceneCache::GetInertia( const std::string& body_name, uint64_t signature, dart::dynamics::Inertia& dst_inertia )
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        auto it_inertia = m_Inertias.find( body_name );
+        if ( it_inertia == m_Inertias.end() || it_inertia->second.signature != signature )
+        {
+            m_NumMisses++;
+            return false;
+        }
+
+        m_NumHits++;
+        const double* values = it_inertia->second.values;
+        dst_inertia.setMass( values[0] );
+        dst_inertia.setLocalCOM( Eigen::Vector3d( values[1], values[2], values[3] ) );
+        dst_inertia.setMoment( values[4], values[5], values[6], values[7], values[8], values[9] );
+        return true;
+    }
+
+    void TDartSceneCache::AddInertia( const std::string& body_name, uint64_t signature, const dart::dynamics::Inertia& inertia )
+    {
+        const Eigen::Matrix3d moment = inertia.getMoment();
+        const Eigen::Vector3d com = inertia.getLocalCOM();
+        TInertiaEntry inertia_entry;
+        inertia_entry.signature = signature;
+        const double values[10] = { inertia.getMass(), com.x(), com.y(), com.z(),
+                                    moment( 0, 0 ), moment( 1, 1 ), moment( 2, 2 ),
+                                    moment( 0, 1 ), moment( 0, 2 ), moment( 1, 2 ) };
+        std::copy( values, values + 10, inertia_entry.values );
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        m_Inertias[body_name] = inertia_entry;
+        m_Dirty = true;
+    }
+
+    dart::dynamics::Inertia ComputeBodyInertia( const std::string& body_name,
+                                                const TInertialData& inertia_data,
+                                                const TCollisionData* collision_data,
+                                                const dart::dynamics::ShapePtr& collision_shape,
+                                                TDartSceneCache* scene_cache )
+    {
+        // Inertias computed from (mesh) collision-shapes are expensive, so these are taken from the cache if possible
+        dart::dynamics::Inertia body_inertia;
+        TDartSignature signature;
+        if ( scene_cache )
+        {
+            signature.AddInertia( inertia_data );
+            if ( collision_data )
+            {
+                signature.Add( double( collision_data->density ) );
+                signature.AddShape( *collision_data );
+                _AddMeshFileSignatures( signature, *collision_data );
+            }
+            if ( scene_cache->GetInertia( body_name, signature.value, body_inertia ) )
+                return body_inertia;
+        }
+
+        if ( inertia_data.mass > 0.0f )
+            body_inertia.setMass( inertia_data.mass );
+        else if ( collision_data && collision_shape )
+            body_inertia.setMass( collision_shape->getVolume() * collision_data->density );
+
+        if ( ( inertia_data.ixx > 0.0f ) && ( inertia_data.iyy > 0.0f ) && ( inertia_data.izz > 0.0f ) &&
+             ( inertia_data.ixy >= 0.0f ) && ( inertia_data.ixz >= 0.0f ) && ( inertia_data.iyz >= 0.0f ) )
+            body_inertia.setMoment( inertia_data.ixx, inertia_data.iyy, inertia_data.izz,
+                                    inertia_data.ixy, inertia_data.ixz, inertia_data.iyz );
+        else if ( collision_data && collision_shape )
+            body_inertia.setMoment( collision_shape->computeInertia( body_inertia.getMass() ) );
+
+        if ( scene_cache )
+            scene_cache->AddInertia( body_name, signature.value, body_inertia );
+        return body_inertia;
+    }
+}}
@@ -27,11 +27,19 @@ namespace loco {
         //// boxed_lcp_constraint_solver->setBoxedLcpSolver( std::make_shared<dart::constraint::PgsBoxedLcpSolver>() );
 
         m_DartWorld->getConstraintSolver()->getCollisionOption().collisionFilter = std::make_shared<dartsim::TDartBitmaskCollisionFilter>();
+        m_JointActuators = std::make_unique<kintree::TDartJointActuators>();
+        m_JointSensors = std::make_unique<sensors::TDartJointSensors>();
+        m_BodySensors = std::make_unique<sensors::TDartBodySensors>();
+        m_Queries = std::make_unique<dartsim::TDartQueries>( m_DartWorld.get() );
+        m_StateBuffer = std::make_unique<dartsim::TDartStateBuffer>();
+        m_VisualBuffer = std::make_unique<dartsim::TDartVisualBuffer>();
+        // Shares the workers of the queries, as these aren't used until the world is built
+        m_ParallelBuilder = std::make_unique<dartsim::TDartParallelBuilder>( &m_Queries->thread_pool() );
 
         _CreateSingleBodyAdapters();
         //// _CreateCompoundAdapters();
-        //// _CreateKintreeAdapters();
-        //// _CreateTerrainGeneratorAdapters();
+        _CreateKintreeAdapters();
+        // @note: terrain-generators are created on ->Initialize, as tiled-terrains are registered after construction
 
     #if defined( LOCO_CORE_USE_TRACK_ALLOCS )
         if ( tinyutils::Logger::IsActive() )
@@ -48,13 +56,127 @@ namespace loco {
         {
             auto single_body_adapter = std::make_unique<primitives::TDartSingleBodyAdapter>( single_body );
             single_body->SetBodyAdapter( single_body_adapter.get() );
+            if ( auto collider = single_body->collider() )
+            {
+                m_ParallelBuilder->AddBody( single_body->name(), &single_body->data().inertia, { &collider->data() },
+                                            single_body->dyntype() == eDynamicsType::DYNAMIC );
+                single_body_adapter->SetParallelBuilder( m_ParallelBuilder.get() );
+            }
             m_SingleBodyAdapters.push_back( std::move( single_body_adapter ) );
         }
     }
 
+    void TDartSimulation::_CreateKintreeAdapters()
+    {
+        // Equivalent kintrees (e.g. many copies of the same robot) clone the skeleton of the first one built
+        std::unordered_map<std::string, kintree::TDartKinematicTreeAdapter*> kintree_templates;
+        auto kintrees = m_ScenarioRef->GetKinematicTreesList();
+        for ( auto kintree : kintrees )
+        {
+            auto kintree_adapter = std::make_unique<kintree::TDartKinematicTreeAdapter>( kintree );
+            kintree->SetKinematicTreeAdapter( kintree_adapter.get() );
+
+            const auto signature = kintree::TDartKinematicTreeAdapter::ComputeTemplateSignature( kintree );
+            auto it_template = kintree_templates.find( signature );
+            if ( it_template != kintree_templates.end() )
+            {
+                kintree_adapter->SetTemplate( it_template->second );
+            }
+            else
+            {
+                kintree_templates[signature] = kintree_adapter.get();
+                // Only kintrees that aren't cloned build their own resources
+                std::vector<kintree::TKinematicTreeBody*> bodies_to_register;
+                if ( kintree->root() )
+                    bodies_to_register.push_back( kintree->root() );
+                for ( size_t i = 0; i < bodies_to_register.size(); i++ )
+                {
+                    auto body = bodies_to_register[i];
+                    std::vector<const TCollisionData*> colliders_data;
+                    for ( auto collider : body->colliders() )
+                        colliders_data.push_back( &collider->data() );
+                    m_ParallelBuilder->AddBody( body->name(), &body->data().inertia, colliders_data, true );
+                    for ( auto child : body->children() )
+                        bodies_to_register.push_back( child );
+                }
+                kintree_adapter->SetParallelBuilder( m_ParallelBuilder.get() );
+            }
+
+            m_KinematicTreeAdapters.push_back( std::move( kintree_adapter ) );
+        }
+    }
+
+    void TDartSimulation::_CreateTerrainGeneratorAdapters()
+    {
+        for ( const auto& terrain_data : m_TiledTerrainsData )
+        {
+            auto tiled_terrain = std::make_unique<terrain::TDartTiledTerrain>( terrain_data );
+            if ( !tiled_terrain->valid() )
+            {
+                LOCO_CORE_ERROR( "TDartSimulation::_CreateTerrainGeneratorAdapters >>> couldn't create tiled-terrain {0}", terrain_data.name );
+                continue;
+            }
+            tiled_terrain->SetDartWorld( m_DartWorld.get() );
+            m_TiledTerrains.push_back( std::move( tiled_terrain ) );
+        }
+        _UpdateTerrainTiles();
+    }
+
+    void TDartSimulation::AddTiledTerrain( const terrain::TDartTiledTerrainData& terrain_data )
+    {
+        m_TiledTerrainsData.push_back( terrain_data );
+    }
+
+    terrain::TDartTiledTerrain* TDartSimulation::GetTiledTerrainByName( const std::string& name )
+    {
+        for ( auto& tiled_terrain : m_TiledTerrains )
+            if ( tiled_terrain->name() == name )
+                return tiled_terrain.get();
+        return nullptr;
+    }
+
+    void TDartSimulation::_UpdateTerrainTiles()
+    {
+        if ( m_TiledTerrains.size() < 1 )
+            return;
+
+        // Only bodies that can move around require the terrain to be streamed in around them
+        std::vector<Eigen::Vector3d> focus_points;
+        for ( auto& single_body_adapter : m_SingleBodyAdapters )
+        {
+            auto dart_adapter = static_cast<primitives::TDartSingleBodyAdapter*>( single_body_adapter.get() );
+            if ( dart_adapter->body_node() && dart_adapter->skeleton()->isMobile() && dart_adapter->skeleton()->getNumDofs() > 0 )
+                focus_points.push_back( dart_adapter->body_node()->getTransform().translation() );
+        }
+        for ( auto& kintree_adapter : m_KinematicTreeAdapters )
+        {
+            auto dart_adapter = static_cast<kintree::TDartKinematicTreeAdapter*>( kintree_adapter.get() );
+            if ( dart_adapter->body_adapters().size() > 0 && dart_adapter->skeleton()->isMobile() && dart_adapter->skeleton()->getNumDofs() > 0 )
+                focus_points.push_back( dart_adapter->body_adapters()[0]->body_node()->getTransform().translation() );
+        }
+
+        for ( auto& tiled_terrain : m_TiledTerrains )
+            tiled_terrain->Update( focus_points );
+    }
+
     TDartSimulation::~TDartSimulation()
     {
+        // Any step in flight still uses all resources below
+        _StopStepThread();
+        // Tiles hold references to the world, so release them first
+        m_TiledTerrains.clear();
+        m_JointActuators = nullptr;
+        m_JointSensors = nullptr;
+        m_BodySensors = nullptr;
+        m_Queries = nullptr;
+        m_StateBuffer = nullptr;
+        m_VisualBuffer = nullptr;
+        m_ParallelBuilder = nullptr;
+        m_SingleBodyPool.clear();
+        m_ReplayRecorder = nullptr;
+        m_TrajectoryRecorder = nullptr;
         m_DartWorld = nullptr;
+        m_SceneCache = nullptr;
 
     #if defined( LOCO_CORE_USE_TRACK_ALLOCS )
         if ( tinyutils::Logger::IsActive() )
@@ -72,8 +194,27 @@ namespace loco {
                 dart_adapter->SetDartWorld( m_DartWorld.get() );
         }
 
+        for ( auto& kintree_adapter : m_KinematicTreeAdapters )
+        {
+            if ( auto dart_adapter = dynamic_cast<kintree::TDartKinematicTreeAdapter*>( kintree_adapter.get() ) )
+                dart_adapter->SetDartWorld( m_DartWorld.get() );
+        }
+
+        // All adapters hold their shapes by now
+        m_ParallelBuilder->Release();
+
         // Collect dart-resources from the adapters and assemble any required resources
-        // @todo: implement-me ...
+        _CreateTerrainGeneratorAdapters();
+        _RegisterQueryColliders();
+        _RegisterStateBodies();
+
+        if ( m_SceneCache && m_SceneCache->dirty() )
+        {
+            if ( !m_SceneCache->Save( m_SceneCacheFilepath ) )
+                LOCO_CORE_WARN( "TDartSimulation::_InitializeInternal >>> couldn't write scene-cache {0}", m_SceneCacheFilepath );
+        }
+
+        m_WorldBuilt = true;
 
         LOCO_CORE_TRACE( "Dart-backend >>> gravity      : {0}", ToString( dartsim::vec3_from_eigen( m_DartWorld->getGravity() ) ) );
         LOCO_CORE_TRACE( "Dart-backend >>> time-step    : {0}", std::to_string( m_DartWorld->getTimeStep() ) );
@@ -82,38 +223,380 @@ namespace loco {
         return true;
     }
 
+    void TDartSimulation::_RegisterQueryColliders()
+    {
+        // Shape-nodes are created when the adapters are built, so these are available by now
+        for ( auto single_body : m_ScenarioRef->GetSingleBodiesList() )
+        {
+            auto collider = single_body->collider();
+            auto dart_collider_adapter = static_cast<primitives::TDartSingleBodyColliderAdapter*>( collider->collider_adapter() );
+            m_Queries->RegisterCollider( dart_collider_adapter->shape_node(), collider->name() );
+        }
+
+        for ( auto kintree : m_ScenarioRef->GetKinematicTreesList() )
+        {
+            for ( auto body : kintree->bodies() )
+            {
+                for ( auto collider : body->colliders() )
+                {
+                    auto dart_collider_adapter = static_cast<kintree::TDartKinematicTreeColliderAdapter*>( collider->collider_adapter() );
+                    m_Queries->RegisterCollider( dart_collider_adapter->shape_node(), collider->name() );
+                }
+            }
+        }
+    }
+
+    void TDartSimulation::_RegisterStateBodies()
+    {
+        // Adapters were created in the same order as the bodies|kintrees of the scenario
+        auto single_bodies = m_ScenarioRef->GetSingleBodiesList();
+        for ( size_t i = 0; i < single_bodies.size(); i++ )
+        {
+            auto dart_adapter = static_cast<primitives::TDartSingleBodyAdapter*>( m_SingleBodyAdapters[i].get() );
+            m_StateBuffer->AddBody( dart_adapter->body_node(), single_bodies[i]->name() );
+        }
+
+        auto kintrees = m_ScenarioRef->GetKinematicTreesList();
+        for ( size_t i = 0; i < kintrees.size(); i++ )
+        {
+            // Body-adapters of a kintree are built in breadth-first order (see TDartKinematicTreeAdapter::Build)
+            auto dart_adapter = static_cast<kintree::TDartKinematicTreeAdapter*>( m_KinematicTreeAdapters[i].get() );
+            auto& body_adapters = dart_adapter->body_adapters();
+            std::vector<TKinematicTreeBody*> bodies = { kintrees[i]->root() };
+            for ( size_t j = 0; j < bodies.size() && j < body_adapters.size(); j++ )
+            {
+                m_StateBuffer->AddBody( body_adapters[j]->body_node(), bodies[j]->name() );
+                for ( auto child : bodies[j]->children() )
+                    bodies.push_back( child );
+            }
+        }
+    }
+
+    TSingleBody* TDartSimulation::AddSingleBody( std::unique_ptr<TSingleBody> body )
+    {
+        LOCO_CORE_ASSERT( body, "TDartSimulation::AddSingleBody >>> expected a valid single-body, got nullptr instead" );
+        LOCO_CORE_ASSERT( m_WorldBuilt, "TDartSimulation::AddSingleBody >>> must be called after ->Initialize \
+                          (add body {0} to the scenario instead)", body->name() );
+        LOCO_CORE_ASSERT( !stepping(), "TDartSimulation::AddSingleBody >>> can't add body {0} while a step \
+                          is running. Perhaps missing call to ->Wait()?", body->name() );
+        LOCO_CORE_ASSERT( body->collider(), "TDartSimulation::AddSingleBody >>> single-body {0} doesn't have \
+                          a valid collider (nullptr)", body->name() );
+
+        auto single_body = m_ScenarioRef->AddSingleBody( std::move( body ) );
+
+        std::unique_ptr<primitives::TDartSingleBodyAdapter> single_body_adapter = nullptr;
+        auto it_pool = m_SingleBodyPool.find( primitives::TDartSingleBodyAdapter::ComputePoolSignature( single_body ) );
+        if ( it_pool != m_SingleBodyPool.end() && it_pool->second.size() > 0 )
+        {
+            single_body_adapter = std::move( it_pool->second.back() );
+            it_pool->second.pop_back();
+            single_body_adapter->Rebind( single_body );
+        }
+        else
+        {
+            single_body_adapter = std::make_unique<primitives::TDartSingleBodyAdapter>( single_body );
+            single_body->SetBodyAdapter( single_body_adapter.get() );
+            single_body_adapter->SetSceneCache( m_SceneCache.get() );
+            single_body_adapter->Build();
+        }
+        // Registers the collider in the collision-filter, and adds the skeleton to the world at its initial configuration
+        single_body_adapter->SetDartWorld( m_DartWorld.get() );
+        single_body_adapter->Initialize();
+
+        auto dart_collider_adapter = static_cast<primitives::TDartSingleBodyColliderAdapter*>( single_body->collider()->collider_adapter() );
+        m_Queries->RegisterCollider( dart_collider_adapter->shape_node(), single_body->collider()->name() );
+        m_StateBuffer->AddBody( single_body_adapter->body_node(), single_body->name() );
+        m_SingleBodyAdapters.push_back( std::move( single_body_adapter ) );
+        _StopRecordingsOnBodiesChanged( "TDartSimulation::AddSingleBody" );
+        return single_body;
+    }
+
+    bool TDartSimulation::RemoveSingleBody( const std::string& name )
+    {
+        LOCO_CORE_ASSERT( m_WorldBuilt, "TDartSimulation::RemoveSingleBody >>> must be called after ->Initialize \
+                          (remove body {0} from the scenario instead)", name );
+        LOCO_CORE_ASSERT( !stepping(), "TDartSimulation::RemoveSingleBody >>> can't remove body {0} while a step \
+                          is running. Perhaps missing call to ->Wait()?", name );
+
+        // Adapters are kept in the same order as the bodies of the scenario (see ->_RegisterStateBodies)
+        auto single_bodies = m_ScenarioRef->GetSingleBodiesList();
+        ssize_t body_index = -1;
+        for ( size_t i = 0; i < single_bodies.size() && body_index < 0; i++ )
+            if ( single_bodies[i]->name() == name )
+                body_index = i;
+        if ( body_index < 0 )
+        {
+            LOCO_CORE_WARN( "TDartSimulation::RemoveSingleBody >>> single-body {0} not found", name );
+            return false;
+        }
+
+        auto single_body = single_bodies[body_index];
+        auto dart_adapter = static_cast<primitives::TDartSingleBodyAdapter*>( m_SingleBodyAdapters[body_index].get() );
+        auto dart_collider_adapter = static_cast<primitives::TDartSingleBodyColliderAdapter*>( single_body->collider()->collider_adapter() );
+        m_Queries->UnregisterCollider( dart_collider_adapter->shape_node() );
+        // The body-node is kept (pooled) or destroyed, so sensors can't keep pointing to it
+        const ssize_t num_sensors_removed = m_BodySensors->RemoveSensorsOf( dart_adapter->body_node() );
+        if ( num_sensors_removed > 0 )
+            LOCO_CORE_WARN( "TDartSimulation::RemoveSingleBody >>> removed {0} sensor(s) attached to body {1}",
+                            num_sensors_removed, name );
+        m_StateBuffer->RemoveBody( name );
+        dart_adapter->RemoveFromWorld();
+
+        // The adapter outlives the body (either pooled, or destroyed right below), so both are detached first
+        const uint64_t pool_signature = primitives::TDartSingleBodyAdapter::ComputePoolSignature( single_body );
+        single_body->DetachSim();
+        dart_adapter->OnDetach();
+        dart_collider_adapter->OnDetach();
+
+        std::unique_ptr<primitives::TDartSingleBodyAdapter> single_body_adapter(
+                static_cast<primitives::TDartSingleBodyAdapter*>( m_SingleBodyAdapters[body_index].release() ) );
+        m_SingleBodyAdapters.erase( m_SingleBodyAdapters.begin() + body_index );
+        if ( pool_signature != 0 )
+            m_SingleBodyPool[pool_signature].push_back( std::move( single_body_adapter ) );
+
+        m_ScenarioRef->RemoveSingleBodyByName( name );
+        _StopRecordingsOnBodiesChanged( "TDartSimulation::RemoveSingleBody" );
+        return true;
+    }
+
+    ssize_t TDartSimulation::num_pooled_bodies() const
+    {
+        ssize_t num_pooled = 0;
+        for ( const auto& pool_entry : m_SingleBodyPool )
+            num_pooled += pool_entry.second.size();
+        return num_pooled;
+    }
+
+    void TDartSimulation::_StopRecordingsOnBodiesChanged( const std::string& caller )
+    {
+        // Replay-logs and trajectory files are laid out for a fixed set of bodies
+        if ( m_ReplayRecorder )
+        {
+            LOCO_CORE_WARN( "{0} >>> bodies changed, stopping replay recording", caller );
+            m_ReplayRecorder = nullptr;
+        }
+        if ( m_TrajectoryRecorder )
+        {
+            LOCO_CORE_WARN( "{0} >>> bodies changed, stopping trajectory recording", caller );
+            m_TrajectoryRecorder = nullptr;
+        }
+    }
+
+    void TDartSimulation::EnableRealtimePacing( const dartsim::TDartRealtimeData& data )
+    {
+        m_RealtimePacer = std::make_unique<dartsim::TDartRealtimePacer>( data );
+        m_RealtimePacer->Start( m_WorldTime );
+    }
+
+    bool TDartSimulation::StartReplayRecording( const std::string& filepath, ssize_t keyframe_interval )
+    {
+        m_ReplayRecorder = std::make_unique<dartsim::TDartReplayRecorder>( m_DartWorld.get(), filepath, keyframe_interval );
+        if ( !m_ReplayRecorder->valid() )
+        {
+            m_ReplayRecorder = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    bool TDartSimulation::StartTrajectoryRecording( const std::string& filepath, const dartsim::TDartTrajectoryData& data )
+    {
+        std::vector<std::string> body_names;
+        for ( ssize_t i = 0; i < m_StateBuffer->num_bodies(); i++ )
+            body_names.push_back( m_StateBuffer->body_name( i ) );
+        m_TrajectoryRecorder = std::make_unique<dartsim::TDartTrajectoryRecorder>( filepath, body_names, data );
+        if ( !m_TrajectoryRecorder->valid() )
+        {
+            m_TrajectoryRecorder = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    bool TDartSimulation::UseSceneCache( const std::string& filepath )
+    {
+        LOCO_CORE_ASSERT( m_DartWorld->getNumSkeletons() == 0, "TDartSimulation::UseSceneCache >>> \
+                          must be called before ->Initialize" );
+
+        m_SceneCache = std::make_unique<dartsim::TDartSceneCache>();
+        m_SceneCacheFilepath = filepath;
+        // A missing (or stale) file is fine, as it gets written once the world is built
+        const bool loaded = m_SceneCache->Load( filepath );
+        m_ParallelBuilder->SetSceneCache( m_SceneCache.get() );
+
+        for ( auto& single_body_adapter : m_SingleBodyAdapters )
+        {
+            if ( auto dart_adapter = dynamic_cast<primitives::TDartSingleBodyAdapter*>( single_body_adapter.get() ) )
+                dart_adapter->SetSceneCache( m_SceneCache.get() );
+        }
+        for ( auto& kintree_adapter : m_KinematicTreeAdapters )
+        {
+            if ( auto dart_adapter = dynamic_cast<kintree::TDartKinematicTreeAdapter*>( kintree_adapter.get() ) )
+                dart_adapter->SetSceneCache( m_SceneCache.get() );
+        }
+        return loaded;
+    }
+
+    void TDartSimulation::StepAsync( const TScalar& dt )
+    {
+        if ( stepping() )
+        {
+            LOCO_CORE_WARN( "TDartSimulation::StepAsync >>> a step is still running, waiting for it to finish" );
+            Wait();
+        }
+
+        if ( !m_StepThread.joinable() )
+            m_StepThread = std::thread( &TDartSimulation::_StepThreadLoop, this );
+
+        {
+            std::lock_guard<std::mutex> lock( m_StepMutex );
+            m_StepAsyncDt = dt;
+            m_StepPending = true;
+        }
+        m_StepCondition.notify_all();
+    }
+
+    void TDartSimulation::Wait()
+    {
+        std::unique_lock<std::mutex> lock( m_StepMutex );
+        m_StepCondition.wait( lock, [this] { return !m_StepPending; } );
+    }
+
+    bool TDartSimulation::stepping() const
+    {
+        std::lock_guard<std::mutex> lock( m_StepMutex );
+        return m_StepPending;
+    }
+
+    void TDartSimulation::_StepThreadLoop()
+    {
+        std::unique_lock<std::mutex> lock( m_StepMutex );
+        while ( true )
+        {
+            m_StepCondition.wait( lock, [this] { return m_StepPending || m_StepThreadStop; } );
+            if ( m_StepThreadStop )
+                break;
+
+            // Same step as the synchronous one (wrappers and adapters included), publishing the state at the end
+            lock.unlock();
+            Step( m_StepAsyncDt );
+            lock.lock();
+
+            m_StepPending = false;
+            m_StepCondition.notify_all();
+        }
+    }
+
+    void TDartSimulation::_StopStepThread()
+    {
+        if ( !m_StepThread.joinable() )
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock( m_StepMutex );
+            m_StepThreadStop = true;
+        }
+        m_StepCondition.notify_all();
+        m_StepThread.join();
+    }
+
+    ssize_t TDartSimulation::RegisterDistancePair( const std::string& collider_a, const std::string& collider_b )
+    {
+        return RegisterDistanceGroup( collider_a, { collider_b } );
+    }
+
+    ssize_t TDartSimulation::RegisterDistanceGroup( const std::string& collider_a, const std::vector<std::string>& colliders_b )
+    {
+        const ssize_t collider_id_a = m_Queries->collider_id( collider_a );
+        if ( collider_id_a < 0 )
+        {
+            LOCO_CORE_WARN( "TDartSimulation::RegisterDistanceGroup >>> collider {0} not found. Perhaps the \
+                             simulation hasn't been initialized yet?", collider_a );
+            return -1;
+        }
+
+        std::vector<ssize_t> collider_ids_b;
+        for ( const auto& collider_b : colliders_b )
+        {
+            const ssize_t collider_id_b = m_Queries->collider_id( collider_b );
+            if ( collider_id_b < 0 )
+                LOCO_CORE_WARN( "TDartSimulation::RegisterDistanceGroup >>> collider {0} not found, skipping", collider_b );
+            else
+                collider_ids_b.push_back( collider_id_b );
+        }
+        return m_Queries->RegisterDistanceGroup( collider_id_a, collider_ids_b );
+    }
+
     void TDartSimulation::_CollectContacts()
     {
         LOCO_CORE_ASSERT( m_DartWorld, "TDartSimulation::_CollectContacts >>> dart-world object \
                            is required, but got nullptr instead" );
 
+        // Colliders are identified by their shape-nodes (shapes might be shared among kintree instances), and
+        // terrain tiles by their shapes (shape-nodes of evicted tiles are reused by other tiles)
+        std::unordered_map<const dart::dynamics::ShapeFrame*, std::string> shape_frame_to_collider;
         std::unordered_map<const dart::dynamics::Shape*, std::string> shape_to_collider;
         auto single_bodies = m_ScenarioRef->GetSingleBodiesList();
         for ( auto single_body : single_bodies )
         {
             auto collider = single_body->collider();
             auto dart_collider_adapter = static_cast<primitives::TDartSingleBodyColliderAdapter*>( collider->collider_adapter() );
-            const dart::dynamics::Shape* dart_collider_shape = dart_collider_adapter->collision_shape().get();
-            shape_to_collider[dart_collider_shape] = collider->name();
+            shape_frame_to_collider[dart_collider_adapter->shape_node()] = collider->name();
+        }
+
+        auto kintrees = m_ScenarioRef->GetKinematicTreesList();
+        for ( auto kintree : kintrees )
+        {
+            for ( auto body : kintree->bodies() )
+            {
+                for ( auto collider : body->colliders() )
+                {
+                    auto dart_collider_adapter = static_cast<kintree::TDartKinematicTreeColliderAdapter*>( collider->collider_adapter() );
+                    shape_frame_to_collider[dart_collider_adapter->shape_node()] = collider->name();
+                }
+            }
         }
 
+        std::vector<const dart::dynamics::Shape*> terrain_shapes;
+        for ( auto& tiled_terrain : m_TiledTerrains )
+        {
+            terrain_shapes.clear();
+            tiled_terrain->GetActiveShapes( terrain_shapes );
+            for ( auto terrain_shape : terrain_shapes )
+                shape_to_collider[terrain_shape] = tiled_terrain->name();
+        }
+
+        auto find_collider_name = [&]( const dart::collision::CollisionObject* object, std::string& dst_name ) -> bool
+            {
+                auto it_frame = shape_frame_to_collider.find( object->getShapeFrame() );
+                if ( it_frame != shape_frame_to_collider.end() )
+                {
+                    dst_name = it_frame->second;
+                    return true;
+                }
+                auto it_shape = shape_to_collider.find( object->getShape().get() );
+                if ( it_shape != shape_to_collider.end() )
+                {
+                    dst_name = it_shape->second;
+                    return true;
+                }
+                return false;
+            };
+
         std::map< std::string, std::vector<TContactData> > detected_contacts;
         const auto& collision_result = m_DartWorld->getLastCollisionResult();
         const size_t num_contacts = collision_result.getNumContacts();
         for ( size_t i = 0; i < num_contacts; i++ )
         {
             const auto& contact_info = collision_result.getContact( i );
-            const dart::dynamics::Shape* collider_shape_1 = contact_info.collisionObject1->getShape().get();
-            const dart::dynamics::Shape* collider_shape_2 = contact_info.collisionObject2->getShape().get();
-            if ( ( shape_to_collider.find( collider_shape_1 ) == shape_to_collider.end() ) ||
-                 ( shape_to_collider.find( collider_shape_2 ) == shape_to_collider.end() ) )
+            std::string collider_1, collider_2;
+            if ( !find_collider_name( contact_info.collisionObject1, collider_1 ) ||
+                 !find_collider_name( contact_info.collisionObject2, collider_2 ) )
             {
                 LOCO_CORE_WARN( "TDartSimulation::_CollectContacts >>> a contact is dangling without a contact-pair" );
                 continue;
             }
 
-            const std::string collider_1 = shape_to_collider[collider_shape_1];
-            const std::string collider_2 = shape_to_collider[collider_shape_2];
             const TVec3 position = dartsim::vec3_from_eigen( contact_info.point );
             const TVec3 normal = dartsim::vec3_from_eigen( contact_info.normal );
 
@@ -140,11 +623,32 @@ namespace loco {
             if ( detected_contacts.find( collider_name ) != detected_contacts.end() )
                 collider->contacts() = detected_contacts[collider_name];
         }
+
+        for ( auto kintree : kintrees )
+        {
+            for ( auto body : kintree->bodies() )
+            {
+                for ( auto collider : body->colliders() )
+                {
+                    collider->contacts().clear();
+                    if ( detected_contacts.find( collider->name() ) != detected_contacts.end() )
+                        collider->contacts() = detected_contacts[collider->name()];
+                }
+            }
+        }
     }
 
     void TDartSimulation::_PreStepInternal()
     {
-        // Do nothing here, as call to wrappers is enough (made in base)
+        // Calls to wrappers are made in base. Here we only apply the collision group|mask changes made since the
+        // last step, by refreshing the broadphase-proxies of the related bullet collision-objects
+        auto constraint_solver = m_DartWorld->getConstraintSolver();
+        auto collision_filter = dynamic_cast<dartsim::TDartBitmaskCollisionFilter*>(
+                                        constraint_solver->getCollisionOption().collisionFilter.get() );
+        auto bullet_collision_group = dynamic_cast<dart::collision::BulletCollisionGroup*>(
+                                        constraint_solver->getCollisionGroup().get() );
+        if ( collision_filter && bullet_collision_group )
+            collision_filter->refreshBroadphase( bullet_collision_group->getBulletCollisionWorld() );
     }
 
     void TDartSimulation::_SimStepInternal( const TScalar& dt )
@@ -152,23 +656,162 @@ namespace loco {
         LOCO_CORE_ASSERT( m_DartWorld, "TDartSimulation::_SimStepInternal >>> \
                           dart-world is required, but got nullptr instead" );
         const double sim_step_time = ( dt <= 0 ) ? m_FixedTimeStep : dt;
-        const double sim_start_time = m_DartWorld->getTime();
-        const ssize_t sim_num_substeps = ssize_t(sim_step_time / m_FixedTimeStep);
+        if ( m_AdaptiveSubstepping )
+        {
+            _AdaptiveStep( sim_step_time );
+            return;
+        }
+
+        // Time that doesn't make up a full substep is carried over to the next steps (instead of being dropped)
+        m_SubstepRemainder += sim_step_time;
+        const ssize_t sim_num_substeps = ssize_t( std::floor( m_SubstepRemainder / m_FixedTimeStep + 1e-6 ) );
+        m_SubstepRemainder = std::max( 0.0, m_SubstepRemainder - sim_num_substeps * m_FixedTimeStep );
         for ( ssize_t i = sim_num_substeps - 1; i >= 0; i-- )
+            _SubStep( (i == 0) );
+
+        m_SubstepStats.num_substeps = sim_num_substeps;
+        m_SubstepStats.substep_dt = m_FixedTimeStep;
+        m_SubstepStats.total_substeps += sim_num_substeps;
+    }
+
+    void TDartSimulation::_AdaptiveStep( double step_time )
+    {
+        const ssize_t num_substeps = m_AdaptiveNumSubsteps;
+        const double substep_dt = step_time / num_substeps;
+        m_DartWorld->setTimeStep( substep_dt );
+
+        m_SubstepStats.max_penetration = 0.0;
+        m_SubstepStats.max_displacement = 0.0;
+        m_SubstepStats.max_constraint_error = 0.0;
+        for ( ssize_t i = num_substeps - 1; i >= 0; i-- )
         {
-            m_DartWorld->step( (i == 0) );
-            m_WorldTime += m_FixedTimeStep;
+            _SubStep( (i == 0) );
+            _MeasureSubstepErrors( substep_dt );
         }
+
+        const auto& data = m_AdaptiveSubstepData;
+        m_SubstepStats.num_substeps = num_substeps;
+        m_SubstepStats.substep_dt = substep_dt;
+        m_SubstepStats.total_substeps += num_substeps;
+        m_SubstepStats.error_ratio = std::max( { m_SubstepStats.max_penetration / data.max_penetration,
+                                                 m_SubstepStats.max_displacement / data.max_displacement,
+                                                 m_SubstepStats.max_constraint_error / data.max_constraint_error } );
+
+        // Errors are only known after the step, so these drive the substeps of the next one (raised quickly and
+        // lowered slowly, to avoid oscillating around the thresholds)
+        if ( m_SubstepStats.error_ratio > 1.0 )
+            m_AdaptiveNumSubsteps = std::min( data.max_substeps, 2 * num_substeps );
+        else if ( m_SubstepStats.error_ratio < data.lower_ratio )
+            m_AdaptiveNumSubsteps = std::max( data.min_substeps, num_substeps - 1 );
+    }
+
+    void TDartSimulation::_MeasureSubstepErrors( double substep_dt )
+    {
+        const auto& collision_result = m_DartWorld->getLastCollisionResult();
+        for ( size_t i = 0; i < collision_result.getNumContacts(); i++ )
+            m_SubstepStats.max_penetration = std::max( m_SubstepStats.max_penetration,
+                                                       collision_result.getContact( i ).penetrationDepth );
+
+        for ( size_t i = 0; i < m_DartWorld->getNumSkeletons(); i++ )
+        {
+            auto skeleton = m_DartWorld->getSkeleton( i );
+            if ( skeleton->getNumDofs() < 1 )
+                continue;
+
+            // Read dof by dof, as ->getPositions() and the like allocate a new vector on every call (measured on every
+            // substep). Unlimited dofs have infinite limits, so never show up as violations
+            for ( size_t j = 0; j < skeleton->getNumDofs(); j++ )
+            {
+                const auto dof = skeleton->getDof( j );
+                const double position = dof->getPosition();
+                const double displacement = std::abs( dof->getVelocity() ) * substep_dt;
+                const double constraint_error = std::max( position - dof->getPositionUpperLimit(),
+                                                          dof->getPositionLowerLimit() - position );
+                m_SubstepStats.max_displacement = std::max( m_SubstepStats.max_displacement, displacement );
+                m_SubstepStats.max_constraint_error = std::max( m_SubstepStats.max_constraint_error, constraint_error );
+            }
+        }
+    }
+
+    void TDartSimulation::EnableAdaptiveSubstepping( const dartsim::TDartAdaptiveSubstepData& data )
+    {
+        if ( data.min_substeps < 1 || data.max_substeps < data.min_substeps )
+        {
+            LOCO_CORE_WARN( "TDartSimulation::EnableAdaptiveSubstepping >>> invalid range of substeps [{0}, {1}]",
+                            data.min_substeps, data.max_substeps );
+            return;
+        }
+        // Errors are divided by the thresholds, so these must be positive (infinity disables a threshold)
+        if ( !( data.max_penetration > 0.0 ) || !( data.max_displacement > 0.0 ) || !( data.max_constraint_error > 0.0 ) )
+        {
+            LOCO_CORE_WARN( "TDartSimulation::EnableAdaptiveSubstepping >>> thresholds must be positive, got penetration={0}, "
+                            "displacement={1}, constraint-error={2}", data.max_penetration, data.max_displacement,
+                            data.max_constraint_error );
+            return;
+        }
+        if ( !( data.lower_ratio >= 0.0 ) || !( data.lower_ratio < 1.0 ) )
+        {
+            LOCO_CORE_WARN( "TDartSimulation::EnableAdaptiveSubstepping >>> lower-ratio must be in [0, 1), got {0}",
+                            data.lower_ratio );
+            return;
+        }
+
+        m_AdaptiveSubstepping = true;
+        m_AdaptiveSubstepData = data;
+        m_AdaptiveNumSubsteps = data.min_substeps;
+    }
+
+    void TDartSimulation::DisableAdaptiveSubstepping()
+    {
+        m_AdaptiveSubstepping = false;
+        m_SubstepStats.max_penetration = 0.0;
+        m_SubstepStats.max_displacement = 0.0;
+        m_SubstepStats.max_constraint_error = 0.0;
+        m_SubstepStats.error_ratio = 0.0;
+        m_DartWorld->setTimeStep( m_FixedTimeStep );
+    }
+
+    void TDartSimulation::_SubStep( bool reset_commands )
+    {
+        // Actuators run at the physics rate, so high-gain PD controllers stay stable at larger control periods
+        m_JointActuators->Evaluate();
+        m_JointSensors->RecordCommands();
+        if ( m_ReplayRecorder )
+            m_ReplayRecorder->RecordSubstep( reset_commands );
+        m_DartWorld->step( reset_commands );
+        m_WorldTime += m_DartWorld->getTimeStep();
+        if ( m_ReplayRecorder )
+            m_ReplayRecorder->RecordPostSubstep();
+        m_JointSensors->RecordState( m_DartWorld->getTime() );
     }
 
     void TDartSimulation::_PostStepInternal()
     {
         _CollectContacts();
+        _UpdateTerrainTiles();
+        m_BodySensors->Update( m_DartWorld->getGravity(), m_DartWorld->getTime() );
+        m_StateBuffer->Publish( m_DartWorld->getTime(), m_DartWorld->getLastCollisionResult(), *m_Queries );
+        m_VisualBuffer->Publish( m_DartWorld->getTime(), m_StateBuffer->body_nodes() );
+        if ( m_TrajectoryRecorder )
+            m_TrajectoryRecorder->Record( m_StateBuffer->front() );
+        // Pacing goes last, so the published state is available while waiting for the wall-clock
+        if ( m_RealtimePacer )
+            m_RealtimePacer->Pace( m_WorldTime );
     }
 
     void TDartSimulation::_ResetInternal()
     {
         // @todo: reset loco-contact-manager
+        m_JointSensors->Clear();
+        m_BodySensors->Reset();
+        m_SubstepRemainder = 0.0;
+        m_AdaptiveNumSubsteps = m_AdaptiveSubstepData.min_substeps;
+        if ( m_RealtimePacer )
+            m_RealtimePacer->Start( m_WorldTime );
+        // Bodies were placed back by their adapters, so readers of the published state see the reset right away
+        // (contacts of the last step are stale by now)
+        m_StateBuffer->Publish( m_DartWorld->getTime(), dart::collision::CollisionResult(), *m_Queries );
+        m_VisualBuffer->Publish( m_DartWorld->getTime(), m_StateBuffer->body_nodes() );
     }
 
     void TDartSimulation::_SetTimeStepInternal( const TScalar& time_step )
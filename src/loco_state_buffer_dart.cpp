@@ -0,0 +1,168 @@
+
+#include <loco_state_buffer_dart.h>
+
+namespace loco {
+namespace dartsim {
+
+    ssize_t TDartStateBuffer::AddBody( const dart::dynamics::BodyNode* bodynode, const std::string& name )
+    {
+        if ( !bodynode )
+        {
+            LOCO_CORE_WARN( "TDartStateBuffer::AddBody >>> expected a valid body-node for body {0}", name );
+            return -1;
+        }
+
+        const ssize_t body_index = m_BodyNodes.size();
+        m_BodyNodes.push_back( bodynode );
+        m_BodyNames.push_back( name );
+        m_BodyIndices[name] = body_index;
+        for ( auto& snapshot : m_Snapshots )
+        {
+            snapshot.poses.conservativeResize( body_index + 1, Eigen::NoChange );
+            snapshot.velocities.conservativeResize( body_index + 1, Eigen::NoChange );
+            snapshot.poses.row( body_index ) << 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0;
+            snapshot.velocities.row( body_index ).setZero();
+        }
+        return body_index;
+    }
+
+    bool TDartStateBuffer::RemoveBody( const std::string& name )
+    {
+        const ssize_t body_index = this->body_index( name );
+        if ( body_index < 0 )
+            return false;
+
+        const ssize_t num_rows_after = m_BodyNodes.size() - body_index - 1;
+        m_BodyNodes.erase( m_BodyNodes.begin() + body_index );
+        m_BodyNames.erase( m_BodyNames.begin() + body_index );
+        m_BodyIndices.erase( name );
+        for ( ssize_t i = body_index; i < (ssize_t)m_BodyNames.size(); i++ )
+            m_BodyIndices[m_BodyNames[i]] = i;
+        for ( auto& snapshot : m_Snapshots )
+        {
+            // Blocks are copied through temporaries, as source and destination rows overlap
+            snapshot.poses.middleRows( body_index, num_rows_after ) = snapshot.poses.bottomRows( num_rows_after ).eval();
+            snapshot.velocities.middleRows( body_index, num_rows_after ) = snapshot.velocities.bottomRows( num_rows_after ).eval();
+            snapshot.poses.conservativeResize( m_BodyNodes.size(), Eigen::NoChange );
+            snapshot.velocities.conservativeResize( m_BodyNodes.size(), Eigen::NoChange );
+        }
+        return true;
+    }
+
+    void TDartStateBuffer::Publish( double time, const dart::collision::CollisionResult& collision_result, const TDartQueries& queries )
+    {
+        // Only the stepping thread publishes, so the back snapshot can be written with no synchronization
+        const int back_index = 1 - m_FrontIndex.load( std::memory_order_relaxed );
+        auto& snapshot = m_Snapshots[back_index];
+        // Odd version while writing, so copies of this snapshot still in flight (from when it was the front one)
+        // notice they overlapped with this write
+        auto& version = m_Versions[back_index];
+        version.store( version.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+        std::atomic_thread_fence( std::memory_order_release );
+        snapshot.time = time;
+        snapshot.sequence = m_NumPublished++;
+
+        const ssize_t num_bodies = m_BodyNodes.size();
+        for ( ssize_t i = 0; i < num_bodies; i++ )
+        {
+            const auto& tf_world = m_BodyNodes[i]->getWorldTransform();
+            const Eigen::Quaterniond quat( tf_world.linear() );
+            snapshot.poses.block<1, 3>( i, 0 ) = tf_world.translation().transpose();
+            snapshot.poses.block<1, 4>( i, 3 ) = quat.coeffs().transpose();
+            snapshot.velocities.block<1, 3>( i, 0 ) = m_BodyNodes[i]->getLinearVelocity().transpose();
+            snapshot.velocities.block<1, 3>( i, 3 ) = m_BodyNodes[i]->getAngularVelocity().transpose();
+        }
+
+        // Capacity of the contacts-buffer is kept between publishes, so steady-state publishing doesn't allocate
+        const size_t num_contacts = collision_result.getNumContacts();
+        if ( num_contacts > snapshot.contacts.capacity() )
+        {
+            std::vector<TDartContactState> contacts;
+            contacts.reserve( 2 * num_contacts );
+            m_RetiredContacts[back_index].push_back( std::move( snapshot.contacts ) );
+            snapshot.contacts = std::move( contacts );
+            m_ContactsData[back_index].store( snapshot.contacts.data(), std::memory_order_release );
+        }
+        snapshot.contacts.clear();
+        for ( size_t i = 0; i < num_contacts; i++ )
+        {
+            const auto& contact_info = collision_result.getContact( i );
+            TDartContactState contact;
+            contact.collider_id_1 = queries.collider_id( contact_info.collisionObject1->getShapeFrame() );
+            contact.collider_id_2 = queries.collider_id( contact_info.collisionObject2->getShapeFrame() );
+            contact.position = contact_info.point;
+            contact.normal = contact_info.normal;
+            snapshot.contacts.push_back( contact );
+        }
+        m_NumContacts[back_index].store( num_contacts, std::memory_order_release );
+
+        version.store( version.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+        m_FrontIndex.store( back_index, std::memory_order_release );
+    }
+
+    void TDartStateBuffer::CopyFront( TDartStateSnapshot& dst_snapshot ) const
+    {
+        while ( true )
+        {
+            const int front_index = m_FrontIndex.load( std::memory_order_acquire );
+            const uint64_t version_start = m_Versions[front_index].load( std::memory_order_acquire );
+            // Written right now (it stopped being the front one since the index was loaded)
+            if ( version_start & 1 )
+                continue;
+
+            const auto& snapshot = m_Snapshots[front_index];
+            dst_snapshot.time = snapshot.time;
+            dst_snapshot.sequence = snapshot.sequence;
+            dst_snapshot.poses = snapshot.poses;
+            dst_snapshot.velocities = snapshot.velocities;
+            // Count first, storage after: storage only grows, and is stored before any count that needs it, so the
+            // storage loaded here has room for the count loaded here (even if publishes happened in between)
+            const size_t num_contacts = m_NumContacts[front_index].load( std::memory_order_acquire );
+            const TDartContactState* contacts_data = m_ContactsData[front_index].load( std::memory_order_acquire );
+            dst_snapshot.contacts.assign( contacts_data, contacts_data + num_contacts );
+
+            std::atomic_thread_fence( std::memory_order_acquire );
+            if ( m_Versions[front_index].load( std::memory_order_relaxed ) == version_start )
+                return;
+        }
+    }
+
+    ssize_t TDartStateBuffer::body_index( const std::string& name ) const
+    {
+        auto it_body = m_BodyIndices.find( name );
+        return ( it_body != m_BodyIndices.end() ) ? it_body->second : -1;
+    }
+
+    // Flag set on the middle frame when it has been published but not acquired yet
+    const int LOCO_DART_VISUAL_FRAME_FRESH = 4;
+    const int LOCO_DART_VISUAL_FRAME_INDEX_MASK = 3;
+
+    TDartVisualBuffer::TDartVisualBuffer()
+        : m_BackIndex( 0 ), m_FrontIndex( 1 ), m_MiddleIndex( 2 )
+    {
+    }
+
+    void TDartVisualBuffer::Publish( double time, const std::vector<const dart::dynamics::BodyNode*>& body_nodes )
+    {
+        auto& frame = m_Frames[m_BackIndex];
+        frame.time = time;
+        frame.sequence = m_NumPublished++;
+        frame.transforms.resize( body_nodes.size() );
+        for ( size_t i = 0; i < body_nodes.size(); i++ )
+            frame.transforms[i] = mat4_from_eigen_tf( body_nodes[i]->getWorldTransform() );
+
+        // Swap the back frame with the middle one, which becomes the producer's next back frame
+        const int prev_middle = m_MiddleIndex.exchange( m_BackIndex | LOCO_DART_VISUAL_FRAME_FRESH, std::memory_order_acq_rel );
+        m_BackIndex = prev_middle & LOCO_DART_VISUAL_FRAME_INDEX_MASK;
+    }
+
+    const TDartVisualFrame& TDartVisualBuffer::Acquire()
+    {
+        if ( m_MiddleIndex.load( std::memory_order_relaxed ) & LOCO_DART_VISUAL_FRAME_FRESH )
+        {
+            const int prev_middle = m_MiddleIndex.exchange( m_FrontIndex, std::memory_order_acq_rel );
+            m_FrontIndex = prev_middle & LOCO_DART_VISUAL_FRAME_INDEX_MASK;
+        }
+        return m_Frames[m_FrontIndex];
+    }
+}}
@@ -0,0 +1,392 @@
+
+#include <loco_trajectory_dart.h>
+#include <loco_serialization_dart.h>
+
+#include <cstring>
+
+namespace loco {
+namespace dartsim {
+
+    // Size of the header of every frame: type (uint8) and payload size (uint32)
+    const size_t LOCO_DART_TRAJECTORY_FRAME_HEADER_SIZE = sizeof( uint8_t ) + sizeof( uint32_t );
+    // Quantized values stored per body: position (3), packed quaternion (1) and velocity (6)
+    const ssize_t LOCO_DART_TRAJECTORY_VALUES_PER_BODY = 10;
+    // Bits used by each of the three components of a packed quaternion
+    const uint32_t LOCO_DART_QUAT_COMPONENT_BITS = 10;
+    const uint32_t LOCO_DART_QUAT_COMPONENT_MAX = ( 1u << LOCO_DART_QUAT_COMPONENT_BITS ) - 1;
+
+    // Upper bound of the payload of a frame: time, and per body the changed-flag, nine varints and a quaternion
+    static size_t _MaxPayloadSize( ssize_t num_bodies )
+    {
+        return sizeof( double ) + num_bodies * ( sizeof( uint8_t ) + 9 * 10 + sizeof( uint32_t ) );
+    }
+
+    uint32_t QuantizeQuaternion( const Eigen::Vector4d& quat )
+    {
+        // q and -q are the same rotation, so the largest component is made positive and left out
+        Eigen::Vector4d quat_normalized = quat.normalized();
+        Eigen::Index largest_index;
+        quat_normalized.cwiseAbs().maxCoeff( &largest_index );
+        if ( quat_normalized[largest_index] < 0.0 )
+            quat_normalized = -quat_normalized;
+
+        // The other three components lie in [-1/sqrt(2), 1/sqrt(2)]
+        uint32_t packed_quat = uint32_t( largest_index ) << ( 3 * LOCO_DART_QUAT_COMPONENT_BITS );
+        uint32_t shift = 2 * LOCO_DART_QUAT_COMPONENT_BITS;
+        for ( Eigen::Index i = 0; i < 4; i++ )
+        {
+            if ( i == largest_index )
+                continue;
+            const double normalized = std::min( std::max( 0.5 * ( quat_normalized[i] * std::sqrt( 2.0 ) + 1.0 ), 0.0 ), 1.0 );
+            packed_quat |= uint32_t( std::lround( normalized * LOCO_DART_QUAT_COMPONENT_MAX ) ) << shift;
+            shift -= LOCO_DART_QUAT_COMPONENT_BITS;
+        }
+        return packed_quat;
+    }
+
+    Eigen::Vector4d DequantizeQuaternion( uint32_t packed_quat )
+    {
+        Eigen::Vector4d quat;
+        const Eigen::Index largest_index = packed_quat >> ( 3 * LOCO_DART_QUAT_COMPONENT_BITS );
+        uint32_t shift = 2 * LOCO_DART_QUAT_COMPONENT_BITS;
+        double sum_squares = 0.0;
+        for ( Eigen::Index i = 0; i < 4; i++ )
+        {
+            if ( i == largest_index )
+                continue;
+            const double normalized = double( ( packed_quat >> shift ) & LOCO_DART_QUAT_COMPONENT_MAX ) / LOCO_DART_QUAT_COMPONENT_MAX;
+            quat[i] = ( 2.0 * normalized - 1.0 ) / std::sqrt( 2.0 );
+            sum_squares += quat[i] * quat[i];
+            shift -= LOCO_DART_QUAT_COMPONENT_BITS;
+        }
+        quat[largest_index] = std::sqrt( std::max( 1.0 - sum_squares, 0.0 ) );
+        return quat.normalized();
+    }
+
+    /***********************************************************************************************
+    *                                    Trajectory Recorder                                       *
+    ***********************************************************************************************/
+
+    TDartTrajectoryRecorder::TDartTrajectoryRecorder( const std::string& filepath,
+                                                      const std::vector<std::string>& body_names,
+                                                      const TDartTrajectoryData& data )
+        : m_Data( data ), m_NumBodies( body_names.size() )
+    {
+        m_Data.record_interval = std::max<ssize_t>( m_Data.record_interval, 1 );
+        m_Data.keyframe_interval = std::max<ssize_t>( m_Data.keyframe_interval, 1 );
+        m_Data.queue_capacity = std::max<ssize_t>( m_Data.queue_capacity, 1 );
+        LOCO_CORE_ASSERT( m_Data.position_resolution > 0.0 && m_Data.velocity_resolution > 0.0,
+                          "TDartTrajectoryRecorder >>> resolutions must be positive" );
+
+        m_File = std::make_unique<TDartMappedFileWriter>( filepath, m_Data.chunk_size );
+        if ( !m_File->valid() )
+            return;
+
+        std::vector<uint8_t> header;
+        AppendValue( header, LOCO_DART_TRAJECTORY_MAGIC );
+        AppendValue( header, LOCO_DART_TRAJECTORY_VERSION );
+        AppendValue( header, uint32_t( m_NumBodies ) );
+        AppendValue( header, m_Data.position_resolution );
+        AppendValue( header, m_Data.velocity_resolution );
+        for ( const auto& body_name : body_names )
+        {
+            AppendValue( header, uint32_t( body_name.size() ) );
+            header.insert( header.end(), body_name.begin(), body_name.end() );
+        }
+        m_File->Write( header.data(), header.size() );
+        m_NumBytesWritten.store( m_File->size(), std::memory_order_relaxed );
+
+        // Everything used per frame is allocated up-front, so steady-state recording doesn't allocate
+        m_Queue.resize( m_Data.queue_capacity );
+        for ( auto& frame : m_Queue )
+        {
+            frame.poses.resize( m_NumBodies, Eigen::NoChange );
+            frame.velocities.resize( m_NumBodies, Eigen::NoChange );
+        }
+        m_LastQuantized.resize( LOCO_DART_TRAJECTORY_VALUES_PER_BODY * m_NumBodies, 0 );
+        m_Quantized.resize( LOCO_DART_TRAJECTORY_VALUES_PER_BODY * m_NumBodies, 0 );
+        m_Encoded.reserve( LOCO_DART_TRAJECTORY_FRAME_HEADER_SIZE + _MaxPayloadSize( m_NumBodies ) );
+        m_WriterThread = std::thread( &TDartTrajectoryRecorder::_WriterLoop, this );
+    }
+
+    TDartTrajectoryRecorder::~TDartTrajectoryRecorder()
+    {
+        Close();
+    }
+
+    void TDartTrajectoryRecorder::Record( const TDartStateSnapshot& snapshot )
+    {
+        if ( !m_WriterThread.joinable() || ( m_NumSnapshots++ % m_Data.record_interval ) != 0 )
+            return;
+
+        if ( snapshot.poses.rows() != m_NumBodies )
+        {
+            LOCO_CORE_WARN( "TDartTrajectoryRecorder::Record >>> expected snapshots of {0} bodies, got {1}",
+                            m_NumBodies, snapshot.poses.rows() );
+            return;
+        }
+
+        // The stepping thread never waits for the writer: if the queue is full the frame is dropped
+        const ssize_t tail = m_QueueTail.load( std::memory_order_relaxed );
+        if ( tail - m_QueueHead.load( std::memory_order_acquire ) >= m_Data.queue_capacity )
+        {
+            m_NumFramesDropped.fetch_add( 1, std::memory_order_relaxed );
+            return;
+        }
+        auto& frame = m_Queue[tail % m_Data.queue_capacity];
+        frame.time = snapshot.time;
+        frame.poses = snapshot.poses;
+        frame.velocities = snapshot.velocities;
+        m_QueueTail.store( tail + 1, std::memory_order_release );
+
+        // Empty critical section, so the writer can't miss the wake-up between checking the queue and waiting
+        { std::lock_guard<std::mutex> lock( m_WriterMutex ); }
+        m_WriterCondition.notify_one();
+    }
+
+    void TDartTrajectoryRecorder::Close()
+    {
+        if ( m_WriterThread.joinable() )
+        {
+            {
+                std::lock_guard<std::mutex> lock( m_WriterMutex );
+                m_WriterStop = true;
+            }
+            m_WriterCondition.notify_one();
+            m_WriterThread.join();
+        }
+        if ( m_File )
+            m_File->Close();
+    }
+
+    void TDartTrajectoryRecorder::_WriterLoop()
+    {
+        while ( true )
+        {
+            {
+                std::unique_lock<std::mutex> lock( m_WriterMutex );
+                m_WriterCondition.wait( lock, [this]()
+                    {
+                        return m_WriterStop || m_QueueHead.load( std::memory_order_relaxed ) !=
+                                               m_QueueTail.load( std::memory_order_acquire );
+                    } );
+            }
+
+            // Frames still queued when stopping are written before leaving
+            ssize_t head = m_QueueHead.load( std::memory_order_relaxed );
+            const ssize_t tail = m_QueueTail.load( std::memory_order_acquire );
+            for ( ; head < tail; head++ )
+            {
+                _EncodeFrame( m_Queue[head % m_Data.queue_capacity] );
+                m_QueueHead.store( head + 1, std::memory_order_release );
+            }
+
+            std::lock_guard<std::mutex> lock( m_WriterMutex );
+            if ( m_WriterStop && m_QueueHead.load( std::memory_order_relaxed ) == m_QueueTail.load( std::memory_order_acquire ) )
+                break;
+        }
+    }
+
+    void TDartTrajectoryRecorder::_EncodeFrame( const TQueuedFrame& frame )
+    {
+        if ( m_FileFull || !m_File->valid() )
+        {
+            m_NumFramesDropped.fetch_add( 1, std::memory_order_relaxed );
+            return;
+        }
+
+        const bool is_keyframe = ( m_NumFramesEncoded % m_Data.keyframe_interval ) == 0;
+        m_Encoded.clear();
+        AppendValue( m_Encoded, uint8_t( is_keyframe ? TRAJECTORY_FRAME_KEY : TRAJECTORY_FRAME_DELTA ) );
+        AppendValue( m_Encoded, uint32_t( 0 ) ); // payload size, filled below
+        AppendValue( m_Encoded, frame.time );
+
+        for ( ssize_t i = 0; i < m_NumBodies; i++ )
+        {
+            int64_t* quantized = m_Quantized.data() + LOCO_DART_TRAJECTORY_VALUES_PER_BODY * i;
+            for ( ssize_t j = 0; j < 3; j++ )
+                quantized[j] = std::llround( frame.poses( i, j ) / m_Data.position_resolution );
+            quantized[3] = QuantizeQuaternion( frame.poses.block<1, 4>( i, 3 ).transpose() );
+            for ( ssize_t j = 0; j < 6; j++ )
+                quantized[4 + j] = std::llround( frame.velocities( i, j ) / m_Data.velocity_resolution );
+
+            const int64_t* last_quantized = m_LastQuantized.data() + LOCO_DART_TRAJECTORY_VALUES_PER_BODY * i;
+            if ( is_keyframe )
+            {
+                for ( ssize_t j = 0; j < 3; j++ )
+                    AppendVarint( m_Encoded, quantized[j] );
+                AppendValue( m_Encoded, uint32_t( quantized[3] ) );
+                for ( ssize_t j = 4; j < LOCO_DART_TRAJECTORY_VALUES_PER_BODY; j++ )
+                    AppendVarint( m_Encoded, quantized[j] );
+            }
+            else
+            {
+                // Bodies whose quantized state didn't change (e.g. resting ones) take a single byte
+                const bool changed = !std::equal( quantized, quantized + LOCO_DART_TRAJECTORY_VALUES_PER_BODY, last_quantized );
+                AppendValue( m_Encoded, uint8_t( changed ) );
+                if ( changed )
+                {
+                    for ( ssize_t j = 0; j < 3; j++ )
+                        AppendVarint( m_Encoded, quantized[j] - last_quantized[j] );
+                    AppendValue( m_Encoded, uint32_t( quantized[3] ) );
+                    for ( ssize_t j = 4; j < LOCO_DART_TRAJECTORY_VALUES_PER_BODY; j++ )
+                        AppendVarint( m_Encoded, quantized[j] - last_quantized[j] );
+                }
+            }
+        }
+        const uint32_t payload_size = m_Encoded.size() - LOCO_DART_TRAJECTORY_FRAME_HEADER_SIZE;
+        std::memcpy( m_Encoded.data() + sizeof( uint8_t ), &payload_size, sizeof( uint32_t ) );
+
+        if ( m_Data.max_file_size > 0 && m_File->size() + m_Encoded.size() > m_Data.max_file_size )
+        {
+            LOCO_CORE_WARN( "TDartTrajectoryRecorder >>> reached the maximum file size ({0} bytes), stopped recording",
+                            m_Data.max_file_size );
+            m_FileFull = true;
+            m_NumFramesDropped.fetch_add( 1, std::memory_order_relaxed );
+            return;
+        }
+        if ( !m_File->Write( m_Encoded.data(), m_Encoded.size() ) )
+        {
+            m_NumFramesDropped.fetch_add( 1, std::memory_order_relaxed );
+            return;
+        }
+        m_LastQuantized.swap( m_Quantized );
+        m_NumFramesEncoded++;
+        m_NumFramesRecorded.fetch_add( 1, std::memory_order_relaxed );
+        m_NumBytesWritten.store( m_File->size(), std::memory_order_relaxed );
+    }
+
+    /***********************************************************************************************
+    *                                     Trajectory Reader                                        *
+    ***********************************************************************************************/
+
+    TDartTrajectoryReader::TDartTrajectoryReader( const std::string& filepath )
+        : m_File( filepath, std::ios::binary )
+    {
+        if ( !m_File.is_open() )
+        {
+            LOCO_CORE_ERROR( "TDartTrajectoryReader >>> couldn't open trajectory file {0}", filepath );
+            return;
+        }
+        m_File.seekg( 0, std::ios::end );
+        const std::streamoff file_size = m_File.tellg();
+        m_File.seekg( 0, std::ios::beg );
+
+        uint8_t header[3 * sizeof( uint32_t ) + 2 * sizeof( double )];
+        m_File.read( reinterpret_cast<char*>( header ), sizeof( header ) );
+        TDartByteCursor cursor( header, m_File.gcount() );
+        const uint32_t magic = cursor.Read<uint32_t>();
+        const uint32_t version = cursor.Read<uint32_t>();
+        const uint32_t num_bodies = cursor.Read<uint32_t>();
+        m_PositionResolution = cursor.Read<double>();
+        m_VelocityResolution = cursor.Read<double>();
+        if ( !cursor.valid || magic != LOCO_DART_TRAJECTORY_MAGIC || version != LOCO_DART_TRAJECTORY_VERSION )
+        {
+            LOCO_CORE_ERROR( "TDartTrajectoryReader >>> {0} is not a valid trajectory file", filepath );
+            return;
+        }
+        bool header_valid = true;
+        for ( uint32_t i = 0; i < num_bodies && header_valid; i++ )
+        {
+            uint32_t name_size = 0;
+            m_File.read( reinterpret_cast<char*>( &name_size ), sizeof( uint32_t ) );
+            header_valid = m_File && ( name_size <= file_size - m_File.tellg() );
+            if ( !header_valid )
+                break;
+            std::string body_name( name_size, '\0' );
+            m_File.read( &body_name[0], name_size );
+            m_BodyNames.push_back( body_name );
+        }
+        if ( !header_valid || !m_File )
+        {
+            LOCO_CORE_ERROR( "TDartTrajectoryReader >>> header of trajectory file {0} is truncated", filepath );
+            return;
+        }
+        m_FramesOffset = m_ReadOffset = m_File.tellg();
+        m_MaxPayloadSize = _MaxPayloadSize( num_bodies );
+        m_Payload.reserve( m_MaxPayloadSize );
+        m_LastQuantized.resize( LOCO_DART_TRAJECTORY_VALUES_PER_BODY * num_bodies, 0 );
+        m_Valid = true;
+    }
+
+    void TDartTrajectoryReader::Rewind()
+    {
+        m_ReadOffset = m_FramesOffset;
+        m_NumFramesRead = 0;
+        _SeekReadOffset();
+    }
+
+    bool TDartTrajectoryReader::Next( TDartStateSnapshot& snapshot )
+    {
+        if ( !m_Valid )
+            return false;
+
+        // Frames cut short (e.g. the recording process crashed, or is still writing) are treated as the end of
+        // the file, leaving the stream at the start of the frame
+        uint8_t frame_header[LOCO_DART_TRAJECTORY_FRAME_HEADER_SIZE];
+        m_File.read( reinterpret_cast<char*>( frame_header ), sizeof( frame_header ) );
+        TDartByteCursor header_cursor( frame_header, m_File.gcount() );
+        const uint8_t type = header_cursor.Read<uint8_t>();
+        const uint32_t payload_size = header_cursor.Read<uint32_t>();
+        if ( !header_cursor.valid || payload_size > m_MaxPayloadSize )
+        {
+            _SeekReadOffset();
+            return false;
+        }
+        m_Payload.resize( payload_size );
+        m_File.read( reinterpret_cast<char*>( m_Payload.data() ), payload_size );
+        if ( !m_File )
+        {
+            _SeekReadOffset();
+            return false;
+        }
+        TDartByteCursor cursor( m_Payload.data(), payload_size );
+
+        const ssize_t num_bodies = m_BodyNames.size();
+        snapshot.time = cursor.Read<double>();
+        snapshot.poses.resize( num_bodies, Eigen::NoChange );
+        snapshot.velocities.resize( num_bodies, Eigen::NoChange );
+        snapshot.contacts.clear();
+        for ( ssize_t i = 0; i < num_bodies; i++ )
+        {
+            int64_t* quantized = m_LastQuantized.data() + LOCO_DART_TRAJECTORY_VALUES_PER_BODY * i;
+            if ( type == TRAJECTORY_FRAME_KEY )
+            {
+                for ( ssize_t j = 0; j < 3; j++ )
+                    quantized[j] = cursor.ReadVarint();
+                quantized[3] = cursor.Read<uint32_t>();
+                for ( ssize_t j = 4; j < LOCO_DART_TRAJECTORY_VALUES_PER_BODY; j++ )
+                    quantized[j] = cursor.ReadVarint();
+            }
+            else if ( cursor.Read<uint8_t>() )
+            {
+                for ( ssize_t j = 0; j < 3; j++ )
+                    quantized[j] += cursor.ReadVarint();
+                quantized[3] = cursor.Read<uint32_t>();
+                for ( ssize_t j = 4; j < LOCO_DART_TRAJECTORY_VALUES_PER_BODY; j++ )
+                    quantized[j] += cursor.ReadVarint();
+            }
+
+            for ( ssize_t j = 0; j < 3; j++ )
+                snapshot.poses( i, j ) = quantized[j] * m_PositionResolution;
+            snapshot.poses.block<1, 4>( i, 3 ) = DequantizeQuaternion( uint32_t( quantized[3] ) ).transpose();
+            for ( ssize_t j = 0; j < 6; j++ )
+                snapshot.velocities( i, j ) = quantized[4 + j] * m_VelocityResolution;
+        }
+        if ( !cursor.valid )
+        {
+            LOCO_CORE_WARN( "TDartTrajectoryReader::Next >>> frame at offset {0} is corrupted", m_ReadOffset );
+            _SeekReadOffset();
+            return false;
+        }
+        snapshot.sequence = m_NumFramesRead++;
+        m_ReadOffset += LOCO_DART_TRAJECTORY_FRAME_HEADER_SIZE + payload_size;
+        return true;
+    }
+
+    void TDartTrajectoryReader::_SeekReadOffset()
+    {
+        m_File.clear();
+        m_File.seekg( m_ReadOffset );
+    }
+}}
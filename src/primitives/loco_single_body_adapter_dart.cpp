@@ -25,6 +25,10 @@ namespace primitives {
 
     void TDartSingleBodyAdapter::Build()
     {
+        // Collision-shapes and inertias of all bodies are built in parallel, right before the first adapter is built
+        if ( m_ParallelBuilderRef )
+            m_ParallelBuilderRef->Build();
+
         m_DartSkeleton = dart::dynamics::Skeleton::create( m_BodyRef->name() );
         if ( m_BodyRef->dyntype() == eDynamicsType::STATIC )
         {
@@ -137,6 +141,8 @@ namespace primitives {
         collider->SetColliderAdapter( m_ColliderAdapter.get() );
 
         auto dart_collider_adapter = static_cast<TDartSingleBodyColliderAdapter*>( m_ColliderAdapter.get() );
+        dart_collider_adapter->SetSceneCache( m_SceneCacheRef );
+        dart_collider_adapter->SetParallelBuilder( m_ParallelBuilderRef );
         dart_collider_adapter->Build();
 
         auto& dart_collision_shape = dart_collider_adapter->collision_shape();
@@ -147,20 +153,9 @@ namespace primitives {
         if ( m_BodyRef->dyntype() == eDynamicsType::DYNAMIC )
         {
             dart::dynamics::Inertia body_inertia;
-            const auto& inertia_data = m_BodyRef->data().inertia;
-
-            if ( inertia_data.mass > 0.0f )
-                body_inertia.setMass( inertia_data.mass );
-            else
-                body_inertia.setMass( dart_collision_shape->getVolume() * collider->data().density );
-
-            if ( ( inertia_data.ixx > 0.0f ) && ( inertia_data.iyy > 0.0f ) && ( inertia_data.izz > 0.0f ) && 
-                 ( inertia_data.ixy >= 0.0f ) && ( inertia_data.ixz >= 0.0f ) && ( inertia_data.iyz >= 0.0f ) )
-                body_inertia.setMoment( inertia_data.ixx, inertia_data.iyy, inertia_data.izz,
-                                        inertia_data.ixy, inertia_data.ixz, inertia_data.iyz );
-            else
-                body_inertia.setMoment( dart_collision_shape->computeInertia( body_inertia.getMass() ) );
-
+            if ( !m_ParallelBuilderRef || !m_ParallelBuilderRef->GetInertia( &m_BodyRef->data().inertia, body_inertia ) )
+                body_inertia = dartsim::ComputeBodyInertia( m_BodyRef->name(), m_BodyRef->data().inertia, &collider->data(),
+                                                            dart_collision_shape, m_SceneCacheRef );
             m_DartBodyNodeRef->setInertia( body_inertia );
         }
     }
@@ -216,6 +211,48 @@ namespace primitives {
         m_BodyRef = nullptr;
     }
 
+    void TDartSingleBodyAdapter::Rebind( TSingleBody* body_ref )
+    {
+        LOCO_CORE_ASSERT( body_ref, "TDartSingleBodyAdapter::Rebind >>> expected non-null body-obj reference" );
+        LOCO_CORE_ASSERT( m_DartSkeleton, "TDartSingleBodyAdapter::Rebind >>> body {0} must have been built \
+                          before being reused", body_ref->name() );
+
+        m_BodyRef = body_ref;
+        m_Detached = false;
+        body_ref->SetBodyAdapter( this );
+
+        m_DartSkeleton->setName( body_ref->name() );
+        m_DartBodyNodeRef->setName( body_ref->name() );
+        m_DartJointRef->setName( body_ref->name() + ( ( body_ref->dyntype() == eDynamicsType::STATIC ) ? "_weldjoint" : "_freejoint" ) );
+        m_DartSkeleton->clearExternalForces();
+
+        static_cast<TDartSingleBodyColliderAdapter*>( m_ColliderAdapter.get() )->Rebind( body_ref->collider() );
+    }
+
+    void TDartSingleBodyAdapter::RemoveFromWorld()
+    {
+        LOCO_CORE_ASSERT( m_DartWorldRef, "TDartSingleBodyAdapter::RemoveFromWorld >>> body must have \
+                          a valid dart-world reference" );
+
+        static_cast<TDartSingleBodyColliderAdapter*>( m_ColliderAdapter.get() )->RemoveFromWorld();
+        m_DartWorldRef->removeSkeleton( m_DartSkeleton );
+    }
+
+    uint64_t TDartSingleBodyAdapter::ComputePoolSignature( const TSingleBody* body )
+    {
+        // Constrained bodies own extra joints (constraint-adapters), and heightfields get their heights on ->Build
+        auto collider = body->collider();
+        if ( body->constraint() || !collider || collider->data().type == eShapeType::HEIGHTFIELD )
+            return 0;
+
+        dartsim::TDartSignature signature;
+        signature.Add( int32_t( body->dyntype() ) );
+        signature.Add( double( collider->data().density ) );
+        signature.AddShape( collider->data() );
+        signature.AddInertia( body->data().inertia );
+        return ( signature.value != 0 ) ? signature.value : 1;
+    }
+
     void TDartSingleBodyAdapter::SetTransform( const TMat4& transform )
     {
         LOCO_CORE_ASSERT( m_DartJointRef, "TDartSingleBodyAdapter::SetTransform >>> body {0} must have \
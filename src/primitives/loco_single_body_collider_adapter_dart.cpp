@@ -1,5 +1,6 @@
 
 #include <primitives/loco_single_body_collider_adapter_dart.h>
+#include <loco_parallel_build_dart.h>
 
 namespace loco {
 namespace primitives {
@@ -10,6 +11,8 @@ namespace primitives {
         m_DartShape = nullptr;
         m_DartShapeNodeRef = nullptr;
         m_DartWorldRef = nullptr;
+        m_CollisionFilterRef = nullptr;
+        m_CollisionFilterSlot = -1;
     }
 
     TDartSingleBodyColliderAdapter::~TDartSingleBodyColliderAdapter()
@@ -21,11 +24,19 @@ namespace primitives {
         m_DartShape = nullptr;
         m_DartShapeNodeRef = nullptr;
         m_DartWorldRef = nullptr;
+        m_CollisionFilterRef = nullptr;
+        m_CollisionFilterSlot = -1;
     }
 
     void TDartSingleBodyColliderAdapter::Build()
     {
-        m_DartShape = dartsim::CreateCollisionShape( m_ColliderRef->data() );
+        // The shape might have been created already, by the parallel build-phase of the simulation
+        m_DartShape = m_ParallelBuilderRef ? m_ParallelBuilderRef->GetShape( &m_ColliderRef->data() ) : nullptr;
+        if ( !m_DartShape )
+            m_DartShape = dartsim::CreateCollisionShape( m_ColliderRef->data(), m_SceneCacheRef );
+        // Not part of any world yet, so the buffer of the shape is still in the user's layout
+        if ( auto hfield_shape = dynamic_cast<dart::dynamics::HeightmapShapef*>( m_DartShape.get() ) )
+            m_Heights = hfield_shape->getHeightField();
         m_DartShapeNodeRef = nullptr;
         m_DartWorldRef = nullptr;
     }
@@ -36,12 +47,11 @@ namespace primitives {
                           valid reference to the dart-world object to initialize collider {0}", m_ColliderRef->name() );
 
         auto& collision_filter = m_DartWorldRef->getConstraintSolver()->getCollisionOption().collisionFilter;
-        auto bitmask_collision_filter = dynamic_cast<dartsim::TDartBitmaskCollisionFilter*>( collision_filter.get() );
-        if ( bitmask_collision_filter )
-        {
-            bitmask_collision_filter->setCollisionGroup( m_DartShapeNodeRef, m_ColliderRef->collisionGroup() );
-            bitmask_collision_filter->setCollisionMask( m_DartShapeNodeRef, m_ColliderRef->collisionMask() );
-        }
+        m_CollisionFilterRef = dynamic_cast<dartsim::TDartBitmaskCollisionFilter*>( collision_filter.get() );
+        if ( m_CollisionFilterRef )
+            m_CollisionFilterSlot = m_CollisionFilterRef->registerShapeNode( m_DartShapeNodeRef,
+                                                                              m_ColliderRef->collisionGroup(),
+                                                                              m_ColliderRef->collisionMask() );
         ChangeFriction( m_ColliderRef->data().friction.x() );
     }
 
@@ -51,6 +61,25 @@ namespace primitives {
         m_ColliderRef = nullptr;
     }
 
+    void TDartSingleBodyColliderAdapter::Rebind( TSingleBodyCollider* collider_ref )
+    {
+        LOCO_CORE_ASSERT( collider_ref, "TDartSingleBodyColliderAdapter::Rebind >>> expected non-null collider-obj reference" );
+        LOCO_CORE_ASSERT( m_DartShape, "TDartSingleBodyColliderAdapter::Rebind >>> collider {0} must have been built \
+                          before being reused", collider_ref->name() );
+
+        m_ColliderRef = collider_ref;
+        m_Detached = false;
+        collider_ref->SetColliderAdapter( this );
+    }
+
+    void TDartSingleBodyColliderAdapter::RemoveFromWorld()
+    {
+        if ( m_CollisionFilterRef && m_CollisionFilterSlot >= 0 )
+            m_CollisionFilterRef->unregisterShapeNode( m_CollisionFilterSlot );
+        m_CollisionFilterRef = nullptr;
+        m_CollisionFilterSlot = -1;
+    }
+
     void TDartSingleBodyColliderAdapter::ChangeSize( const TVec3& new_size )
     {
         if ( !m_DartShape )
@@ -153,7 +182,56 @@ namespace primitives {
         }
 
         if ( auto hfield_shape = dynamic_cast<dart::dynamics::HeightmapShapef*>( m_DartShape.get() ) )
-            hfield_shape->setHeightField( num_width_samples, num_depth_samples, heights );
+        {
+            m_Heights = Eigen::Map<const dartsim::THeightsMatrix>( heights.data(), num_depth_samples, num_width_samples );
+            hfield_shape->setHeightField( dart::dynamics::HeightmapShapef::HeightField( m_Heights ) );
+        }
+    }
+
+    void TDartSingleBodyColliderAdapter::ChangeElevationRegion( ssize_t x0, ssize_t y0, ssize_t width, ssize_t depth,
+                                                                const std::vector<float>& heights )
+    {
+        if ( !m_DartShape )
+            return;
+
+        auto hfield_shape = dynamic_cast<dart::dynamics::HeightmapShapef*>( m_DartShape.get() );
+        if ( !hfield_shape )
+        {
+            LOCO_CORE_WARN( "TDartSingleBodyColliderAdapter::ChangeElevationRegion >>> collider {0} is not a \
+                             heightfield", m_ColliderRef->name() );
+            return;
+        }
+
+        const ssize_t num_width_samples = m_Heights.cols();
+        const ssize_t num_depth_samples = m_Heights.rows();
+        if ( ( x0 < 0 ) || ( y0 < 0 ) || ( width <= 0 ) || ( depth <= 0 ) ||
+             ( x0 + width > num_width_samples ) || ( y0 + depth > num_depth_samples ) ||
+             ( width * depth != (ssize_t)heights.size() ) )
+        {
+            LOCO_CORE_WARN( "TDartSingleBodyColliderAdapter::ChangeElevationRegion >>> region-data mismatch for \
+                              collider {0}", m_ColliderRef->name() );
+            LOCO_CORE_WARN( "\tnwidth-samples       : {0}", num_width_samples );
+            LOCO_CORE_WARN( "\tndepth-samples       : {0}", num_depth_samples );
+            LOCO_CORE_WARN( "\tregion (x0,y0,w,d)   : ({0},{1},{2},{3})", x0, y0, width, depth );
+            LOCO_CORE_WARN( "\tgiven buffer-size    : {0}", heights.size() );
+            return;
+        }
+
+        dartsim::UpdateHeightfieldRegion( hfield_shape, m_Heights, x0, y0, width, depth, heights.data(), width );
+    }
+
+    void TDartSingleBodyColliderAdapter::SampleHeights( const dartsim::TPointsXY& points_xy, Eigen::VectorXd& dst_heights ) const
+    {
+        auto hfield_shape = dynamic_cast<const dart::dynamics::HeightmapShapef*>( m_DartShape.get() );
+        if ( !hfield_shape || !m_DartShapeNodeRef )
+        {
+            LOCO_CORE_WARN( "TDartSingleBodyColliderAdapter::SampleHeights >>> collider {0} is not a built \
+                             heightfield", m_ColliderRef->name() );
+            dst_heights.setZero( points_xy.rows() );
+            return;
+        }
+
+        dartsim::SampleHeightfield( m_Heights, hfield_shape->getScale(), m_DartShapeNodeRef->getWorldTransform(), points_xy, dst_heights );
     }
 
     void TDartSingleBodyColliderAdapter::ChangeCollisionGroup( int collisionGroup )
@@ -165,9 +243,9 @@ namespace primitives {
             return;
         }
 
-        // @todo: Must extend Dart functionality to allow collision-groups and collision-masks, as
-        //        in bullet, mujoco, and raisim. So far, it seems only single exclusions are possible.
-        LOCO_CORE_WARN( "TDartSingleBodyColliderAdapter::ChangeCollisionGroup >>> feature not supported yet" );
+        // Changes take effect on the next step (the broadphase-proxy is refreshed by the simulation before stepping)
+        if ( m_CollisionFilterRef && m_CollisionFilterSlot >= 0 )
+            m_CollisionFilterRef->setCollisionGroup( m_CollisionFilterSlot, collisionGroup );
     }
 
     void TDartSingleBodyColliderAdapter::ChangeCollisionMask( int collisionMask )
@@ -179,9 +257,9 @@ namespace primitives {
             return;
         }
 
-        // @todo: Must extend Dart functionality to allow collision-groups and collision-masks, as
-        //        in bullet, mujoco, and raisim. So far, it seems only single exclusions are possible.
-        LOCO_CORE_WARN( "TDartSingleBodyColliderAdapter::ChangeCollisionMask >>> feature not supported yet" );
+        // Changes take effect on the next step (the broadphase-proxy is refreshed by the simulation before stepping)
+        if ( m_CollisionFilterRef && m_CollisionFilterSlot >= 0 )
+            m_CollisionFilterRef->setCollisionMask( m_CollisionFilterSlot, collisionMask );
     }
 
     void TDartSingleBodyColliderAdapter::ChangeFriction( const TScalar& friction )
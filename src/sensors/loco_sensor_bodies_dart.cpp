@@ -0,0 +1,132 @@
+
+#include <sensors/loco_sensor_bodies_dart.h>
+
+namespace loco {
+namespace sensors {
+
+    TDartBodySensors::TDartBodySensors( uint32_t seed )
+        : m_RandomGenerator( seed ), m_NormalDistribution( 0.0, 1.0 )
+    {
+        m_LastUpdateTime = -1.0;
+    }
+
+    ssize_t TDartBodySensors::AddImuSensor( const dart::dynamics::BodyNode* bodynode, const Eigen::Isometry3d& tf_body_to_sensor,
+                                            const TDartSensorNoiseData& accel_noise, const TDartSensorNoiseData& gyro_noise )
+    {
+        return _AddSensor( eDartBodySensorType::IMU, bodynode, tf_body_to_sensor, accel_noise, gyro_noise );
+    }
+
+    ssize_t TDartBodySensors::AddForceTorqueSensor( const dart::dynamics::BodyNode* bodynode, const Eigen::Isometry3d& tf_body_to_sensor,
+                                                    const TDartSensorNoiseData& force_noise, const TDartSensorNoiseData& torque_noise )
+    {
+        return _AddSensor( eDartBodySensorType::FORCE_TORQUE, bodynode, tf_body_to_sensor, force_noise, torque_noise );
+    }
+
+    ssize_t TDartBodySensors::_AddSensor( const eDartBodySensorType& type, const dart::dynamics::BodyNode* bodynode,
+                                          const Eigen::Isometry3d& tf_body_to_sensor,
+                                          const TDartSensorNoiseData& noise_head, const TDartSensorNoiseData& noise_tail )
+    {
+        if ( !bodynode )
+        {
+            LOCO_CORE_WARN( "TDartBodySensors::_AddSensor >>> expected a valid body-node to attach the sensor to" );
+            return -1;
+        }
+
+        const ssize_t sensor_index = m_BodyNodes.size();
+        m_Types.push_back( type );
+        m_BodyNodes.push_back( bodynode );
+        m_TfsBodyToSensor.push_back( tf_body_to_sensor );
+
+        for ( auto buffer : { &m_NoiseStddev, &m_BiasStddev, &m_BiasRandomWalk, &m_Bias, &m_Readings } )
+        {
+            buffer->conservativeResize( sensor_index + 1, Eigen::NoChange );
+            buffer->row( sensor_index ).setZero();
+        }
+        m_NoiseStddev.row( sensor_index ) << Eigen::RowVector3d::Constant( noise_head.noise_stddev ),
+                                             Eigen::RowVector3d::Constant( noise_tail.noise_stddev );
+        m_BiasStddev.row( sensor_index ) << Eigen::RowVector3d::Constant( noise_head.bias_stddev ),
+                                            Eigen::RowVector3d::Constant( noise_tail.bias_stddev );
+        m_BiasRandomWalk.row( sensor_index ) << Eigen::RowVector3d::Constant( noise_head.bias_random_walk ),
+                                                Eigen::RowVector3d::Constant( noise_tail.bias_random_walk );
+        _DrawBias( sensor_index );
+        return sensor_index;
+    }
+
+    ssize_t TDartBodySensors::RemoveSensorsOf( const dart::dynamics::BodyNode* bodynode )
+    {
+        // Compact all per-sensor buffers in place, keeping the remaining sensors in order
+        const ssize_t num_sensors = m_BodyNodes.size();
+        ssize_t num_kept = 0;
+        for ( ssize_t i = 0; i < num_sensors; i++ )
+        {
+            if ( m_BodyNodes[i] == bodynode )
+                continue;
+            if ( num_kept != i )
+            {
+                m_Types[num_kept] = m_Types[i];
+                m_BodyNodes[num_kept] = m_BodyNodes[i];
+                m_TfsBodyToSensor[num_kept] = m_TfsBodyToSensor[i];
+                for ( auto buffer : { &m_NoiseStddev, &m_BiasStddev, &m_BiasRandomWalk, &m_Bias, &m_Readings } )
+                    buffer->row( num_kept ) = buffer->row( i );
+            }
+            num_kept++;
+        }
+
+        m_Types.resize( num_kept );
+        m_BodyNodes.resize( num_kept );
+        m_TfsBodyToSensor.resize( num_kept );
+        for ( auto buffer : { &m_NoiseStddev, &m_BiasStddev, &m_BiasRandomWalk, &m_Bias, &m_Readings } )
+            buffer->conservativeResize( num_kept, Eigen::NoChange );
+        return num_sensors - num_kept;
+    }
+
+    void TDartBodySensors::Update( const Eigen::Vector3d& gravity, double time )
+    {
+        const double dt = ( m_LastUpdateTime < 0.0 ) ? 0.0 : ( time - m_LastUpdateTime );
+        m_LastUpdateTime = time;
+
+        const ssize_t num_sensors = m_BodyNodes.size();
+        for ( ssize_t i = 0; i < num_sensors; i++ )
+        {
+            auto bodynode = m_BodyNodes[i];
+            const auto& tf_body_to_sensor = m_TfsBodyToSensor[i];
+            if ( m_Types[i] == eDartBodySensorType::IMU )
+            {
+                // Accelerations are the ones of the last step (including the velocity changes due to contacts). The
+                // accelerometer measures proper acceleration, so a body at rest reads -gravity (i.e. up)
+                const Eigen::Matrix3d rot_world_to_sensor = bodynode->getWorldTransform().linear() * tf_body_to_sensor.linear();
+                const Eigen::Vector3d accel_world = bodynode->getLinearAcceleration( tf_body_to_sensor.translation() );
+                const Eigen::Vector3d gyro_world = bodynode->getAngularVelocity();
+                m_Readings.block<1, 3>( i, 0 ) = ( rot_world_to_sensor.transpose() * ( accel_world - gravity ) ).transpose();
+                m_Readings.block<1, 3>( i, 3 ) = ( rot_world_to_sensor.transpose() * gyro_world ).transpose();
+            }
+            else
+            {
+                // Wrench transmitted by the parent joint (including constraint impulses), given as [torque, force] in
+                // the body frame, and moved to the sensor frame
+                const Eigen::Vector6d wrench_sensor = dart::math::dAdT( tf_body_to_sensor, bodynode->getBodyForce() );
+                m_Readings.block<1, 3>( i, 0 ) = wrench_sensor.tail<3>().transpose();
+                m_Readings.block<1, 3>( i, 3 ) = wrench_sensor.head<3>().transpose();
+            }
+        }
+
+        // Noise models, applied to all readings at once
+        const double sqrt_dt = std::sqrt( std::max( dt, 0.0 ) );
+        auto draw_normal = [this]( double ) { return m_NormalDistribution( m_RandomGenerator ); };
+        m_Bias.array() += m_BiasRandomWalk.array() * sqrt_dt * m_Bias.unaryExpr( draw_normal ).array();
+        m_Readings.array() += m_Bias.array() + m_NoiseStddev.array() * m_Readings.unaryExpr( draw_normal ).array();
+    }
+
+    void TDartBodySensors::Reset()
+    {
+        m_LastUpdateTime = -1.0;
+        for ( ssize_t i = 0; i < m_BodyNodes.size(); i++ )
+            _DrawBias( i );
+    }
+
+    void TDartBodySensors::_DrawBias( ssize_t sensor_index )
+    {
+        for ( ssize_t j = 0; j < 6; j++ )
+            m_Bias( sensor_index, j ) = m_BiasStddev( sensor_index, j ) * m_NormalDistribution( m_RandomGenerator );
+    }
+}}
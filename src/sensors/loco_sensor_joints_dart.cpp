@@ -0,0 +1,145 @@
+
+#include <sensors/loco_sensor_joints_dart.h>
+
+namespace loco {
+namespace sensors {
+
+    // Index of each channel into the per-channel buffers
+    static ssize_t _ChannelIndex( const eDartJointSensorChannel& channel )
+    {
+        switch ( channel )
+        {
+            case JOINT_QPOS : return 0;
+            case JOINT_QVEL : return 1;
+            case JOINT_TORQUE : return 2;
+        }
+        return 0;
+    }
+
+    TDartJointSensors::TDartJointSensors( ssize_t capacity )
+    {
+        m_Capacity = std::max( capacity, ssize_t( 1 ) );
+        m_NumSamples = 0;
+        m_Head = 0;
+        _Allocate();
+    }
+
+    ssize_t TDartJointSensors::AddSensor( dart::dynamics::Skeleton* skeleton, const std::string& joint_name, int channels,
+                                          ssize_t dof_index )
+    {
+        auto joint = skeleton ? skeleton->getJoint( joint_name ) : nullptr;
+        if ( !joint )
+        {
+            LOCO_CORE_WARN( "TDartJointSensors::AddSensor >>> couldn't find joint {0}", joint_name );
+            return -1;
+        }
+        if ( ( dof_index < 0 ) || ( dof_index >= joint->getNumDofs() ) )
+        {
+            LOCO_CORE_WARN( "TDartJointSensors::AddSensor >>> joint {0} has {1} dofs, but requested dof {2}",
+                            joint_name, joint->getNumDofs(), dof_index );
+            return -1;
+        }
+
+        // Positions|velocities are read straight from the joint's internal state (orientations of ball|free joints
+        // are recorded as dart's exponential coordinates), and torques from the dof's commanded force
+        std::array<ssize_t, 3> sensor_columns = { -1, -1, -1 };
+        const std::pair<eDartJointSensorChannel, const double*> channels_refs[3] =
+            {
+                { JOINT_QPOS, dartsim::GetJointPositionsData( joint ) + dof_index },
+                { JOINT_QVEL, dartsim::GetJointVelocitiesData( joint ) + dof_index },
+                { JOINT_TORQUE, nullptr }
+            };
+        for ( const auto& channel_ref : channels_refs )
+        {
+            if ( !( channels & channel_ref.first ) )
+                continue;
+            auto& channel_buffer = _Channel( channel_ref.first );
+            sensor_columns[_ChannelIndex( channel_ref.first )] = channel_buffer.refs.size();
+            channel_buffer.refs.push_back( channel_ref.second );
+            channel_buffer.dofs.push_back( joint->getDof( dof_index ) );
+        }
+        m_SensorsColumns.push_back( sensor_columns );
+
+        _Allocate();
+        return m_SensorsColumns.size() - 1;
+    }
+
+    void TDartJointSensors::RecordCommands()
+    {
+        // Commanded forces are cleared by the world after the last substep, so these are sampled before stepping
+        auto& torque_buffer = m_Channels[_ChannelIndex( JOINT_TORQUE )];
+        const ssize_t num_columns = torque_buffer.dofs.size();
+        double* sample = torque_buffer.samples.data() + m_Head * num_columns;
+        double* sample_mirror = sample + m_Capacity * num_columns;
+        for ( ssize_t i = 0; i < num_columns; i++ )
+            sample[i] = sample_mirror[i] = torque_buffer.dofs[i]->getForce();
+    }
+
+    void TDartJointSensors::RecordState( double time )
+    {
+        for ( auto channel : { JOINT_QPOS, JOINT_QVEL } )
+        {
+            auto& channel_buffer = _Channel( channel );
+            const ssize_t num_columns = channel_buffer.refs.size();
+            double* sample = channel_buffer.samples.data() + m_Head * num_columns;
+            double* sample_mirror = sample + m_Capacity * num_columns;
+            for ( ssize_t i = 0; i < num_columns; i++ )
+                sample[i] = sample_mirror[i] = *channel_buffer.refs[i];
+        }
+        m_Times[m_Head] = m_Times[m_Head + m_Capacity] = time;
+
+        m_Head = ( m_Head + 1 ) % m_Capacity;
+        m_NumSamples = std::min( m_NumSamples + 1, m_Capacity );
+    }
+
+    void TDartJointSensors::SetCapacity( ssize_t capacity )
+    {
+        m_Capacity = std::max( capacity, ssize_t( 1 ) );
+        _Allocate();
+    }
+
+    void TDartJointSensors::Clear()
+    {
+        m_NumSamples = 0;
+        m_Head = 0;
+    }
+
+    TDartJointSamplesView TDartJointSensors::GetHistory( const eDartJointSensorChannel& channel ) const
+    {
+        // Samples are mirrored, so the last num_samples rows from the oldest one never wrap around the buffer
+        const auto& channel_buffer = _Channel( channel );
+        const ssize_t num_columns = channel_buffer.refs.size();
+        return TDartJointSamplesView( channel_buffer.samples.data() + _OldestRow() * num_columns, m_NumSamples, num_columns );
+    }
+
+    Eigen::Map<const Eigen::VectorXd> TDartJointSensors::GetTimes() const
+    {
+        return Eigen::Map<const Eigen::VectorXd>( m_Times.data() + _OldestRow(), m_NumSamples );
+    }
+
+    ssize_t TDartJointSensors::column( ssize_t sensor_index, const eDartJointSensorChannel& channel ) const
+    {
+        if ( ( sensor_index < 0 ) || ( sensor_index >= m_SensorsColumns.size() ) )
+            return -1;
+        return m_SensorsColumns[sensor_index][_ChannelIndex( channel )];
+    }
+
+    TDartJointSensors::TChannelBuffer& TDartJointSensors::_Channel( const eDartJointSensorChannel& channel )
+    {
+        return m_Channels[_ChannelIndex( channel )];
+    }
+
+    const TDartJointSensors::TChannelBuffer& TDartJointSensors::_Channel( const eDartJointSensorChannel& channel ) const
+    {
+        return m_Channels[_ChannelIndex( channel )];
+    }
+
+    void TDartJointSensors::_Allocate()
+    {
+        // Buffers are only (re)allocated when the layout changes, never while recording
+        for ( auto& channel_buffer : m_Channels )
+            channel_buffer.samples.assign( 2 * m_Capacity * channel_buffer.refs.size(), 0.0 );
+        m_Times.assign( 2 * m_Capacity, 0.0 );
+        Clear();
+    }
+}}
@@ -0,0 +1,379 @@
+
+#include <server/loco_shm_server_dart.h>
+
+#include <cstring>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace loco {
+namespace server {
+
+    // Sections are aligned to cache-lines, so the client's and server's writes don't share lines
+    const uint64_t LOCO_DART_SHM_ALIGNMENT = 64;
+
+    static uint64_t _AlignUp( uint64_t offset )
+    {
+        return ( offset + LOCO_DART_SHM_ALIGNMENT - 1 ) & ~( LOCO_DART_SHM_ALIGNMENT - 1 );
+    }
+
+    // Futexes on the shared region (not FUTEX_PRIVATE, as waiters and wakers live in different processes)
+    static void _FutexWait( std::atomic<uint32_t>* word, uint32_t expected, double timeout )
+    {
+        struct timespec timeout_spec;
+        timeout_spec.tv_sec = time_t( timeout );
+        timeout_spec.tv_nsec = long( ( timeout - timeout_spec.tv_sec ) * 1e9 );
+        syscall( SYS_futex, reinterpret_cast<uint32_t*>( word ), FUTEX_WAIT, expected,
+                 ( timeout >= 0.0 ) ? &timeout_spec : nullptr, nullptr, 0 );
+    }
+
+    static void _FutexWake( std::atomic<uint32_t>* word )
+    {
+        syscall( SYS_futex, reinterpret_cast<uint32_t*>( word ), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0 );
+    }
+
+    /***********************************************************************************************
+    *                                     Shared-memory Server                                     *
+    ***********************************************************************************************/
+
+    TDartShmServer::TDartShmServer( TDartSimulation* simulation_ref, const std::string& name, ssize_t max_contacts )
+        : m_SimulationRef( simulation_ref ), m_MaxContacts( max_contacts )
+    {
+        LOCO_CORE_ASSERT( simulation_ref, "TDartShmServer >>> expected non-null simulation reference" );
+
+        m_ShmName = "/loco_dart_" + name;
+        m_SocketPath = LOCO_DART_SHM_SOCKET_DIR + "/loco_dart_" + name + ".sock";
+    }
+
+    TDartShmServer::~TDartShmServer()
+    {
+        Close();
+    }
+
+    bool TDartShmServer::Open()
+    {
+        // Names are copied into fixed-size buffers (socket address and handshake), so refuse the ones that don't fit
+        struct sockaddr_un address;
+        TDartShmHandshake handshake;
+        if ( m_SocketPath.size() >= sizeof( address.sun_path ) || m_ShmName.size() >= sizeof( handshake.shm_name ) )
+        {
+            LOCO_CORE_ERROR( "TDartShmServer::Open >>> name too long for control-socket {0} (max. {1} characters)",
+                             m_SocketPath, sizeof( address.sun_path ) - 1 );
+            return false;
+        }
+
+        // The layout is kept server-side, as the header lives in memory writable by the clients
+        m_NumBodies = m_SimulationRef->state_buffer()->num_bodies();
+        m_NumActuators = m_SimulationRef->joint_actuators()->num_actuators();
+        m_OffsetStates = _AlignUp( sizeof( TDartShmHeader ) );
+        m_OffsetActuation = _AlignUp( m_OffsetStates + m_NumBodies * LOCO_DART_SHM_BODY_STATE_SIZE * sizeof( double ) );
+        m_OffsetContacts = _AlignUp( m_OffsetActuation + m_NumActuators * sizeof( double ) );
+        m_RegionSize = _AlignUp( m_OffsetContacts + m_MaxContacts * sizeof( TDartShmContact ) );
+
+        m_ShmFd = shm_open( m_ShmName.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600 );
+        if ( m_ShmFd < 0 || ftruncate( m_ShmFd, m_RegionSize ) != 0 )
+        {
+            LOCO_CORE_ERROR( "TDartShmServer::Open >>> couldn't create shared-memory region {0}: {1}", m_ShmName, std::strerror( errno ) );
+            Close();
+            return false;
+        }
+        void* region = mmap( nullptr, m_RegionSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_ShmFd, 0 );
+        if ( region == MAP_FAILED )
+        {
+            LOCO_CORE_ERROR( "TDartShmServer::Open >>> couldn't map shared-memory region {0}: {1}", m_ShmName, std::strerror( errno ) );
+            Close();
+            return false;
+        }
+        m_Region = static_cast<uint8_t*>( region );
+
+        // Freshly truncated regions are zero-filled, so only the layout has to be written
+        m_Header = new ( m_Region ) TDartShmHeader();
+        m_Header->magic = LOCO_DART_SHM_MAGIC;
+        m_Header->version = LOCO_DART_SHM_VERSION;
+        m_Header->region_size = m_RegionSize;
+        m_Header->num_bodies = m_NumBodies;
+        m_Header->num_actuators = m_NumActuators;
+        m_Header->max_contacts = m_MaxContacts;
+        m_Header->offset_states = m_OffsetStates;
+        m_Header->offset_actuation = m_OffsetActuation;
+        m_Header->offset_contacts = m_OffsetContacts;
+        m_Header->request_seq.store( 0 );
+        m_Header->response_seq.store( 0 );
+        m_LastRequestSeq = 0;
+        _WriteState();
+
+        m_SocketFd = socket( AF_UNIX, SOCK_STREAM, 0 );
+        std::memset( &address, 0, sizeof( address ) );
+        address.sun_family = AF_UNIX;
+        std::memcpy( address.sun_path, m_SocketPath.c_str(), m_SocketPath.size() );
+        unlink( m_SocketPath.c_str() );
+        if ( m_SocketFd < 0 || bind( m_SocketFd, reinterpret_cast<struct sockaddr*>( &address ), sizeof( address ) ) != 0 ||
+             listen( m_SocketFd, 8 ) != 0 )
+        {
+            LOCO_CORE_ERROR( "TDartShmServer::Open >>> couldn't create control-socket {0}: {1}", m_SocketPath, std::strerror( errno ) );
+            Close();
+            return false;
+        }
+
+        m_Running = true;
+        m_ControlThread = std::thread( &TDartShmServer::_ControlLoop, this );
+        return true;
+    }
+
+    void TDartShmServer::Close()
+    {
+        Stop();
+        if ( m_SocketFd >= 0 )
+        {
+            // Unblocks the control-thread waiting on accept
+            shutdown( m_SocketFd, SHUT_RDWR );
+            close( m_SocketFd );
+            unlink( m_SocketPath.c_str() );
+            m_SocketFd = -1;
+        }
+        if ( m_ControlThread.joinable() )
+            m_ControlThread.join();
+
+        if ( m_Region )
+            munmap( m_Region, m_RegionSize );
+        if ( m_ShmFd >= 0 )
+        {
+            close( m_ShmFd );
+            shm_unlink( m_ShmName.c_str() );
+        }
+        m_Region = nullptr;
+        m_Header = nullptr;
+        m_ShmFd = -1;
+    }
+
+    void TDartShmServer::_ControlLoop()
+    {
+        TDartShmHandshake handshake;
+        std::memset( &handshake, 0, sizeof( handshake ) );
+        handshake.magic = LOCO_DART_SHM_MAGIC;
+        handshake.version = LOCO_DART_SHM_VERSION;
+        handshake.region_size = m_RegionSize;
+        std::memcpy( handshake.shm_name, m_ShmName.c_str(), m_ShmName.size() );
+
+        while ( m_Running )
+        {
+            const int client_fd = accept( m_SocketFd, nullptr, nullptr );
+            if ( client_fd < 0 )
+                break;
+            if ( write( client_fd, &handshake, sizeof( handshake ) ) != sizeof( handshake ) )
+                LOCO_CORE_WARN( "TDartShmServer::_ControlLoop >>> couldn't send the handshake to a client" );
+            close( client_fd );
+        }
+    }
+
+    void TDartShmServer::Serve()
+    {
+        while ( m_Running )
+            ServeOnce( 0.1 );
+    }
+
+    bool TDartShmServer::ServeOnce( double timeout )
+    {
+        if ( !m_Header )
+            return false;
+
+        uint32_t request_seq = m_Header->request_seq.load( std::memory_order_acquire );
+        if ( request_seq == m_LastRequestSeq )
+        {
+            _FutexWait( &m_Header->request_seq, m_LastRequestSeq, timeout );
+            request_seq = m_Header->request_seq.load( std::memory_order_acquire );
+            if ( request_seq == m_LastRequestSeq )
+                return false;
+        }
+        m_LastRequestSeq = request_seq;
+
+        m_Header->status = SHM_STATUS_OK;
+        switch ( m_Header->command )
+        {
+            case SHM_COMMAND_STEP :
+            {
+                // Actuators might have changed since the region was created, so only the ones in both are set
+                auto joint_actuators = m_SimulationRef->joint_actuators();
+                auto actuation = reinterpret_cast<const double*>( m_Region + m_OffsetActuation );
+                const ssize_t num_actuators = std::min<ssize_t>( m_NumActuators, joint_actuators->num_actuators() );
+                for ( ssize_t i = 0; i < num_actuators; i++ )
+                    joint_actuators->SetTarget( i, actuation[i] );
+                m_SimulationRef->Step( m_Header->dt );
+                break;
+            }
+            case SHM_COMMAND_RESET :
+                m_SimulationRef->Reset();
+                break;
+            case SHM_COMMAND_READ :
+                break;
+            default :
+                m_Header->status = SHM_STATUS_INVALID_COMMAND;
+                break;
+        }
+        _WriteState();
+
+        m_Header->response_seq.store( request_seq, std::memory_order_release );
+        _FutexWake( &m_Header->response_seq );
+        return true;
+    }
+
+    void TDartShmServer::Stop()
+    {
+        m_Running = false;
+        if ( m_Header )
+            _FutexWake( &m_Header->request_seq );
+    }
+
+    void TDartShmServer::_WriteState()
+    {
+        const auto& snapshot = m_SimulationRef->state();
+        const ssize_t num_bodies = std::min<ssize_t>( m_NumBodies, snapshot.poses.rows() );
+        auto states = reinterpret_cast<double*>( m_Region + m_OffsetStates );
+        for ( ssize_t i = 0; i < num_bodies; i++ )
+        {
+            std::memcpy( states + i * LOCO_DART_SHM_BODY_STATE_SIZE, snapshot.poses.row( i ).data(), 7 * sizeof( double ) );
+            std::memcpy( states + i * LOCO_DART_SHM_BODY_STATE_SIZE + 7, snapshot.velocities.row( i ).data(), 6 * sizeof( double ) );
+        }
+
+        auto contacts = reinterpret_cast<TDartShmContact*>( m_Region + m_OffsetContacts );
+        const ssize_t num_contacts = std::min<ssize_t>( m_MaxContacts, snapshot.contacts.size() );
+        for ( ssize_t i = 0; i < num_contacts; i++ )
+        {
+            const auto& contact = snapshot.contacts[i];
+            contacts[i].collider_id_1 = contact.collider_id_1;
+            contacts[i].collider_id_2 = contact.collider_id_2;
+            Eigen::Map<Eigen::Vector3d>( contacts[i].position ) = contact.position;
+            Eigen::Map<Eigen::Vector3d>( contacts[i].normal ) = contact.normal;
+        }
+        m_Header->num_contacts = num_contacts;
+        m_Header->sim_time = snapshot.time;
+    }
+
+    /***********************************************************************************************
+    *                                     Shared-memory Client                                     *
+    ***********************************************************************************************/
+
+    TDartShmClient::~TDartShmClient()
+    {
+        Disconnect();
+    }
+
+    bool TDartShmClient::Connect( const std::string& socket_path )
+    {
+        struct sockaddr_un address;
+        if ( socket_path.size() >= sizeof( address.sun_path ) )
+        {
+            LOCO_CORE_ERROR( "TDartShmClient::Connect >>> control-socket path {0} too long (max. {1} characters)",
+                             socket_path, sizeof( address.sun_path ) - 1 );
+            return false;
+        }
+
+        const int socket_fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+        std::memset( &address, 0, sizeof( address ) );
+        address.sun_family = AF_UNIX;
+        std::memcpy( address.sun_path, socket_path.c_str(), socket_path.size() );
+        if ( socket_fd < 0 || connect( socket_fd, reinterpret_cast<struct sockaddr*>( &address ), sizeof( address ) ) != 0 )
+        {
+            LOCO_CORE_ERROR( "TDartShmClient::Connect >>> couldn't connect to {0}: {1}", socket_path, std::strerror( errno ) );
+            if ( socket_fd >= 0 )
+                close( socket_fd );
+            return false;
+        }
+
+        TDartShmHandshake handshake;
+        const ssize_t num_read = read( socket_fd, &handshake, sizeof( handshake ) );
+        close( socket_fd );
+        if ( num_read != sizeof( handshake ) || handshake.magic != LOCO_DART_SHM_MAGIC || handshake.version != LOCO_DART_SHM_VERSION )
+        {
+            LOCO_CORE_ERROR( "TDartShmClient::Connect >>> invalid handshake from {0} (expected layout version {1})",
+                             socket_path, LOCO_DART_SHM_VERSION );
+            return false;
+        }
+
+        handshake.shm_name[sizeof( handshake.shm_name ) - 1] = '\0';
+        m_ShmFd = shm_open( handshake.shm_name, O_RDWR, 0600 );
+        void* region = ( m_ShmFd >= 0 ) ? mmap( nullptr, handshake.region_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_ShmFd, 0 ) : MAP_FAILED;
+        if ( region == MAP_FAILED )
+        {
+            LOCO_CORE_ERROR( "TDartShmClient::Connect >>> couldn't map shared-memory region {0}: {1}", handshake.shm_name, std::strerror( errno ) );
+            Disconnect();
+            return false;
+        }
+        m_Region = static_cast<uint8_t*>( region );
+        m_RegionSize = handshake.region_size;
+        m_Header = reinterpret_cast<TDartShmHeader*>( m_Region );
+        return true;
+    }
+
+    void TDartShmClient::Disconnect()
+    {
+        if ( m_Region )
+            munmap( m_Region, m_RegionSize );
+        if ( m_ShmFd >= 0 )
+            close( m_ShmFd );
+        m_Region = nullptr;
+        m_Header = nullptr;
+        m_ShmFd = -1;
+    }
+
+    bool TDartShmClient::Step( double dt )
+    {
+        return _Request( SHM_COMMAND_STEP, dt );
+    }
+
+    bool TDartShmClient::Reset()
+    {
+        return _Request( SHM_COMMAND_RESET, 0.0 );
+    }
+
+    bool TDartShmClient::Read()
+    {
+        return _Request( SHM_COMMAND_READ, 0.0 );
+    }
+
+    bool TDartShmClient::_Request( uint32_t command, double dt )
+    {
+        if ( !m_Header )
+        {
+            LOCO_CORE_ERROR( "TDartShmClient::_Request >>> not connected to a server" );
+            return false;
+        }
+
+        m_Header->command = command;
+        m_Header->dt = dt;
+        const uint32_t request_seq = m_Header->request_seq.load( std::memory_order_relaxed ) + 1;
+        m_Header->request_seq.store( request_seq, std::memory_order_release );
+        _FutexWake( &m_Header->request_seq );
+
+        // Responses to steps of small scenes come back within microseconds, so spin for a while before sleeping
+        for ( ssize_t i = 0; i < m_SpinIterations; i++ )
+            if ( m_Header->response_seq.load( std::memory_order_acquire ) == request_seq )
+                return m_Header->status == SHM_STATUS_OK;
+
+        uint32_t response_seq;
+        while ( ( response_seq = m_Header->response_seq.load( std::memory_order_acquire ) ) != request_seq )
+            _FutexWait( &m_Header->response_seq, response_seq, -1.0 );
+        return m_Header->status == SHM_STATUS_OK;
+    }
+
+    TDartShmClient::TStates TDartShmClient::states() const
+    {
+        return TStates( reinterpret_cast<const double*>( m_Region + m_Header->offset_states ), m_Header->num_bodies,
+                        LOCO_DART_SHM_BODY_STATE_SIZE );
+    }
+
+    TDartShmClient::TActuation TDartShmClient::actuation()
+    {
+        return TActuation( reinterpret_cast<double*>( m_Region + m_Header->offset_actuation ), m_Header->num_actuators );
+    }
+
+    const TDartShmContact* TDartShmClient::contacts() const
+    {
+        return reinterpret_cast<const TDartShmContact*>( m_Region + m_Header->offset_contacts );
+    }
+}}
@@ -0,0 +1,345 @@
+
+#include <terrain/loco_terrain_tiled_dart.h>
+
+#include <fstream>
+#include <cstring>
+
+namespace loco {
+namespace terrain {
+
+    // Factor applied to the activation radius to decide when to evict a tile (avoids load/evict thrashing)
+    const TScalar LOCO_DART_TERRAIN_EVICTION_FACTOR = 1.25f;
+
+    bool CreateHeightFile( const std::string& filepath, ssize_t num_width_samples, ssize_t num_depth_samples,
+                           const TVec3& size, const std::vector<float>& heights )
+    {
+        if ( num_width_samples * num_depth_samples != (ssize_t)heights.size() )
+        {
+            LOCO_CORE_ERROR( "CreateHeightFile >>> heights-data mismatch ({0}x{1} samples, but got buffer of size {2})",
+                             num_width_samples, num_depth_samples, heights.size() );
+            return false;
+        }
+
+        std::ofstream file_handle( filepath, std::ios::binary | std::ios::trunc );
+        if ( !file_handle.is_open() )
+        {
+            LOCO_CORE_ERROR( "CreateHeightFile >>> couldn't open file {0} for writing", filepath );
+            return false;
+        }
+
+        TDartHeightFileHeader header;
+        std::memcpy( header.magic, LOCO_DART_HEIGHT_FILE_MAGIC, sizeof( header.magic ) );
+        header.version = LOCO_DART_HEIGHT_FILE_VERSION;
+        header.nWidthSamples = num_width_samples;
+        header.nDepthSamples = num_depth_samples;
+        header.size_x = size.x();
+        header.size_y = size.y();
+        header.scale_z = size.z();
+        file_handle.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+        file_handle.write( reinterpret_cast<const char*>( heights.data() ), sizeof( float ) * heights.size() );
+        return file_handle.good();
+    }
+
+    TDartTiledTerrain::TDartTiledTerrain( const TDartTiledTerrainData& data )
+        : m_Data( data )
+    {
+        m_HeightFile = nullptr;
+        m_HeightsMapped = nullptr;
+        m_NumTilesX = 0;
+        m_NumTilesY = 0;
+        m_DartWorldRef = nullptr;
+
+        if ( m_Data.tile_num_samples < 2 )
+        {
+            LOCO_CORE_WARN( "TDartTiledTerrain >>> tiles of terrain {0} need at least 2 samples per side", m_Data.name );
+            m_Data.tile_num_samples = 2;
+        }
+
+        if ( !_MapHeightFile() )
+            return;
+
+        const ssize_t num_width_samples = m_Header.nWidthSamples;
+        const ssize_t num_depth_samples = m_Header.nDepthSamples;
+        m_Scale = Eigen::Vector3f( m_Header.size_x / ( num_width_samples - 1 ),
+                                   m_Header.size_y / ( num_depth_samples - 1 ),
+                                   m_Header.scale_z );
+
+        // Neighbouring tiles share their border samples, so each tile advances (tile_num_samples - 1) samples
+        const ssize_t tile_stride = m_Data.tile_num_samples - 1;
+        m_NumTilesX = ( num_width_samples - 2 ) / tile_stride + 1;
+        m_NumTilesY = ( num_depth_samples - 2 ) / tile_stride + 1;
+        m_Tiles.resize( m_NumTilesX * m_NumTilesY );
+        m_TilesFlags.resize( m_Tiles.size(), 0 );
+        m_TilesLayouts.resize( m_Tiles.size(), dartsim::eHeightfieldLayout::UNKNOWN );
+        for ( ssize_t ty = 0; ty < m_NumTilesY; ty++ )
+        {
+            for ( ssize_t tx = 0; tx < m_NumTilesX; tx++ )
+            {
+                auto& tile = m_Tiles[ty * m_NumTilesX + tx];
+                tile.x0 = tx * tile_stride;
+                tile.y0 = ty * tile_stride;
+                tile.width = std::min( m_Data.tile_num_samples, num_width_samples - tile.x0 );
+                tile.depth = std::min( m_Data.tile_num_samples, num_depth_samples - tile.y0 );
+                tile.skeleton = nullptr;
+                tile.shape = nullptr;
+            }
+        }
+
+    #if defined( LOCO_CORE_USE_TRACK_ALLOCS )
+        if ( tinyutils::Logger::IsActive() )
+            LOCO_CORE_TRACE( "Loco::Allocs: Created TDartTiledTerrain {0} @ {1}", m_Data.name, tinyutils::PointerToHexAddress( this ) );
+        else
+            std::cout << "Loco::Allocs: Created TDartTiledTerrain " << m_Data.name << " @ " << tinyutils::PointerToHexAddress( this ) << std::endl;
+    #endif
+    }
+
+    TDartTiledTerrain::~TDartTiledTerrain()
+    {
+        if ( m_DartWorldRef )
+        {
+            for ( auto tile_index : m_ActiveTiles )
+                m_DartWorldRef->removeSkeleton( m_Tiles[tile_index].skeleton );
+        }
+        m_ActiveTiles.clear();
+        m_Tiles.clear();
+        m_SkeletonsPool.clear();
+        m_DartWorldRef = nullptr;
+
+        _UnmapHeightFile();
+
+    #if defined( LOCO_CORE_USE_TRACK_ALLOCS )
+        if ( tinyutils::Logger::IsActive() )
+            LOCO_CORE_TRACE( "Loco::Allocs: Destroyed TDartTiledTerrain {0} @ {1}", m_Data.name, tinyutils::PointerToHexAddress( this ) );
+        else
+            std::cout << "Loco::Allocs: Destroyed TDartTiledTerrain " << m_Data.name << " @ " << tinyutils::PointerToHexAddress( this ) << std::endl;
+    #endif
+    }
+
+    bool TDartTiledTerrain::_MapHeightFile()
+    {
+        m_HeightFile = std::make_unique<dartsim::TDartMappedFileReader>( m_Data.heights_filepath, true );
+        if ( !m_HeightFile->valid() )
+        {
+            LOCO_CORE_ERROR( "TDartTiledTerrain::_MapHeightFile >>> couldn't map height-file {0}", m_Data.heights_filepath );
+            _UnmapHeightFile();
+            return false;
+        }
+
+        if ( m_HeightFile->size() < sizeof( TDartHeightFileHeader ) )
+        {
+            LOCO_CORE_ERROR( "TDartTiledTerrain::_MapHeightFile >>> height-file {0} is too small", m_Data.heights_filepath );
+            _UnmapHeightFile();
+            return false;
+        }
+
+        std::memcpy( &m_Header, m_HeightFile->data(), sizeof( m_Header ) );
+        const size_t expected_size = sizeof( TDartHeightFileHeader ) + sizeof( float ) * m_Header.nWidthSamples * m_Header.nDepthSamples;
+        if ( ( std::memcmp( m_Header.magic, LOCO_DART_HEIGHT_FILE_MAGIC, sizeof( m_Header.magic ) ) != 0 ) ||
+             ( m_Header.version != LOCO_DART_HEIGHT_FILE_VERSION ) ||
+             ( m_Header.nWidthSamples < 2 ) || ( m_Header.nDepthSamples < 2 ) ||
+             ( m_HeightFile->size() < expected_size ) )
+        {
+            LOCO_CORE_ERROR( "TDartTiledTerrain::_MapHeightFile >>> height-file {0} has an invalid header", m_Data.heights_filepath );
+            _UnmapHeightFile();
+            return false;
+        }
+
+        m_HeightsMapped = reinterpret_cast<float*>( m_HeightFile->mutable_data() + sizeof( TDartHeightFileHeader ) );
+        return true;
+    }
+
+    void TDartTiledTerrain::_UnmapHeightFile()
+    {
+        // Changes to the elevation-data are flushed into the height-file when unmapped
+        m_HeightFile = nullptr;
+        m_HeightsMapped = nullptr;
+    }
+
+    void TDartTiledTerrain::Update( const std::vector<Eigen::Vector3d>& focus_points )
+    {
+        if ( !m_HeightsMapped || !m_DartWorldRef )
+            return;
+
+        // Tiles go along +x as their first sample, but along -y (first row at the +y border, as dart lays them out)
+        const double terrain_min_x = m_Data.position.x() - 0.5 * m_Header.size_x;
+        const double terrain_max_y = m_Data.position.y() + 0.5 * m_Header.size_y;
+        const double tile_span_x = ( m_Data.tile_num_samples - 1 ) * m_Scale.x();
+        const double tile_span_y = ( m_Data.tile_num_samples - 1 ) * m_Scale.y();
+        const double load_radius = m_Data.activation_radius;
+        const double keep_radius = m_Data.activation_radius * LOCO_DART_TERRAIN_EVICTION_FACTOR;
+
+        // Flag the tiles around each focus point (only the tiles within the keep-radius are visited)
+        std::fill( m_TilesFlags.begin(), m_TilesFlags.end(), 0 );
+        for ( const auto& point : focus_points )
+        {
+            const Eigen::Vector2d point_xy( point.x(), point.y() );
+            const ssize_t tx_min = std::max<ssize_t>( 0, std::floor( ( point.x() - keep_radius - terrain_min_x ) / tile_span_x ) );
+            const ssize_t tx_max = std::min<ssize_t>( m_NumTilesX - 1, std::floor( ( point.x() + keep_radius - terrain_min_x ) / tile_span_x ) );
+            const ssize_t ty_min = std::max<ssize_t>( 0, std::floor( ( terrain_max_y - point.y() - keep_radius ) / tile_span_y ) );
+            const ssize_t ty_max = std::min<ssize_t>( m_NumTilesY - 1, std::floor( ( terrain_max_y - point.y() + keep_radius ) / tile_span_y ) );
+            for ( ssize_t ty = ty_min; ty <= ty_max; ty++ )
+            {
+                for ( ssize_t tx = tx_min; tx <= tx_max; tx++ )
+                {
+                    const ssize_t tile_index = ty * m_NumTilesX + tx;
+                    const double distance = ( _TileCenter( tile_index ) - point_xy ).norm();
+                    if ( distance <= load_radius )
+                        m_TilesFlags[tile_index] = 2;
+                    else if ( distance <= keep_radius )
+                        m_TilesFlags[tile_index] = std::max<uint8_t>( m_TilesFlags[tile_index], 1 );
+                }
+            }
+        }
+
+        // Evict the active tiles that are far from all focus points (back to the pool)
+        for ( ssize_t i = (ssize_t)m_ActiveTiles.size() - 1; i >= 0; i-- )
+        {
+            const ssize_t tile_index = m_ActiveTiles[i];
+            if ( m_TilesFlags[tile_index] != 0 )
+            {
+                // Already loaded, so no need to load it again
+                m_TilesFlags[tile_index] = 1;
+                continue;
+            }
+            _EvictTile( tile_index );
+            m_ActiveTiles[i] = m_ActiveTiles.back();
+            m_ActiveTiles.pop_back();
+        }
+
+        // Instantiate the tiles that were requested and are not loaded yet
+        for ( const auto& point : focus_points )
+        {
+            const ssize_t tx_min = std::max<ssize_t>( 0, std::floor( ( point.x() - load_radius - terrain_min_x ) / tile_span_x ) );
+            const ssize_t tx_max = std::min<ssize_t>( m_NumTilesX - 1, std::floor( ( point.x() + load_radius - terrain_min_x ) / tile_span_x ) );
+            const ssize_t ty_min = std::max<ssize_t>( 0, std::floor( ( terrain_max_y - point.y() - load_radius ) / tile_span_y ) );
+            const ssize_t ty_max = std::min<ssize_t>( m_NumTilesY - 1, std::floor( ( terrain_max_y - point.y() + load_radius ) / tile_span_y ) );
+            for ( ssize_t ty = ty_min; ty <= ty_max; ty++ )
+            {
+                for ( ssize_t tx = tx_min; tx <= tx_max; tx++ )
+                {
+                    const ssize_t tile_index = ty * m_NumTilesX + tx;
+                    if ( m_TilesFlags[tile_index] != 2 )
+                        continue;
+                    _LoadTile( tile_index );
+                    m_ActiveTiles.push_back( tile_index );
+                    m_TilesFlags[tile_index] = 1;
+                }
+            }
+        }
+    }
+
+    void TDartTiledTerrain::ChangeElevationRegion( ssize_t x0, ssize_t y0, ssize_t width, ssize_t depth, const std::vector<float>& heights )
+    {
+        if ( !m_HeightsMapped )
+            return;
+
+        const ssize_t num_width_samples = m_Header.nWidthSamples;
+        const ssize_t num_depth_samples = m_Header.nDepthSamples;
+        if ( ( x0 < 0 ) || ( y0 < 0 ) || ( width <= 0 ) || ( depth <= 0 ) ||
+             ( x0 + width > num_width_samples ) || ( y0 + depth > num_depth_samples ) ||
+             ( width * depth != (ssize_t)heights.size() ) )
+        {
+            LOCO_CORE_WARN( "TDartTiledTerrain::ChangeElevationRegion >>> region-data mismatch for terrain {0}", m_Data.name );
+            return;
+        }
+
+        // The height-file holds the unflipped heights of the tiles in use, so the layouts of the buffers of their
+        // shapes must be checked against it before it changes
+        for ( auto tile_index : m_ActiveTiles )
+            m_TilesLayouts[tile_index] = dartsim::GetHeightfieldLayout( m_Tiles[tile_index].shape, _TileHeights( tile_index ) );
+
+        // The height-file is the source of truth (tiles are just caches of it), so write there first
+        for ( ssize_t i = 0; i < depth; i++ )
+            std::memcpy( m_HeightsMapped + ( y0 + i ) * num_width_samples + x0, heights.data() + i * width, sizeof( float ) * width );
+
+        // Then refresh the overlapping part of the tiles currently instantiated
+        for ( auto tile_index : m_ActiveTiles )
+        {
+            const auto& tile = m_Tiles[tile_index];
+            const ssize_t ox0 = std::max( x0, tile.x0 );
+            const ssize_t oy0 = std::max( y0, tile.y0 );
+            const ssize_t ox1 = std::min( x0 + width, tile.x0 + tile.width );
+            const ssize_t oy1 = std::min( y0 + depth, tile.y0 + tile.depth );
+            if ( ( ox0 >= ox1 ) || ( oy0 >= oy1 ) )
+                continue;
+
+            dartsim::WriteHeightfieldRegion( tile.shape, m_TilesLayouts[tile_index], _TileHeights( tile_index ),
+                                             ox0 - tile.x0, oy0 - tile.y0, ox1 - ox0, oy1 - oy0 );
+        }
+    }
+
+    void TDartTiledTerrain::GetActiveShapes( std::vector<const dart::dynamics::Shape*>& dst_shapes ) const
+    {
+        for ( auto tile_index : m_ActiveTiles )
+            dst_shapes.push_back( m_Tiles[tile_index].shape );
+    }
+
+    void TDartTiledTerrain::_LoadTile( ssize_t tile_index )
+    {
+        auto& tile = m_Tiles[tile_index];
+        tile.skeleton = _GrabSkeleton( tile_index );
+
+        auto body_node = tile.skeleton->getBodyNode( 0 );
+        tile.shape = static_cast<dart::dynamics::HeightmapShapef*>( body_node->getShapeNode( 0 )->getShape().get() );
+
+        tile.shape->setHeightField( dart::dynamics::HeightmapShapef::HeightField( _TileHeights( tile_index ) ) );
+        tile.shape->setScale( m_Scale );
+
+        // Heightmap-shapes are centered (in xy) at the origin of their frame, so place the tile at its center
+        const Eigen::Vector2d tile_center = _TileCenter( tile_index );
+        Eigen::Isometry3d tile_tf( Eigen::Isometry3d::Identity() );
+        tile_tf.translation() = Eigen::Vector3d( tile_center.x(), tile_center.y(), m_Data.position.z() );
+        tile.skeleton->getJoint( 0 )->setTransformFromParentBodyNode( tile_tf );
+
+        m_DartWorldRef->addSkeleton( tile.skeleton );
+    }
+
+    void TDartTiledTerrain::_EvictTile( ssize_t tile_index )
+    {
+        auto& tile = m_Tiles[tile_index];
+        // Elevation-data lives in the height-file (edits are written through), so nothing to write back here
+        m_DartWorldRef->removeSkeleton( tile.skeleton );
+        m_SkeletonsPool.push_back( std::move( tile.skeleton ) );
+        tile.skeleton = nullptr;
+        tile.shape = nullptr;
+    }
+
+    dart::dynamics::SkeletonPtr TDartTiledTerrain::_GrabSkeleton( ssize_t tile_index )
+    {
+        const std::string tile_name = m_Data.name + "_tile_" + std::to_string( tile_index );
+        if ( m_SkeletonsPool.size() > 0 )
+        {
+            auto skeleton = std::move( m_SkeletonsPool.back() );
+            m_SkeletonsPool.pop_back();
+            skeleton->setName( tile_name );
+            return skeleton;
+        }
+
+        auto skeleton = dart::dynamics::Skeleton::create( tile_name );
+        dart::dynamics::WeldJoint::Properties joint_properties;
+        joint_properties.mName = tile_name + "_weldjoint";
+        auto joint_bodynode_pair = skeleton->createJointAndBodyNodePair<dart::dynamics::WeldJoint>(
+                                            nullptr, joint_properties, dart::dynamics::BodyNode::AspectProperties( tile_name ) );
+        auto shape_node = joint_bodynode_pair.second->createShapeNodeWith<
+                                            dart::dynamics::CollisionAspect,
+                                            dart::dynamics::DynamicsAspect>( std::make_shared<dart::dynamics::HeightmapShapef>() );
+        shape_node->getDynamicsAspect()->setFrictionCoeff( m_Data.friction );
+        return skeleton;
+    }
+
+    Eigen::Vector2d TDartTiledTerrain::_TileCenter( ssize_t tile_index ) const
+    {
+        const auto& tile = m_Tiles[tile_index];
+        const double center_x = ( tile.x0 + 0.5 * ( tile.width - 1 ) ) * m_Scale.x();
+        const double center_y = ( tile.y0 + 0.5 * ( tile.depth - 1 ) ) * m_Scale.y();
+        return Eigen::Vector2d( m_Data.position.x() - 0.5 * m_Header.size_x + center_x,
+                                m_Data.position.y() + 0.5 * m_Header.size_y - center_y );
+    }
+
+    dartsim::THeightsConstMap TDartTiledTerrain::_TileHeights( ssize_t tile_index ) const
+    {
+        const auto& tile = m_Tiles[tile_index];
+        return dartsim::THeightsConstMap( m_HeightsMapped + tile.y0 * m_Header.nWidthSamples + tile.x0,
+                                          tile.depth, tile.width, Eigen::OuterStride<>( m_Header.nWidthSamples ) );
+    }
+}}
@@ -34,6 +34,38 @@ std::vector<float> create_hfield( size_t nWidthSamples, size_t nDepthSamples )
     return hfield;
 }
 
+// Ramp along the depth direction (not symmetric, so rows that end up mirrored can be told apart)
+std::vector<float> create_hfield_ramp( size_t nWidthSamples, size_t nDepthSamples )
+{
+    std::vector<float> hfield( nWidthSamples * nDepthSamples );
+    for ( size_t i = 0; i < nDepthSamples; i++ )
+        for ( size_t j = 0; j < nWidthSamples; j++ )
+            hfield[i * nWidthSamples + j] = 0.1f * i + 0.01f * j;
+    return hfield;
+}
+
+dart::dynamics::SkeletonPtr create_fixed_skeleton( const std::string& name, const dart::dynamics::ShapePtr& shape )
+{
+    auto skeleton = dart::dynamics::Skeleton::create( name );
+    auto body_node = skeleton->createJointAndBodyNodePair<dart::dynamics::WeldJoint>().second;
+    body_node->createShapeNodeWith<dart::dynamics::CollisionAspect>( shape );
+    return skeleton;
+}
+
+double probe_penetration( dart::collision::CollisionGroup* group, dart::dynamics::SkeletonPtr probe, const Eigen::Vector3d& position )
+{
+    Eigen::Isometry3d tf = Eigen::Isometry3d::Identity();
+    tf.translation() = position;
+    probe->getRootJoint()->setTransformFromParentBodyNode( tf );
+    dart::collision::CollisionOption option( true, 100 );
+    dart::collision::CollisionResult result;
+    group->collide( option, &result );
+    double penetration = 0.0;
+    for ( const auto& contact : result.getContacts() )
+        penetration = std::max( penetration, contact.penetrationDepth );
+    return penetration;
+}
+
 std::pair<std::vector<float>, std::vector<int>> create_mesh_tetrahedron()
 {
     std::vector<float> vertices = { 0.0f, 0.0f, 0.0f,
@@ -216,4 +248,130 @@ TEST( TestLocoDartCollisionAdapter, TestLocoDartCollisionAdapterHfieldBuild )
     EXPECT_TRUE( std::abs( dart_scale.z() - expected_scale_height ) < 1e-5 );
     EXPECT_EQ( dart_hfield_shape->getWidth(), num_width_samples );
     EXPECT_EQ( dart_hfield_shape->getDepth(), num_depth_samples );
-}
\ No newline at end of file
+}
+
+TEST( TestLocoDartCollisionAdapter, TestLocoDartCollisionAdapterHfieldRegionUpdate )
+{
+    loco::InitUtils();
+
+    const size_t num_width_samples = 40;
+    const size_t num_depth_samples = 30;
+    auto col_data = loco::TCollisionData();
+    col_data.type = loco::eShapeType::HFIELD;
+    col_data.size = { 10.0f, 10.0f, 2.0f }; // width, depth, scale-height
+    col_data.hfield_data.nWidthSamples = num_width_samples;
+    col_data.hfield_data.nDepthSamples = num_depth_samples;
+    col_data.hfield_data.heights = create_hfield( num_width_samples, num_depth_samples );
+
+    const auto collider_name = loco::ToString( col_data.type ) + "_collider";
+    auto col_obj = std::make_unique<loco::TSingleBodyCollider>( collider_name, col_data );
+    auto col_adapter = std::make_unique<loco::primitives::TDartSingleBodyColliderAdapter>( col_obj.get() );
+    col_adapter->Build();
+    auto dart_hfield_shape = dynamic_cast<dart::dynamics::HeightmapShapef*>( col_adapter->collision_shape().get() );
+    ASSERT_TRUE( dart_hfield_shape != nullptr );
+
+    // Patch within the current bounds (updated in place)
+    const ssize_t x0 = 5, y0 = 7, width = 4, depth = 3;
+    std::vector<float> patch( width * depth, 0.25f );
+    col_adapter->ChangeElevationRegion( x0, y0, width, depth, patch );
+
+    const auto& hfield = dart_hfield_shape->getHeightField();
+    for ( ssize_t i = 0; i < (ssize_t)num_depth_samples; i++ )
+    {
+        for ( ssize_t j = 0; j < (ssize_t)num_width_samples; j++ )
+        {
+            const bool in_patch = ( i >= y0 && i < y0 + depth && j >= x0 && j < x0 + width );
+            const float expected = in_patch ? 0.25f : col_data.hfield_data.heights[i * num_width_samples + j];
+            EXPECT_TRUE( std::abs( hfield( i, j ) - expected ) < 1e-5 );
+        }
+    }
+
+    // Patch going past the current bounds (vertical extent must be refreshed)
+    std::vector<float> tall_patch( width * depth, 10.0f );
+    col_adapter->ChangeElevationRegion( x0, y0, width, depth, tall_patch );
+    EXPECT_TRUE( std::abs( dart_hfield_shape->getMaxHeight() - 10.0f ) < 1e-5 );
+
+    // Out-of-range patches are rejected, leaving the heights untouched
+    col_adapter->ChangeElevationRegion( num_width_samples - 2, 0, width, depth, patch );
+    EXPECT_TRUE( std::abs( dart_hfield_shape->getHeightField()( 0, num_width_samples - 1 ) -
+                           col_data.hfield_data.heights[num_width_samples - 1] ) < 1e-5 );
+}
+
+TEST( TestLocoDartCollisionAdapter, TestLocoDartCollisionAdapterHfieldRegionUpdateBullet )
+{
+    loco::InitUtils();
+
+    const ssize_t num_width_samples = 20;
+    const ssize_t num_depth_samples = 30;
+    auto col_data = loco::TCollisionData();
+    col_data.type = loco::eShapeType::HFIELD;
+    col_data.size = { 4.0f, 6.0f, 1.0f }; // width, depth, scale-height
+    col_data.hfield_data.nWidthSamples = num_width_samples;
+    col_data.hfield_data.nDepthSamples = num_depth_samples;
+    col_data.hfield_data.heights = create_hfield_ramp( num_width_samples, num_depth_samples );
+
+    const auto collider_name = loco::ToString( col_data.type ) + "_collider";
+    auto col_obj = std::make_unique<loco::TSingleBodyCollider>( collider_name, col_data );
+    auto col_adapter = std::make_unique<loco::primitives::TDartSingleBodyColliderAdapter>( col_obj.get() );
+    col_adapter->Build();
+    auto dart_hfield_shape = std::dynamic_pointer_cast<dart::dynamics::HeightmapShapef>( col_adapter->collision_shape() );
+    ASSERT_TRUE( dart_hfield_shape != nullptr );
+
+    // The bullet collision-detector flips the heights of the shape in place once it has built its terrain-shape
+    auto detector = dart::collision::BulletCollisionDetector::create();
+    auto terrain = create_fixed_skeleton( "terrain", dart_hfield_shape );
+    auto probe = create_fixed_skeleton( "probe", std::make_shared<dart::dynamics::SphereShape>( 0.1 ) );
+    auto group = detector->createCollisionGroup( terrain.get(), probe.get() );
+
+    auto expected_heights = col_data.hfield_data.heights;
+    auto fnCheckContacts = [&]()
+        {
+            // Reference terrain, built from scratch with the heights we expect (and flipped the same way)
+            auto ref_shape = std::make_shared<dart::dynamics::HeightmapShapef>();
+            ref_shape->setScale( dart_hfield_shape->getScale() );
+            ref_shape->setHeightField( dart::dynamics::HeightmapShapef::HeightField(
+                Eigen::Map<const loco::dartsim::THeightsMatrix>( expected_heights.data(), num_depth_samples, num_width_samples ) ) );
+            auto ref_detector = dart::collision::BulletCollisionDetector::create();
+            auto ref_terrain = create_fixed_skeleton( "ref_terrain", ref_shape );
+            auto ref_probe = create_fixed_skeleton( "ref_probe", std::make_shared<dart::dynamics::SphereShape>( 0.1 ) );
+            auto ref_group = ref_detector->createCollisionGroup( ref_terrain.get(), ref_probe.get() );
+
+            const auto scale = dart_hfield_shape->getScale();
+            ssize_t num_hits = 0;
+            for ( ssize_t i = 1; i < num_depth_samples - 1; i += 2 )
+            {
+                for ( ssize_t j = 1; j < num_width_samples - 1; j += 3 )
+                {
+                    for ( double z : { 0.5, 1.5, 2.5, 3.4 } )
+                    {
+                        const Eigen::Vector3d position( ( j - 0.5 * ( num_width_samples - 1 ) ) * scale.x(),
+                                                        ( i - 0.5 * ( num_depth_samples - 1 ) ) * scale.y(), z );
+                        const double penetration = probe_penetration( group.get(), probe, position );
+                        const double ref_penetration = probe_penetration( ref_group.get(), ref_probe, position );
+                        EXPECT_NEAR( penetration, ref_penetration, 1e-4 );
+                        num_hits += ( ref_penetration > 0.0 ) ? 1 : 0;
+                    }
+                }
+            }
+            EXPECT_GT( num_hits, 0 );
+        };
+    auto fnChangeRegion = [&]( ssize_t x0, ssize_t y0, ssize_t width, ssize_t depth, float height )
+        {
+            std::vector<float> patch( width * depth, height );
+            col_adapter->ChangeElevationRegion( x0, y0, width, depth, patch );
+            for ( ssize_t i = y0; i < y0 + depth; i++ )
+                for ( ssize_t j = x0; j < x0 + width; j++ )
+                    expected_heights[i * num_width_samples + j] = height;
+        };
+
+    fnCheckContacts();
+    // Patch within the current bounds, written in place into the (flipped) buffer used by bullet
+    fnChangeRegion( 3, 4, 6, 5, 1.5f );
+    fnCheckContacts();
+    // Patch going past the current bounds, so the shape gets rebuilt (and flipped again by bullet)
+    fnChangeRegion( 10, 20, 5, 6, 3.4f );
+    fnCheckContacts();
+    // Patch within bounds once again, after the rebuild
+    fnChangeRegion( 12, 2, 4, 4, 2.5f );
+    fnCheckContacts();
+}
@@ -0,0 +1,357 @@
+
+#include <loco.h>
+#include <gtest/gtest.h>
+
+#include <loco_common_dart.h>
+
+// Exposes the creation of collision-objects, so the filters can be queried without going through a full step
+class TExposedBulletCollisionDetector : public dart::collision::BulletCollisionDetector
+{
+public :
+    TExposedBulletCollisionDetector() : dart::collision::BulletCollisionDetector() {}
+
+    using dart::collision::CollisionDetector::claimCollisionObject;
+};
+
+// Previous filter implementation (hash-maps lookups on every pair), kept as reference for the dense-slots filter
+class TMapBasedBitmaskCollisionFilter : public dart::collision::BodyNodeCollisionFilter
+{
+public :
+
+    bool ignoresCollision( const dart::collision::CollisionObject* object_1,
+                           const dart::collision::CollisionObject* object_2 ) const override
+    {
+        if ( dart::collision::BodyNodeCollisionFilter::ignoresCollision( object_1, object_2 ) )
+            return true;
+
+        auto shape_node_1 = object_1->getShapeFrame()->asShapeNode();
+        auto shape_node_2 = object_2->getShapeFrame()->asShapeNode();
+
+        if ( m_CollisionGroupsMap.find( shape_node_1 ) == m_CollisionGroupsMap.end() ||
+             m_CollisionGroupsMap.find( shape_node_2 ) == m_CollisionGroupsMap.end() ||
+             m_CollisionMasksMap.find( shape_node_1 ) == m_CollisionMasksMap.end() ||
+             m_CollisionMasksMap.find( shape_node_2 ) == m_CollisionMasksMap.end() )
+            return false;
+
+        auto shape_1_colgroup = m_CollisionGroupsMap.at( shape_node_1 );
+        auto shape_2_colgroup = m_CollisionGroupsMap.at( shape_node_2 );
+        auto shape_1_colmask = m_CollisionMasksMap.at( shape_node_1 );
+        auto shape_2_colmask = m_CollisionMasksMap.at( shape_node_2 );
+
+        bool col_affinity_1_2 = ( shape_1_colgroup & shape_2_colmask ) != 0;
+        bool col_affinity_2_1 = ( shape_2_colgroup & shape_1_colmask ) != 0;
+
+        return !(col_affinity_1_2 || col_affinity_2_1);
+    }
+
+    void setCollisionGroup( const dart::dynamics::ShapeNode* shape_node, int collision_group )
+    {
+        m_CollisionGroupsMap[shape_node] = collision_group;
+    }
+
+    void setCollisionMask( const dart::dynamics::ShapeNode* shape_node, int collision_mask )
+    {
+        m_CollisionMasksMap[shape_node] = collision_mask;
+    }
+
+private :
+
+    std::unordered_map<const dart::dynamics::ShapeNode*,int> m_CollisionGroupsMap;
+    std::unordered_map<const dart::dynamics::ShapeNode*,int> m_CollisionMasksMap;
+};
+
+TEST( TestLocoDartCollisionFilter, TestLocoDartCollisionFilterDenseSlots )
+{
+    loco::InitUtils();
+
+    // Swarm-like setup: agents (group 2) only collide with the environment (group 1), and vice-versa
+    const size_t num_bodies = 256;
+    std::vector<dart::dynamics::SkeletonPtr> skeletons;
+    std::vector<dart::dynamics::ShapeNode*> shape_nodes;
+    for ( size_t i = 0; i < num_bodies; i++ )
+    {
+        auto skeleton = dart::dynamics::Skeleton::create( "body_" + std::to_string( i ) );
+        auto joint_bodynode_pair = skeleton->createJointAndBodyNodePair<dart::dynamics::FreeJoint>();
+        auto shape_node = joint_bodynode_pair.second->createShapeNodeWith<dart::dynamics::CollisionAspect>(
+                                    std::make_shared<dart::dynamics::BoxShape>( Eigen::Vector3d( 0.1, 0.1, 0.1 ) ) );
+        skeletons.push_back( skeleton );
+        shape_nodes.push_back( shape_node );
+    }
+
+    auto detector = std::make_shared<TExposedBulletCollisionDetector>();
+    std::vector<std::shared_ptr<dart::collision::CollisionObject>> objects;
+    for ( auto shape_node : shape_nodes )
+        objects.push_back( detector->claimCollisionObject( shape_node ) );
+
+    TMapBasedBitmaskCollisionFilter map_filter;
+    loco::dartsim::TDartBitmaskCollisionFilter dense_filter;
+    for ( size_t i = 0; i < num_bodies; i++ )
+    {
+        const int group = ( i % 8 == 0 ) ? 1 : 2;
+        const int mask = ( i % 8 == 0 ) ? 2 : 1;
+        map_filter.setCollisionGroup( shape_nodes[i], group );
+        map_filter.setCollisionMask( shape_nodes[i], mask );
+        dense_filter.setCollisionGroup( shape_nodes[i], group );
+        dense_filter.setCollisionMask( shape_nodes[i], mask );
+    }
+
+    std::vector<std::pair<dart::collision::CollisionObject*, dart::collision::CollisionObject*>> pairs;
+    for ( size_t i = 0; i < num_bodies; i++ )
+        for ( size_t j = i + 1; j < num_bodies; j++ )
+            pairs.push_back( { objects[i].get(), objects[j].get() } );
+
+    // Both filters must agree on every pair
+    for ( const auto& pair : pairs )
+        EXPECT_EQ( map_filter.ignoresCollision( pair.first, pair.second ),
+                   dense_filter.ignoresCollision( pair.first, pair.second ) );
+    EXPECT_EQ( dense_filter.num_slots(), num_bodies );
+}
+
+TEST( TestLocoDartCollisionFilter, TestLocoDartCollisionFilterRuntimeChanges )
+{
+    loco::InitUtils();
+
+    std::vector<dart::dynamics::SkeletonPtr> skeletons;
+    std::vector<dart::dynamics::ShapeNode*> shape_nodes;
+    for ( size_t i = 0; i < 2; i++ )
+    {
+        auto skeleton = dart::dynamics::Skeleton::create( "body_" + std::to_string( i ) );
+        auto joint_bodynode_pair = skeleton->createJointAndBodyNodePair<dart::dynamics::FreeJoint>();
+        auto shape_node = joint_bodynode_pair.second->createShapeNodeWith<dart::dynamics::CollisionAspect>(
+                                    std::make_shared<dart::dynamics::SphereShape>( 0.1 ) );
+        skeletons.push_back( skeleton );
+        shape_nodes.push_back( shape_node );
+    }
+
+    loco::dartsim::TDartBitmaskCollisionFilter filter;
+    const ssize_t slot_0 = filter.registerShapeNode( shape_nodes[0], 1, 1 );
+    const ssize_t slot_1 = filter.registerShapeNode( shape_nodes[1], 1, 1 );
+    EXPECT_NE( slot_0, slot_1 );
+
+    auto detector = std::make_shared<TExposedBulletCollisionDetector>();
+    auto object_0 = detector->claimCollisionObject( shape_nodes[0] );
+    auto object_1 = detector->claimCollisionObject( shape_nodes[1] );
+    EXPECT_FALSE( filter.ignoresCollision( object_0.get(), object_1.get() ) );
+
+    // Move body 1 into a group body 0 doesn't collide with (and vice-versa)
+    filter.setCollisionGroup( slot_1, 2 );
+    filter.setCollisionMask( slot_1, 2 );
+    EXPECT_TRUE( filter.ignoresCollision( object_0.get(), object_1.get() ) );
+
+    // One-sided affinity is enough for the pair to collide
+    filter.setCollisionMask( slot_0, 3 );
+    EXPECT_FALSE( filter.ignoresCollision( object_0.get(), object_1.get() ) );
+
+    // Slot-based and shape-node based setters update the same entry
+    filter.setCollisionMask( shape_nodes[0], 1 );
+    EXPECT_TRUE( filter.ignoresCollision( object_0.get(), object_1.get() ) );
+    EXPECT_EQ( filter.num_slots(), 2 );
+
+    // Shapes never registered collide as usual, and testing them doesn't give them a slot
+    auto skeleton_extra = dart::dynamics::Skeleton::create( "body_extra" );
+    auto shape_node_extra = skeleton_extra->createJointAndBodyNodePair<dart::dynamics::FreeJoint>().second->
+                                createShapeNodeWith<dart::dynamics::CollisionAspect>( std::make_shared<dart::dynamics::SphereShape>( 0.1 ) );
+    auto object_extra = detector->claimCollisionObject( shape_node_extra );
+    EXPECT_FALSE( filter.ignoresCollision( object_0.get(), object_extra.get() ) );
+    EXPECT_FALSE( filter.ignoresCollision( object_extra.get(), object_1.get() ) );
+    EXPECT_EQ( filter.num_slots(), 2 );
+}
+
+// Counts the pairs that reach the filter (i.e. the ones that passed bullet's own broadphase tests)
+class TCountingBitmaskCollisionFilter : public loco::dartsim::TDartBitmaskCollisionFilter
+{
+public :
+
+    bool ignoresCollision( const dart::collision::CollisionObject* object_1,
+                           const dart::collision::CollisionObject* object_2 ) const override
+    {
+        num_queries++;
+        return loco::dartsim::TDartBitmaskCollisionFilter::ignoresCollision( object_1, object_2 );
+    }
+
+    mutable size_t num_queries = 0;
+};
+
+TEST( TestLocoDartCollisionFilter, TestLocoDartCollisionFilterBroadphase )
+{
+    loco::InitUtils();
+
+    auto world = dart::simulation::World::create();
+    world->getConstraintSolver()->setCollisionDetector( dart::collision::BulletCollisionDetector::create() );
+    auto filter = std::make_shared<TCountingBitmaskCollisionFilter>();
+    world->getConstraintSolver()->getCollisionOption().collisionFilter = filter;
+    auto bullet_group = dynamic_cast<dart::collision::BulletCollisionGroup*>( world->getConstraintSolver()->getCollisionGroup().get() );
+    ASSERT_TRUE( bullet_group != nullptr );
+
+    // Swarm of overlapping agents (group 2, mask 1) resting on a static ground (group 1, mask 2)
+    const size_t num_agents = 32;
+    std::vector<dart::dynamics::ShapeNode*> agents_shape_nodes;
+    for ( size_t i = 0; i < num_agents; i++ )
+    {
+        auto skeleton = dart::dynamics::Skeleton::create( "agent_" + std::to_string( i ) );
+        auto joint_bodynode_pair = skeleton->createJointAndBodyNodePair<dart::dynamics::FreeJoint>();
+        auto shape_node = joint_bodynode_pair.second->createShapeNodeWith<dart::dynamics::CollisionAspect,
+                                                                          dart::dynamics::DynamicsAspect>(
+                                    std::make_shared<dart::dynamics::SphereShape>( 0.5 ) );
+        Eigen::Isometry3d tf = Eigen::Isometry3d::Identity();
+        tf.translation() = Eigen::Vector3d( 0.01 * i, 0.0, 0.45 );
+        joint_bodynode_pair.first->setTransformFromParentBodyNode( tf );
+        world->addSkeleton( skeleton );
+        agents_shape_nodes.push_back( shape_node );
+    }
+    auto ground = dart::dynamics::Skeleton::create( "ground" );
+    auto ground_pair = ground->createJointAndBodyNodePair<dart::dynamics::WeldJoint>();
+    auto ground_shape_node = ground_pair.second->createShapeNodeWith<dart::dynamics::CollisionAspect,
+                                                                     dart::dynamics::DynamicsAspect>(
+                                    std::make_shared<dart::dynamics::BoxShape>( Eigen::Vector3d( 10.0, 10.0, 0.1 ) ) );
+    world->addSkeleton( ground );
+
+    filter->registerShapeNode( ground_shape_node, 1, 2 );
+    std::vector<ssize_t> agents_slots;
+    for ( auto shape_node : agents_shape_nodes )
+        agents_slots.push_back( filter->registerShapeNode( shape_node, 2, 1 ) );
+    EXPECT_EQ( filter->num_classes(), 2 );
+
+    // Symmetric classes: agent-agent pairs are rejected by bullet, so only agent-ground pairs reach the filter
+    filter->refreshBroadphase( bullet_group->getBulletCollisionWorld() );
+    EXPECT_TRUE( filter->broadphase_filtering() );
+    filter->num_queries = 0;
+    world->step();
+    const size_t num_queries_stamped = filter->num_queries;
+    EXPECT_EQ( bullet_group->getBulletCollisionWorld()->getPairCache()->getNumOverlappingPairs(), num_agents );
+
+    // One-sided affinity (ground sees agents, agents don't see the ground) can't be expressed with bullet's
+    // two-sided test, so the filter falls back to handle all pairs in software (same results as before)
+    filter->setCollisionMask( agents_slots[0], 0 );
+    filter->refreshBroadphase( bullet_group->getBulletCollisionWorld() );
+    EXPECT_FALSE( filter->broadphase_filtering() );
+    filter->num_queries = 0;
+    world->step();
+    EXPECT_GT( filter->num_queries, num_queries_stamped );
+    EXPECT_EQ( bullet_group->getBulletCollisionWorld()->getPairCache()->getNumOverlappingPairs(), num_agents );
+
+    // Back to symmetric classes, which stamps the proxies again
+    filter->setCollisionMask( agents_slots[0], 1 );
+    filter->refreshBroadphase( bullet_group->getBulletCollisionWorld() );
+    EXPECT_TRUE( filter->broadphase_filtering() );
+    EXPECT_EQ( filter->num_classes(), 2 );
+
+    // Shapes registered at runtime only get their own proxies stamped (the ones of the other shapes are left as is)
+    auto fnGetProxy = [&]( const dart::dynamics::ShapeFrame* shape_frame ) -> btBroadphaseProxy*
+        {
+            auto& bullet_objects = bullet_group->getBulletCollisionWorld()->getCollisionObjectArray();
+            for ( int i = 0; i < bullet_objects.size(); i++ )
+            {
+                auto dart_object = static_cast<dart::collision::CollisionObject*>( bullet_objects[i]->getUserPointer() );
+                if ( dart_object && dart_object->getShapeFrame() == shape_frame )
+                    return bullet_objects[i]->getBroadphaseHandle();
+            }
+            return nullptr;
+        };
+    auto ground_proxy = fnGetProxy( ground_shape_node );
+    ASSERT_TRUE( ground_proxy != nullptr );
+    const auto ground_proxy_group = ground_proxy->m_collisionFilterGroup;
+    ground_proxy->m_collisionFilterGroup = btBroadphaseProxy::DefaultFilter;
+
+    auto new_agent = dart::dynamics::Skeleton::create( "agent_new" );
+    auto new_agent_shape_node = new_agent->createJointAndBodyNodePair<dart::dynamics::FreeJoint>().second->
+                                    createShapeNodeWith<dart::dynamics::CollisionAspect, dart::dynamics::DynamicsAspect>(
+                                        std::make_shared<dart::dynamics::SphereShape>( 0.5 ) );
+    world->addSkeleton( new_agent );
+    filter->registerShapeNode( new_agent_shape_node, 2, 1 );
+    filter->refreshBroadphase( bullet_group->getBulletCollisionWorld() );
+    auto new_agent_proxy = fnGetProxy( new_agent_shape_node );
+    ASSERT_TRUE( new_agent_proxy != nullptr );
+    EXPECT_EQ( new_agent_proxy->m_collisionFilterGroup, 2 << 1 );
+    EXPECT_EQ( new_agent_proxy->m_collisionFilterMask, ( 1 << 1 ) | 1 );
+    EXPECT_EQ( ground_proxy->m_collisionFilterGroup, btBroadphaseProxy::DefaultFilter );
+    ground_proxy->m_collisionFilterGroup = ground_proxy_group;
+}
+
+TEST( TestLocoDartCollisionFilter, TestLocoDartCollisionFilterSelfCollision )
+{
+    loco::InitUtils();
+
+    // Humanoid-sized tree: a torso with 4 limbs of 8 links each
+    const size_t num_limbs = 4;
+    const size_t num_links_per_limb = 8;
+    auto skeleton = dart::dynamics::Skeleton::create( "humanoid" );
+    auto torso = skeleton->createJointAndBodyNodePair<dart::dynamics::FreeJoint>(
+                        nullptr, dart::dynamics::FreeJoint::Properties(), dart::dynamics::BodyNode::AspectProperties( "torso" ) ).second;
+    torso->createShapeNodeWith<dart::dynamics::CollisionAspect>( std::make_shared<dart::dynamics::BoxShape>( Eigen::Vector3d( 0.3, 0.2, 0.5 ) ) );
+    for ( size_t l = 0; l < num_limbs; l++ )
+    {
+        dart::dynamics::BodyNode* parent_bodynode = torso;
+        for ( size_t i = 0; i < num_links_per_limb; i++ )
+        {
+            const std::string link_name = "limb_" + std::to_string( l ) + "_link_" + std::to_string( i );
+            dart::dynamics::RevoluteJoint::Properties joint_properties;
+            joint_properties.mName = link_name + "_joint";
+            auto bodynode = skeleton->createJointAndBodyNodePair<dart::dynamics::RevoluteJoint>(
+                                parent_bodynode, joint_properties, dart::dynamics::BodyNode::AspectProperties( link_name ) ).second;
+            bodynode->createShapeNodeWith<dart::dynamics::CollisionAspect>( std::make_shared<dart::dynamics::CapsuleShape>( 0.05, 0.2 ) );
+            parent_bodynode = bodynode;
+        }
+    }
+
+    auto detector = std::make_shared<TExposedBulletCollisionDetector>();
+    std::vector<std::shared_ptr<dart::collision::CollisionObject>> objects;
+    for ( size_t i = 0; i < skeleton->getNumShapeNodes(); i++ )
+        objects.push_back( detector->claimCollisionObject( skeleton->getShapeNode( i ) ) );
+
+    std::vector<std::pair<dart::collision::CollisionObject*, dart::collision::CollisionObject*>> pairs;
+    for ( size_t i = 0; i < objects.size(); i++ )
+        for ( size_t j = i + 1; j < objects.size(); j++ )
+            pairs.push_back( { objects[i].get(), objects[j].get() } );
+
+    // No self-collisions: every intra-skeleton pair is rejected
+    loco::dartsim::TDartBitmaskCollisionFilter filter;
+    filter.setSelfCollisionTable( skeleton.get(), loco::dartsim::CompileSelfCollisionTable(
+                                    skeleton.get(), loco::dartsim::eDartSelfCollisionPolicy::NONE, {} ) );
+    for ( const auto& pair : pairs )
+        EXPECT_TRUE( filter.ignoresCollision( pair.first, pair.second ) );
+
+    // Non-adjacent pairs must match dart's own self-collision and adjacency checks
+    skeleton->enableSelfCollisionCheck();
+    skeleton->disableAdjacentBodyCheck();
+    dart::collision::BodyNodeCollisionFilter dart_filter;
+    filter.setSelfCollisionTable( skeleton.get(), loco::dartsim::CompileSelfCollisionTable(
+                                    skeleton.get(), loco::dartsim::eDartSelfCollisionPolicy::NON_ADJACENT, {} ) );
+    for ( const auto& pair : pairs )
+        EXPECT_EQ( dart_filter.ignoresCollision( pair.first, pair.second ), filter.ignoresCollision( pair.first, pair.second ) );
+
+    // Explicit pairs: only the given ones collide (in both orders), and unknown bodies are skipped
+    filter.setSelfCollisionTable( skeleton.get(), loco::dartsim::CompileSelfCollisionTable(
+                                    skeleton.get(), loco::dartsim::eDartSelfCollisionPolicy::EXPLICIT_PAIRS,
+                                    { { "limb_0_link_7", "limb_1_link_7" }, { "torso", "limb_2_link_5" }, { "torso", "tail" } } ) );
+    auto object_of = [&]( const std::string& body_name )
+        {
+            auto shape_node = skeleton->getBodyNode( body_name )->getShapeNode( 0 );
+            for ( auto& object : objects )
+                if ( object->getShapeFrame() == shape_node )
+                    return object.get();
+            return static_cast<dart::collision::CollisionObject*>( nullptr );
+        };
+    size_t num_colliding = 0;
+    for ( const auto& pair : pairs )
+        num_colliding += filter.ignoresCollision( pair.first, pair.second ) ? 0 : 1;
+    EXPECT_EQ( num_colliding, 2 );
+    EXPECT_FALSE( filter.ignoresCollision( object_of( "limb_1_link_7" ), object_of( "limb_0_link_7" ) ) );
+    EXPECT_FALSE( filter.ignoresCollision( object_of( "torso" ), object_of( "limb_2_link_5" ) ) );
+    EXPECT_TRUE( filter.ignoresCollision( object_of( "torso" ), object_of( "limb_2_link_0" ) ) );
+
+    // Blacklisted pairs are ignored even if the table lets them collide
+    filter.addBodyNodePairToBlackList( skeleton->getBodyNode( "limb_2_link_5" ), torso );
+    EXPECT_TRUE( filter.ignoresCollision( object_of( "torso" ), object_of( "limb_2_link_5" ) ) );
+    EXPECT_FALSE( filter.ignoresCollision( object_of( "limb_1_link_7" ), object_of( "limb_0_link_7" ) ) );
+    filter.removeBodyNodePairFromBlackList( torso, skeleton->getBodyNode( "limb_2_link_5" ) );
+    EXPECT_FALSE( filter.ignoresCollision( object_of( "torso" ), object_of( "limb_2_link_5" ) ) );
+
+    // So are pairs with a body that isn't collidable
+    skeleton->getBodyNode( "limb_2_link_5" )->setCollidable( false );
+    EXPECT_TRUE( filter.ignoresCollision( object_of( "torso" ), object_of( "limb_2_link_5" ) ) );
+    EXPECT_TRUE( filter.ignoresCollision( object_of( "limb_2_link_5" ), object_of( "torso" ) ) );
+    EXPECT_FALSE( filter.ignoresCollision( object_of( "limb_1_link_7" ), object_of( "limb_0_link_7" ) ) );
+    skeleton->getBodyNode( "limb_2_link_5" )->setCollidable( true );
+    EXPECT_FALSE( filter.ignoresCollision( object_of( "torso" ), object_of( "limb_2_link_5" ) ) );
+}
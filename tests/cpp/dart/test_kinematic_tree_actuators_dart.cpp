@@ -0,0 +1,120 @@
+
+#include <loco.h>
+#include <gtest/gtest.h>
+
+#include <loco_common_dart.h>
+#include <kinematic_trees/loco_kinematic_tree_actuators_dart.h>
+
+// Fixed-base pendulum (single hinge along y, 1kg link with its com 0.5m below the hinge)
+dart::dynamics::SkeletonPtr create_pendulum_skeleton( const std::string& name )
+{
+    auto skeleton = dart::dynamics::Skeleton::create( name );
+    dart::dynamics::RevoluteJoint::Properties joint_properties;
+    joint_properties.mName = "hinge";
+    joint_properties.mAxis = Eigen::Vector3d::UnitY();
+    auto bodynode = skeleton->createJointAndBodyNodePair<dart::dynamics::RevoluteJoint>(
+                        nullptr, joint_properties, dart::dynamics::BodyNode::AspectProperties( "link" ) ).second;
+    dart::dynamics::Inertia inertia;
+    inertia.setMass( 1.0 );
+    inertia.setLocalCOM( Eigen::Vector3d( 0.0, 0.0, -0.5 ) );
+    inertia.setMoment( 0.02, 0.02, 0.001, 0.0, 0.0, 0.0 );
+    bodynode->setInertia( inertia );
+    return skeleton;
+}
+
+// Steps the world at the physics rate, holding the targets for the whole control period
+void step_control_period( dart::simulation::World* world, loco::kintree::TDartJointActuators& actuators,
+                          ssize_t num_substeps, bool actuate_every_substep )
+{
+    for ( ssize_t i = 0; i < num_substeps; i++ )
+    {
+        if ( actuate_every_substep || i == 0 )
+            actuators.Evaluate();
+        world->step( false );
+    }
+}
+
+TEST( TestLocoDartJointActuators, TestLocoDartJointActuatorsModes )
+{
+    loco::InitUtils();
+
+    auto world = dart::simulation::World::create();
+    world->setTimeStep( 0.002 );
+    auto skeleton_pos = create_pendulum_skeleton( "pendulum_pos" );
+    auto skeleton_vel = create_pendulum_skeleton( "pendulum_vel" );
+    auto skeleton_trq = create_pendulum_skeleton( "pendulum_trq" );
+    world->addSkeleton( skeleton_pos );
+    world->addSkeleton( skeleton_vel );
+    world->addSkeleton( skeleton_trq );
+
+    loco::kintree::TDartJointActuators actuators;
+    loco::kintree::TDartActuatorData pos_data;
+    pos_data.mode = loco::kintree::eDartActuatorMode::POSITION;
+    pos_data.kp = 200.0f;
+    pos_data.kv = 5.0f;
+    loco::kintree::TDartActuatorData vel_data;
+    vel_data.mode = loco::kintree::eDartActuatorMode::VELOCITY;
+    vel_data.kv = 20.0f;
+    vel_data.gear = 2.0f;
+    loco::kintree::TDartActuatorData trq_data;
+    trq_data.mode = loco::kintree::eDartActuatorMode::TORQUE;
+    trq_data.torque_limit = 1.0f;
+
+    EXPECT_EQ( actuators.AddActuator( skeleton_pos.get(), "hinge", pos_data ), 0 );
+    EXPECT_EQ( actuators.AddActuator( skeleton_vel.get(), "hinge", vel_data ), 1 );
+    EXPECT_EQ( actuators.AddActuator( skeleton_trq.get(), "hinge", trq_data ), 2 );
+    EXPECT_EQ( actuators.AddActuator( skeleton_trq.get(), "missing", trq_data ), -1 );
+    EXPECT_EQ( actuators.num_actuators(), 3 );
+
+    // Gravity off, so each mode can be checked against its own target
+    world->setGravity( Eigen::Vector3d::Zero() );
+    actuators.SetTargets( Eigen::Vector3d( 0.5, 1.0, 10.0 ) );
+    for ( ssize_t i = 0; i < 200; i++ )
+        step_control_period( world.get(), actuators, 10, true );
+
+    EXPECT_NEAR( skeleton_pos->getPosition( 0 ), 0.5, 1e-3 );
+    EXPECT_NEAR( skeleton_vel->getVelocity( 0 ), 1.0, 1e-3 );
+    // Torque targets are clamped by the motor limit, and then amplified by the gear-ratio (1 here)
+    EXPECT_NEAR( actuators.torques()[2], 1.0, 1e-9 );
+}
+
+TEST( TestLocoDartJointActuators, TestLocoDartJointActuatorsSubstepStability )
+{
+    loco::InitUtils();
+
+    // High-gain PD at a 20ms control period (10 substeps of 2ms): holding the torque computed at the start of the
+    // control period makes it go unstable, whereas evaluating it every substep keeps it stable
+    loco::kintree::TDartActuatorData pd_data;
+    pd_data.mode = loco::kintree::eDartActuatorMode::POSITION;
+    pd_data.kp = 2000.0f;
+    pd_data.kv = 50.0f;
+
+    double max_error[2] = { 0.0, 0.0 };
+    for ( size_t k = 0; k < 2; k++ )
+    {
+        const bool actuate_every_substep = ( k == 0 );
+        auto world = dart::simulation::World::create();
+        world->setTimeStep( 0.002 );
+        auto skeleton = create_pendulum_skeleton( "pendulum" );
+        world->addSkeleton( skeleton );
+
+        loco::kintree::TDartJointActuators actuators;
+        actuators.AddActuator( skeleton.get(), "hinge", pd_data );
+        actuators.SetTarget( 0, 0.3 );
+        for ( ssize_t i = 0; i < 100; i++ )
+        {
+            step_control_period( world.get(), actuators, 10, actuate_every_substep );
+            const double error = std::abs( skeleton->getPosition( 0 ) - 0.3 );
+            if ( !std::isfinite( error ) )
+            {
+                max_error[k] = std::numeric_limits<double>::infinity();
+                break;
+            }
+            if ( i > 50 )
+                max_error[k] = std::max( max_error[k], error );
+        }
+    }
+
+    EXPECT_LT( max_error[0], 0.05 );
+    EXPECT_LT( max_error[0], max_error[1] );
+}
@@ -0,0 +1,123 @@
+
+#include <loco.h>
+#include <gtest/gtest.h>
+
+#include <loco_common_dart.h>
+
+// Free-floating base with a ball-joint and a revolute-joint chained to it
+dart::dynamics::SkeletonPtr create_test_skeleton()
+{
+    auto skeleton = dart::dynamics::Skeleton::create( "test_kintree" );
+    auto base_pair = skeleton->createJointAndBodyNodePair<dart::dynamics::FreeJoint>();
+    base_pair.first->setName( "base_free" );
+    auto shoulder_pair = skeleton->createJointAndBodyNodePair<dart::dynamics::BallJoint>( base_pair.second );
+    shoulder_pair.first->setName( "shoulder_ball" );
+    dart::dynamics::RevoluteJoint::Properties elbow_properties;
+    elbow_properties.mName = "elbow_revolute";
+    elbow_properties.mAxis = Eigen::Vector3d::UnitY();
+    skeleton->createJointAndBodyNodePair<dart::dynamics::RevoluteJoint>( shoulder_pair.second, elbow_properties );
+    return skeleton;
+}
+
+TEST( TestLocoDartKinematicTreeQpos, TestLocoDartKinematicTreeJointConversions )
+{
+    loco::InitUtils();
+
+    auto skeleton = create_test_skeleton();
+    auto free_joint = skeleton->getJoint( "base_free" );
+    auto ball_joint = skeleton->getJoint( "shoulder_ball" );
+    auto revolute_joint = skeleton->getJoint( "elbow_revolute" );
+    EXPECT_EQ( loco::dartsim::GetJointNumQpos( free_joint ), 7 );
+    EXPECT_EQ( loco::dartsim::GetJointNumQvel( free_joint ), 6 );
+    EXPECT_EQ( loco::dartsim::GetJointNumQpos( ball_joint ), 4 );
+    EXPECT_EQ( loco::dartsim::GetJointNumQvel( ball_joint ), 3 );
+    EXPECT_EQ( loco::dartsim::GetJointNumQpos( revolute_joint ), 1 );
+
+    // Free-joint: position first, then quaternion (w,x,y,z)
+    const Eigen::Quaterniond quat( Eigen::AngleAxisd( 0.3, Eigen::Vector3d( 1.0, 2.0, 3.0 ).normalized() ) );
+    std::vector<loco::TScalar> free_qpos = { 1.0, 2.0, 3.0, (loco::TScalar)quat.w(), (loco::TScalar)quat.x(),
+                                                             (loco::TScalar)quat.y(), (loco::TScalar)quat.z() };
+    loco::dartsim::SetJointQpos( free_joint, free_qpos );
+    const Eigen::Isometry3d base_tf = skeleton->getBodyNode( 0 )->getTransform();
+    EXPECT_TRUE( base_tf.translation().isApprox( Eigen::Vector3d( 1.0, 2.0, 3.0 ), 1e-5 ) );
+    EXPECT_TRUE( base_tf.linear().isApprox( quat.toRotationMatrix(), 1e-5 ) );
+
+    std::vector<loco::TScalar> free_qpos_out;
+    loco::dartsim::GetJointQpos( free_joint, free_qpos_out );
+    ASSERT_EQ( free_qpos_out.size(), free_qpos.size() );
+    for ( size_t i = 0; i < free_qpos.size(); i++ )
+        EXPECT_NEAR( free_qpos_out[i], free_qpos[i], 1e-5 );
+
+    // Free-joint velocities: linear first, then angular (dart stores them the other way around)
+    std::vector<loco::TScalar> free_qvel = { 0.1, 0.2, 0.3, 0.4, 0.5, 0.6 };
+    loco::dartsim::SetJointQvel( free_joint, free_qvel );
+    EXPECT_TRUE( free_joint->getVelocities().head<3>().isApprox( Eigen::Vector3d( 0.4, 0.5, 0.6 ), 1e-5 ) );
+    EXPECT_TRUE( free_joint->getVelocities().tail<3>().isApprox( Eigen::Vector3d( 0.1, 0.2, 0.3 ), 1e-5 ) );
+
+    // Ball-joint: quaternion round-trip
+    std::vector<loco::TScalar> ball_qpos = { (loco::TScalar)quat.w(), (loco::TScalar)quat.x(),
+                                             (loco::TScalar)quat.y(), (loco::TScalar)quat.z() };
+    loco::dartsim::SetJointQpos( ball_joint, ball_qpos );
+    std::vector<loco::TScalar> ball_qpos_out;
+    loco::dartsim::GetJointQpos( ball_joint, ball_qpos_out );
+    for ( size_t i = 0; i < ball_qpos.size(); i++ )
+        EXPECT_NEAR( ball_qpos_out[i], ball_qpos[i], 1e-5 );
+
+    // Mismatched sizes are rejected, leaving the joint untouched
+    loco::dartsim::SetJointQpos( revolute_joint, { 0.5 } );
+    loco::dartsim::SetJointQpos( revolute_joint, { 0.1, 0.2 } );
+    EXPECT_NEAR( revolute_joint->getPosition( 0 ), 0.5, 1e-6 );
+}
+
+TEST( TestLocoDartKinematicTreeQpos, TestLocoDartKinematicTreeWholeSkeletonLayout )
+{
+    loco::InitUtils();
+
+    // The whole-skeleton vector is the concatenation of the joints' dart coordinates, in tree order
+    auto skeleton = create_test_skeleton();
+    EXPECT_EQ( skeleton->getNumDofs(), 6 + 3 + 1 );
+    EXPECT_EQ( skeleton->getJoint( "base_free" )->getIndexInSkeleton( 0 ), 0 );
+    EXPECT_EQ( skeleton->getJoint( "shoulder_ball" )->getIndexInSkeleton( 0 ), 6 );
+    EXPECT_EQ( skeleton->getJoint( "elbow_revolute" )->getIndexInSkeleton( 0 ), 9 );
+
+    Eigen::VectorXd qpos = Eigen::VectorXd::LinSpaced( skeleton->getNumDofs(), 0.0, 0.9 );
+    skeleton->setPositions( qpos );
+    EXPECT_NEAR( skeleton->getJoint( "elbow_revolute" )->getPosition( 0 ), 0.9, 1e-9 );
+    EXPECT_TRUE( skeleton->getJoint( "shoulder_ball" )->getPositions().isApprox( qpos.segment<3>( 6 ) ) );
+}
+
+TEST( TestLocoDartKinematicTreeQpos, TestLocoDartKinematicTreeJointStateViews )
+{
+    loco::InitUtils();
+
+    auto skeleton = create_test_skeleton();
+    auto free_joint = skeleton->getJoint( "base_free" );
+    auto ball_joint = skeleton->getJoint( "shoulder_ball" );
+    auto revolute_joint = skeleton->getJoint( "elbow_revolute" );
+
+    // Views are mapped once, and then follow the state of the skeleton with no copies
+    Eigen::Map<const Eigen::VectorXd> free_qpos( loco::dartsim::GetJointPositionsData( free_joint ), 6 );
+    Eigen::Map<const Eigen::VectorXd> ball_qpos( loco::dartsim::GetJointPositionsData( ball_joint ), 3 );
+    Eigen::Map<const Eigen::VectorXd> revolute_qpos( loco::dartsim::GetJointPositionsData( revolute_joint ), 1 );
+    Eigen::Map<const Eigen::VectorXd> revolute_qvel( loco::dartsim::GetJointVelocitiesData( revolute_joint ), 1 );
+    ASSERT_TRUE( free_qpos.data() != nullptr );
+    ASSERT_TRUE( ball_qpos.data() != nullptr );
+    ASSERT_TRUE( revolute_qpos.data() != nullptr );
+    ASSERT_TRUE( revolute_qvel.data() != nullptr );
+
+    for ( size_t k = 0; k < 3; k++ )
+    {
+        const Eigen::VectorXd qpos = Eigen::VectorXd::Random( skeleton->getNumDofs() );
+        const Eigen::VectorXd qvel = Eigen::VectorXd::Random( skeleton->getNumDofs() );
+        skeleton->setPositions( qpos );
+        skeleton->setVelocities( qvel );
+        EXPECT_TRUE( free_qpos.isApprox( qpos.segment<6>( free_joint->getIndexInSkeleton( 0 ) ) ) );
+        EXPECT_TRUE( ball_qpos.isApprox( qpos.segment<3>( ball_joint->getIndexInSkeleton( 0 ) ) ) );
+        EXPECT_DOUBLE_EQ( revolute_qpos[0], qpos[revolute_joint->getIndexInSkeleton( 0 )] );
+        EXPECT_DOUBLE_EQ( revolute_qvel[0], qvel[revolute_joint->getIndexInSkeleton( 0 )] );
+    }
+
+    // Zero-dof joints don't have any state to view
+    auto weld_pair = skeleton->createJointAndBodyNodePair<dart::dynamics::WeldJoint>( revolute_joint->getChildBodyNode() );
+    EXPECT_TRUE( loco::dartsim::GetJointPositionsData( weld_pair.first ) == nullptr );
+}
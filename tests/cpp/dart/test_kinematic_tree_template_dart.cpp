@@ -0,0 +1,209 @@
+
+#include <loco.h>
+#include <gtest/gtest.h>
+
+#include <loco_common_dart.h>
+#include <kinematic_trees/loco_kinematic_tree_adapter_dart.h>
+#include <kinematic_trees/loco_kinematic_tree_actuators_dart.h>
+#include <sensors/loco_sensor_joints_dart.h>
+
+// Serial chain of capsule links hanging from a fixed base (similar to the limbs of the robots used in training
+// scenes), with bodies, joints and colliders named after the kintree
+std::unique_ptr<loco::kintree::TKinematicTree> create_chain_kintree( const std::string& name, ssize_t num_links,
+                                                                     const loco::TVec3& position, float radius = 0.05f )
+{
+    // Built from the tip up, as bodies take ownership of their children
+    std::unique_ptr<loco::kintree::TKinematicTreeBody> child_body = nullptr;
+    for ( ssize_t i = num_links - 1; i >= 0; i-- )
+    {
+        const std::string suffix = "_" + std::to_string( i );
+        auto body = std::make_unique<loco::kintree::TKinematicTreeBody>( name + "_link" + suffix, loco::kintree::TKinematicTreeBodyData() );
+        body->AddJoint( std::make_unique<loco::kintree::TKinematicTreeRevoluteJoint>( name + "_joint" + suffix, loco::TVec3( 0.0f, 1.0f, 0.0f ) ),
+                        loco::TMat4() );
+        body->AddCollider( std::make_unique<loco::kintree::TKinematicTreeCapsuleCollider>( name + "_collider" + suffix, radius, 0.2f ),
+                           loco::TMat4( loco::TMat3(), loco::TVec3( 0.0f, 0.0f, -0.1f ) ) );
+        if ( child_body )
+            body->AddChild( std::move( child_body ), loco::TMat4( loco::TMat3(), loco::TVec3( 0.0f, 0.0f, -0.2f ) ) );
+        child_body = std::move( body );
+    }
+    auto kintree = std::make_unique<loco::kintree::TKinematicTree>( name, position, loco::TMat3() );
+    kintree->SetRoot( std::move( child_body ) );
+    return kintree;
+}
+
+TEST( TestLocoDartKinematicTreeTemplate, TestLocoDartKinematicTreeTemplateInstanceNames )
+{
+    loco::InitUtils();
+
+    const ssize_t num_links = 4;
+    auto kintree_template = create_chain_kintree( "chain_a", num_links, loco::TVec3( 0.0f, 0.0f, 2.0f ) );
+    auto kintree_instance = create_chain_kintree( "chain_b", num_links, loco::TVec3( 1.0f, 0.0f, 2.0f ) );
+    loco::kintree::TDartKinematicTreeAdapter adapter_template( kintree_template.get() );
+    adapter_template.Build();
+    loco::kintree::TDartKinematicTreeAdapter adapter_instance( kintree_instance.get() );
+    adapter_instance.SetTemplate( &adapter_template );
+    adapter_instance.Build();
+    ASSERT_EQ( adapter_instance.template_ref(), &adapter_template );
+
+    // Elements of the clone are named after the instance, not after the template it was cloned from
+    auto skeleton_instance = adapter_instance.skeleton().get();
+    for ( ssize_t i = 0; i < num_links; i++ )
+    {
+        const std::string suffix = "_" + std::to_string( i );
+        auto bodynode = skeleton_instance->getBodyNode( "chain_b_link" + suffix );
+        ASSERT_TRUE( bodynode != nullptr );
+        EXPECT_EQ( bodynode, adapter_instance.body_adapters()[i]->body_node() );
+        EXPECT_EQ( skeleton_instance->getJoint( "chain_b_joint" + suffix ), bodynode->getParentJoint() );
+        EXPECT_TRUE( skeleton_instance->getBodyNode( "chain_a_link" + suffix ) == nullptr );
+        EXPECT_TRUE( skeleton_instance->getJoint( "chain_a_joint" + suffix ) == nullptr );
+    }
+
+    // Actuators and sensors are attached by joint name, so they must end up on the instance's own dofs
+    loco::kintree::TDartJointActuators actuators;
+    loco::kintree::TDartActuatorData actuator_data;
+    actuator_data.mode = loco::kintree::eDartActuatorMode::TORQUE;
+    EXPECT_EQ( actuators.AddActuator( skeleton_instance, "chain_b_joint_1", actuator_data ), 0 );
+    loco::sensors::TDartJointSensors sensors;
+    EXPECT_EQ( sensors.AddSensor( skeleton_instance, "chain_b_joint_1", loco::sensors::JOINT_QPOS ), 0 );
+
+    auto world = dart::simulation::World::create();
+    world->setTimeStep( 0.001 );
+    world->setGravity( Eigen::Vector3d::Zero() );
+    adapter_template.SetDartWorld( world.get() );
+    adapter_template.Initialize();
+    adapter_instance.SetDartWorld( world.get() );
+    adapter_instance.Initialize();
+
+    actuators.SetTarget( 0, 0.5 );
+    for ( ssize_t i = 0; i < 100; i++ )
+    {
+        actuators.Evaluate();
+        sensors.RecordCommands();
+        world->step( false );
+        sensors.RecordState( world->getTime() );
+    }
+    const double instance_qpos = skeleton_instance->getJoint( "chain_b_joint_1" )->getPosition( 0 );
+    EXPECT_GT( std::abs( instance_qpos ), 1e-3 );
+    EXPECT_NEAR( adapter_template.skeleton()->getJoint( "chain_a_joint_1" )->getPosition( 0 ), 0.0, 1e-9 );
+    auto qpos_history = sensors.GetHistory( loco::sensors::JOINT_QPOS );
+    ASSERT_EQ( qpos_history.rows(), 100 );
+    EXPECT_NEAR( qpos_history( 99, 0 ), instance_qpos, 1e-9 );
+
+    // Explicit self-collision pairs are given by body names as well
+    adapter_instance.SetSelfCollisionPolicy( loco::dartsim::eDartSelfCollisionPolicy::EXPLICIT_PAIRS,
+                                             { { "chain_b_link_0", "chain_b_link_2" } } );
+    EXPECT_TRUE( adapter_instance.self_collision_table().collides( 0, 2 ) );
+    EXPECT_FALSE( adapter_instance.self_collision_table().collides( 0, 1 ) );
+}
+
+TEST( TestLocoDartKinematicTreeTemplate, TestLocoDartKinematicTreeTemplateSignature )
+{
+    loco::InitUtils();
+
+    // Names and placement don't matter, only what ends up in the dart-skeleton does
+    auto kintree_a = create_chain_kintree( "chain_a", 4, loco::TVec3( 0.0f, 0.0f, 2.0f ) );
+    auto kintree_b = create_chain_kintree( "chain_b", 4, loco::TVec3( 1.0f, 2.0f, 3.0f ) );
+    auto kintree_longer = create_chain_kintree( "chain_c", 5, loco::TVec3( 0.0f, 0.0f, 2.0f ) );
+    auto kintree_thicker = create_chain_kintree( "chain_d", 4, loco::TVec3( 0.0f, 0.0f, 2.0f ), 0.08f );
+    const auto signature_a = loco::kintree::TDartKinematicTreeAdapter::ComputeTemplateSignature( kintree_a.get() );
+    EXPECT_FALSE( signature_a.empty() );
+    EXPECT_EQ( loco::kintree::TDartKinematicTreeAdapter::ComputeTemplateSignature( kintree_b.get() ), signature_a );
+    EXPECT_NE( loco::kintree::TDartKinematicTreeAdapter::ComputeTemplateSignature( kintree_longer.get() ), signature_a );
+    EXPECT_NE( loco::kintree::TDartKinematicTreeAdapter::ComputeTemplateSignature( kintree_thicker.get() ), signature_a );
+}
+
+TEST( TestLocoDartKinematicTreeTemplate, TestLocoDartKinematicTreeTemplateWiring )
+{
+    loco::InitUtils();
+
+    const ssize_t num_links = 6;
+    auto kintree_template = create_chain_kintree( "chain_a", num_links, loco::TVec3( 0.0f, 0.0f, 2.0f ) );
+    auto kintree_instance = create_chain_kintree( "chain_b", num_links, loco::TVec3( 1.0f, 0.0f, 2.0f ) );
+    loco::kintree::TDartKinematicTreeAdapter adapter_template( kintree_template.get() );
+    adapter_template.Build();
+    loco::kintree::TDartKinematicTreeAdapter adapter_instance( kintree_instance.get() );
+    adapter_instance.SetTemplate( &adapter_template );
+    adapter_instance.Build();
+
+    // Adapters of the instance are wired to its own skeleton, at the same indices as the template's
+    auto skeleton_template = adapter_template.skeleton().get();
+    auto skeleton_instance = adapter_instance.skeleton().get();
+    ASSERT_NE( skeleton_instance, skeleton_template );
+    ASSERT_EQ( adapter_instance.body_adapters().size(), adapter_template.body_adapters().size() );
+    ASSERT_EQ( adapter_instance.num_dofs(), adapter_template.num_dofs() );
+    for ( ssize_t i = 0; i < num_links; i++ )
+    {
+        auto& template_body_adapter = adapter_template.body_adapters()[i];
+        auto& instance_body_adapter = adapter_instance.body_adapters()[i];
+        ASSERT_EQ( instance_body_adapter->body_node()->getSkeleton().get(), skeleton_instance );
+        EXPECT_EQ( instance_body_adapter->body_node()->getIndexInSkeleton(), template_body_adapter->body_node()->getIndexInSkeleton() );
+        EXPECT_EQ( instance_body_adapter->joint(), instance_body_adapter->body_node()->getParentJoint() );
+
+        ASSERT_EQ( instance_body_adapter->joint_adapters().size(), 1 );
+        auto& template_joint_adapter = template_body_adapter->joint_adapters()[0];
+        auto& instance_joint_adapter = instance_body_adapter->joint_adapters()[0];
+        EXPECT_EQ( instance_joint_adapter->dofs_index(), template_joint_adapter->dofs_index() );
+        EXPECT_EQ( instance_joint_adapter->num_dofs(), 1 );
+
+        ASSERT_EQ( instance_body_adapter->collider_adapters().size(), 1 );
+        auto& template_collider_adapter = template_body_adapter->collider_adapters()[0];
+        auto& instance_collider_adapter = instance_body_adapter->collider_adapters()[0];
+        EXPECT_EQ( instance_collider_adapter->shape_node()->getBodyNodePtr().get(), instance_body_adapter->body_node() );
+        // Shapes are shared by all instances ...
+        EXPECT_EQ( instance_collider_adapter->collision_shape(), template_collider_adapter->collision_shape() );
+        EXPECT_EQ( instance_collider_adapter->shape_node()->getShape(), template_collider_adapter->shape_node()->getShape() );
+    }
+
+    // Joint state views read the instance's own coordinates
+    Eigen::VectorXd qpos = Eigen::VectorXd::LinSpaced( num_links, 0.1, 0.6 );
+    adapter_instance.SetQpos( qpos );
+    for ( ssize_t i = 0; i < num_links; i++ )
+    {
+        auto& instance_joint_adapter = adapter_instance.body_adapters()[i]->joint_adapters()[0];
+        EXPECT_DOUBLE_EQ( instance_joint_adapter->qpos_view()( 0 ), qpos( i ) );
+        EXPECT_DOUBLE_EQ( adapter_template.body_adapters()[i]->joint_adapters()[0]->qpos_view()( 0 ), 0.0 );
+    }
+
+    // ... until one of them changes its size (copy-on-write)
+    auto& instance_collider_adapter = adapter_instance.body_adapters()[0]->collider_adapters()[0];
+    instance_collider_adapter->ChangeSize( loco::TVec3( 0.1f, 0.2f, 0.0f ) );
+    auto template_capsule = std::static_pointer_cast<dart::dynamics::CapsuleShape>(
+                                adapter_template.body_adapters()[0]->collider_adapters()[0]->shape_node()->getShape() );
+    EXPECT_NE( instance_collider_adapter->shape_node()->getShape(), template_capsule );
+    EXPECT_DOUBLE_EQ( template_capsule->getRadius(), 0.05 );
+}
+
+TEST( TestLocoDartKinematicTreeTemplate, TestLocoDartKinematicTreeTemplateIndependentInstances )
+{
+    loco::InitUtils();
+
+    const ssize_t num_links = 4;
+    auto kintree_template = create_chain_kintree( "chain_a", num_links, loco::TVec3( 0.0f, 0.0f, 2.0f ) );
+    auto kintree_instance = create_chain_kintree( "chain_b", num_links, loco::TVec3( 1.0f, 0.0f, 2.0f ) );
+    loco::kintree::TDartKinematicTreeAdapter adapter_template( kintree_template.get() );
+    adapter_template.Build();
+    loco::kintree::TDartKinematicTreeAdapter adapter_instance( kintree_instance.get() );
+    adapter_instance.SetTemplate( &adapter_template );
+    adapter_instance.Build();
+
+    auto world = dart::simulation::World::create();
+    world->setTimeStep( 0.001 );
+    adapter_template.SetDartWorld( world.get() );
+    adapter_template.Initialize();
+    adapter_instance.SetDartWorld( world.get() );
+    adapter_instance.Initialize();
+
+    // Chains released from mirrored configurations swing as mirror images of each other
+    Eigen::VectorXd qpos = Eigen::VectorXd::Zero( num_links );
+    qpos( 0 ) = 0.4;
+    adapter_template.SetQpos( qpos );
+    adapter_instance.SetQpos( -qpos );
+    for ( ssize_t i = 0; i < 500; i++ )
+        world->step();
+
+    Eigen::VectorXd qpos_template, qpos_instance;
+    adapter_template.GetQpos( qpos_template );
+    adapter_instance.GetQpos( qpos_instance );
+    EXPECT_GT( std::abs( qpos_template( 0 ) - 0.4 ), 1e-2 );
+    EXPECT_TRUE( qpos_instance.isApprox( -qpos_template, 1e-6 ) );
+}
@@ -0,0 +1,113 @@
+
+#include <loco.h>
+#include <gtest/gtest.h>
+#include <set>
+
+#include <loco_simulation_dart.h>
+
+// Mesh colliders of varying sizes (every body builds its own shape, and computes its inertia from it)
+std::vector<loco::TCollisionData> create_mesh_colliders_data( ssize_t num_colliders )
+{
+    std::vector<loco::TCollisionData> colliders_data;
+    for ( ssize_t i = 0; i < num_colliders; i++ )
+    {
+        auto col_data = loco::TCollisionData();
+        col_data.type = loco::eShapeType::MESH;
+        col_data.size = { 0.1f + 0.01f * i, 0.2f, 0.2f };
+        col_data.mesh_data.filename = loco::PATH_RESOURCES + "meshes/monkey.stl";
+        colliders_data.push_back( col_data );
+    }
+    return colliders_data;
+}
+
+TEST( TestLocoDartParallelBuild, TestLocoDartParallelBuildResources )
+{
+    loco::InitUtils();
+
+    const ssize_t num_bodies = 64;
+    const auto colliders_data = create_mesh_colliders_data( num_bodies );
+    const std::vector<loco::TInertialData> inertias_data( num_bodies );
+
+    // Same resources whatever the number of threads used to build them
+    loco::dartsim::TDartThreadPool thread_pool_serial( 0 );
+    loco::dartsim::TDartThreadPool thread_pool_parallel( -1 );
+    loco::dartsim::TDartParallelBuilder builder_serial( &thread_pool_serial );
+    loco::dartsim::TDartParallelBuilder builder_parallel( &thread_pool_parallel );
+    for ( ssize_t i = 0; i < num_bodies; i++ )
+    {
+        builder_serial.AddBody( "body_" + std::to_string( i ), &inertias_data[i], { &colliders_data[i] }, true );
+        builder_parallel.AddBody( "body_" + std::to_string( i ), &inertias_data[i], { &colliders_data[i] }, true );
+    }
+
+    builder_serial.Build();
+    builder_parallel.Build();
+    EXPECT_TRUE( builder_parallel.built() );
+
+    // Shapes get unique ids, even though their meshes were decoded concurrently
+    std::set<size_t> shapes_ids;
+    for ( ssize_t i = 0; i < num_bodies; i++ )
+    {
+        auto shape = builder_parallel.GetShape( &colliders_data[i] );
+        ASSERT_TRUE( shape != nullptr );
+        shapes_ids.insert( shape->getID() );
+        EXPECT_EQ( shape->getType(), dart::dynamics::MeshShape::getStaticType() );
+        EXPECT_NE( shape, builder_serial.GetShape( &colliders_data[i] ) );
+
+        dart::dynamics::Inertia inertia_serial, inertia_parallel;
+        ASSERT_TRUE( builder_serial.GetInertia( &inertias_data[i], inertia_serial ) );
+        ASSERT_TRUE( builder_parallel.GetInertia( &inertias_data[i], inertia_parallel ) );
+        EXPECT_DOUBLE_EQ( inertia_parallel.getMass(), inertia_serial.getMass() );
+        EXPECT_TRUE( inertia_parallel.getMoment().isApprox( inertia_serial.getMoment() ) );
+    }
+    EXPECT_EQ( shapes_ids.size(), num_bodies );
+    // Inertias are only available for the bodies registered in each builder
+    auto col_data_sphere = loco::TCollisionData();
+    col_data_sphere.type = loco::eShapeType::SPHERE;
+    col_data_sphere.size = { 0.1f, 0.1f, 0.1f };
+    const auto inertia_data_sphere = loco::TInertialData();
+    loco::dartsim::TDartParallelBuilder builder_sphere( &thread_pool_parallel );
+    builder_sphere.AddBody( "sphere", &inertia_data_sphere, { &col_data_sphere }, true );
+    builder_sphere.Build();
+    dart::dynamics::Inertia inertia_sphere;
+    ASSERT_TRUE( builder_sphere.GetInertia( &inertia_data_sphere, inertia_sphere ) );
+    EXPECT_NEAR( inertia_sphere.getMass(), ( 4. / 3. ) * loco::PI * 0.1 * 0.1 * 0.1 * loco::DEFAULT_DENSITY, 1e-5 );
+    EXPECT_FALSE( builder_sphere.GetInertia( &inertias_data[0], inertia_sphere ) );
+}
+
+TEST( TestLocoDartParallelBuild, TestLocoDartParallelBuildSimulation )
+{
+    loco::InitUtils();
+
+    // Bodies built by the simulation (in parallel) match the ones built by standalone adapters (serially)
+    const ssize_t num_bodies = 16;
+    const auto colliders_data = create_mesh_colliders_data( num_bodies );
+    auto scenario = std::make_unique<loco::TScenario>();
+    for ( ssize_t i = 0; i < num_bodies; i++ )
+    {
+        auto body_data = loco::TBodyData();
+        body_data.dyntype = loco::eDynamicsType::DYNAMIC;
+        body_data.collision = colliders_data[i];
+        body_data.visual.type = colliders_data[i].type;
+        body_data.visual.size = colliders_data[i].size;
+        body_data.visual.mesh_data.filename = colliders_data[i].mesh_data.filename;
+        scenario->AddSingleBody( std::make_unique<loco::TSingleBody>( "monkey_" + std::to_string( i ), body_data,
+                                                                      loco::TVec3( 0.5 * i, 0.0, 1.0 ), loco::TMat3() ) );
+    }
+    auto simulation = std::make_unique<loco::TDartSimulation>( scenario.get() );
+    simulation->Initialize();
+
+    // Skeletons are added to the world in the order of the bodies in the scenario
+    ASSERT_EQ( simulation->dart_world()->getNumSkeletons(), num_bodies );
+    for ( ssize_t i = 0; i < num_bodies; i++ )
+    {
+        auto skeleton = simulation->dart_world()->getSkeleton( i );
+        EXPECT_EQ( skeleton->getName(), "monkey_" + std::to_string( i ) );
+
+        auto shape = loco::dartsim::CreateCollisionShape( colliders_data[i] );
+        const auto inertia = loco::dartsim::ComputeBodyInertia( skeleton->getName(), loco::TInertialData(),
+                                                                &colliders_data[i], shape );
+        EXPECT_DOUBLE_EQ( skeleton->getBodyNode( 0 )->getMass(), inertia.getMass() );
+        EXPECT_TRUE( skeleton->getBodyNode( 0 )->getInertia().getMoment().isApprox( inertia.getMoment() ) );
+    }
+    simulation->Step();
+}
@@ -0,0 +1,266 @@
+
+#include <loco.h>
+#include <gtest/gtest.h>
+#include <random>
+
+#include <loco_common_dart.h>
+#include <loco_queries_dart.h>
+
+dart::dynamics::ShapeNode* add_static_shape( dart::simulation::World* world, const std::string& name,
+                                             const dart::dynamics::ShapePtr& shape, const Eigen::Vector3d& position )
+{
+    auto skeleton = dart::dynamics::Skeleton::create( name );
+    dart::dynamics::WeldJoint::Properties joint_properties;
+    joint_properties.mT_ParentBodyToJoint.translation() = position;
+    auto bodynode = skeleton->createJointAndBodyNodePair<dart::dynamics::WeldJoint>( nullptr, joint_properties ).second;
+    auto shape_node = bodynode->createShapeNodeWith<dart::dynamics::CollisionAspect, dart::dynamics::DynamicsAspect>( shape );
+    world->addSkeleton( skeleton );
+    return shape_node;
+}
+
+TEST( TestLocoDartQueries, TestLocoDartQueriesThreadPool )
+{
+    loco::InitUtils();
+
+    loco::dartsim::TDartThreadPool thread_pool( 3 );
+    EXPECT_EQ( thread_pool.num_threads(), 4 );
+    for ( ssize_t num_items : { 0, 1, 7, 1000, 12345 } )
+    {
+        std::vector<int> visits( num_items, 0 );
+        thread_pool.ParallelFor( num_items, 16, [&]( ssize_t begin, ssize_t end, ssize_t thread_index )
+            {
+                for ( ssize_t i = begin; i < end; i++ )
+                    visits[i]++;
+            } );
+        for ( ssize_t i = 0; i < num_items; i++ )
+            ASSERT_EQ( visits[i], 1 );
+    }
+}
+
+TEST( TestLocoDartQueries, TestLocoDartQueriesRaycast )
+{
+    loco::InitUtils();
+
+    // Ground (top face at z=0) and a sphere of radius 0.5 resting on it
+    auto world = dart::simulation::World::create();
+    world->getConstraintSolver()->setCollisionDetector( dart::collision::BulletCollisionDetector::create() );
+    auto ground_node = add_static_shape( world.get(), "ground", std::make_shared<dart::dynamics::BoxShape>( Eigen::Vector3d( 20.0, 20.0, 1.0 ) ),
+                                         Eigen::Vector3d( 0.0, 0.0, -0.5 ) );
+    auto sphere_node = add_static_shape( world.get(), "sphere", std::make_shared<dart::dynamics::SphereShape>( 0.5 ),
+                                         Eigen::Vector3d( 2.0, 0.0, 0.5 ) );
+    world->step();
+
+    loco::dartsim::TDartQueries queries( world.get(), 3 );
+    const ssize_t ground_id = queries.RegisterCollider( ground_node, "ground" );
+    const ssize_t sphere_id = queries.RegisterCollider( sphere_node, "sphere" );
+    EXPECT_EQ( queries.collider_name( sphere_id ), "sphere" );
+
+    // Height-scan like pattern: a grid of vertical rays from 5m above the ground
+    const ssize_t num_rays_side = 64;
+    loco::dartsim::TDartRayBatch batch;
+    batch.Resize( num_rays_side * num_rays_side );
+    batch.max_distance = 10.0;
+    for ( ssize_t i = 0; i < num_rays_side; i++ )
+    {
+        for ( ssize_t j = 0; j < num_rays_side; j++ )
+        {
+            const double x = -4.0 + 8.0 * i / ( num_rays_side - 1 );
+            const double y = -4.0 + 8.0 * j / ( num_rays_side - 1 );
+            batch.origins.row( i * num_rays_side + j ) << x, y, 5.0;
+            batch.directions.row( i * num_rays_side + j ) << 0.0, 0.0, -2.0;
+        }
+    }
+    queries.CastRays( batch );
+
+    for ( ssize_t r = 0; r < batch.num_rays(); r++ )
+    {
+        const Eigen::Vector3d origin = batch.origins.row( r ).transpose();
+        const double dist_xy = ( origin.head<2>() - Eigen::Vector2d( 2.0, 0.0 ) ).norm();
+        if ( dist_xy < 0.45 )
+        {
+            EXPECT_EQ( batch.collider_ids[r], sphere_id );
+            EXPECT_NEAR( batch.distances[r], 5.0 - ( 0.5 + std::sqrt( 0.25 - dist_xy * dist_xy ) ), 1e-3 );
+        }
+        else if ( dist_xy > 0.55 )
+        {
+            EXPECT_EQ( batch.collider_ids[r], ground_id );
+            EXPECT_NEAR( batch.distances[r], 5.0, 1e-3 );
+            EXPECT_NEAR( batch.normals( r, 2 ), 1.0, 1e-6 );
+        }
+    }
+
+    // Rays going up don't hit anything
+    loco::dartsim::TDartRayBatch batch_up;
+    batch_up.Resize( 1 );
+    batch_up.origins.row( 0 ) << 0.0, 0.0, 1.0;
+    batch_up.directions.row( 0 ) << 0.0, 0.0, 1.0;
+    queries.CastRays( batch_up );
+    EXPECT_EQ( batch_up.collider_ids[0], loco::dartsim::LOCO_DART_RAY_MISS );
+    EXPECT_DOUBLE_EQ( batch_up.distances[0], batch_up.max_distance );
+
+    // Compare against bullet's own (serial) ray-test
+    auto bullet_group = dynamic_cast<dart::collision::BulletCollisionGroup*>( world->getConstraintSolver()->getCollisionGroup().get() );
+    auto bullet_world = bullet_group->getBulletCollisionWorld();
+    for ( ssize_t r = 0; r < batch.num_rays(); r++ )
+    {
+        const btVector3 ray_from( batch.origins( r, 0 ), batch.origins( r, 1 ), batch.origins( r, 2 ) );
+        const btVector3 ray_to = ray_from + btVector3( 0.0, 0.0, -batch.max_distance );
+        btCollisionWorld::ClosestRayResultCallback result_callback( ray_from, ray_to );
+        bullet_world->rayTest( ray_from, ray_to, result_callback );
+        ASSERT_TRUE( result_callback.hasHit() );
+        EXPECT_NEAR( result_callback.m_closestHitFraction * batch.max_distance, batch.distances[r], 1e-6 );
+    }
+}
+
+TEST( TestLocoDartQueries, TestLocoDartQueriesHeightfieldSampling )
+{
+    loco::InitUtils();
+
+    // Bumpy heightfield (random heights), rotated around z and lifted from the ground
+    const ssize_t num_width_samples = 50;
+    const ssize_t num_depth_samples = 40;
+    std::mt19937 random_generator( 0 );
+    std::uniform_real_distribution<float> random_height( 0.0f, 1.0f );
+    auto shape_data = loco::TShapeData();
+    shape_data.type = loco::eShapeType::HFIELD;
+    shape_data.size = { 10.0f, 8.0f, 0.5f }; // width, depth, scale-height
+    shape_data.hfield_data.nWidthSamples = num_width_samples;
+    shape_data.hfield_data.nDepthSamples = num_depth_samples;
+    shape_data.hfield_data.heights.resize( num_width_samples * num_depth_samples );
+    for ( auto& height : shape_data.hfield_data.heights )
+        height = random_height( random_generator );
+    auto hfield_shape = std::dynamic_pointer_cast<dart::dynamics::HeightmapShapef>( loco::dartsim::CreateCollisionShape( shape_data ) );
+    ASSERT_TRUE( hfield_shape != nullptr );
+    // Heights as given by the user (bullet flips the buffer of the shape in place once it's in the world)
+    const Eigen::Map<const loco::dartsim::THeightsMatrix> hfield( shape_data.hfield_data.heights.data(), num_depth_samples, num_width_samples );
+    const Eigen::Vector3f hfield_scale = hfield_shape->getScale();
+
+    auto world = dart::simulation::World::create();
+    world->getConstraintSolver()->setCollisionDetector( dart::collision::BulletCollisionDetector::create() );
+    auto hfield_node = add_static_shape( world.get(), "terrain", hfield_shape, Eigen::Vector3d( 1.0, -0.5, 0.2 ) );
+    hfield_node->setRelativeRotation( Eigen::AngleAxisd( 0.3, Eigen::Vector3d::UnitZ() ).toRotationMatrix() );
+    world->step();
+    loco::dartsim::TDartQueries queries( world.get(), 0 );
+    queries.RegisterCollider( hfield_node, "terrain" );
+    const Eigen::Isometry3d tf_world_to_shape = hfield_node->getWorldTransform();
+    const double delta_x = hfield_shape->getScale().x();
+    const double delta_y = hfield_shape->getScale().y();
+
+    // At the samples both agree (bullet triangulates each cell, while the sampling is bilinear in between)
+    loco::dartsim::TPointsXY points_xy( ( num_width_samples - 2 ) * ( num_depth_samples - 2 ), 2 );
+    for ( ssize_t i = 1; i < num_depth_samples - 1; i++ )
+    {
+        for ( ssize_t j = 1; j < num_width_samples - 1; j++ )
+        {
+            const Eigen::Vector3d point_local( ( j - 0.5 * ( num_width_samples - 1 ) ) * delta_x,
+                                               ( i - 0.5 * ( num_depth_samples - 1 ) ) * delta_y, 0.0 );
+            points_xy.row( ( i - 1 ) * ( num_width_samples - 2 ) + ( j - 1 ) ) = ( tf_world_to_shape * point_local ).head<2>().transpose();
+        }
+    }
+    Eigen::VectorXd heights;
+    loco::dartsim::SampleHeightfield( hfield, hfield_scale, tf_world_to_shape, points_xy, heights );
+
+    loco::dartsim::TDartRayBatch batch;
+    batch.Resize( points_xy.rows() );
+    batch.max_distance = 20.0;
+    for ( ssize_t r = 0; r < batch.num_rays(); r++ )
+    {
+        batch.origins.row( r ) << points_xy( r, 0 ), points_xy( r, 1 ), 10.0;
+        batch.directions.row( r ) << 0.0, 0.0, -1.0;
+    }
+    queries.CastRays( batch );
+    for ( ssize_t r = 0; r < batch.num_rays(); r++ )
+    {
+        ASSERT_NE( batch.collider_ids[r], loco::dartsim::LOCO_DART_RAY_MISS );
+        EXPECT_NEAR( heights[r], 10.0 - batch.distances[r], 1e-4 );
+    }
+
+    // Bilinear interpolation within a cell, and clamping to the border outside the heightfield (the first row of
+    // heights lies at the +y border, so rows go along -y)
+    const ssize_t cell_x = 10, cell_y = 20;
+    const Eigen::Vector3d point_local( ( cell_x + 0.25 - 0.5 * ( num_width_samples - 1 ) ) * delta_x,
+                                       ( 0.5 * ( num_depth_samples - 1 ) - cell_y - 0.5 ) * delta_y, 0.0 );
+    const Eigen::Vector3d point_outside_local( 100.0, ( 0.5 * ( num_depth_samples - 1 ) - cell_y ) * delta_y, 0.0 );
+    loco::dartsim::TPointsXY points_check( 2, 2 );
+    points_check.row( 0 ) = ( tf_world_to_shape * point_local ).head<2>().transpose();
+    points_check.row( 1 ) = ( tf_world_to_shape * point_outside_local ).head<2>().transpose();
+    loco::dartsim::SampleHeightfield( hfield, hfield_scale, tf_world_to_shape, points_check, heights );
+    const double expected_height = 0.5 * ( 0.75 * hfield( cell_y, cell_x ) + 0.25 * hfield( cell_y, cell_x + 1 ) ) +
+                                   0.5 * ( 0.75 * hfield( cell_y + 1, cell_x ) + 0.25 * hfield( cell_y + 1, cell_x + 1 ) );
+    EXPECT_NEAR( heights[0], 0.2 + 0.5 * expected_height, 1e-5 );
+    EXPECT_NEAR( heights[1], 0.2 + 0.5 * hfield( cell_y, num_width_samples - 1 ), 1e-5 );
+
+    // Height-scan of a single robot (17 x 11 points around it): analytic sampling matches vertical rays
+    const ssize_t num_scan_points = 17 * 11;
+    loco::dartsim::TPointsXY points_scan( num_scan_points, 2 );
+    for ( ssize_t r = 0; r < num_scan_points; r++ )
+        points_scan.row( r ) << 1.0 + 0.1 * ( r % 17 - 8 ), -0.5 + 0.1 * ( r / 17 - 5 );
+    batch.Resize( num_scan_points );
+    for ( ssize_t r = 0; r < num_scan_points; r++ )
+    {
+        batch.origins.row( r ) << points_scan( r, 0 ), points_scan( r, 1 ), 10.0;
+        batch.directions.row( r ) << 0.0, 0.0, -1.0;
+    }
+    queries.CastRays( batch );
+    loco::dartsim::SampleHeightfield( hfield, hfield_scale, tf_world_to_shape, points_scan, heights );
+    for ( ssize_t r = 0; r < num_scan_points; r++ )
+    {
+        ASSERT_NE( batch.collider_ids[r], loco::dartsim::LOCO_DART_RAY_MISS );
+        EXPECT_NEAR( heights[r], 10.0 - batch.distances[r], 1e-4 );
+    }
+}
+
+TEST( TestLocoDartQueries, TestLocoDartQueriesDistances )
+{
+    loco::InitUtils();
+
+    // Gripper-like sphere above the ground, next to a box and another sphere (obstacles)
+    auto world = dart::simulation::World::create();
+    auto ground_node = add_static_shape( world.get(), "ground", std::make_shared<dart::dynamics::BoxShape>( Eigen::Vector3d( 20.0, 20.0, 1.0 ) ),
+                                         Eigen::Vector3d( 0.0, 0.0, -0.5 ) );
+    auto gripper_node = add_static_shape( world.get(), "gripper", std::make_shared<dart::dynamics::SphereShape>( 0.1 ),
+                                          Eigen::Vector3d( 0.0, 0.0, 1.0 ) );
+    auto box_node = add_static_shape( world.get(), "box", std::make_shared<dart::dynamics::BoxShape>( Eigen::Vector3d( 0.2, 0.2, 0.2 ) ),
+                                      Eigen::Vector3d( 0.6, 0.0, 1.0 ) );
+    auto sphere_node = add_static_shape( world.get(), "sphere", std::make_shared<dart::dynamics::SphereShape>( 0.2 ),
+                                         Eigen::Vector3d( 0.0, -0.8, 1.0 ) );
+
+    loco::dartsim::TDartQueries queries( world.get(), 2 );
+    const ssize_t ground_id = queries.RegisterCollider( ground_node, "ground" );
+    const ssize_t gripper_id = queries.RegisterCollider( gripper_node, "gripper" );
+    const ssize_t box_id = queries.RegisterCollider( box_node, "box" );
+    const ssize_t sphere_id = queries.RegisterCollider( sphere_node, "sphere" );
+    EXPECT_EQ( queries.collider_id( "box" ), box_id );
+    EXPECT_EQ( queries.collider_id( "unknown" ), -1 );
+
+    const ssize_t query_ground = queries.RegisterDistancePair( gripper_id, ground_id );
+    const ssize_t query_sphere = queries.RegisterDistancePair( gripper_id, sphere_id );
+    const ssize_t query_obstacles = queries.RegisterDistanceGroup( gripper_id, { gripper_id, ground_id, box_id, sphere_id } );
+    EXPECT_EQ( queries.RegisterDistancePair( gripper_id, 100 ), -1 );
+    EXPECT_EQ( queries.num_distance_queries(), 3 );
+
+    loco::dartsim::TDartDistanceResults results;
+    queries.ComputeDistances( results );
+    ASSERT_EQ( results.num_queries(), 3 );
+
+    EXPECT_NEAR( results.distances[query_ground], 0.9, 1e-4 );
+    EXPECT_NEAR( results.points_a( query_ground, 2 ), 0.9, 1e-4 );
+    EXPECT_NEAR( results.points_b( query_ground, 2 ), 0.0, 1e-4 );
+    EXPECT_EQ( results.collider_ids_b[query_ground], ground_id );
+
+    EXPECT_NEAR( results.distances[query_sphere], 0.5, 1e-4 );
+    EXPECT_NEAR( results.points_a( query_sphere, 1 ), -0.1, 1e-4 );
+    EXPECT_NEAR( results.points_b( query_sphere, 1 ), -0.6, 1e-4 );
+
+    // Closest obstacle is the box (the gripper itself is excluded from the group)
+    EXPECT_NEAR( results.distances[query_obstacles], 0.4, 1e-4 );
+    EXPECT_EQ( results.collider_ids_b[query_obstacles], box_id );
+    EXPECT_NEAR( results.points_b( query_obstacles, 0 ), 0.5, 1e-4 );
+
+    // Moving the gripper into the box puts them in contact
+    gripper_node->getSkeleton()->getBodyNode( 0 )->getParentJoint()->setTransformFromParentBodyNode(
+        Eigen::Translation3d( 0.45, 0.0, 1.0 ) * Eigen::Isometry3d::Identity() );
+    queries.ComputeDistances( results );
+    EXPECT_NEAR( results.distances[query_obstacles], 0.0, 1e-6 );
+    EXPECT_EQ( results.collider_ids_b[query_obstacles], box_id );
+}
@@ -0,0 +1,117 @@
+
+#include <loco.h>
+#include <gtest/gtest.h>
+
+#include <loco_realtime_dart.h>
+
+using TClock = loco::dartsim::TDartRealtimePacer::TClock;
+
+// Wall-clock driven by the test: sleeping jumps right to the wake-up time, and every read advances it by a
+// microsecond (so spinning until a deadline terminates)
+struct TFakeClock
+{
+    TClock::time_point now = TClock::time_point() + std::chrono::seconds( 1 );
+
+    void Advance( double seconds )
+    {
+        now += std::chrono::duration_cast<TClock::duration>( std::chrono::duration<double>( seconds ) );
+    }
+
+    loco::dartsim::TDartRealtimePacer::TNowFn now_fn()
+    {
+        return [this]()
+            {
+                const auto wall_time = now;
+                now += std::chrono::microseconds( 1 );
+                return wall_time;
+            };
+    }
+
+    loco::dartsim::TDartRealtimePacer::TSleepUntilFn sleep_until_fn()
+    {
+        return [this]( const TClock::time_point& wall_time ) { now = std::max( now, wall_time ); };
+    }
+};
+
+double seconds_between( const TClock::time_point& start, const TClock::time_point& end )
+{
+    return std::chrono::duration<double>( end - start ).count();
+}
+
+TEST( TestLocoDartRealtime, TestLocoDartRealtimePacing )
+{
+    loco::InitUtils();
+
+    const double dt = 0.001;
+    const ssize_t num_steps = 200;
+
+    TFakeClock clock;
+    loco::dartsim::TDartRealtimePacer pacer( loco::dartsim::TDartRealtimeData(), clock.now_fn(), clock.sleep_until_fn() );
+    double sim_time = 0.0;
+    pacer.Start( sim_time );
+    const auto wall_start = clock.now;
+    for ( ssize_t i = 0; i < num_steps; i++ )
+    {
+        // Steps taking a fraction of their simulated duration are released at their deadlines (never earlier)
+        clock.Advance( 0.3 * dt );
+        sim_time += dt;
+        pacer.Pace( sim_time );
+        EXPECT_GE( seconds_between( wall_start, clock.now ), sim_time - 1e-8 );
+        EXPECT_LT( seconds_between( wall_start, clock.now ), sim_time + 1e-5 );
+    }
+    EXPECT_EQ( pacer.stats().num_steps, num_steps );
+    EXPECT_EQ( pacer.stats().num_overruns, 0 );
+    EXPECT_EQ( pacer.stats().num_resyncs, 0 );
+    EXPECT_GE( pacer.stats().last_lateness, 0.0 );
+    EXPECT_LT( pacer.stats().max_lateness, 1e-5 );
+
+    // A step that takes 5ms shows up as an overrun of ~4ms (bucket [2^11, 2^12) us)
+    clock.Advance( 0.005 );
+    sim_time += dt;
+    pacer.Pace( sim_time );
+    EXPECT_EQ( pacer.stats().num_overruns, 1 );
+    EXPECT_EQ( pacer.stats().overruns_histogram[11], 1 );
+
+    // Next steps are rushed to catch up with the wall-clock (released right away, as their deadlines passed)
+    const auto wall_overrun = clock.now;
+    sim_time += dt;
+    pacer.Pace( sim_time );
+    EXPECT_LT( seconds_between( wall_overrun, clock.now ), 1e-5 );
+    EXPECT_EQ( pacer.stats().num_resyncs, 0 );
+
+    // Lagging more than the maximum lag resyncs the clocks, instead of rushing the next steps
+    clock.Advance( 0.2 );
+    sim_time += dt;
+    pacer.Pace( sim_time );
+    EXPECT_EQ( pacer.stats().num_resyncs, 1 );
+    const auto wall_resync = clock.now;
+    sim_time += dt;
+    pacer.Pace( sim_time );
+    EXPECT_GE( seconds_between( wall_resync, clock.now ), dt - 1e-5 );
+}
+
+TEST( TestLocoDartRealtime, TestLocoDartRealtimePacingSteadyClock )
+{
+    loco::InitUtils();
+
+    // Same pacing on the actual wall-clock, only checking the ordering (timings depend on the machine's load)
+    const double dt = 0.001;
+    const ssize_t num_steps = 50;
+    loco::dartsim::TDartRealtimePacer pacer;
+    double sim_time = 0.0;
+    const auto wall_start = TClock::now();
+    pacer.Start( sim_time );
+    auto wall_last = wall_start;
+    for ( ssize_t i = 0; i < num_steps; i++ )
+    {
+        sim_time += dt;
+        pacer.Pace( sim_time );
+        const auto wall_time = TClock::now();
+        EXPECT_GE( wall_time, wall_last );
+        wall_last = wall_time;
+    }
+    EXPECT_GE( seconds_between( wall_start, wall_last ), num_steps * dt );
+    EXPECT_EQ( pacer.stats().num_steps, num_steps );
+    EXPECT_GE( pacer.stats().last_lateness, 0.0 );
+    EXPECT_GE( pacer.stats().max_lateness, pacer.stats().last_lateness );
+}
@@ -0,0 +1,182 @@
+
+#include <loco.h>
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <random>
+
+#include <loco_common_dart.h>
+#include <loco_replay_dart.h>
+
+// Ground and a few boxes stacked on top of it (same world every time it's created)
+dart::simulation::WorldPtr create_boxes_world()
+{
+    auto world = dart::simulation::World::create();
+    world->setTimeStep( 0.002 );
+    world->getConstraintSolver()->setCollisionDetector( dart::collision::BulletCollisionDetector::create() );
+
+    auto ground = dart::dynamics::Skeleton::create( "ground" );
+    dart::dynamics::WeldJoint::Properties ground_joint_properties;
+    ground_joint_properties.mT_ParentBodyToJoint.translation() = Eigen::Vector3d( 0.0, 0.0, -0.5 );
+    auto ground_body = ground->createJointAndBodyNodePair<dart::dynamics::WeldJoint>( nullptr, ground_joint_properties ).second;
+    ground_body->createShapeNodeWith<dart::dynamics::CollisionAspect, dart::dynamics::DynamicsAspect>(
+                        std::make_shared<dart::dynamics::BoxShape>( Eigen::Vector3d( 10.0, 10.0, 1.0 ) ) );
+    world->addSkeleton( ground );
+
+    for ( ssize_t i = 0; i < 3; i++ )
+    {
+        auto box = dart::dynamics::Skeleton::create( "box_" + std::to_string( i ) );
+        auto box_body = box->createJointAndBodyNodePair<dart::dynamics::FreeJoint>().second;
+        box_body->createShapeNodeWith<dart::dynamics::CollisionAspect, dart::dynamics::DynamicsAspect>(
+                        std::make_shared<dart::dynamics::BoxShape>( Eigen::Vector3d( 0.2, 0.2, 0.2 ) ) );
+        Eigen::Isometry3d tf = Eigen::Isometry3d::Identity();
+        tf.translation() = Eigen::Vector3d( 0.05 * i, 0.0, 0.1 + 0.25 * i );
+        dart::dynamics::FreeJoint::setTransform( box_body, tf );
+        world->addSkeleton( box );
+    }
+    return world;
+}
+
+TEST( TestLocoDartReplay, TestLocoDartReplaySeek )
+{
+    loco::InitUtils();
+
+    const std::string replay_filepath = "test_replay_dart.bin";
+    const ssize_t num_substeps = 600;
+    const ssize_t substep_teleport = 300;
+
+    // Record a run with random pushes, a teleport and a change of gravity, keeping the state before every substep
+    auto world = create_boxes_world();
+    std::vector<Eigen::VectorXd> states;
+    auto get_state = []( dart::simulation::World* world )
+        {
+            Eigen::VectorXd state( 3 * 12 );
+            for ( ssize_t i = 0; i < 3; i++ )
+                state.segment<12>( 12 * i ) << world->getSkeleton( i + 1 )->getPositions(), world->getSkeleton( i + 1 )->getVelocities();
+            return state;
+        };
+    {
+        std::mt19937 random_generator( 0 );
+        std::uniform_real_distribution<double> random_force( -20.0, 20.0 );
+        loco::dartsim::TDartReplayRecorder recorder( world.get(), replay_filepath, 100 );
+        ASSERT_TRUE( recorder.valid() );
+        for ( ssize_t i = 0; i < num_substeps; i++ )
+        {
+            if ( i % 7 == 0 )
+                world->getSkeleton( 1 + i % 3 )->getBodyNode( 0 )->addExtForce( Eigen::Vector3d( random_force( random_generator ), random_force( random_generator ), 0.0 ) );
+            if ( i % 5 == 0 )
+                world->getSkeleton( 2 )->getDof( 3 )->setForce( random_force( random_generator ) );
+            if ( i == substep_teleport )
+                world->getSkeleton( 3 )->setPosition( 5, 1.0 );
+            if ( i == 450 )
+                world->setGravity( Eigen::Vector3d( 0.0, 0.0, -5.0 ) );
+
+            states.push_back( get_state( world.get() ) );
+            recorder.RecordSubstep( true );
+            world->step( true );
+            recorder.RecordPostSubstep();
+        }
+        states.push_back( get_state( world.get() ) );
+        EXPECT_EQ( recorder.num_substeps(), num_substeps );
+    }
+
+    // Play back on a fresh copy of the world, seeking back and forth (results must be bit-exact)
+    auto world_replay = create_boxes_world();
+    loco::dartsim::TDartReplayPlayer player( world_replay.get(), replay_filepath );
+    ASSERT_TRUE( player.valid() );
+    EXPECT_EQ( player.num_substeps(), num_substeps );
+    for ( ssize_t substep : { 0, 250, 99, 100, substep_teleport + 1, 599, 450, num_substeps } )
+    {
+        ASSERT_TRUE( player.Seek( substep ) );
+        EXPECT_EQ( player.current_substep(), substep );
+        ASSERT_TRUE( get_state( world_replay.get() ) == states[substep] ) << "state mismatch at substep " << substep;
+    }
+    EXPECT_FALSE( player.StepForward() );
+    EXPECT_FALSE( player.Seek( num_substeps + 1 ) );
+
+    // Playing straight through gives the same states as well
+    ASSERT_TRUE( player.Seek( 0 ) );
+    for ( ssize_t i = 0; i < num_substeps; i++ )
+    {
+        ASSERT_TRUE( player.StepForward() );
+        ASSERT_TRUE( get_state( world_replay.get() ) == states[i + 1] ) << "state mismatch at substep " << ( i + 1 );
+    }
+    std::remove( replay_filepath.c_str() );
+}
+
+TEST( TestLocoDartReplay, TestLocoDartReplaySeekRestingContacts )
+{
+    loco::InitUtils();
+
+    // Boxes settle on the ground (and on each other) early on, so every keyframe after that has cached contacts
+    const std::string replay_filepath = "test_replay_dart_resting.bin";
+    const ssize_t num_substeps = 800;
+    auto world = create_boxes_world();
+    std::vector<std::vector<Eigen::VectorXd>> states;
+    auto get_state = []( dart::simulation::World* world )
+        {
+            std::vector<Eigen::VectorXd> state;
+            for ( size_t i = 1; i < world->getNumSkeletons(); i++ )
+            {
+                state.push_back( world->getSkeleton( i )->getPositions() );
+                state.push_back( world->getSkeleton( i )->getVelocities() );
+            }
+            return state;
+        };
+    {
+        loco::dartsim::TDartReplayRecorder recorder( world.get(), replay_filepath, 50 );
+        ASSERT_TRUE( recorder.valid() );
+        for ( ssize_t i = 0; i < num_substeps; i++ )
+        {
+            states.push_back( get_state( world.get() ) );
+            recorder.RecordSubstep( true );
+            world->step( true );
+            recorder.RecordPostSubstep();
+        }
+        states.push_back( get_state( world.get() ) );
+    }
+    ASSERT_GT( world->getLastCollisionResult().getNumContacts(), 0 );
+
+    // Seeking straight into the resting phase (from a fresh world) starts from the keyframe right before it, whose
+    // restored contacts must give the same substeps as the recorded ones
+    auto world_replay = create_boxes_world();
+    loco::dartsim::TDartReplayPlayer player( world_replay.get(), replay_filepath );
+    ASSERT_TRUE( player.valid() );
+    for ( ssize_t substep : { 775, 320, 799, 510, 560 } )
+    {
+        ASSERT_TRUE( player.Seek( substep ) );
+        ASSERT_TRUE( get_state( world_replay.get() ) == states[substep] ) << "state mismatch at substep " << substep;
+        for ( ssize_t i = 1; ( i <= 120 ) && ( substep + i <= num_substeps ); i++ )
+        {
+            ASSERT_TRUE( player.StepForward() );
+            ASSERT_TRUE( get_state( world_replay.get() ) == states[substep + i] ) << "state mismatch at substep " << ( substep + i )
+                                                                                   << " (seeked to substep " << substep << ")";
+        }
+    }
+    std::remove( replay_filepath.c_str() );
+}
+
+TEST( TestLocoDartReplay, TestLocoDartReplayRecordingIsPassive )
+{
+    loco::InitUtils();
+
+    // Recording a run doesn't change it (same states as the run without a recorder)
+    const std::string replay_filepath = "test_replay_dart_passive.bin";
+    const ssize_t num_substeps = 500;
+    auto world_plain = create_boxes_world();
+    auto world_recorded = create_boxes_world();
+    loco::dartsim::TDartReplayRecorder recorder( world_recorded.get(), replay_filepath );
+    for ( ssize_t i = 0; i < num_substeps; i++ )
+    {
+        world_plain->step( true );
+        recorder.RecordSubstep( true );
+        world_recorded->step( true );
+        recorder.RecordPostSubstep();
+    }
+    for ( size_t i = 0; i < world_plain->getNumSkeletons(); i++ )
+    {
+        EXPECT_TRUE( world_plain->getSkeleton( i )->getPositions() == world_recorded->getSkeleton( i )->getPositions() );
+        EXPECT_TRUE( world_plain->getSkeleton( i )->getVelocities() == world_recorded->getSkeleton( i )->getVelocities() );
+    }
+    recorder.Close();
+    std::remove( replay_filepath.c_str() );
+}
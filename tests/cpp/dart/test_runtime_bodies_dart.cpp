@@ -0,0 +1,126 @@
+
+#include <loco.h>
+#include <gtest/gtest.h>
+
+#include <loco_simulation_dart.h>
+
+std::unique_ptr<loco::TSingleBody> create_box_body( const std::string& name, const loco::TVec3& position,
+                                                    const loco::TVec3& size = { 0.2f, 0.2f, 0.2f } )
+{
+    auto body_data = loco::TBodyData();
+    body_data.dyntype = loco::eDynamicsType::DYNAMIC;
+    body_data.collision.type = loco::eShapeType::BOX;
+    body_data.collision.size = size;
+    body_data.visual.type = loco::eShapeType::BOX;
+    body_data.visual.size = size;
+    return std::make_unique<loco::TSingleBody>( name, body_data, position, loco::TMat3() );
+}
+
+std::unique_ptr<loco::TSingleBody> create_floor_body()
+{
+    auto body_data = loco::TBodyData();
+    body_data.dyntype = loco::eDynamicsType::STATIC;
+    body_data.collision.type = loco::eShapeType::PLANE;
+    body_data.collision.size = { 10.0f, 10.0f, 1.0f };
+    body_data.visual.type = loco::eShapeType::PLANE;
+    body_data.visual.size = { 10.0f, 10.0f, 1.0f };
+    return std::make_unique<loco::TSingleBody>( "floor", body_data, loco::TVec3( 0.0f, 0.0f, 0.0f ), loco::TMat3() );
+}
+
+TEST( TestLocoDartRuntimeBodies, TestLocoDartRuntimeBodiesAddRemove )
+{
+    loco::InitUtils();
+
+    auto scenario = std::make_unique<loco::TScenario>();
+    scenario->AddSingleBody( create_floor_body() );
+    scenario->AddSingleBody( create_box_body( "box_0", { 0.0f, 0.0f, 1.0f } ) );
+    auto simulation = std::make_unique<loco::TDartSimulation>( scenario.get() );
+    simulation->Initialize();
+    ASSERT_EQ( simulation->dart_world()->getNumSkeletons(), 2 );
+    ASSERT_EQ( simulation->state_buffer()->num_bodies(), 2 );
+    const ssize_t num_colliders = simulation->queries()->num_colliders();
+
+    // Bodies added at runtime take part in the simulation right away (skeleton, state-row and collider-id)
+    auto box_1 = simulation->AddSingleBody( create_box_body( "box_1", { 1.0f, 0.0f, 1.0f } ) );
+    ASSERT_TRUE( box_1 != nullptr );
+    EXPECT_EQ( simulation->dart_world()->getNumSkeletons(), 3 );
+    EXPECT_EQ( simulation->state_buffer()->body_index( "box_1" ), 2 );
+    EXPECT_EQ( simulation->queries()->collider_id( box_1->collider()->name() ), num_colliders );
+    for ( ssize_t i = 0; i < 500; i++ )
+        simulation->Step();
+    // Falls down and rests on the floor (same as the box that was there from the start)
+    EXPECT_NEAR( simulation->state().poses( 2, 2 ), 0.1, 1e-2 );
+    EXPECT_NEAR( simulation->state().poses( 1, 2 ), 0.1, 1e-2 );
+
+    // Sensors attached to a removed body go away with it (its body-node gets pooled), the others stay in order
+    auto sensors = simulation->body_sensors();
+    sensors->AddImuSensor( simulation->dart_world()->getSkeleton( "box_0" )->getBodyNode( 0 ), Eigen::Isometry3d::Identity() );
+    sensors->AddImuSensor( simulation->dart_world()->getSkeleton( "box_1" )->getBodyNode( 0 ), Eigen::Isometry3d::Identity() );
+    sensors->AddForceTorqueSensor( simulation->dart_world()->getSkeleton( "box_0" )->getBodyNode( 0 ), Eigen::Isometry3d::Identity() );
+    ASSERT_EQ( sensors->num_sensors(), 3 );
+
+    // Removed bodies leave the world, and rows of the bodies after them move up
+    EXPECT_TRUE( simulation->RemoveSingleBody( "box_0" ) );
+    EXPECT_EQ( sensors->num_sensors(), 1 );
+    EXPECT_EQ( sensors->type( 0 ), loco::sensors::eDartBodySensorType::IMU );
+    EXPECT_FALSE( simulation->RemoveSingleBody( "box_0" ) );
+    EXPECT_EQ( simulation->dart_world()->getNumSkeletons(), 2 );
+    EXPECT_EQ( simulation->state_buffer()->num_bodies(), 2 );
+    EXPECT_EQ( simulation->state_buffer()->body_index( "box_0" ), -1 );
+    EXPECT_EQ( simulation->state_buffer()->body_index( "box_1" ), 1 );
+    EXPECT_EQ( simulation->num_pooled_bodies(), 1 );
+    simulation->Step();
+    EXPECT_NEAR( simulation->state().poses( 1, 0 ), 1.0, 1e-2 );
+    EXPECT_NEAR( simulation->state().poses( 1, 2 ), 0.1, 1e-2 );
+}
+
+TEST( TestLocoDartRuntimeBodies, TestLocoDartRuntimeBodiesPool )
+{
+    loco::InitUtils();
+
+    auto scenario = std::make_unique<loco::TScenario>();
+    scenario->AddSingleBody( create_floor_body() );
+    auto simulation = std::make_unique<loco::TDartSimulation>( scenario.get() );
+    simulation->Initialize();
+    const ssize_t num_colliders = simulation->queries()->num_colliders();
+
+    auto box = simulation->AddSingleBody( create_box_body( "box_0", { 0.0f, 0.0f, 1.0f } ) );
+    auto skeleton = simulation->dart_world()->getSkeleton( "box_0" );
+    ASSERT_TRUE( skeleton != nullptr );
+    simulation->Step();
+
+    // Spawning and despawning equivalent bodies keeps reusing the same skeleton, collider-id and filter slot
+    for ( ssize_t i = 1; i < 50; i++ )
+    {
+        const std::string name_prev = "box_" + std::to_string( i - 1 );
+        const std::string name = "box_" + std::to_string( i );
+        const std::string collider_name_prev = box->collider()->name();
+        EXPECT_TRUE( simulation->RemoveSingleBody( name_prev ) );
+        EXPECT_EQ( simulation->num_pooled_bodies(), 1 );
+        EXPECT_EQ( simulation->dart_world()->getNumSkeletons(), 1 );
+
+        box = simulation->AddSingleBody( create_box_body( name, { 0.1f * i, 0.0f, 1.0f } ) );
+        EXPECT_EQ( simulation->num_pooled_bodies(), 0 );
+        EXPECT_EQ( simulation->dart_world()->getNumSkeletons(), 2 );
+        EXPECT_EQ( simulation->dart_world()->getSkeleton( name ), skeleton );
+        EXPECT_EQ( skeleton->getBodyNode( 0 )->getName(), name );
+        EXPECT_EQ( simulation->queries()->num_colliders(), num_colliders + 1 );
+        EXPECT_EQ( simulation->queries()->collider_id( box->collider()->name() ), num_colliders );
+        EXPECT_EQ( simulation->queries()->collider_id( collider_name_prev ), -1 );
+
+        // Reused bodies start over from their initial configuration
+        simulation->Step();
+        EXPECT_NEAR( simulation->state().poses( 1, 0 ), 0.1 * i, 1e-6 );
+        EXPECT_GT( simulation->state().poses( 1, 2 ), 0.9 );
+    }
+
+    // Bodies with different data get their own skeletons
+    EXPECT_TRUE( simulation->RemoveSingleBody( "box_49" ) );
+    auto big_box = simulation->AddSingleBody( create_box_body( "big_box", { 0.0f, 0.0f, 1.0f }, { 0.4f, 0.4f, 0.4f } ) );
+    ASSERT_TRUE( big_box != nullptr );
+    EXPECT_NE( simulation->dart_world()->getSkeleton( "big_box" ), skeleton );
+    EXPECT_EQ( simulation->num_pooled_bodies(), 1 );
+    for ( ssize_t i = 0; i < 500; i++ )
+        simulation->Step();
+    EXPECT_NEAR( simulation->state().poses( 1, 2 ), 0.2, 1e-2 );
+}
@@ -0,0 +1,156 @@
+
+#include <loco.h>
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+
+#include <loco_simulation_dart.h>
+
+// Bodies with meshes loaded from file (several shared, so some resources are reused within the same run)
+std::unique_ptr<loco::TScenario> create_meshes_scenario( ssize_t num_bodies, double density_last = loco::DEFAULT_DENSITY )
+{
+    auto scenario = std::make_unique<loco::TScenario>();
+    for ( ssize_t i = 0; i < num_bodies; i++ )
+    {
+        auto col_data = loco::TCollisionData();
+        col_data.type = loco::eShapeType::MESH;
+        col_data.size = { 0.2f + 0.05f * ( i % 3 ), 0.2f, 0.2f };
+        col_data.mesh_data.filename = loco::PATH_RESOURCES + "meshes/monkey.stl";
+        col_data.density = ( i == num_bodies - 1 ) ? density_last : loco::DEFAULT_DENSITY;
+        auto body_data = loco::TBodyData();
+        body_data.dyntype = loco::eDynamicsType::DYNAMIC;
+        body_data.collision = col_data;
+        body_data.visual.type = col_data.type;
+        body_data.visual.size = col_data.size;
+        body_data.visual.mesh_data.filename = col_data.mesh_data.filename;
+        scenario->AddSingleBody( std::make_unique<loco::TSingleBody>( "monkey_" + std::to_string( i ), body_data,
+                                                                      loco::TVec3( 0.5 * i, 0.0, 1.0 ), loco::TMat3() ) );
+    }
+    return scenario;
+}
+
+TEST( TestLocoDartSceneCache, TestLocoDartSceneCacheReuse )
+{
+    loco::InitUtils();
+
+    const std::string cache_filepath = "test_scene_cache_dart.bin";
+    const ssize_t num_bodies = 6;
+    std::remove( cache_filepath.c_str() );
+
+    // First run builds everything from scratch, and writes the cache
+    std::vector<dart::dynamics::Inertia> inertias;
+    {
+        auto scenario = create_meshes_scenario( num_bodies );
+        auto simulation = std::make_unique<loco::TDartSimulation>( scenario.get() );
+        EXPECT_FALSE( simulation->UseSceneCache( cache_filepath ) );
+        simulation->Initialize();
+        ASSERT_TRUE( simulation->scene_cache() != nullptr );
+        // The mesh file is loaded once (the other bodies reuse it), and all inertias are computed
+        EXPECT_EQ( simulation->scene_cache()->num_misses(), 1 + num_bodies );
+        EXPECT_EQ( simulation->scene_cache()->num_meshes(), 1 );
+        EXPECT_EQ( simulation->scene_cache()->num_inertias(), num_bodies );
+        EXPECT_FALSE( simulation->scene_cache()->dirty() );
+        for ( size_t i = 0; i < simulation->dart_world()->getNumSkeletons(); i++ )
+            inertias.push_back( simulation->dart_world()->getSkeleton( i )->getBodyNode( 0 )->getInertia() );
+    }
+
+    // Second run grabs meshes and inertias from the cache, and builds the same world
+    {
+        auto scenario = create_meshes_scenario( num_bodies );
+        auto simulation = std::make_unique<loco::TDartSimulation>( scenario.get() );
+        EXPECT_TRUE( simulation->UseSceneCache( cache_filepath ) );
+        simulation->Initialize();
+        EXPECT_EQ( simulation->scene_cache()->num_misses(), 0 );
+        EXPECT_GT( simulation->scene_cache()->num_hits(), 0 );
+        ASSERT_EQ( simulation->dart_world()->getNumSkeletons(), inertias.size() );
+        for ( size_t i = 0; i < simulation->dart_world()->getNumSkeletons(); i++ )
+        {
+            const auto& inertia = simulation->dart_world()->getSkeleton( i )->getBodyNode( 0 )->getInertia();
+            EXPECT_DOUBLE_EQ( inertia.getMass(), inertias[i].getMass() );
+            EXPECT_TRUE( inertia.getLocalCOM().isApprox( inertias[i].getLocalCOM() ) );
+            EXPECT_TRUE( inertia.getMoment().isApprox( inertias[i].getMoment() ) );
+        }
+        simulation->Step();
+    }
+    std::remove( cache_filepath.c_str() );
+}
+
+TEST( TestLocoDartSceneCache, TestLocoDartSceneCacheStale )
+{
+    loco::InitUtils();
+
+    const std::string cache_filepath = "test_scene_cache_dart_stale.bin";
+    {
+        auto scenario = create_meshes_scenario( 2 );
+        auto simulation = std::make_unique<loco::TDartSimulation>( scenario.get() );
+        simulation->UseSceneCache( cache_filepath );
+        simulation->Initialize();
+    }
+
+    // Bodies whose data changed are rebuilt (and their entries replaced), the others still come from the cache
+    {
+        auto scenario = create_meshes_scenario( 2, 2.0 * loco::DEFAULT_DENSITY );
+        auto simulation = std::make_unique<loco::TDartSimulation>( scenario.get() );
+        EXPECT_TRUE( simulation->UseSceneCache( cache_filepath ) );
+        simulation->Initialize();
+        EXPECT_EQ( simulation->scene_cache()->num_misses(), 1 );
+        EXPECT_FALSE( simulation->scene_cache()->dirty() );
+    }
+
+    // Files that aren't scene-caches are ignored, and overwritten with a valid one
+    {
+        std::ofstream garbage_file( cache_filepath, std::ios::binary | std::ios::trunc );
+        garbage_file << "not a scene-cache";
+    }
+    {
+        auto scenario = create_meshes_scenario( 2 );
+        auto simulation = std::make_unique<loco::TDartSimulation>( scenario.get() );
+        EXPECT_FALSE( simulation->UseSceneCache( cache_filepath ) );
+        simulation->Initialize();
+        EXPECT_EQ( simulation->scene_cache()->num_misses(), 1 + 2 );
+    }
+    {
+        dart::dynamics::Inertia inertia;
+        loco::dartsim::TDartSceneCache scene_cache;
+        EXPECT_TRUE( scene_cache.Load( cache_filepath ) );
+        EXPECT_EQ( scene_cache.num_inertias(), 2 );
+        EXPECT_FALSE( scene_cache.GetInertia( "monkey_0", 0, inertia ) );
+    }
+    std::remove( cache_filepath.c_str() );
+}
+
+TEST( TestLocoDartSceneCache, TestLocoDartSceneCacheMeshFileChanged )
+{
+    loco::InitUtils();
+
+    // Copy of a mesh file that gets modified after its inertia was cached (the filename stays the same)
+    const std::string mesh_filepath = "test_scene_cache_dart_mesh.stl";
+    {
+        std::ifstream src_file( loco::PATH_RESOURCES + "meshes/monkey.stl", std::ios::binary );
+        std::ofstream dst_file( mesh_filepath, std::ios::binary | std::ios::trunc );
+        dst_file << src_file.rdbuf();
+    }
+    auto col_data = loco::TCollisionData();
+    col_data.type = loco::eShapeType::COMPOUND;
+    auto child_data = loco::TShapeData();
+    child_data.type = loco::eShapeType::MESH;
+    child_data.size = { 0.2f, 0.2f, 0.2f };
+    child_data.mesh_data.filename = mesh_filepath;
+    col_data.children.push_back( child_data );
+    col_data.children_tfs.push_back( loco::TMat4() );
+    auto inertia_data = loco::TInertialData();
+    inertia_data.mass = 1.0f;
+
+    loco::dartsim::TDartSceneCache scene_cache;
+    loco::dartsim::ComputeBodyInertia( "compound", inertia_data, &col_data, nullptr, &scene_cache );
+    loco::dartsim::ComputeBodyInertia( "compound", inertia_data, &col_data, nullptr, &scene_cache );
+    EXPECT_EQ( scene_cache.num_misses(), 1 );
+    EXPECT_EQ( scene_cache.num_hits(), 1 );
+    {
+        std::ofstream dst_file( mesh_filepath, std::ios::binary | std::ios::app );
+        dst_file << "solid extra\nendsolid extra\n";
+    }
+    loco::dartsim::ComputeBodyInertia( "compound", inertia_data, &col_data, nullptr, &scene_cache );
+    EXPECT_EQ( scene_cache.num_misses(), 2 );
+    std::remove( mesh_filepath.c_str() );
+}
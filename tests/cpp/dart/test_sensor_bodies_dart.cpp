@@ -0,0 +1,114 @@
+
+#include <loco.h>
+#include <gtest/gtest.h>
+
+#include <loco_common_dart.h>
+#include <sensors/loco_sensor_bodies_dart.h>
+
+// Single body with the given joint to the world (1kg, com 0.5m below the joint)
+template< class JointType >
+dart::dynamics::SkeletonPtr create_body_skeleton( const std::string& name )
+{
+    auto skeleton = dart::dynamics::Skeleton::create( name );
+    typename JointType::Properties joint_properties;
+    joint_properties.mName = name + "_joint";
+    auto bodynode = skeleton->createJointAndBodyNodePair<JointType>(
+                        nullptr, joint_properties, dart::dynamics::BodyNode::AspectProperties( name + "_body" ) ).second;
+    dart::dynamics::Inertia inertia;
+    inertia.setMass( 1.0 );
+    inertia.setLocalCOM( Eigen::Vector3d( 0.0, 0.0, -0.5 ) );
+    inertia.setMoment( 0.02, 0.02, 0.001, 0.0, 0.0, 0.0 );
+    bodynode->setInertia( inertia );
+    return skeleton;
+}
+
+TEST( TestLocoDartBodySensors, TestLocoDartBodySensorsReadings )
+{
+    loco::InitUtils();
+
+    auto world = dart::simulation::World::create();
+    world->setTimeStep( 0.001 );
+    auto skeleton_welded = create_body_skeleton<dart::dynamics::WeldJoint>( "welded" );
+    auto skeleton_falling = create_body_skeleton<dart::dynamics::FreeJoint>( "falling" );
+    auto skeleton_hanging = create_body_skeleton<dart::dynamics::RevoluteJoint>( "hanging" );
+    world->addSkeleton( skeleton_welded );
+    world->addSkeleton( skeleton_falling );
+    world->addSkeleton( skeleton_hanging );
+
+    loco::sensors::TDartBodySensors sensors;
+    // Imu rotated 90deg around x: the world's up (z) is the sensor's y
+    Eigen::Isometry3d tf_rotated = Eigen::Isometry3d::Identity();
+    tf_rotated.linear() = Eigen::AngleAxisd( 0.5 * M_PI, Eigen::Vector3d::UnitX() ).toRotationMatrix();
+    const ssize_t imu_welded = sensors.AddImuSensor( skeleton_welded->getBodyNode( 0 ), tf_rotated );
+    const ssize_t imu_falling = sensors.AddImuSensor( skeleton_falling->getBodyNode( 0 ), Eigen::Isometry3d::Identity() );
+    const ssize_t ft_hanging = sensors.AddForceTorqueSensor( skeleton_hanging->getBodyNode( 0 ), Eigen::Isometry3d::Identity() );
+    EXPECT_EQ( sensors.AddImuSensor( nullptr, Eigen::Isometry3d::Identity() ), -1 );
+    EXPECT_EQ( sensors.num_sensors(), 3 );
+
+    for ( size_t i = 0; i < 10; i++ )
+    {
+        world->step();
+        sensors.Update( world->getGravity(), world->getTime() );
+    }
+
+    const double g = -world->getGravity().z();
+    // Bodies at rest measure the reaction to gravity, and free-falling ones measure no acceleration
+    const auto reading_welded = sensors.reading( imu_welded );
+    EXPECT_NEAR( reading_welded[0], 0.0, 1e-6 );
+    EXPECT_NEAR( reading_welded[1], g, 1e-6 );
+    EXPECT_NEAR( reading_welded[2], 0.0, 1e-6 );
+    EXPECT_NEAR( reading_welded.tail<3>().norm(), 0.0, 1e-6 );
+    EXPECT_NEAR( sensors.reading( imu_falling ).head<3>().norm(), 0.0, 1e-6 );
+    // Hanging pendulum at rest: the joint holds its weight, with no torque (com right below the joint)
+    const auto reading_hanging = sensors.reading( ft_hanging );
+    EXPECT_NEAR( reading_hanging[2], g, 1e-6 );
+    EXPECT_NEAR( reading_hanging.tail<3>().norm(), 0.0, 1e-6 );
+    EXPECT_EQ( sensors.readings().rows(), 3 );
+}
+
+TEST( TestLocoDartBodySensors, TestLocoDartBodySensorsNoise )
+{
+    loco::InitUtils();
+
+    auto world = dart::simulation::World::create();
+    world->setTimeStep( 0.001 );
+    auto skeleton = create_body_skeleton<dart::dynamics::WeldJoint>( "welded" );
+    world->addSkeleton( skeleton );
+    world->step();
+
+    loco::sensors::TDartSensorNoiseData accel_noise;
+    accel_noise.noise_stddev = 0.05f;
+    accel_noise.bias_stddev = 0.2f;
+    loco::sensors::TDartSensorNoiseData gyro_noise;
+    gyro_noise.noise_stddev = 0.01f;
+
+    // Same seed, same readings (runs are reproducible)
+    loco::sensors::TDartBodySensors sensors_a( 42 ), sensors_b( 42 );
+    sensors_a.AddImuSensor( skeleton->getBodyNode( 0 ), Eigen::Isometry3d::Identity(), accel_noise, gyro_noise );
+    sensors_b.AddImuSensor( skeleton->getBodyNode( 0 ), Eigen::Isometry3d::Identity(), accel_noise, gyro_noise );
+
+    const ssize_t num_samples = 20000;
+    Eigen::Matrix<double, 6, 1> mean = Eigen::Matrix<double, 6, 1>::Zero();
+    Eigen::Matrix<double, 6, 1> mean_sq = Eigen::Matrix<double, 6, 1>::Zero();
+    for ( ssize_t i = 0; i < num_samples; i++ )
+    {
+        sensors_a.Update( world->getGravity(), world->getTime() );
+        sensors_b.Update( world->getGravity(), world->getTime() );
+        ASSERT_EQ( sensors_a.reading( 0 ), sensors_b.reading( 0 ) );
+        mean += sensors_a.reading( 0 );
+        mean_sq += sensors_a.reading( 0 ).cwiseAbs2();
+    }
+    mean /= num_samples;
+    const Eigen::Matrix<double, 6, 1> stddev = ( mean_sq / num_samples - mean.cwiseAbs2() ).cwiseSqrt();
+
+    // White noise shows up as spread around the (constant) biased reading, and the gyro has no bias
+    for ( ssize_t j = 0; j < 3; j++ )
+    {
+        EXPECT_NEAR( stddev[j], 0.05, 0.005 );
+        EXPECT_NEAR( stddev[3 + j], 0.01, 0.001 );
+        EXPECT_NEAR( mean[3 + j], 0.0, 0.001 );
+    }
+    const double bias_z = mean[2] + world->getGravity().z();
+    EXPECT_GT( std::abs( bias_z ), 0.0 );
+    EXPECT_LT( std::abs( bias_z ), 1.0 );
+}
@@ -0,0 +1,92 @@
+
+#include <loco.h>
+#include <gtest/gtest.h>
+
+#include <loco_common_dart.h>
+#include <sensors/loco_sensor_joints_dart.h>
+
+// Double pendulum (two hinges along y), hanging from the world
+dart::dynamics::SkeletonPtr create_double_pendulum_skeleton()
+{
+    auto skeleton = dart::dynamics::Skeleton::create( "double_pendulum" );
+    dart::dynamics::BodyNode* parent_bodynode = nullptr;
+    for ( size_t i = 0; i < 2; i++ )
+    {
+        dart::dynamics::RevoluteJoint::Properties joint_properties;
+        joint_properties.mName = "hinge_" + std::to_string( i );
+        joint_properties.mAxis = Eigen::Vector3d::UnitY();
+        joint_properties.mT_ParentBodyToJoint.translation() = Eigen::Vector3d( 0.0, 0.0, ( i == 0 ) ? 0.0 : -0.5 );
+        auto bodynode = skeleton->createJointAndBodyNodePair<dart::dynamics::RevoluteJoint>(
+                            parent_bodynode, joint_properties, dart::dynamics::BodyNode::AspectProperties( "link_" + std::to_string( i ) ) ).second;
+        dart::dynamics::Inertia inertia;
+        inertia.setMass( 1.0 );
+        inertia.setLocalCOM( Eigen::Vector3d( 0.0, 0.0, -0.25 ) );
+        inertia.setMoment( 0.02, 0.02, 0.001, 0.0, 0.0, 0.0 );
+        bodynode->setInertia( inertia );
+        parent_bodynode = bodynode;
+    }
+    skeleton->setPosition( 0, 0.5 );
+    return skeleton;
+}
+
+TEST( TestLocoDartJointSensors, TestLocoDartJointSensorsRingBuffers )
+{
+    loco::InitUtils();
+
+    auto world = dart::simulation::World::create();
+    world->setTimeStep( 0.001 );
+    auto skeleton = create_double_pendulum_skeleton();
+    world->addSkeleton( skeleton );
+
+    const ssize_t capacity = 16;
+    loco::sensors::TDartJointSensors sensors( capacity );
+    const ssize_t sensor_0 = sensors.AddSensor( skeleton.get(), "hinge_0", loco::sensors::JOINT_QPOS |
+                                                                          loco::sensors::JOINT_QVEL |
+                                                                          loco::sensors::JOINT_TORQUE );
+    const ssize_t sensor_1 = sensors.AddSensor( skeleton.get(), "hinge_1", loco::sensors::JOINT_QVEL );
+    EXPECT_EQ( sensors.AddSensor( skeleton.get(), "missing", loco::sensors::JOINT_QPOS ), -1 );
+    EXPECT_EQ( sensors.num_sensors(), 2 );
+    EXPECT_EQ( sensors.num_columns( loco::sensors::JOINT_QPOS ), 1 );
+    EXPECT_EQ( sensors.num_columns( loco::sensors::JOINT_QVEL ), 2 );
+    EXPECT_EQ( sensors.num_columns( loco::sensors::JOINT_TORQUE ), 1 );
+    EXPECT_EQ( sensors.column( sensor_1, loco::sensors::JOINT_QPOS ), -1 );
+    EXPECT_EQ( sensors.column( sensor_1, loco::sensors::JOINT_QVEL ), 1 );
+
+    // Record more samples than the capacity, keeping track of the expected values of the newest ones
+    const ssize_t num_substeps = 40;
+    std::vector<double> expected_qpos, expected_qvel_1, expected_torques, expected_times;
+    for ( ssize_t i = 0; i < num_substeps; i++ )
+    {
+        const double torque = 0.1 * std::sin( 0.3 * i );
+        skeleton->setForce( 0, torque );
+        sensors.RecordCommands();
+        world->step( true );
+        sensors.RecordState( world->getTime() );
+
+        expected_torques.push_back( torque );
+        expected_qpos.push_back( skeleton->getPosition( 0 ) );
+        expected_qvel_1.push_back( skeleton->getVelocity( 1 ) );
+        expected_times.push_back( world->getTime() );
+    }
+    EXPECT_EQ( sensors.num_samples(), capacity );
+
+    // Histories are views into the ring-buffers (no copies), contiguous even after wrapping around
+    const auto qpos_history = sensors.GetHistory( loco::sensors::JOINT_QPOS );
+    const auto qvel_history = sensors.GetHistory( loco::sensors::JOINT_QVEL );
+    const auto torque_history = sensors.GetHistory( loco::sensors::JOINT_TORQUE );
+    const auto times = sensors.GetTimes();
+    ASSERT_EQ( qpos_history.rows(), capacity );
+    ASSERT_EQ( qvel_history.cols(), 2 );
+    for ( ssize_t i = 0; i < capacity; i++ )
+    {
+        const ssize_t k = num_substeps - capacity + i;
+        EXPECT_DOUBLE_EQ( qpos_history( i, 0 ), expected_qpos[k] );
+        EXPECT_DOUBLE_EQ( qvel_history( i, sensors.column( sensor_1, loco::sensors::JOINT_QVEL ) ), expected_qvel_1[k] );
+        EXPECT_DOUBLE_EQ( torque_history( i, sensors.column( sensor_0, loco::sensors::JOINT_TORQUE ) ), expected_torques[k] );
+        EXPECT_DOUBLE_EQ( times[i], expected_times[k] );
+    }
+
+    sensors.Clear();
+    EXPECT_EQ( sensors.GetHistory( loco::sensors::JOINT_QPOS ).rows(), 0 );
+    EXPECT_EQ( sensors.GetTimes().size(), 0 );
+}
@@ -0,0 +1,118 @@
+
+#include <loco.h>
+#include <gtest/gtest.h>
+
+#if defined( __linux__ )
+
+#include <server/loco_shm_server_dart.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+TEST( TestLocoDartShmServer, TestLocoDartShmServerRoundtrip )
+{
+    loco::InitUtils();
+
+    auto col_data = loco::TCollisionData();
+    col_data.type = loco::eShapeType::SPHERE;
+    col_data.size = { 0.1, 0.1, 0.1 };
+    auto body_data = loco::TBodyData();
+    body_data.dyntype = loco::eDynamicsType::DYNAMIC;
+    body_data.collision = col_data;
+    body_data.visual.type = loco::eShapeType::SPHERE;
+    body_data.visual.size = col_data.size;
+    auto scenario = std::make_unique<loco::TScenario>();
+    scenario->AddSingleBody( std::make_unique<loco::TSingleBody>( "ball", body_data, loco::TVec3( 0.0, 0.0, 1.0 ), loco::TMat3() ) );
+
+    auto simulation = std::make_unique<loco::TDartSimulation>( scenario.get() );
+    simulation->Initialize();
+    loco::server::TDartShmServer server( simulation.get(), "test_roundtrip" );
+    ASSERT_TRUE( server.Open() );
+    std::thread server_thread( &loco::server::TDartShmServer::Serve, &server );
+
+    // The client only needs the control-socket path, and could live in any other process
+    loco::server::TDartShmClient client;
+    ASSERT_TRUE( client.Connect( server.socket_path() ) );
+    ASSERT_TRUE( client.Read() );
+    ASSERT_EQ( client.states().rows(), 1 );
+    EXPECT_NEAR( client.states()( 0, 2 ), 1.0, 1e-6 );
+
+    const ssize_t num_steps = 1000;
+    for ( ssize_t i = 0; i < num_steps; i++ )
+        ASSERT_TRUE( client.Step() );
+
+    // Free-falling ball, with its state read straight from the shared region
+    const double sim_time = client.sim_time();
+    EXPECT_NEAR( sim_time, simulation->dart_world()->getTime(), 1e-9 );
+    EXPECT_NEAR( client.states()( 0, 9 ), simulation->dart_world()->getGravity().z() * sim_time, 1e-6 );
+    EXPECT_LT( client.states()( 0, 2 ), 1.0 );
+    EXPECT_EQ( client.num_contacts(), 0 );
+
+    ASSERT_TRUE( client.Reset() );
+    EXPECT_NEAR( client.states()( 0, 2 ), 1.0, 1e-6 );
+
+    server.Stop();
+    server_thread.join();
+    client.Disconnect();
+    server.Close();
+}
+
+TEST( TestLocoDartShmServer, TestLocoDartShmServerUntrustedHeader )
+{
+    loco::InitUtils();
+
+    auto body_data = loco::TBodyData();
+    body_data.dyntype = loco::eDynamicsType::DYNAMIC;
+    body_data.collision.type = loco::eShapeType::SPHERE;
+    body_data.collision.size = { 0.1, 0.1, 0.1 };
+    body_data.visual.type = loco::eShapeType::SPHERE;
+    body_data.visual.size = body_data.collision.size;
+    auto scenario = std::make_unique<loco::TScenario>();
+    scenario->AddSingleBody( std::make_unique<loco::TSingleBody>( "ball", body_data, loco::TVec3( 0.0, 0.0, 1.0 ), loco::TMat3() ) );
+    auto simulation = std::make_unique<loco::TDartSimulation>( scenario.get() );
+    simulation->Initialize();
+
+    // Names that don't fit in a control-socket path are rejected (instead of silently truncated)
+    loco::server::TDartShmServer server_long_name( simulation.get(), std::string( 200, 'x' ) );
+    EXPECT_FALSE( server_long_name.Open() );
+    loco::server::TDartShmClient client_long_name;
+    EXPECT_FALSE( client_long_name.Connect( "/tmp/" + std::string( 200, 'x' ) + ".sock" ) );
+
+    loco::server::TDartShmServer server( simulation.get(), "test_untrusted_header" );
+    ASSERT_TRUE( server.Open() );
+    std::thread server_thread( &loco::server::TDartShmServer::Serve, &server );
+    loco::server::TDartShmClient client;
+    ASSERT_TRUE( client.Connect( server.socket_path() ) );
+
+    // A client scribbling over the layout in the header can't make the server read or write out of the region
+    const int shm_fd = shm_open( server.shm_name().c_str(), O_RDWR, 0600 );
+    ASSERT_GE( shm_fd, 0 );
+    auto header = static_cast<loco::server::TDartShmHeader*>( mmap( nullptr, sizeof( loco::server::TDartShmHeader ),
+                                                                    PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0 ) );
+    ASSERT_NE( header, MAP_FAILED );
+    const auto header_backup = std::make_tuple( header->num_bodies, header->num_actuators, header->max_contacts,
+                                                header->offset_states, header->offset_actuation, header->offset_contacts );
+    header->num_bodies = 1 << 30;
+    header->num_actuators = 1 << 30;
+    header->max_contacts = 1 << 30;
+    header->offset_states = 1ull << 40;
+    header->offset_actuation = 1ull << 40;
+    header->offset_contacts = 1ull << 40;
+    for ( ssize_t i = 0; i < 10; i++ )
+        ASSERT_TRUE( client.Step() );
+    EXPECT_NEAR( client.sim_time(), simulation->dart_world()->getTime(), 1e-9 );
+
+    std::tie( header->num_bodies, header->num_actuators, header->max_contacts,
+              header->offset_states, header->offset_actuation, header->offset_contacts ) = header_backup;
+    ASSERT_TRUE( client.Read() );
+    EXPECT_NEAR( client.states()( 0, 2 ), simulation->state().poses( 0, 2 ), 1e-9 );
+    munmap( header, sizeof( loco::server::TDartShmHeader ) );
+    close( shm_fd );
+
+    server.Stop();
+    server_thread.join();
+    client.Disconnect();
+    server.Close();
+}
+
+#endif // __linux__
@@ -0,0 +1,93 @@
+
+#include <loco.h>
+#include <gtest/gtest.h>
+
+#include <loco_simulation_dart.h>
+
+std::unique_ptr<loco::TScenario> create_ball_drop_scenario()
+{
+    auto col_data_plane = loco::TCollisionData();
+    col_data_plane.type = loco::eShapeType::PLANE;
+    col_data_plane.size = { 10.0, 10.0, 1.0 };
+    auto body_data_plane = loco::TBodyData();
+    body_data_plane.dyntype = loco::eDynamicsType::STATIC;
+    body_data_plane.collision = col_data_plane;
+    body_data_plane.visual.type = loco::eShapeType::PLANE;
+    body_data_plane.visual.size = col_data_plane.size;
+
+    auto col_data_ball = loco::TCollisionData();
+    col_data_ball.type = loco::eShapeType::SPHERE;
+    col_data_ball.size = { 0.1, 0.1, 0.1 };
+    auto body_data_ball = loco::TBodyData();
+    body_data_ball.dyntype = loco::eDynamicsType::DYNAMIC;
+    body_data_ball.collision = col_data_ball;
+    body_data_ball.visual.type = loco::eShapeType::SPHERE;
+    body_data_ball.visual.size = col_data_ball.size;
+
+    auto scenario = std::make_unique<loco::TScenario>();
+    scenario->AddSingleBody( std::make_unique<loco::TSingleBody>( "plane", body_data_plane, loco::TVec3( 0.0, 0.0, 0.0 ), loco::TMat3() ) );
+    scenario->AddSingleBody( std::make_unique<loco::TSingleBody>( "ball", body_data_ball, loco::TVec3( 0.0, 0.0, 1.0 ), loco::TMat3() ) );
+    return scenario;
+}
+
+TEST( TestLocoDartSimulationSubsteps, TestLocoDartSimulationSubstepsFixedRemainder )
+{
+    loco::InitUtils();
+
+    auto scenario = create_ball_drop_scenario();
+    auto simulation = std::make_unique<loco::TDartSimulation>( scenario.get() );
+    simulation->SetTimeStep( 0.001 );
+    simulation->Initialize();
+
+    // Steps of 2.5 substeps: the remainder isn't dropped, but carried over to the next steps
+    for ( ssize_t i = 0; i < 4; i++ )
+        simulation->Step( 0.0025 );
+    EXPECT_EQ( simulation->substep_stats().total_substeps, 10 );
+    EXPECT_NEAR( simulation->dart_world()->getTime(), 0.01, 1e-9 );
+}
+
+TEST( TestLocoDartSimulationSubsteps, TestLocoDartSimulationSubstepsAdaptive )
+{
+    loco::InitUtils();
+
+    auto scenario = create_ball_drop_scenario();
+    auto simulation = std::make_unique<loco::TDartSimulation>( scenario.get() );
+    simulation->Initialize();
+
+    // Thresholds the errors are divided by must be positive
+    loco::dartsim::TDartAdaptiveSubstepData substep_data;
+    substep_data.max_constraint_error = 0.0;
+    simulation->EnableAdaptiveSubstepping( substep_data );
+    EXPECT_FALSE( simulation->adaptive_substepping() );
+
+    substep_data.min_substeps = 1;
+    substep_data.max_substeps = 16;
+    substep_data.max_penetration = 0.001;
+    substep_data.max_displacement = 1.0;
+    substep_data.max_constraint_error = std::numeric_limits<double>::infinity();
+    simulation->EnableAdaptiveSubstepping( substep_data );
+    EXPECT_TRUE( simulation->adaptive_substepping() );
+
+    // Free flight runs at the coarse time-step, and the impact raises the substeps
+    const double step_time = 0.01;
+    ssize_t max_num_substeps = 0;
+    ssize_t num_steps = 0;
+    for ( ; num_steps < 100; num_steps++ )
+    {
+        simulation->Step( step_time );
+        const auto& stats = simulation->substep_stats();
+        if ( simulation->dart_world()->getLastCollisionResult().getNumContacts() < 1 && max_num_substeps < 2 )
+            EXPECT_EQ( stats.num_substeps, 1 );
+        EXPECT_NEAR( stats.num_substeps * stats.substep_dt, step_time, 1e-12 );
+        max_num_substeps = std::max( max_num_substeps, stats.num_substeps );
+    }
+    EXPECT_GT( max_num_substeps, 1 );
+    EXPECT_LE( max_num_substeps, substep_data.max_substeps );
+    EXPECT_NEAR( simulation->dart_world()->getTime(), num_steps * step_time, 1e-9 );
+
+    // Back to fixed substeps
+    simulation->DisableAdaptiveSubstepping();
+    simulation->Step();
+    EXPECT_EQ( simulation->substep_stats().num_substeps, 1 );
+    EXPECT_DOUBLE_EQ( simulation->dart_world()->getTimeStep(), simulation->substep_stats().substep_dt );
+}
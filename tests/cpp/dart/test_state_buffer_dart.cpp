@@ -0,0 +1,238 @@
+
+#include <loco.h>
+#include <gtest/gtest.h>
+#include <future>
+
+#include <loco_common_dart.h>
+#include <loco_state_buffer_dart.h>
+#include <loco_simulation_dart.h>
+
+dart::dynamics::BodyNode* add_free_sphere( dart::simulation::World* world, const std::string& name, const Eigen::Vector3d& position )
+{
+    auto skeleton = dart::dynamics::Skeleton::create( name );
+    dart::dynamics::FreeJoint::Properties joint_properties;
+    auto bodynode = skeleton->createJointAndBodyNodePair<dart::dynamics::FreeJoint>(
+                        nullptr, joint_properties, dart::dynamics::BodyNode::AspectProperties( name ) ).second;
+    bodynode->createShapeNodeWith<dart::dynamics::CollisionAspect, dart::dynamics::DynamicsAspect>(
+                        std::make_shared<dart::dynamics::SphereShape>( 0.1 ) );
+    Eigen::Isometry3d tf = Eigen::Isometry3d::Identity();
+    tf.translation() = position;
+    dart::dynamics::FreeJoint::setTransform( bodynode, tf );
+    world->addSkeleton( skeleton );
+    return bodynode;
+}
+
+TEST( TestLocoDartStateBuffer, TestLocoDartStateBufferPublish )
+{
+    loco::InitUtils();
+
+    auto world = dart::simulation::World::create();
+    world->setTimeStep( 0.001 );
+    auto body_a = add_free_sphere( world.get(), "sphere_a", Eigen::Vector3d( 0.0, 0.0, 2.0 ) );
+    auto body_b = add_free_sphere( world.get(), "sphere_b", Eigen::Vector3d( 1.0, 0.0, 2.0 ) );
+
+    loco::dartsim::TDartQueries queries( world.get(), 0 );
+    loco::dartsim::TDartStateBuffer state_buffer;
+    EXPECT_EQ( state_buffer.AddBody( body_a, "sphere_a" ), 0 );
+    EXPECT_EQ( state_buffer.AddBody( body_b, "sphere_b" ), 1 );
+    EXPECT_EQ( state_buffer.AddBody( nullptr, "none" ), -1 );
+    EXPECT_EQ( state_buffer.body_index( "sphere_b" ), 1 );
+    EXPECT_EQ( state_buffer.num_bodies(), 2 );
+
+    // Step on another thread while reading the last published snapshot (as ->StepAsync and ->state() do)
+    auto step_and_publish = [&]()
+        {
+            world->step();
+            state_buffer.Publish( world->getTime(), world->getLastCollisionResult(), queries );
+        };
+    step_and_publish();
+    ssize_t last_sequence = -1;
+    for ( ssize_t i = 0; i < 200; i++ )
+    {
+        auto step_future = std::async( std::launch::async, step_and_publish );
+        const auto& snapshot = state_buffer.front();
+        // Both spheres fall in the same way, so a consistent snapshot has them at the same height
+        EXPECT_GT( snapshot.sequence, last_sequence );
+        EXPECT_DOUBLE_EQ( snapshot.poses( 0, 2 ), snapshot.poses( 1, 2 ) );
+        EXPECT_DOUBLE_EQ( snapshot.velocities( 0, 2 ), snapshot.velocities( 1, 2 ) );
+        EXPECT_NEAR( snapshot.velocities( 0, 2 ), world->getGravity().z() * snapshot.time, 1e-9 );
+        last_sequence = snapshot.sequence;
+        step_future.wait();
+    }
+
+    const auto& snapshot = state_buffer.front();
+    EXPECT_EQ( snapshot.sequence, 200 );
+    EXPECT_NEAR( snapshot.poses( 1, 0 ), 1.0, 1e-9 );
+    EXPECT_NEAR( snapshot.poses( 0, 6 ), 1.0, 1e-9 ); // identity quaternion (qw last)
+    EXPECT_EQ( snapshot.contacts.size(), 0 );
+
+    // Copies taken while publishing as fast as possible (several publishes per copy) are consistent as well
+    auto publish_future = std::async( std::launch::async, [&]()
+        {
+            for ( ssize_t i = 0; i < 2000; i++ )
+                step_and_publish();
+        } );
+    loco::dartsim::TDartStateSnapshot snapshot_copy;
+    last_sequence = -1;
+    while ( last_sequence < 2200 )
+    {
+        state_buffer.CopyFront( snapshot_copy );
+        ASSERT_GE( snapshot_copy.sequence, last_sequence );
+        ASSERT_EQ( snapshot_copy.poses( 0, 2 ), snapshot_copy.poses( 1, 2 ) );
+        ASSERT_EQ( snapshot_copy.velocities( 0, 2 ), snapshot_copy.velocities( 1, 2 ) );
+        last_sequence = snapshot_copy.sequence;
+    }
+    publish_future.wait();
+}
+
+TEST( TestLocoDartStateBuffer, TestLocoDartStateBufferCopyContacts )
+{
+    loco::InitUtils();
+
+    // Spheres dropped from increasing heights onto a floor, so the number of contacts keeps growing (and so do the
+    // contacts-buffers of the snapshots) while copies are being taken
+    auto world = dart::simulation::World::create();
+    world->setTimeStep( 0.001 );
+    auto floor = dart::dynamics::Skeleton::create( "floor" );
+    auto floor_bodynode = floor->createJointAndBodyNodePair<dart::dynamics::WeldJoint>().second;
+    auto floor_shape_node = floor_bodynode->createShapeNodeWith<dart::dynamics::CollisionAspect, dart::dynamics::DynamicsAspect>(
+                                std::make_shared<dart::dynamics::BoxShape>( Eigen::Vector3d( 100.0, 100.0, 0.2 ) ) );
+    floor_shape_node->setRelativeTranslation( Eigen::Vector3d( 0.0, 0.0, -0.1 ) );
+    world->addSkeleton( floor );
+
+    loco::dartsim::TDartStateBuffer state_buffer;
+    const ssize_t num_spheres = 40;
+    for ( ssize_t i = 0; i < num_spheres; i++ )
+    {
+        const std::string name = "sphere_" + std::to_string( i );
+        state_buffer.AddBody( add_free_sphere( world.get(), name, Eigen::Vector3d( 0.5 * i, 0.0, 0.1 + 0.02 * i ) ), name );
+    }
+    loco::dartsim::TDartQueries queries( world.get(), 0 );
+
+    const ssize_t num_steps = 2000;
+    auto publish_future = std::async( std::launch::async, [&]()
+        {
+            for ( ssize_t i = 0; i < num_steps; i++ )
+            {
+                world->step();
+                state_buffer.Publish( world->getTime(), world->getLastCollisionResult(), queries );
+            }
+        } );
+
+    // Copied contacts are always contacts of a single snapshot: spheres touching the floor from above
+    loco::dartsim::TDartStateSnapshot snapshot_copy;
+    size_t max_num_contacts = 0;
+    ssize_t last_sequence = -1;
+    while ( last_sequence < num_steps - 1 )
+    {
+        state_buffer.CopyFront( snapshot_copy );
+        ASSERT_GE( snapshot_copy.sequence, last_sequence );
+        for ( const auto& contact : snapshot_copy.contacts )
+        {
+            ASSERT_NEAR( contact.position.z(), 0.0, 0.05 );
+            ASSERT_NEAR( std::abs( contact.normal.z() ), 1.0, 1e-3 );
+        }
+        max_num_contacts = std::max( max_num_contacts, snapshot_copy.contacts.size() );
+        last_sequence = snapshot_copy.sequence;
+    }
+    publish_future.wait();
+
+    // All spheres end up resting on the floor
+    state_buffer.CopyFront( snapshot_copy );
+    EXPECT_GE( snapshot_copy.contacts.size(), num_spheres );
+    EXPECT_EQ( snapshot_copy.contacts.size(), state_buffer.front().contacts.size() );
+    EXPECT_GE( max_num_contacts, num_spheres );
+}
+
+TEST( TestLocoDartStateBuffer, TestLocoDartStateBufferVisualHandoff )
+{
+    loco::InitUtils();
+
+    auto world = dart::simulation::World::create();
+    world->setTimeStep( 0.001 );
+    std::vector<const dart::dynamics::BodyNode*> body_nodes;
+    for ( ssize_t i = 0; i < 50; i++ )
+        body_nodes.push_back( add_free_sphere( world.get(), "sphere_" + std::to_string( i ), Eigen::Vector3d( i, 0.0, 2.0 ) ) );
+
+    loco::dartsim::TDartVisualBuffer visual_buffer;
+    EXPECT_EQ( visual_buffer.Acquire().sequence, -1 );
+
+    // Physics publishes every step, while the renderer grabs frames at its own pace
+    const ssize_t num_steps = 2000;
+    auto physics_future = std::async( std::launch::async, [&]()
+        {
+            for ( ssize_t i = 0; i < num_steps; i++ )
+            {
+                world->step();
+                visual_buffer.Publish( world->getTime(), body_nodes );
+            }
+        } );
+
+    ssize_t last_sequence = -1;
+    ssize_t num_frames_rendered = 0;
+    while ( last_sequence < num_steps - 1 )
+    {
+        const auto& frame = visual_buffer.Acquire();
+        if ( frame.sequence == last_sequence )
+            continue;
+        // Frames are never older than the previous one, and are consistent (all spheres at the same height)
+        ASSERT_GT( frame.sequence, last_sequence );
+        ASSERT_EQ( frame.transforms.size(), body_nodes.size() );
+        for ( size_t j = 0; j < frame.transforms.size(); j++ )
+            ASSERT_EQ( frame.transforms[j]( 2, 3 ), frame.transforms[0]( 2, 3 ) );
+        last_sequence = frame.sequence;
+        num_frames_rendered++;
+    }
+    physics_future.wait();
+
+    EXPECT_GT( num_frames_rendered, 0 );
+    EXPECT_NEAR( visual_buffer.Acquire().time, world->getTime(), 1e-9 );
+    EXPECT_NEAR( visual_buffer.Acquire().transforms[10]( 0, 3 ), 10.0, 1e-5 );
+}
+
+TEST( TestLocoDartStateBuffer, TestLocoDartStateBufferVisualHandoffAsyncSteps )
+{
+    loco::InitUtils();
+
+    auto scenario = std::make_unique<loco::TScenario>();
+    for ( ssize_t i = 0; i < 4; i++ )
+    {
+        auto body_data = loco::TBodyData();
+        body_data.dyntype = loco::eDynamicsType::DYNAMIC;
+        body_data.collision.type = loco::eShapeType::SPHERE;
+        body_data.collision.size = { 0.1f, 0.1f, 0.1f };
+        body_data.visual.type = loco::eShapeType::SPHERE;
+        body_data.visual.size = { 0.1f, 0.1f, 0.1f };
+        scenario->AddSingleBody( std::make_unique<loco::TSingleBody>( "sphere_" + std::to_string( i ), body_data,
+                                                                      loco::TVec3( i, 0.0f, 2.0f ), loco::TMat3() ) );
+    }
+    auto simulation = std::make_unique<loco::TDartSimulation>( scenario.get() );
+    simulation->Initialize();
+    auto visual_buffer = simulation->visual_buffer();
+    ASSERT_TRUE( visual_buffer != nullptr );
+
+    // The rendering side grabs frames while the physics thread steps, never waiting for it
+    ssize_t last_sequence = visual_buffer->Acquire().sequence;
+    for ( ssize_t i = 0; i < 200; i++ )
+    {
+        simulation->StepAsync();
+        while ( simulation->stepping() )
+        {
+            const auto& frame = visual_buffer->Acquire();
+            ASSERT_GE( frame.sequence, last_sequence );
+            last_sequence = frame.sequence;
+        }
+        simulation->Wait();
+    }
+
+    // Once the steps are done, the latest frame matches the published state (all spheres falling together)
+    const auto& frame = visual_buffer->Acquire();
+    ASSERT_EQ( frame.transforms.size(), 4 );
+    EXPECT_NEAR( frame.time, simulation->state().time, 1e-9 );
+    for ( ssize_t i = 0; i < 4; i++ )
+    {
+        EXPECT_NEAR( frame.transforms[i]( 0, 3 ), simulation->state().poses( i, 0 ), 1e-5 );
+        EXPECT_NEAR( frame.transforms[i]( 2, 3 ), simulation->state().poses( i, 2 ), 1e-5 );
+    }
+    EXPECT_LT( frame.transforms[0]( 2, 3 ), 2.0 );
+}
@@ -0,0 +1,82 @@
+
+#include <loco.h>
+#include <gtest/gtest.h>
+
+#include <terrain/loco_terrain_tiled_dart.h>
+
+TEST( TestLocoDartTiledTerrain, TestLocoDartTiledTerrainStreaming )
+{
+    loco::InitUtils();
+
+    // 257x257 samples over 256x256 meters, split into tiles of 33 samples (8x8 tiles of 32x32 meters)
+    const ssize_t num_width_samples = 257;
+    const ssize_t num_depth_samples = 257;
+    std::vector<float> heights( num_width_samples * num_depth_samples, 0.0f );
+    for ( ssize_t i = 0; i < num_depth_samples; i++ )
+        for ( ssize_t j = 0; j < num_width_samples; j++ )
+            heights[i * num_width_samples + j] = 0.01f * ( i + j );
+
+    const std::string heights_filepath = "./tiled_terrain_heights.bin";
+    ASSERT_TRUE( loco::terrain::CreateHeightFile( heights_filepath, num_width_samples, num_depth_samples,
+                                                  { 256.0f, 256.0f, 1.0f }, heights ) );
+
+    auto terrain_data = loco::terrain::TDartTiledTerrainData();
+    terrain_data.name = "terrain_0";
+    terrain_data.heights_filepath = heights_filepath;
+    terrain_data.tile_num_samples = 33;
+    terrain_data.activation_radius = 25.0f;
+
+    auto dart_world = dart::simulation::World::create();
+    dart_world->getConstraintSolver()->setCollisionDetector( dart::collision::BulletCollisionDetector::create() );
+    auto tiled_terrain = std::make_unique<loco::terrain::TDartTiledTerrain>( terrain_data );
+    ASSERT_TRUE( tiled_terrain->valid() );
+    EXPECT_EQ( tiled_terrain->num_tiles_x(), 8 );
+    EXPECT_EQ( tiled_terrain->num_tiles_y(), 8 );
+    tiled_terrain->SetDartWorld( dart_world.get() );
+
+    // A body at the center of the terrain requires only the 4 tiles around it
+    tiled_terrain->Update( { Eigen::Vector3d( 0.0, 0.0, 1.0 ) } );
+    EXPECT_EQ( tiled_terrain->num_active_tiles(), 4 );
+    EXPECT_EQ( dart_world->getNumSkeletons(), 4 );
+
+    // Moving to a corner evicts the previous tiles and loads only the corner one
+    tiled_terrain->Update( { Eigen::Vector3d( 112.0, -112.0, 1.0 ) } );
+    EXPECT_EQ( tiled_terrain->num_active_tiles(), 1 );
+    EXPECT_EQ( dart_world->getNumSkeletons(), 1 );
+
+    // Ground height seen by bullet (sample (j,i) of the height-file lies at x = -128 + j, y = 128 - i)
+    auto fnGroundHeight = [&]( double x, double y )
+        {
+            auto bullet_group = dynamic_cast<dart::collision::BulletCollisionGroup*>( dart_world->getConstraintSolver()->getCollisionGroup().get() );
+            const btVector3 ray_from( x, y, 10.0 );
+            const btVector3 ray_to( x, y, -10.0 );
+            btCollisionWorld::ClosestRayResultCallback result_callback( ray_from, ray_to );
+            bullet_group->getBulletCollisionWorld()->rayTest( ray_from, ray_to, result_callback );
+            return result_callback.hasHit() ? 10.0 - 20.0 * result_callback.m_closestHitFraction : -1e3;
+        };
+
+    // Edits are written through to the height-file, so reloaded tiles see them
+    tiled_terrain->ChangeElevationRegion( 0, 0, 2, 2, { 5.0f, 5.0f, 5.0f, 5.0f } );
+    tiled_terrain->Update( { Eigen::Vector3d( -112.0, 112.0, 1.0 ) } );
+    std::vector<const dart::dynamics::Shape*> active_shapes;
+    tiled_terrain->GetActiveShapes( active_shapes );
+    ASSERT_EQ( active_shapes.size(), 1 );
+    dart_world->step();
+    EXPECT_NEAR( fnGroundHeight( -127.5, 127.5 ), 5.0, 1e-4 );
+    EXPECT_NEAR( fnGroundHeight( -108.0, 118.0 ), 0.3, 1e-4 );
+
+    // Edits of active tiles reach the buffers used by bullet (flipped in place by it), both when written in
+    // place and when the tile has to be rebuilt (edit going past its vertical bounds)
+    tiled_terrain->ChangeElevationRegion( 4, 4, 2, 2, { 0.5f, 0.5f, 0.5f, 0.5f } );
+    dart_world->step();
+    EXPECT_NEAR( fnGroundHeight( -123.5, 123.5 ), 0.5, 1e-4 );
+    EXPECT_NEAR( fnGroundHeight( -108.0, 118.0 ), 0.3, 1e-4 );
+    tiled_terrain->ChangeElevationRegion( 8, 8, 2, 2, { 7.0f, 7.0f, 7.0f, 7.0f } );
+    dart_world->step();
+    EXPECT_NEAR( fnGroundHeight( -119.5, 119.5 ), 7.0, 1e-4 );
+    EXPECT_NEAR( fnGroundHeight( -123.5, 123.5 ), 0.5, 1e-4 );
+    EXPECT_NEAR( fnGroundHeight( -108.0, 118.0 ), 0.3, 1e-4 );
+
+    tiled_terrain = nullptr;
+    std::remove( heights_filepath.c_str() );
+}
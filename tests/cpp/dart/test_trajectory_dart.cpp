@@ -0,0 +1,152 @@
+
+#include <loco.h>
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+#include <loco_trajectory_dart.h>
+
+TEST( TestLocoDartTrajectory, TestLocoDartTrajectoryQuaternionPacking )
+{
+    std::mt19937 random_generator( 0 );
+    std::normal_distribution<double> random_normal( 0.0, 1.0 );
+    for ( ssize_t i = 0; i < 1000; i++ )
+    {
+        const Eigen::Vector4d quat = Eigen::Vector4d( random_normal( random_generator ), random_normal( random_generator ),
+                                                      random_normal( random_generator ), random_normal( random_generator ) ).normalized();
+        const Eigen::Vector4d quat_unpacked = loco::dartsim::DequantizeQuaternion( loco::dartsim::QuantizeQuaternion( quat ) );
+        // Angle between both rotations (q and -q being the same rotation)
+        const double angle = 2.0 * std::acos( std::min( std::abs( quat.dot( quat_unpacked ) ), 1.0 ) );
+        ASSERT_LT( angle, 0.2 * M_PI / 180.0 );
+    }
+}
+
+TEST( TestLocoDartTrajectory, TestLocoDartTrajectoryRoundtrip )
+{
+    loco::InitUtils();
+
+    // Half of the bodies move (random walks), the other half rest
+    const std::string trajectory_filepath = "test_trajectory_dart.bin";
+    const ssize_t num_bodies = 200;
+    const ssize_t num_frames = 500;
+    std::vector<std::string> body_names;
+    for ( ssize_t i = 0; i < num_bodies; i++ )
+        body_names.push_back( "body_" + std::to_string( i ) );
+
+    std::mt19937 random_generator( 0 );
+    std::normal_distribution<double> random_normal( 0.0, 1.0 );
+    loco::dartsim::TDartStateSnapshot snapshot;
+    snapshot.poses.resize( num_bodies, Eigen::NoChange );
+    snapshot.velocities.resize( num_bodies, Eigen::NoChange );
+    for ( ssize_t i = 0; i < num_bodies; i++ )
+    {
+        snapshot.poses.row( i ) << 0.5 * i, -0.25 * i, 1.0, 0.0, 0.0, 0.0, 1.0;
+        snapshot.velocities.row( i ).setZero();
+    }
+
+    loco::dartsim::TDartTrajectoryData trajectory_data;
+    trajectory_data.keyframe_interval = 100;
+    trajectory_data.queue_capacity = num_frames; // no frames dropped, whatever the speed of the writer
+    trajectory_data.chunk_size = 64 * 1024; // several chunks get mapped
+    std::vector<loco::dartsim::TDartStateSnapshot> snapshots;
+    {
+        loco::dartsim::TDartTrajectoryRecorder recorder( trajectory_filepath, body_names, trajectory_data );
+        ASSERT_TRUE( recorder.valid() );
+        for ( ssize_t k = 0; k < num_frames; k++ )
+        {
+            snapshot.time = 0.001 * k;
+            for ( ssize_t i = 0; i < num_bodies; i += 2 )
+            {
+                for ( ssize_t j = 0; j < 6; j++ )
+                    snapshot.velocities( i, j ) = random_normal( random_generator );
+                snapshot.poses.block<1, 3>( i, 0 ) += 0.001 * snapshot.velocities.block<1, 3>( i, 0 );
+                Eigen::Quaterniond quat( snapshot.poses( i, 6 ), snapshot.poses( i, 3 ), snapshot.poses( i, 4 ), snapshot.poses( i, 5 ) );
+                const Eigen::Vector3d delta_angle = 0.001 * snapshot.velocities.block<1, 3>( i, 3 ).transpose();
+                quat = ( Eigen::Quaterniond( Eigen::AngleAxisd( delta_angle.norm(), delta_angle.normalized() ) ) * quat ).normalized();
+                snapshot.poses.block<1, 4>( i, 3 ) = quat.coeffs().transpose();
+            }
+            recorder.Record( snapshot );
+            snapshots.push_back( snapshot );
+        }
+        recorder.Close();
+        EXPECT_EQ( recorder.num_frames_recorded(), num_frames );
+        EXPECT_EQ( recorder.num_frames_dropped(), 0 );
+        // Much smaller than the raw states (13 doubles per body per frame)
+        EXPECT_LT( double( recorder.num_bytes_written() ) / ( num_frames * num_bodies ), 0.5 * 13 * sizeof( double ) );
+    }
+
+    // Decoded states are within the quantization errors of the recorded ones
+    loco::dartsim::TDartTrajectoryReader reader( trajectory_filepath );
+    ASSERT_TRUE( reader.valid() );
+    ASSERT_EQ( reader.num_bodies(), num_bodies );
+    EXPECT_EQ( reader.body_name( 3 ), "body_3" );
+    loco::dartsim::TDartStateSnapshot snapshot_decoded;
+    for ( ssize_t k = 0; k < num_frames; k++ )
+    {
+        ASSERT_TRUE( reader.Next( snapshot_decoded ) );
+        EXPECT_EQ( snapshot_decoded.sequence, k );
+        EXPECT_DOUBLE_EQ( snapshot_decoded.time, snapshots[k].time );
+        const double position_error = ( snapshot_decoded.poses.leftCols<3>() - snapshots[k].poses.leftCols<3>() ).cwiseAbs().maxCoeff();
+        const double velocity_error = ( snapshot_decoded.velocities - snapshots[k].velocities ).cwiseAbs().maxCoeff();
+        ASSERT_LE( position_error, 0.5 * trajectory_data.position_resolution + 1e-12 );
+        ASSERT_LE( velocity_error, 0.5 * trajectory_data.velocity_resolution + 1e-12 );
+        for ( ssize_t i = 0; i < num_bodies; i++ )
+        {
+            const double quat_dot = snapshot_decoded.poses.block<1, 4>( i, 3 ).dot( snapshots[k].poses.block<1, 4>( i, 3 ) );
+            ASSERT_LT( 2.0 * std::acos( std::min( std::abs( quat_dot ), 1.0 ) ), 0.2 * M_PI / 180.0 );
+        }
+    }
+    EXPECT_FALSE( reader.Next( snapshot_decoded ) );
+
+    reader.Rewind();
+    ASSERT_TRUE( reader.Next( snapshot_decoded ) );
+    EXPECT_EQ( snapshot_decoded.sequence, 0 );
+
+    // A frame cut short (e.g. the recorder crashed while writing it) ends the trajectory, every time it's reached
+    const std::string truncated_filepath = "test_trajectory_dart_truncated.bin";
+    {
+        std::ifstream file( trajectory_filepath, std::ios::binary );
+        std::string contents( ( std::istreambuf_iterator<char>( file ) ), std::istreambuf_iterator<char>() );
+        std::ofstream truncated_file( truncated_filepath, std::ios::binary );
+        truncated_file.write( contents.data(), contents.size() - 3 );
+    }
+    loco::dartsim::TDartTrajectoryReader truncated_reader( truncated_filepath );
+    ASSERT_TRUE( truncated_reader.valid() );
+    ssize_t num_frames_truncated = 0;
+    while ( truncated_reader.Next( snapshot_decoded ) )
+        num_frames_truncated++;
+    EXPECT_EQ( num_frames_truncated, num_frames - 1 );
+    EXPECT_FALSE( truncated_reader.Next( snapshot_decoded ) );
+    std::remove( truncated_filepath.c_str() );
+    std::remove( trajectory_filepath.c_str() );
+}
+
+TEST( TestLocoDartTrajectory, TestLocoDartTrajectoryMaxFileSize )
+{
+    loco::InitUtils();
+
+    const std::string trajectory_filepath = "test_trajectory_dart_limited.bin";
+    loco::dartsim::TDartStateSnapshot snapshot;
+    snapshot.poses.resize( 10, Eigen::NoChange );
+    snapshot.velocities.resize( 10, Eigen::NoChange );
+    snapshot.poses.setZero();
+    snapshot.poses.col( 6 ).setOnes();
+    snapshot.velocities.setZero();
+
+    loco::dartsim::TDartTrajectoryData trajectory_data;
+    trajectory_data.max_file_size = 4096;
+    trajectory_data.queue_capacity = 1000;
+    loco::dartsim::TDartTrajectoryRecorder recorder( trajectory_filepath, std::vector<std::string>( 10, "body" ), trajectory_data );
+    for ( ssize_t k = 0; k < 1000; k++ )
+    {
+        snapshot.time = 0.001 * k;
+        snapshot.poses( k % 10, 0 ) += 0.01;
+        recorder.Record( snapshot );
+    }
+    recorder.Close();
+    EXPECT_LE( recorder.num_bytes_written(), trajectory_data.max_file_size );
+    EXPECT_EQ( recorder.num_frames_recorded() + recorder.num_frames_dropped(), 1000 );
+    EXPECT_GT( recorder.num_frames_dropped(), 0 );
+    std::remove( trajectory_filepath.c_str() );
+}